@@ -35,8 +35,35 @@ typedef struct tagDISKCONTEXT
     ULONGLONG SectorOffset;
     ULONGLONG SectorCount;
     ULONGLONG SectorNumber;
+    BOOLEAN ReadAheadAllowed;
+
+    /* Statistics, dumped on close */
+    ULONG ReadCount;
+    ULONG DeviceReadCount;
+    ULONGLONG DeviceSectors;
+    ULONGLONG ReadAheadSectors;
 } DISKCONTEXT;
 
+/*
+ * Read-ahead window. File systems read files a cluster or a run at a
+ * time, and every DiskRead used to become at least one BIOS call, which
+ * means a real mode round trip. Once reads go sequential, a whole
+ * DiskReadBuffer worth of sectors is fetched in one call and later reads
+ * are served from this copy.
+ */
+typedef struct tagDISKREADAHEAD
+{
+    PUCHAR Buffer;
+    UCHAR DriveNumber;
+    ULONG SectorSize;
+    ULONGLONG StartSector;
+    ULONG SectorCount;
+
+    /* Where the last read ended */
+    UCHAR NextDriveNumber;
+    ULONGLONG NextSector;
+} DISKREADAHEAD;
+
 static const CHAR Hex[] = "0123456789abcdef";
 
 /* Data cache for BIOS disks pre-enumeration */
@@ -46,6 +73,8 @@ static CHAR PcDiskIdentifier[32][20];
 PVOID DiskReadBuffer;
 SIZE_T DiskReadBufferSize;
 
+static DISKREADAHEAD DiskReadAhead;
+
 
 /* FUNCTIONS *****************************************************************/
 
@@ -53,6 +82,11 @@ static ARC_STATUS
 DiskClose(ULONG FileId)
 {
     DISKCONTEXT* Context = FsGetDeviceSpecific(FileId);
+
+    TRACE("Disk 0x%x: %lu reads, %lu device reads of %I64u sectors, %I64u sectors from read-ahead\n",
+          Context->DriveNumber, Context->ReadCount, Context->DeviceReadCount,
+          Context->DeviceSectors, Context->ReadAheadSectors);
+
     FrLdrTempFree(Context, TAG_HW_DISK_CONTEXT);
     return ESUCCESS;
 }
@@ -146,19 +180,100 @@ DiskOpen(CHAR* Path, OPENMODE OpenMode, ULONG* FileId)
     Context->SectorOffset = SectorOffset;
     Context->SectorCount = SectorCount;
     Context->SectorNumber = 0;
+    Context->ReadCount = 0;
+    Context->DeviceReadCount = 0;
+    Context->DeviceSectors = 0;
+    Context->ReadAheadSectors = 0;
+
+    /*
+     * Only read ahead where the end of the device is known, so the window
+     * never runs past it. CD-ROMs don't report a reliable size.
+     */
+    Context->ReadAheadAllowed = (DrivePartition != 0xff && SectorCount != 0);
+
+    /* The medium may have changed since the window was filled */
+    DiskReadAhead.SectorCount = 0;
+
     FsSetDeviceSpecific(*FileId, Context);
 
     return ESUCCESS;
 }
 
+static BOOLEAN
+DiskReadAheadLookup(
+    IN DISKCONTEXT* Context,
+    IN ULONGLONG SectorOffset,
+    OUT PUCHAR* Data,
+    OUT PULONG SectorCount)
+{
+    if (DiskReadAhead.SectorCount == 0 ||
+        DiskReadAhead.DriveNumber != Context->DriveNumber ||
+        DiskReadAhead.SectorSize != Context->SectorSize ||
+        SectorOffset < DiskReadAhead.StartSector ||
+        SectorOffset >= DiskReadAhead.StartSector + DiskReadAhead.SectorCount)
+    {
+        return FALSE;
+    }
+
+    *Data = DiskReadAhead.Buffer +
+            (ULONG)(SectorOffset - DiskReadAhead.StartSector) * Context->SectorSize;
+    *SectorCount = (ULONG)(DiskReadAhead.StartSector + DiskReadAhead.SectorCount - SectorOffset);
+    return TRUE;
+}
+
+static BOOLEAN
+DiskReadAheadFill(
+    IN DISKCONTEXT* Context,
+    IN ULONGLONG SectorOffset,
+    IN ULONG MinimumSectors)
+{
+    ULONG SectorCount;
+    ULONGLONG EndSector;
+
+    if (!DiskReadAhead.Buffer)
+    {
+        /* The temporary heap is gone before the last reads, so use the default one */
+        DiskReadAhead.Buffer = FrLdrHeapAlloc(DiskReadBufferSize, TAG_HW_DISK_READAHEAD);
+        if (!DiskReadAhead.Buffer)
+            return FALSE;
+    }
+
+    /* Fill as much as the transfer buffer allows, without leaving the device */
+    SectorCount = DiskReadBufferSize / Context->SectorSize;
+    EndSector = Context->SectorOffset + Context->SectorCount;
+    if (SectorOffset + SectorCount > EndSector)
+        SectorCount = (ULONG)(EndSector - SectorOffset);
+    if (SectorCount < MinimumSectors)
+        return FALSE;
+
+    DiskReadAhead.SectorCount = 0;
+    if (!MachDiskReadLogicalSectors(Context->DriveNumber,
+                                    SectorOffset,
+                                    SectorCount,
+                                    DiskReadBuffer))
+    {
+        return FALSE;
+    }
+    Context->DeviceReadCount++;
+    Context->DeviceSectors += SectorCount;
+
+    RtlCopyMemory(DiskReadAhead.Buffer, DiskReadBuffer, SectorCount * Context->SectorSize);
+    DiskReadAhead.DriveNumber = Context->DriveNumber;
+    DiskReadAhead.SectorSize = Context->SectorSize;
+    DiskReadAhead.StartSector = SectorOffset;
+    DiskReadAhead.SectorCount = SectorCount;
+    return TRUE;
+}
+
 static ARC_STATUS
 DiskRead(ULONG FileId, VOID* Buffer, ULONG N, ULONG* Count)
 {
     DISKCONTEXT* Context = FsGetDeviceSpecific(FileId);
     UCHAR* Ptr = (UCHAR*)Buffer;
+    PUCHAR Data;
     ULONG Length, TotalSectors, MaxSectors, ReadSectors;
     ULONGLONG SectorOffset;
-    BOOLEAN ret;
+    BOOLEAN ret, Sequential;
 
     ASSERT(DiskReadBufferSize > 0);
 
@@ -170,26 +285,58 @@ DiskRead(ULONG FileId, VOID* Buffer, ULONG N, ULONG* Count)
     // In release builds assertions are disabled, however we also have sanity checks in DiskOpen()
     ASSERT(MaxSectors > 0);
 
+    Context->ReadCount++;
+
+    /* Reads that continue the previous one are worth reading ahead for */
+    Sequential = Context->ReadAheadAllowed &&
+                 ((DiskReadAhead.NextDriveNumber == Context->DriveNumber &&
+                   SectorOffset == DiskReadAhead.NextSector) ||
+                  (DiskReadAhead.SectorCount != 0 &&
+                   DiskReadAhead.DriveNumber == Context->DriveNumber &&
+                   SectorOffset == DiskReadAhead.StartSector + DiskReadAhead.SectorCount));
+
     ret = TRUE;
 
     while (TotalSectors)
     {
-        ReadSectors = TotalSectors;
-        if (ReadSectors > MaxSectors)
-            ReadSectors = MaxSectors;
-
-        ret = MachDiskReadLogicalSectors(Context->DriveNumber,
-                                         SectorOffset,
-                                         ReadSectors,
-                                         DiskReadBuffer);
-        if (!ret)
-            break;
+        /* Take what the read-ahead window already has */
+        if (DiskReadAheadLookup(Context, SectorOffset, &Data, &ReadSectors))
+        {
+            if (ReadSectors > TotalSectors)
+                ReadSectors = TotalSectors;
+            Context->ReadAheadSectors += ReadSectors;
+        }
+        /* Small sequential reads refill the window and take their part from it */
+        else if (Sequential && TotalSectors < MaxSectors &&
+                 DiskReadAheadFill(Context, SectorOffset, TotalSectors))
+        {
+            Data = DiskReadAhead.Buffer;
+            ReadSectors = TotalSectors;
+            Context->ReadAheadSectors += ReadSectors;
+        }
+        else
+        {
+            ReadSectors = TotalSectors;
+            if (ReadSectors > MaxSectors)
+                ReadSectors = MaxSectors;
+
+            ret = MachDiskReadLogicalSectors(Context->DriveNumber,
+                                             SectorOffset,
+                                             ReadSectors,
+                                             DiskReadBuffer);
+            if (!ret)
+                break;
+
+            Context->DeviceReadCount++;
+            Context->DeviceSectors += ReadSectors;
+            Data = DiskReadBuffer;
+        }
 
         Length = ReadSectors * Context->SectorSize;
         if (Length > N)
             Length = N;
 
-        RtlCopyMemory(Ptr, DiskReadBuffer, Length);
+        RtlCopyMemory(Ptr, Data, Length);
 
         Ptr += Length;
         N -= Length;
@@ -197,6 +344,9 @@ DiskRead(ULONG FileId, VOID* Buffer, ULONG N, ULONG* Count)
         TotalSectors -= ReadSectors;
     }
 
+    DiskReadAhead.NextDriveNumber = Context->DriveNumber;
+    DiskReadAhead.NextSector = SectorOffset;
+
     *Count = (ULONG)((ULONG_PTR)Ptr - (ULONG_PTR)Buffer);
     Context->SectorNumber = SectorOffset - Context->SectorOffset;
 
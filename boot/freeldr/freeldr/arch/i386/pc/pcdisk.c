@@ -43,6 +43,9 @@ typedef struct
                                         //       such extended structure
 } I386_DISK_ADDRESS_PACKET, *PI386_DISK_ADDRESS_PACKET;
 
+/* Largest LBABlockCount that every EDD implementation accepts */
+#define PC_DISK_MAX_LBA_TRANSFER 0x7F
+
 typedef struct
 {
     UCHAR   PacketSize;     // 00h - Size of packet in bytes (13h)
@@ -557,62 +560,94 @@ PcDiskDriveNumberToDrive(IN UCHAR DriveNumber)
 static BOOLEAN
 PcDiskReadLogicalSectorsLBA(
     IN UCHAR DriveNumber,
+    IN PPC_DISK_DRIVE DiskDrive,
     IN ULONGLONG SectorNumber,
     IN ULONG SectorCount,
     OUT PVOID Buffer)
 {
     REGS RegsIn, RegsOut;
     ULONG RetryCount;
+    ULONG BlockCount, SectorSize;
     PI386_DISK_ADDRESS_PACKET Packet = (PI386_DISK_ADDRESS_PACKET)(BIOSCALLBUFFER);
 
-    /* Setup disk address packet */
-    RtlZeroMemory(Packet, sizeof(*Packet));
-    Packet->PacketSize = sizeof(*Packet);
-    Packet->Reserved = 0;
-    Packet->LBABlockCount = (USHORT)SectorCount;
-    ASSERT(Packet->LBABlockCount == SectorCount);
-    Packet->TransferBufferOffset = ((ULONG_PTR)Buffer) & 0x0F;
-    Packet->TransferBufferSegment = (USHORT)(((ULONG_PTR)Buffer) >> 4);
-    Packet->LBAStartBlock = SectorNumber;
+    if (DiskDrive->ExtGeometry.Size == sizeof(DiskDrive->ExtGeometry) &&
+        DiskDrive->ExtGeometry.BytesPerSector != 0)
+    {
+        SectorSize = DiskDrive->ExtGeometry.BytesPerSector;
+    }
+    else
+    {
+        SectorSize = DiskDrive->Geometry.BytesPerSector;
+    }
 
-    /*
-     * BIOS int 0x13, function 42h - IBM/MS INT 13 Extensions - EXTENDED READ
-     * Return:
-     * CF clear if successful
-     * AH = 00h
-     * CF set on error
-     * AH = error code
-     * Disk address packet's block count field set to the
-     * number of blocks successfully transferred.
-     */
-    RegsIn.b.ah = 0x42;                 // Subfunction 42h
-    RegsIn.b.dl = DriveNumber;          // Drive number in DL (0 - floppy, 0x80 - harddisk)
-    RegsIn.x.ds = BIOSCALLBUFSEGMENT;   // DS:SI -> disk address packet
-    RegsIn.w.si = BIOSCALLBUFOFFSET;
+    RegsOut.b.ah = 0;
+    RetryCount = 0;
 
-    /* Retry 3 times */
-    for (RetryCount = 0; RetryCount < 3; ++RetryCount)
+    while (SectorCount > 0)
     {
+        /*
+         * Phoenix EDD limits a single transfer to 0x7F blocks, so larger
+         * requests are split. Each transfer may also stop short; the BIOS
+         * then reports how many blocks made it in the packet.
+         */
+        BlockCount = min(SectorCount, PC_DISK_MAX_LBA_TRANSFER);
+
+        /* Setup disk address packet */
+        RtlZeroMemory(Packet, sizeof(*Packet));
+        Packet->PacketSize = sizeof(*Packet);
+        Packet->Reserved = 0;
+        Packet->LBABlockCount = (USHORT)BlockCount;
+        Packet->TransferBufferOffset = ((ULONG_PTR)Buffer) & 0x0F;
+        Packet->TransferBufferSegment = (USHORT)(((ULONG_PTR)Buffer) >> 4);
+        Packet->LBAStartBlock = SectorNumber;
+
+        /*
+         * BIOS int 0x13, function 42h - IBM/MS INT 13 Extensions - EXTENDED READ
+         * Return:
+         * CF clear if successful
+         * AH = 00h
+         * CF set on error
+         * AH = error code
+         * Disk address packet's block count field set to the
+         * number of blocks successfully transferred.
+         */
+        RegsIn.b.ah = 0x42;                 // Subfunction 42h
+        RegsIn.b.dl = DriveNumber;          // Drive number in DL (0 - floppy, 0x80 - harddisk)
+        RegsIn.x.ds = BIOSCALLBUFSEGMENT;   // DS:SI -> disk address packet
+        RegsIn.w.si = BIOSCALLBUFOFFSET;
+
         Int386(0x13, &RegsIn, &RegsOut);
 
-        /* If it worked return TRUE */
-        if (INT386_SUCCESS(RegsOut))
-        {
-            return TRUE;
-        }
-        /* If it was a corrected ECC error then the data is still good */
-        else if (RegsOut.b.ah == 0x11)
+        /* If it worked, or it was a corrected ECC error, the data is good */
+        if (INT386_SUCCESS(RegsOut) || RegsOut.b.ah == 0x11)
         {
-            return TRUE;
+            SectorNumber += BlockCount;
+            SectorCount -= BlockCount;
+            Buffer = (PVOID)((ULONG_PTR)Buffer + BlockCount * SectorSize);
+            RetryCount = 0;
+            continue;
         }
-        /* If it failed then do the next retry */
-        else
+
+        /* Keep what was transferred before the error */
+        if (Packet->LBABlockCount > 0 && Packet->LBABlockCount < BlockCount)
         {
-            DiskResetController(DriveNumber);
-            continue;
+            BlockCount = Packet->LBABlockCount;
+            SectorNumber += BlockCount;
+            SectorCount -= BlockCount;
+            Buffer = (PVOID)((ULONG_PTR)Buffer + BlockCount * SectorSize);
+            RetryCount = 0;
         }
+
+        /* Retry 3 times */
+        if (++RetryCount >= 3)
+            break;
+
+        DiskResetController(DriveNumber);
     }
 
+    if (SectorCount == 0)
+        return TRUE;
+
     /* If we get here then the read failed */
     DiskError("Disk Read Failed in LBA mode", RegsOut.b.ah);
     ERR("Disk Read Failed in LBA mode: %x (%s) (DriveNumber: 0x%x SectorNumber: %I64d SectorCount: %d)\n",
@@ -777,7 +812,7 @@ PcDiskReadLogicalSectors(
     {
         /* LBA is easy, nothing to calculate. Just do the read. */
         TRACE("--> Using LBA\n");
-        return PcDiskReadLogicalSectorsLBA(DriveNumber, SectorNumber, SectorCount, Buffer);
+        return PcDiskReadLogicalSectorsLBA(DriveNumber, DiskDrive, SectorNumber, SectorCount, Buffer);
     }
     else
     {
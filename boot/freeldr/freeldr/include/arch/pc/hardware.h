@@ -25,6 +25,7 @@
 
 #define TAG_HW_RESOURCE_LIST    'lRwH'
 #define TAG_HW_DISK_CONTEXT     'cDwH'
+#define TAG_HW_DISK_READAHEAD   'aDwH'
 
 /* PROTOTYPES ***************************************************************/
 
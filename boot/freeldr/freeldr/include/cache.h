@@ -35,6 +35,7 @@
 typedef struct
 {
     LIST_ENTRY    ListEntry;                    // Doubly linked list synchronization member
+    LIST_ENTRY    HashListEntry;                // Link in the drive's block hash bucket
 
     ULONG            BlockNumber;                // Track index for CHS, 64k block index for LBA
     BOOLEAN        LockedInCache;                // Indicates that this block is locked in cache memory
@@ -51,13 +52,21 @@ typedef struct
 // the drive's geometry is described here.
 //
 ///////////////////////////////////////////////////////////////////////////////////////
+#define CACHE_HASH_BUCKETS 64                // Must be a power of two
+#define CACHE_HASH_BLOCK(BlockNumber) ((BlockNumber) & (CACHE_HASH_BUCKETS - 1))
+
 typedef struct
 {
     UCHAR            DriveNumber;
     ULONG            BytesPerSector;
 
     ULONG            BlockSize;            // Block size (in sectors)
-    LIST_ENTRY        CacheBlockHead;            // Contains CACHE_BLOCK structures
+    LIST_ENTRY        CacheBlockHead;            // Contains CACHE_BLOCK structures, most recently used first
+    LIST_ENTRY        HashTable[CACHE_HASH_BUCKETS];    // Same blocks, hashed by block number
+
+    ULONG            HitCount;            // Statistics for the debug log
+    ULONG            MissCount;
+    ULONG            DiskReadCount;
 
 } CACHE_DRIVE, *PCACHE_DRIVE;
 
@@ -78,9 +87,9 @@ extern    SIZE_T                CacheSizeCurrent;
 // Internal functions
 //
 ///////////////////////////////////////////////////////////////////////////////////////
-PCACHE_BLOCK    CacheInternalGetBlockPointer(PCACHE_DRIVE CacheDrive, ULONG BlockNumber);                // Returns a pointer to a CACHE_BLOCK structure given a block number
-PCACHE_BLOCK    CacheInternalFindBlock(PCACHE_DRIVE CacheDrive, ULONG BlockNumber);                    // Searches the block list for a particular block
-PCACHE_BLOCK    CacheInternalAddBlockToCache(PCACHE_DRIVE CacheDrive, ULONG BlockNumber);                // Adds a block to the cache's block list
+PCACHE_BLOCK    CacheInternalGetBlockPointer(PCACHE_DRIVE CacheDrive, ULONG BlockNumber, ULONG BlocksWanted);    // Returns a pointer to a CACHE_BLOCK structure given a block number, reading ahead up to BlocksWanted blocks on a miss
+PCACHE_BLOCK    CacheInternalFindBlock(PCACHE_DRIVE CacheDrive, ULONG BlockNumber);                    // Looks up a particular block in the block hash
+PCACHE_BLOCK    CacheInternalAddBlocksToCache(PCACHE_DRIVE CacheDrive, ULONG BlockNumber, ULONG BlockCount);    // Reads consecutive blocks in one disk read and adds them to the cache's block list
 BOOLEAN            CacheInternalFreeBlock(PCACHE_DRIVE CacheDrive);                                    // Removes a block from the cache's block list & frees the memory
 VOID            CacheInternalCheckCacheSizeLimits(PCACHE_DRIVE CacheDrive);                            // Checks the cache size limits to see if we can add a new block, if not calls CacheInternalFreeBlock()
 VOID            CacheInternalDumpBlockList(PCACHE_DRIVE CacheDrive);                                // Dumps the list of cached blocks to the debug output port
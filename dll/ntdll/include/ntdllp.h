@@ -8,8 +8,8 @@
 
 #pragma once
 
-#define LDR_HASH_TABLE_ENTRIES 32
-#define LDR_GET_HASH_ENTRY(x) (RtlUpcaseUnicodeChar((x)) & (LDR_HASH_TABLE_ENTRIES - 1))
+#define LDR_HASH_TABLE_ENTRIES 256
+#define LDR_GET_HASH_ENTRY(x) ((x) & (LDR_HASH_TABLE_ENTRIES - 1))
 
 /* LdrpUpdateLoadCount2 flags */
 #define LDRP_UPDATE_REFCOUNT   0x01
@@ -29,6 +29,34 @@ typedef struct _LDRP_TLS_DATA
     IMAGE_TLS_DIRECTORY TlsDirectory;
 } LDRP_TLS_DATA, *PLDRP_TLS_DATA;
 
+typedef struct _LDRP_PATH_HASH_ENTRY
+{
+    LIST_ENTRY HashLinks;
+    ULONG Hash;
+    PLDR_DATA_TABLE_ENTRY LdrEntry;
+} LDRP_PATH_HASH_ENTRY, *PLDRP_PATH_HASH_ENTRY;
+
+typedef struct _LDRP_EXPORT_INDEX_SLOT
+{
+    ULONG Hash;
+    ULONG NameIndex;
+} LDRP_EXPORT_INDEX_SLOT, *PLDRP_EXPORT_INDEX_SLOT;
+
+typedef struct _LDRP_EXPORT_INDEX
+{
+    struct _LDRP_EXPORT_INDEX *Next;
+    struct _LDRP_EXPORT_INDEX *NextRetired;
+    PVOID DllBase;
+    PIMAGE_EXPORT_DIRECTORY ExportDirectory;
+    ULONG NumberOfNames;
+    ULONG SlotMask;
+    LDRP_EXPORT_INDEX_SLOT Slots[ANYSIZE_ARRAY];
+} LDRP_EXPORT_INDEX, *PLDRP_EXPORT_INDEX;
+
+/* Export tables outside of these bounds are binary searched directly */
+#define LDRP_EXPORT_INDEX_MIN_NAMES 32
+#define LDRP_EXPORT_INDEX_MAX_NAMES 0x100000
+
 typedef
 NTSTATUS
 (NTAPI* PLDR_APP_COMPAT_DLL_REDIRECTION_CALLBACK_FUNCTION)(
@@ -44,6 +72,9 @@ extern RTL_CRITICAL_SECTION LdrpLoaderLock;
 extern BOOLEAN LdrpInLdrInit;
 extern PVOID LdrpHeap;
 extern LIST_ENTRY LdrpHashTable[LDR_HASH_TABLE_ENTRIES];
+extern LIST_ENTRY LdrpPathHashTable[LDR_HASH_TABLE_ENTRIES];
+extern PLDRP_EXPORT_INDEX LdrpExportIndexTable[LDR_HASH_TABLE_ENTRIES];
+extern RTL_CRITICAL_SECTION LdrpExportIndexLock;
 extern BOOLEAN ShowSnaps;
 extern UNICODE_STRING LdrpDefaultPath;
 extern HANDLE LdrpKnownDllObjectDirectory;
@@ -96,6 +127,9 @@ NTSTATUS NTAPI
 LdrpWalkImportDescriptor(IN LPWSTR DllPath OPTIONAL,
                          IN PLDR_DATA_TABLE_ENTRY LdrEntry);
 
+VOID NTAPI
+LdrpFreeExportIndex(IN PVOID DllBase);
+
 
 /* ldrutils.c */
 NTSTATUS NTAPI
@@ -108,9 +142,15 @@ LdrpGetProcedureAddress(IN PVOID BaseAddress,
 PLDR_DATA_TABLE_ENTRY NTAPI
 LdrpAllocateDataTableEntry(IN PVOID BaseAddress);
 
+ULONG NTAPI
+LdrpHashUnicodeString(IN PCUNICODE_STRING NameString);
+
 VOID NTAPI
 LdrpInsertMemoryTableEntry(IN PLDR_DATA_TABLE_ENTRY LdrEntry);
 
+VOID NTAPI
+LdrpRemoveHashTableEntry(IN PLDR_DATA_TABLE_ENTRY LdrEntry);
+
 NTSTATUS NTAPI
 LdrpLoadDll(IN BOOLEAN Redirected,
             IN PWSTR DllPath OPTIONAL,
@@ -58,6 +58,8 @@ extern LARGE_INTEGER RtlpTimeout;
 BOOLEAN RtlpTimeoutDisable;
 PVOID LdrpHeap;
 LIST_ENTRY LdrpHashTable[LDR_HASH_TABLE_ENTRIES];
+LIST_ENTRY LdrpPathHashTable[LDR_HASH_TABLE_ENTRIES];
+PLDRP_EXPORT_INDEX LdrpExportIndexTable[LDR_HASH_TABLE_ENTRIES];
 LIST_ENTRY LdrpDllNotificationList;
 HANDLE LdrpKnownDllObjectDirectory;
 UNICODE_STRING LdrpKnownDllPath;
@@ -77,6 +79,7 @@ RTL_CRITICAL_SECTION LdrpLoaderLock =
     0
 };
 RTL_CRITICAL_SECTION FastPebLock;
+RTL_CRITICAL_SECTION LdrpExportIndexLock;
 
 BOOLEAN ShowSnaps;
 
@@ -1970,10 +1973,11 @@ LdrpInitializeProcess(IN PCONTEXT Context,
                         TLS_EXPANSION_SLOTS);
     RtlSetBit(&TlsExpansionBitMap, 0);
 
-    /* Initialize the Hash Table */
+    /* Initialize the Hash Tables */
     for (i = 0; i < LDR_HASH_TABLE_ENTRIES; i++)
     {
         InitializeListHead(&LdrpHashTable[i]);
+        InitializeListHead(&LdrpPathHashTable[i]);
     }
 
     /* Initialize the Loader Lock */
@@ -1984,6 +1988,10 @@ LdrpInitializeProcess(IN PCONTEXT Context,
     RtlInitializeCriticalSection(&LdrpLoaderLock);
     LdrpLoaderLockInit = TRUE;
 
+    /* Export lookups don't always hold the loader lock, building and freeing
+       the export indexes takes its own */
+    RtlInitializeCriticalSection(&LdrpExportIndexLock);
+
     /* Check if User Stack Trace Database support was requested */
     if (Peb->NtGlobalFlag & FLG_USER_STACK_TRACE_DB)
     {
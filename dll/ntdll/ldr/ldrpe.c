@@ -623,19 +623,215 @@ LdrpHandleOldFormatImportDescriptors(IN LPWSTR DllPath OPTIONAL,
     return STATUS_SUCCESS;
 }
 
+static
+ULONG
+LdrpHashExportName(IN LPSTR Name)
+{
+    ULONG Hash = 0;
+
+    /* Export names are case-sensitive, so hash the raw bytes */
+    while (*Name) Hash = Hash * 65599 + (UCHAR)*Name++;
+
+    return Hash;
+}
+
+static
+ULONG
+LdrpGetExportIndexBucket(IN PVOID DllBase)
+{
+    /* Images are mapped on 64KB boundaries */
+    return LDR_GET_HASH_ENTRY((ULONG)((ULONG_PTR)DllBase >> 16));
+}
+
+/* Lookups walking the bucket chains without the lock, and indexes that were
+   unlinked while they may still have been walking past them */
+static LONG LdrpExportIndexReaders;
+static PLDRP_EXPORT_INDEX LdrpRetiredExportIndexes;
+
+static
+PLDRP_EXPORT_INDEX
+LdrpFindExportIndex(IN PVOID ExportBase,
+                    IN PIMAGE_EXPORT_DIRECTORY ExportDirectory)
+{
+    PLDRP_EXPORT_INDEX ExportIndex;
+
+    /* Indexes are only linked in once they're complete, so the chain can be
+       walked without the lock */
+    ExportIndex = *(PLDRP_EXPORT_INDEX volatile *)&LdrpExportIndexTable[LdrpGetExportIndexBucket(ExportBase)];
+    while (ExportIndex)
+    {
+        if ((ExportIndex->DllBase == ExportBase) &&
+            (ExportIndex->ExportDirectory == ExportDirectory) &&
+            (ExportIndex->NumberOfNames == ExportDirectory->NumberOfNames))
+        {
+            /* Found it */
+            return ExportIndex;
+        }
+
+        ExportIndex = *(PLDRP_EXPORT_INDEX volatile *)&ExportIndex->Next;
+    }
+
+    return NULL;
+}
+
+static
+VOID
+LdrpFreeRetiredExportIndexes(VOID)
+{
+    PLDRP_EXPORT_INDEX ExportIndex;
+
+    /* The caller holds LdrpExportIndexLock. Once no lookup is running, none
+       can still be on an index that was unlinked before */
+    if (InterlockedCompareExchange(&LdrpExportIndexReaders, 0, 0) != 0) return;
+
+    while (LdrpRetiredExportIndexes)
+    {
+        ExportIndex = LdrpRetiredExportIndexes;
+        LdrpRetiredExportIndexes = ExportIndex->NextRetired;
+        RtlFreeHeap(LdrpHeap, 0, ExportIndex);
+    }
+}
+
+static
+PLDRP_EXPORT_INDEX
+LdrpBuildExportIndex(IN PVOID ExportBase,
+                     IN PIMAGE_EXPORT_DIRECTORY ExportDirectory,
+                     IN PULONG NameTable)
+{
+    PLDRP_EXPORT_INDEX ExportIndex, *ListHead;
+    ULONG NumberOfNames, SlotCount, i, Slot;
+    ULONG_PTR Size;
+
+    /* The caller holds LdrpExportIndexLock, another thread may have built
+       the index while we were waiting for it */
+    ExportIndex = LdrpFindExportIndex(ExportBase, ExportDirectory);
+    if (ExportIndex) return ExportIndex;
+
+    /* Keep the load factor at or below one half */
+    NumberOfNames = ExportDirectory->NumberOfNames;
+    SlotCount = LDRP_EXPORT_INDEX_MIN_NAMES * 2;
+    while (SlotCount < NumberOfNames * 2) SlotCount <<= 1;
+
+    /* Allocate the index */
+    Size = FIELD_OFFSET(LDRP_EXPORT_INDEX, Slots) + SlotCount * sizeof(LDRP_EXPORT_INDEX_SLOT);
+    ExportIndex = RtlAllocateHeap(LdrpHeap, HEAP_ZERO_MEMORY, Size);
+    if (!ExportIndex) return NULL;
+
+    ExportIndex->DllBase = ExportBase;
+    ExportIndex->ExportDirectory = ExportDirectory;
+    ExportIndex->NumberOfNames = NumberOfNames;
+    ExportIndex->SlotMask = SlotCount - 1;
+
+    /* Hash every name, a NameIndex of zero marks an empty slot */
+    for (i = 0; i < NumberOfNames; i++)
+    {
+        ULONG Hash = LdrpHashExportName((LPSTR)((ULONG_PTR)ExportBase + NameTable[i]));
+
+        /* Linear probing */
+        Slot = Hash & ExportIndex->SlotMask;
+        while (ExportIndex->Slots[Slot].NameIndex)
+        {
+            Slot = (Slot + 1) & ExportIndex->SlotMask;
+        }
+
+        ExportIndex->Slots[Slot].Hash = Hash;
+        ExportIndex->Slots[Slot].NameIndex = i + 1;
+    }
+
+    /* Publish it for the next lookups into this image. The interlocked
+       exchange orders the writes above before the link */
+    ListHead = &LdrpExportIndexTable[LdrpGetExportIndexBucket(ExportBase)];
+    ExportIndex->Next = *ListHead;
+    InterlockedExchangePointer((PVOID*)ListHead, ExportIndex);
+
+    /* Good time to drop what an unload left behind */
+    LdrpFreeRetiredExportIndexes();
+    return ExportIndex;
+}
+
+VOID
+NTAPI
+LdrpFreeExportIndex(IN PVOID DllBase)
+{
+    PLDRP_EXPORT_INDEX ExportIndex, *Link;
+
+    /* Unlink any index that was built for this image. Lookups may still be
+       walking past it, so it keeps its Next link and is freed later */
+    RtlEnterCriticalSection(&LdrpExportIndexLock);
+    Link = &LdrpExportIndexTable[LdrpGetExportIndexBucket(DllBase)];
+    while (*Link)
+    {
+        ExportIndex = *Link;
+        if (ExportIndex->DllBase == DllBase)
+        {
+            InterlockedExchangePointer((PVOID*)Link, ExportIndex->Next);
+            ExportIndex->NextRetired = LdrpRetiredExportIndexes;
+            LdrpRetiredExportIndexes = ExportIndex;
+        }
+        else
+        {
+            Link = &ExportIndex->Next;
+        }
+    }
+    LdrpFreeRetiredExportIndexes();
+    RtlLeaveCriticalSection(&LdrpExportIndexLock);
+}
+
 USHORT
 NTAPI
 LdrpNameToOrdinal(IN LPSTR ImportName,
-                  IN ULONG NumberOfNames,
+                  IN PIMAGE_EXPORT_DIRECTORY ExportDirectory,
                   IN PVOID ExportBase,
                   IN PULONG NameTable,
                   IN PUSHORT OrdinalTable)
 {
     LONG Start, End, Next, CmpResult;
+    PLDRP_EXPORT_INDEX ExportIndex = NULL;
+    ULONG Hash, Slot, NameIndex;
+    USHORT Ordinal = -1;
+
+    /* Small tables are cheap enough to binary search, huge ones are bogus */
+    if ((ExportDirectory->NumberOfNames >= LDRP_EXPORT_INDEX_MIN_NAMES) &&
+        (ExportDirectory->NumberOfNames <= LDRP_EXPORT_INDEX_MAX_NAMES))
+    {
+        /* Use the hashed index of this image, only building it takes the
+           lock. Count ourselves as a reader so that an index unlinked by
+           an unload isn't freed under us */
+        InterlockedIncrement(&LdrpExportIndexReaders);
+        ExportIndex = LdrpFindExportIndex(ExportBase, ExportDirectory);
+        if (!ExportIndex)
+        {
+            RtlEnterCriticalSection(&LdrpExportIndexLock);
+            ExportIndex = LdrpBuildExportIndex(ExportBase, ExportDirectory, NameTable);
+            RtlLeaveCriticalSection(&LdrpExportIndexLock);
+        }
+
+        if (ExportIndex)
+        {
+            Hash = LdrpHashExportName(ImportName);
+            Slot = Hash & ExportIndex->SlotMask;
+            while ((NameIndex = ExportIndex->Slots[Slot].NameIndex))
+            {
+                /* Only compare the strings when the full hash matches */
+                if ((ExportIndex->Slots[Slot].Hash == Hash) &&
+                    !strcmp(ImportName, (PCHAR)((ULONG_PTR)ExportBase + NameTable[NameIndex - 1])))
+                {
+                    Ordinal = OrdinalTable[NameIndex - 1];
+                    break;
+                }
+
+                Slot = (Slot + 1) & ExportIndex->SlotMask;
+            }
+        }
+        InterlockedDecrement(&LdrpExportIndexReaders);
+    }
+
+    /* Found or not, the index had the final word */
+    if (ExportIndex) return Ordinal;
 
     /* Use classical binary search to find the ordinal */
     Start = Next = 0;
-    End = NumberOfNames - 1;
+    End = ExportDirectory->NumberOfNames - 1;
     while (End >= Start)
     {
         /* Next will be exactly between Start and End */
@@ -1014,7 +1210,7 @@ LdrpSnapThunk(IN PVOID ExportBase,
         {
             /* Well bummer, hint didn't work, do it the long way */
             Ordinal = LdrpNameToOrdinal(ImportName,
-                                        ExportDirectory->NumberOfNames,
+                                        ExportDirectory,
                                         ExportBase,
                                         NameTable,
                                         OrdinalTable);
@@ -1283,7 +1283,7 @@ SkipCheck:
             /* Remove the DLL from the lists */
             RemoveEntryList(&LdrEntry->InLoadOrderLinks);
             RemoveEntryList(&LdrEntry->InMemoryOrderLinks);
-            RemoveEntryList(&LdrEntry->HashLinks);
+            LdrpRemoveHashTableEntry(LdrEntry);
 
             /* Remove the LDR Entry */
             RtlFreeHeap(LdrpHeap, 0, LdrEntry );
@@ -1477,7 +1477,7 @@ FailRelocate:
                 /* Remove it from the lists */
                 RemoveEntryList(&LdrEntry->InLoadOrderLinks);
                 RemoveEntryList(&LdrEntry->InMemoryOrderLinks);
-                RemoveEntryList(&LdrEntry->HashLinks);
+                LdrpRemoveHashTableEntry(LdrEntry);
 
                 /* Unmap it, clear the entry */
                 NtUnmapViewOfSection(NtCurrentProcess(), ViewBase);
@@ -1574,22 +1574,95 @@ LdrpAllocateDataTableEntry(IN PVOID BaseAddress)
     return LdrEntry;
 }
 
+ULONG
+NTAPI
+LdrpHashUnicodeString(IN PCUNICODE_STRING NameString)
+{
+    PWCHAR Current, End;
+    WCHAR Char;
+    ULONG Hash = 0;
+
+    /* Case-insensitive x65599 hash over the whole name */
+    Current = NameString->Buffer;
+    End = Current + NameString->Length / sizeof(WCHAR);
+    while (Current < End)
+    {
+        Char = *Current++;
+
+        /* Module names are almost always ASCII, avoid the NLS lookup for those */
+        if ((Char >= L'a') && (Char <= L'z'))
+            Char -= L'a' - L'A';
+        else if (Char >= 0x80)
+            Char = RtlUpcaseUnicodeChar(Char);
+
+        Hash = Hash * 65599 + Char;
+    }
+
+    return Hash;
+}
+
 VOID
 NTAPI
 LdrpInsertMemoryTableEntry(IN PLDR_DATA_TABLE_ENTRY LdrEntry)
 {
     PPEB_LDR_DATA PebData = NtCurrentPeb()->Ldr;
-    ULONG i;
+    PLDRP_PATH_HASH_ENTRY PathEntry;
+    ULONG Hash;
 
     /* Insert into hash table */
-    i = LDR_GET_HASH_ENTRY(LdrEntry->BaseDllName.Buffer[0]);
-    InsertTailList(&LdrpHashTable[i], &LdrEntry->HashLinks);
+    Hash = LdrpHashUnicodeString(&LdrEntry->BaseDllName);
+    InsertTailList(&LdrpHashTable[LDR_GET_HASH_ENTRY(Hash)], &LdrEntry->HashLinks);
+
+    /* Insert into the full path index. If we can't, LdrpCheckForLoadedDll
+       will still find the module through its mapped file comparison */
+    if (LdrEntry->FullDllName.Length)
+    {
+        PathEntry = RtlAllocateHeap(LdrpHeap, 0, sizeof(LDRP_PATH_HASH_ENTRY));
+        if (PathEntry)
+        {
+            PathEntry->Hash = LdrpHashUnicodeString(&LdrEntry->FullDllName);
+            PathEntry->LdrEntry = LdrEntry;
+            InsertTailList(&LdrpPathHashTable[LDR_GET_HASH_ENTRY(PathEntry->Hash)],
+                           &PathEntry->HashLinks);
+        }
+    }
 
     /* Insert into other lists */
     InsertTailList(&PebData->InLoadOrderModuleList, &LdrEntry->InLoadOrderLinks);
     InsertTailList(&PebData->InMemoryOrderModuleList, &LdrEntry->InMemoryOrderLinks);
 }
 
+VOID
+NTAPI
+LdrpRemoveHashTableEntry(IN PLDR_DATA_TABLE_ENTRY LdrEntry)
+{
+    PLIST_ENTRY ListHead, ListEntry;
+    PLDRP_PATH_HASH_ENTRY PathEntry;
+
+    /* Remove it from the base name hash table */
+    RemoveEntryList(&LdrEntry->HashLinks);
+
+    /* Nothing else to do if it was never put in the full path index */
+    if (!LdrEntry->FullDllName.Length) return;
+
+    /* Find its full path index entry */
+    ListHead = &LdrpPathHashTable[LDR_GET_HASH_ENTRY(LdrpHashUnicodeString(&LdrEntry->FullDllName))];
+    ListEntry = ListHead->Flink;
+    while (ListEntry != ListHead)
+    {
+        PathEntry = CONTAINING_RECORD(ListEntry, LDRP_PATH_HASH_ENTRY, HashLinks);
+        if (PathEntry->LdrEntry == LdrEntry)
+        {
+            /* Found it, unlink and free it */
+            RemoveEntryList(&PathEntry->HashLinks);
+            RtlFreeHeap(LdrpHeap, 0, PathEntry);
+            return;
+        }
+
+        ListEntry = ListEntry->Flink;
+    }
+}
+
 VOID
 NTAPI
 LdrpFinalizeAndDeallocateDataTableEntry(IN PLDR_DATA_TABLE_ENTRY Entry)
@@ -1606,6 +1679,9 @@ LdrpFinalizeAndDeallocateDataTableEntry(IN PLDR_DATA_TABLE_ENTRY Entry)
         Entry->EntryPointActivationContext = INVALID_HANDLE_VALUE;
     }
 
+    /* Drop the cached export index, another image may be mapped here later */
+    LdrpFreeExportIndex(Entry->DllBase);
+
     /* Release the full dll name string */
     if (Entry->FullDllName.Buffer) LdrpFreeUnicodeString(&Entry->FullDllName);
 
@@ -1979,9 +2055,10 @@ LdrpCheckForLoadedDll(IN PWSTR DllPath,
                       IN BOOLEAN RedirectedDll,
                       OUT PLDR_DATA_TABLE_ENTRY *LdrEntry)
 {
-    ULONG HashIndex;
+    ULONG HashIndex, Hash;
     PLIST_ENTRY ListHead, ListEntry;
     PLDR_DATA_TABLE_ENTRY CurEntry;
+    PLDRP_PATH_HASH_ENTRY PathEntry;
     BOOLEAN FullPath = FALSE;
     PWCHAR wc;
     WCHAR NameBuf[266];
@@ -2009,7 +2086,7 @@ lookinhash:
         /* FIXME: if we get redirected dll it means that we also get a full path so we need to find its filename for the hash lookup */
 
         /* Get hash index */
-        HashIndex = LDR_GET_HASH_ENTRY(DllName->Buffer[0]);
+        HashIndex = LDR_GET_HASH_ENTRY(LdrpHashUnicodeString(DllName));
 
         /* Traverse that list */
         ListHead = &LdrpHashTable[HashIndex];
@@ -2097,18 +2174,23 @@ lookinhash:
 
     /* NOTE: From here on down, everything looks good */
 
-    /* Loop the module list */
-    ListHead = &NtCurrentPeb()->Ldr->InLoadOrderModuleList;
+    /* Look up the full path index */
+    Hash = LdrpHashUnicodeString(&FullDllName);
+    ListHead = &LdrpPathHashTable[LDR_GET_HASH_ENTRY(Hash)];
     ListEntry = ListHead->Flink;
     while (ListEntry != ListHead)
     {
         /* Get the current entry and advance to the next one */
-        CurEntry = CONTAINING_RECORD(ListEntry,
-                                     LDR_DATA_TABLE_ENTRY,
-                                     InLoadOrderLinks);
+        PathEntry = CONTAINING_RECORD(ListEntry,
+                                      LDRP_PATH_HASH_ENTRY,
+                                      HashLinks);
         ListEntry = ListEntry->Flink;
 
+        /* Skip it if the full hash doesn't match */
+        if (PathEntry->Hash != Hash) continue;
+
         /* Check if it's being unloaded */
+        CurEntry = PathEntry->LdrEntry;
         if (!CurEntry->InMemoryOrderLinks.Flink) continue;
 
         /* Check if name matches */
@@ -19,6 +19,12 @@ RtlpInitializeKeyedEvent(VOID);
 VOID
 RtlpCloseKeyedEvent(VOID);
 
+VOID
+RtlpInitializeAddressWait(VOID);
+
+VOID
+RtlpCloseAddressWait(VOID);
+
 BOOL
 WINAPI
 DllMain(HANDLE hDll,
@@ -29,9 +35,11 @@ DllMain(HANDLE hDll,
     {
         LdrDisableThreadCalloutsForDll(hDll);
         RtlpInitializeKeyedEvent();
+        RtlpInitializeAddressWait();
     }
     else if (dwReason == DLL_PROCESS_DETACH)
     {
+        RtlpCloseAddressWait();
         RtlpCloseKeyedEvent();
     }
     return TRUE;
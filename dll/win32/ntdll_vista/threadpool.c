@@ -0,0 +1,219 @@
+/*
+ * COPYRIGHT:         See COPYING in the top level directory
+ * PROJECT:           ReactOS system libraries
+ * PURPOSE:           Thread pool work objects (Tp*Work)
+ *
+ * NOTES:             Work objects are layered on top of RtlQueueWorkItem, so
+ *                    they share its worker threads, local queues and work
+ *                    stealing. Private pools and cleanup groups are not
+ *                    supported yet, callbacks always run in the process pool.
+ */
+
+/* INCLUDES *****************************************************************/
+
+#include <rtl_vista.h>
+
+#define NDEBUG
+#include <debug.h>
+
+/* INTERNAL TYPES ************************************************************/
+
+struct _TP_CALLBACK_INSTANCE
+{
+    PTP_WORK Work;
+};
+
+struct _TP_WORK
+{
+    LONG RefCount;
+    PTP_WORK_CALLBACK Callback;
+    PVOID Context;
+    ULONG Flags;
+
+    /* The counters below are protected by Lock */
+    RTL_SRWLOCK Lock;
+    LONG Queued;
+    LONG Running;
+    LONG Canceled;
+
+    /* Signaled while nothing is queued or running */
+    HANDLE IdleEvent;
+};
+
+/* FUNCTIONS *****************************************************************/
+
+static
+VOID
+TppDereferenceWork(IN PTP_WORK Work)
+{
+    if (InterlockedDecrement(&Work->RefCount) == 0)
+    {
+        NtClose(Work->IdleEvent);
+        RtlFreeHeap(RtlGetProcessHeap(), 0, Work);
+    }
+}
+
+static
+VOID
+TppCheckWorkIdle(IN PTP_WORK Work)
+{
+    /* We MUST hold the work lock while calling this function */
+    if (Work->Queued == 0 && Work->Running == 0)
+        NtSetEvent(Work->IdleEvent, NULL);
+}
+
+static
+VOID
+NTAPI
+TppWorkCallback(IN PVOID Context)
+{
+    PTP_WORK Work = (PTP_WORK)Context;
+    TP_CALLBACK_INSTANCE Instance;
+    BOOLEAN Run;
+
+    RtlAcquireSRWLockExclusive(&Work->Lock);
+    if (Work->Canceled != 0)
+    {
+        /* TpWaitForWork cancelled this post */
+        Work->Canceled--;
+        Run = FALSE;
+    }
+    else
+    {
+        Work->Queued--;
+        Work->Running++;
+        Run = TRUE;
+    }
+    RtlReleaseSRWLockExclusive(&Work->Lock);
+
+    if (Run)
+    {
+        Instance.Work = Work;
+        Work->Callback(&Instance, Work->Context, Work);
+
+        RtlAcquireSRWLockExclusive(&Work->Lock);
+        Work->Running--;
+        TppCheckWorkIdle(Work);
+        RtlReleaseSRWLockExclusive(&Work->Lock);
+    }
+
+    /* Release the reference held by this post */
+    TppDereferenceWork(Work);
+}
+
+/*
+ * @implemented
+ */
+NTSTATUS
+NTAPI
+TpAllocWork(OUT PTP_WORK *WorkReturn,
+            IN PTP_WORK_CALLBACK Callback,
+            IN OUT PVOID Context OPTIONAL,
+            IN PTP_CALLBACK_ENVIRON Environment OPTIONAL)
+{
+    PTP_WORK Work;
+    NTSTATUS Status;
+
+    if (!WorkReturn || !Callback)
+        return STATUS_INVALID_PARAMETER;
+
+    Work = RtlAllocateHeap(RtlGetProcessHeap(), 0, sizeof(*Work));
+    if (!Work)
+        return STATUS_NO_MEMORY;
+
+    Status = NtCreateEvent(&Work->IdleEvent,
+                           EVENT_ALL_ACCESS,
+                           NULL,
+                           NotificationEvent,
+                           TRUE);
+    if (!NT_SUCCESS(Status))
+    {
+        RtlFreeHeap(RtlGetProcessHeap(), 0, Work);
+        return Status;
+    }
+
+    Work->RefCount = 1;
+    Work->Callback = Callback;
+    Work->Context = Context;
+    Work->Flags = WT_EXECUTEDEFAULT;
+    RtlInitializeSRWLock(&Work->Lock);
+    Work->Queued = 0;
+    Work->Running = 0;
+    Work->Canceled = 0;
+
+    if (Environment)
+    {
+        if (Environment->Pool)
+            DPRINT1("TpAllocWork: private pool %p not supported, using the process pool\n", Environment->Pool);
+
+        if (Environment->u.s.LongFunction)
+            Work->Flags |= WT_EXECUTELONGFUNCTION;
+    }
+
+    *WorkReturn = Work;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * @implemented
+ */
+VOID
+NTAPI
+TpPostWork(IN PTP_WORK Work)
+{
+    NTSTATUS Status;
+
+    RtlAcquireSRWLockExclusive(&Work->Lock);
+    if (Work->Queued == 0 && Work->Running == 0)
+        NtResetEvent(Work->IdleEvent, NULL);
+    Work->Queued++;
+    RtlReleaseSRWLockExclusive(&Work->Lock);
+
+    /* Every post keeps the work object alive until its callback ran */
+    InterlockedIncrement(&Work->RefCount);
+
+    Status = RtlQueueWorkItem(TppWorkCallback, Work, Work->Flags);
+    if (!NT_SUCCESS(Status))
+    {
+        DPRINT1("TpPostWork: failed to queue work %p: 0x%lx\n", Work, Status);
+
+        RtlAcquireSRWLockExclusive(&Work->Lock);
+        Work->Queued--;
+        TppCheckWorkIdle(Work);
+        RtlReleaseSRWLockExclusive(&Work->Lock);
+
+        TppDereferenceWork(Work);
+    }
+}
+
+/*
+ * @implemented
+ */
+VOID
+NTAPI
+TpWaitForWork(IN PTP_WORK Work,
+              IN BOOLEAN CancelPendingCallbacks)
+{
+    if (CancelPendingCallbacks)
+    {
+        /* Posts that haven't started yet will skip their callback */
+        RtlAcquireSRWLockExclusive(&Work->Lock);
+        Work->Canceled += Work->Queued;
+        Work->Queued = 0;
+        TppCheckWorkIdle(Work);
+        RtlReleaseSRWLockExclusive(&Work->Lock);
+    }
+
+    NtWaitForSingleObject(Work->IdleEvent, FALSE, NULL);
+}
+
+/*
+ * @implemented
+ */
+VOID
+NTAPI
+TpReleaseWork(IN PTP_WORK Work)
+{
+    /* Outstanding posts hold their own references */
+    TppDereferenceWork(Work);
+}
@@ -0,0 +1,219 @@
+/*
+ * COPYRIGHT:         See COPYING in the top level directory
+ * PROJECT:           ReactOS system libraries
+ * PURPOSE:           Address based waits (RtlWaitOnAddress)
+ *
+ * NOTES:             Waiters are kept in a small hash table keyed by the
+ *                    address they wait on, and block on a keyed event with
+ *                    their own wait entry as the key. A wake therefore only
+ *                    touches the threads waiting on that address, and the
+ *                    kernel keyed event table sees unique, well spread keys.
+ */
+
+/* INCLUDES *****************************************************************/
+
+#include <rtl_vista.h>
+
+#define NDEBUG
+#include <debug.h>
+
+/* INTERNAL TYPES ************************************************************/
+
+#define ADDRESS_WAIT_BUCKETS_SHIFT 6
+#define ADDRESS_WAIT_BUCKETS (1 << ADDRESS_WAIT_BUCKETS_SHIFT)
+
+typedef struct _ADDRESS_WAIT_ENTRY
+{
+    LIST_ENTRY ListEntry;
+    const volatile VOID *Address;
+    BOOLEAN Woken;
+} ADDRESS_WAIT_ENTRY, *PADDRESS_WAIT_ENTRY;
+
+typedef struct _ADDRESS_WAIT_BUCKET
+{
+    RTL_SRWLOCK Lock;
+    LIST_ENTRY WaitListHead;
+} ADDRESS_WAIT_BUCKET, *PADDRESS_WAIT_BUCKET;
+
+/* GLOBALS *******************************************************************/
+
+static HANDLE AddressWaitKeyedEventHandle = NULL;
+static ADDRESS_WAIT_BUCKET AddressWaitTable[ADDRESS_WAIT_BUCKETS];
+
+/* INTERNAL FUNCTIONS ********************************************************/
+
+FORCEINLINE
+PADDRESS_WAIT_BUCKET
+RtlpGetAddressWaitBucket(IN const volatile VOID *Address)
+{
+    ULONG Hash = (ULONG)((ULONG_PTR)Address >> 2);
+
+    return &AddressWaitTable[(Hash * 0x9E3779B1UL) >> (32 - ADDRESS_WAIT_BUCKETS_SHIFT)];
+}
+
+static
+BOOLEAN
+RtlpCompareAddress(IN const volatile VOID *Address,
+                   IN PVOID CompareAddress,
+                   IN SIZE_T AddressSize)
+{
+    switch (AddressSize)
+    {
+        case 1:
+            return *(const volatile UCHAR *)Address == *(PUCHAR)CompareAddress;
+        case 2:
+            return *(const volatile USHORT *)Address == *(PUSHORT)CompareAddress;
+        case 4:
+            return *(const volatile ULONG *)Address == *(PULONG)CompareAddress;
+        default:
+            return *(const volatile ULONGLONG *)Address == *(PULONGLONG)CompareAddress;
+    }
+}
+
+static
+VOID
+RtlpWakeAddress(IN const volatile VOID *Address,
+                IN BOOLEAN WakeAll)
+{
+    PADDRESS_WAIT_BUCKET Bucket = RtlpGetAddressWaitBucket(Address);
+    PADDRESS_WAIT_ENTRY WaitEntry;
+    PLIST_ENTRY ListEntry;
+    LIST_ENTRY WakeListHead;
+
+    InitializeListHead(&WakeListHead);
+
+    /* Collect the waiters, keeping them off the bucket while waking */
+    RtlAcquireSRWLockExclusive(&Bucket->Lock);
+    ListEntry = Bucket->WaitListHead.Flink;
+    while (ListEntry != &Bucket->WaitListHead)
+    {
+        WaitEntry = CONTAINING_RECORD(ListEntry, ADDRESS_WAIT_ENTRY, ListEntry);
+        ListEntry = ListEntry->Flink;
+
+        if (WaitEntry->Address != Address)
+            continue;
+
+        RemoveEntryList(&WaitEntry->ListEntry);
+        InsertTailList(&WakeListHead, &WaitEntry->ListEntry);
+        WaitEntry->Woken = TRUE;
+
+        if (!WakeAll)
+            break;
+    }
+    RtlReleaseSRWLockExclusive(&Bucket->Lock);
+
+    /* The waiters stay blocked on their entry until we release them,
+       so the entries remain valid while we walk the list */
+    ListEntry = WakeListHead.Flink;
+    while (ListEntry != &WakeListHead)
+    {
+        WaitEntry = CONTAINING_RECORD(ListEntry, ADDRESS_WAIT_ENTRY, ListEntry);
+        ListEntry = ListEntry->Flink;
+
+        NtReleaseKeyedEvent(AddressWaitKeyedEventHandle, WaitEntry, FALSE, NULL);
+    }
+}
+
+/* FUNCTIONS *****************************************************************/
+
+/*
+ * @implemented
+ */
+NTSTATUS
+NTAPI
+RtlWaitOnAddress(IN const volatile VOID *Address,
+                 IN PVOID CompareAddress,
+                 IN SIZE_T AddressSize,
+                 IN PLARGE_INTEGER Timeout OPTIONAL)
+{
+    PADDRESS_WAIT_BUCKET Bucket;
+    ADDRESS_WAIT_ENTRY WaitEntry;
+    BOOLEAN Removed = FALSE;
+    NTSTATUS Status;
+
+    if (AddressSize != 1 && AddressSize != 2 && AddressSize != 4 && AddressSize != 8)
+        return STATUS_INVALID_PARAMETER;
+
+    ASSERT(AddressWaitKeyedEventHandle != NULL);
+
+    Bucket = RtlpGetAddressWaitBucket(Address);
+    WaitEntry.Address = Address;
+    WaitEntry.Woken = FALSE;
+
+    /* Compare under the bucket lock, so a wake racing with us either sees
+       our entry or happens after we observe the new value */
+    RtlAcquireSRWLockExclusive(&Bucket->Lock);
+    if (!RtlpCompareAddress(Address, CompareAddress, AddressSize))
+    {
+        RtlReleaseSRWLockExclusive(&Bucket->Lock);
+        return STATUS_SUCCESS;
+    }
+    InsertTailList(&Bucket->WaitListHead, &WaitEntry.ListEntry);
+    RtlReleaseSRWLockExclusive(&Bucket->Lock);
+
+    Status = NtWaitForKeyedEvent(AddressWaitKeyedEventHandle, &WaitEntry, FALSE, Timeout);
+    if (Status == STATUS_SUCCESS)
+        return STATUS_SUCCESS;
+
+    /* Timed out, take ourselves off the list unless a waker already did */
+    RtlAcquireSRWLockExclusive(&Bucket->Lock);
+    if (!WaitEntry.Woken)
+    {
+        RemoveEntryList(&WaitEntry.ListEntry);
+        Removed = TRUE;
+    }
+    RtlReleaseSRWLockExclusive(&Bucket->Lock);
+
+    if (!Removed)
+    {
+        /* A waker picked us and is about to release our key, consume it
+           so it doesn't block forever */
+        NtWaitForKeyedEvent(AddressWaitKeyedEventHandle, &WaitEntry, FALSE, NULL);
+        return STATUS_SUCCESS;
+    }
+
+    return Status;
+}
+
+/*
+ * @implemented
+ */
+VOID
+NTAPI
+RtlWakeAddressAll(IN const volatile VOID *Address)
+{
+    RtlpWakeAddress(Address, TRUE);
+}
+
+/*
+ * @implemented
+ */
+VOID
+NTAPI
+RtlWakeAddressSingle(IN const volatile VOID *Address)
+{
+    RtlpWakeAddress(Address, FALSE);
+}
+
+VOID
+RtlpInitializeAddressWait(VOID)
+{
+    ULONG i;
+
+    for (i = 0; i < ADDRESS_WAIT_BUCKETS; i++)
+    {
+        RtlInitializeSRWLock(&AddressWaitTable[i].Lock);
+        InitializeListHead(&AddressWaitTable[i].WaitListHead);
+    }
+
+    ASSERT(AddressWaitKeyedEventHandle == NULL);
+    NtCreateKeyedEvent(&AddressWaitKeyedEventHandle, EVENT_ALL_ACCESS, NULL, 0);
+}
+
+VOID
+RtlpCloseAddressWait(VOID)
+{
+    ASSERT(AddressWaitKeyedEventHandle != NULL);
+    NtClose(AddressWaitKeyedEventHandle);
+    AddressWaitKeyedEventHandle = NULL;
+}
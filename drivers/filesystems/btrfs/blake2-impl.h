@@ -17,6 +17,11 @@
 #include <stdint.h>
 #include <string.h>
 
+#ifdef __REACTOS__
+/* all the architectures we build for are little endian */
+#define NATIVE_LITTLE_ENDIAN
+#endif
+
 #if !defined(__cplusplus) && (!defined(__STDC_VERSION__) || __STDC_VERSION__ < 199901L)
   #if   defined(_MSC_VER)
     #define BLAKE2_INLINE __inline
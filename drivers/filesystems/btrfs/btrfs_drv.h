@@ -1555,12 +1555,17 @@ NTSTATUS zlib_compress(uint8_t* inbuf, uint32_t inlen, uint8_t* outbuf, uint32_t
 NTSTATUS lzo_compress(uint8_t* inbuf, uint32_t inlen, uint8_t* outbuf, uint32_t outlen, unsigned int* space_left);
 NTSTATUS zstd_compress(uint8_t* inbuf, uint32_t inlen, uint8_t* outbuf, uint32_t outlen, uint32_t level, unsigned int* space_left);
 
+#ifdef __REACTOS__
+#include "galois.h"
+#else
 // in galois.c
 void galois_double(uint8_t* data, uint32_t len);
 void galois_divpower(uint8_t* data, uint8_t div, uint32_t readlen);
+void galois_recover2(uint8_t* qxy, const uint8_t* pxy, const uint8_t* p, const uint8_t* q, uint8_t a, uint8_t b, uint32_t len);
 uint8_t gpow2(uint8_t e);
 uint8_t gmul(uint8_t a, uint8_t b);
 uint8_t gdiv(uint8_t a, uint8_t b);
+#endif /* __REACTOS__ */
 
 // in devctrl.c
 
@@ -15,7 +15,11 @@
  * You should have received a copy of the GNU Lesser General Public Licence
  * along with WinBtrfs.  If not, see <http://www.gnu.org/licenses/>. */
 
+#ifdef __REACTOS__
+#include "galois.h"
+#else
 #include "btrfs_drv.h"
+#endif /* __REACTOS__ */
 
 static const uint8_t glog[] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26,
                              0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0,
@@ -51,21 +55,6 @@ static const uint8_t gilog[] = {0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6,
                               0xcb, 0x59, 0x5f, 0xb0, 0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
                               0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea, 0xa8, 0x50, 0x58, 0xaf};
 
-// divides the bytes in data by 2^div
-void galois_divpower(uint8_t* data, uint8_t div, uint32_t len) {
-    while (len > 0) {
-        if (data[0] != 0) {
-            if (gilog[data[0]] <= div)
-                data[0] = glog[(gilog[data[0]] + (255 - div)) % 255];
-            else
-                data[0] = glog[(gilog[data[0]] - div) % 255];
-        }
-
-        data++;
-        len--;
-    }
-}
-
 uint8_t gpow2(uint8_t e) {
     return glog[e%255];
 }
@@ -90,6 +79,53 @@ uint8_t gdiv(uint8_t a, uint8_t b) {
     }
 }
 
+// Multiplication by a constant c is linear over GF(2), so c*x is
+// c*(x & 0xf) ^ c*(x & 0xf0). This fills in those two 16-entry tables.
+static void galois_mul_tables(uint8_t c, uint8_t* lo, uint8_t* hi) {
+    unsigned int i;
+
+    for (i = 0; i < 16; i++) {
+        lo[i] = gmul(c, (uint8_t)i);
+        hi[i] = gmul(c, (uint8_t)(i << 4));
+    }
+}
+
+// divides the bytes in data by 2^div
+void galois_divpower(uint8_t* data, uint8_t div, uint32_t len) {
+    uint8_t lo[16], hi[16];
+
+    // dividing by 2^div is multiplying by 2^(255-div)
+    galois_mul_tables(gpow2((uint8_t)(255 - div)), lo, hi);
+
+    while (len > 0) {
+        data[0] = lo[data[0] & 0xf] ^ hi[data[0] >> 4];
+
+        data++;
+        len--;
+    }
+}
+
+// Sets qxy to a * (p ^ pxy) ^ b * (q ^ qxy), the last step of recovering
+// two missing stripes from P and Q.
+void galois_recover2(uint8_t* qxy, const uint8_t* pxy, const uint8_t* p, const uint8_t* q, uint8_t a, uint8_t b, uint32_t len) {
+    uint8_t tables[64];
+
+    galois_mul_tables(a, tables, tables + 16);
+    galois_mul_tables(b, tables + 32, tables + 48);
+
+    while (len > 0) {
+        uint8_t vp = p[0] ^ pxy[0], vq = q[0] ^ qxy[0];
+
+        qxy[0] = tables[vp & 0xf] ^ tables[16 + (vp >> 4)] ^ tables[32 + (vq & 0xf)] ^ tables[48 + (vq >> 4)];
+
+        qxy++;
+        pxy++;
+        p++;
+        q++;
+        len--;
+    }
+}
+
 // The code from the following functions is derived from the paper
 // "The mathematics of RAID-6", by H. Peter Anvin.
 // https://www.kernel.org/pub/linux/kernel/people/hpa/raid6.pdf
@@ -0,0 +1,21 @@
+/*
+ * PROJECT:     ReactOS btrfs driver
+ * LICENSE:     LGPL-3.0-or-later (https://spdx.org/licenses/LGPL-3.0-or-later)
+ * PURPOSE:     Galois field helpers used for RAID6
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Split out of btrfs_drv.h so that galois.c builds without the driver
+ * headers, e.g. in modules/rostests/regtests/btrfs.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// in galois.c
+void galois_double(uint8_t* data, uint32_t len);
+void galois_divpower(uint8_t* data, uint8_t div, uint32_t readlen);
+void galois_recover2(uint8_t* qxy, const uint8_t* pxy, const uint8_t* p, const uint8_t* q, uint8_t a, uint8_t b, uint32_t len);
+uint8_t gpow2(uint8_t e);
+uint8_t gmul(uint8_t a, uint8_t b);
+uint8_t gdiv(uint8_t a, uint8_t b);
@@ -197,7 +197,9 @@ NpCreateClientEnd(IN PNP_FCB Fcb,
     IoStatus.Status = NpInitializeSecurity(Ccb, SecurityQos, Thread);
     if (!NT_SUCCESS(IoStatus.Status)) return IoStatus;
 
+    ExAcquireResourceExclusiveLite(&Ccb->NonPagedCcb->Lock, TRUE);
     IoStatus.Status = NpSetConnectedPipeState(Ccb, FileObject, List);
+    ExReleaseResourceLite(&Ccb->NonPagedCcb->Lock);
     if (!NT_SUCCESS(IoStatus.Status))
     {
         NpUninitializeSecurity(Ccb);
@@ -209,6 +209,7 @@ NpCancelDataQueueIrp(IN PDEVICE_OBJECT DeviceObject,
 {
     PNP_DATA_QUEUE DataQueue;
     PNP_DATA_QUEUE_ENTRY DataEntry;
+    PNP_NONPAGED_CCB NonPagedCcb;
     LIST_ENTRY DeferredList;
     PSECURITY_CLIENT_CONTEXT ClientSecurityContext;
     BOOLEAN CompleteWrites, FirstEntry;
@@ -219,11 +220,23 @@ NpCancelDataQueueIrp(IN PDEVICE_OBJECT DeviceObject,
 
     DataQueue = Irp->Tail.Overlay.DriverContext[2];
     ClientSecurityContext = NULL;
+    NonPagedCcb = NULL;
 
     if (DeviceObject)
     {
         FsRtlEnterFileSystem();
         NpAcquireExclusiveVcb();
+
+        /*
+         * Reads and writes only hold the CCB lock while they work on the
+         * queue. The CCB can't go away while the entry is still queued
+         * and we own the VCB, so lock it and look at the entry again.
+         */
+        if (Irp->Tail.Overlay.DriverContext[3])
+        {
+            NonPagedCcb = Irp->Tail.Overlay.DriverContext[1];
+            ExAcquireResourceExclusiveLite(&NonPagedCcb->Lock, TRUE);
+        }
     }
 
     DataEntry = Irp->Tail.Overlay.DriverContext[3];
@@ -277,6 +290,7 @@ NpCancelDataQueueIrp(IN PDEVICE_OBJECT DeviceObject,
 
     if (DeviceObject)
     {
+        if (NonPagedCcb) ExReleaseResourceLite(&NonPagedCcb->Lock);
         NpReleaseVcb();
         FsRtlExitFileSystem();
     }
@@ -467,6 +481,7 @@ NpAddDataQueueEntry(IN ULONG NamedPipeEnd,
     if (Status == STATUS_PENDING)
     {
         IoMarkIrpPending(Irp);
+        Irp->Tail.Overlay.DriverContext[1] = Ccb->NonPagedCcb;
         Irp->Tail.Overlay.DriverContext[2] = DataQueue;
         Irp->Tail.Overlay.DriverContext[3] = DataEntry;
 
@@ -88,6 +88,7 @@ NpCommonSetInformation(IN PDEVICE_OBJECT DeviceObject,
     PNP_FCB Fcb;
     PNP_CCB Ccb;
     ULONG NamedPipeEnd;
+    NTSTATUS Status;
     PAGED_CODE();
 
     IoStack = IoGetCurrentIrpStackLocation(Irp);
@@ -106,7 +107,11 @@ NpCommonSetInformation(IN PDEVICE_OBJECT DeviceObject,
 
     if (InfoClass != FilePipeInformation) return STATUS_INVALID_PARAMETER;
 
-    return NpSetPipeInfo(Fcb, Ccb, Buffer, NamedPipeEnd, List);
+    ExAcquireResourceExclusiveLite(&Ccb->NonPagedCcb->Lock, TRUE);
+    Status = NpSetPipeInfo(Fcb, Ccb, Buffer, NamedPipeEnd, List);
+    ExReleaseResourceLite(&Ccb->NonPagedCcb->Lock);
+
+    return Status;
 }
 
 NTSTATUS
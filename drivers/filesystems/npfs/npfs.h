@@ -32,6 +32,9 @@
 #define MIN_INDEXED_LENGTH 5
 #define MAX_INDEXED_LENGTH 9
 
+/* Largest pending read whose buffer is locked for the writer to fill */
+#define NP_MAX_DIRECT_READ_SIZE (64 * 1024)
+
 /* TYPEDEFS & DEFINES *********************************************************/
 
 //
@@ -252,6 +255,7 @@ typedef struct _NP_NONPAGED_CCB
     NODE_TYPE_CODE NodeType;
     PNP_EVENT_BUFFER EventBuffer[2];
     ERESOURCE Lock;
+    EX_RUNDOWN_REF RundownRef;
 } NP_NONPAGED_CCB, *PNP_NONPAGED_CCB;
 
 /* A Client Control Block (CCB) */
@@ -41,21 +41,38 @@ NpCommonRead(IN PFILE_OBJECT FileObject,
     PAGED_CODE();
 
     IoStatus->Information = 0;
+
+    NpAcquireSharedVcb();
     NodeType = NpDecodeFileObject(FileObject, NULL, &Ccb, &NamedPipeEnd);
 
     if (!NodeType)
     {
+        NpReleaseVcb();
         IoStatus->Status = STATUS_PIPE_DISCONNECTED;
         return TRUE;
     }
 
     if (NodeType != NPFS_NTC_CCB)
     {
+        NpReleaseVcb();
         IoStatus->Status = STATUS_INVALID_PARAMETER;
         return TRUE;
     }
 
+    /*
+     * The VCB is only needed to look the CCB up. The rundown reference
+     * keeps the CCB alive and its own lock protects the data queues, so
+     * I/O on unrelated pipes doesn't serialize on the VCB.
+     */
     NonPagedCcb = Ccb->NonPagedCcb;
+    if (!ExAcquireRundownProtection(&NonPagedCcb->RundownRef))
+    {
+        NpReleaseVcb();
+        IoStatus->Status = STATUS_PIPE_DISCONNECTED;
+        return TRUE;
+    }
+
+    NpReleaseVcb();
     ExAcquireResourceExclusiveLite(&NonPagedCcb->Lock, TRUE);
 
     if (Ccb->NamedPipeState == FILE_PIPE_DISCONNECTED_STATE || Ccb->NamedPipeState == FILE_PIPE_LISTENING_STATE)
@@ -129,6 +146,28 @@ NpCommonRead(IN PFILE_OBJECT FileObject,
         goto Quickie;
     }
 
+    /*
+     * Lock the reader's buffer down while the read is pending, so that
+     * the writer can copy straight into it instead of into a pool buffer
+     * that would be copied again on completion. The pages stay locked
+     * until data arrives, which may be never, so only small buffers get
+     * this. Larger reads and failures use the buffered path.
+     */
+    if (BufferSize && BufferSize <= NP_MAX_DIRECT_READ_SIZE && !Irp->MdlAddress &&
+        IoAllocateMdl(Buffer, BufferSize, FALSE, FALSE, Irp))
+    {
+        _SEH2_TRY
+        {
+            MmProbeAndLockPages(Irp->MdlAddress, Irp->RequestorMode, IoWriteAccess);
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+            IoFreeMdl(Irp->MdlAddress);
+            Irp->MdlAddress = NULL;
+        }
+        _SEH2_END;
+    }
+
     Status = NpAddDataQueueEntry(NamedPipeEnd,
                                  Ccb,
                                  ReadQueue,
@@ -150,7 +189,8 @@ NpCommonRead(IN PFILE_OBJECT FileObject,
     }
 
 Quickie:
-    ExReleaseResourceLite(&Ccb->NonPagedCcb->Lock);
+    ExReleaseResourceLite(&NonPagedCcb->Lock);
+    ExReleaseRundownProtection(&NonPagedCcb->RundownRef);
     return ReadOk;
 }
 
@@ -169,7 +209,6 @@ NpFsdRead(IN PDEVICE_OBJECT DeviceObject,
     IoStack = IoGetCurrentIrpStackLocation(Irp);
 
     FsRtlEnterFileSystem();
-    NpAcquireSharedVcb();
 
     NpCommonRead(IoStack->FileObject,
                  Irp->UserBuffer,
@@ -178,7 +217,6 @@ NpFsdRead(IN PDEVICE_OBJECT DeviceObject,
                  Irp,
                  &DeferredList);
 
-    NpReleaseVcb();
     NpCompleteDeferredIrps(&DeferredList);
     FsRtlExitFileSystem();
 
@@ -214,7 +252,6 @@ NpFastRead(
     InitializeListHead(&DeferredList);
 
     FsRtlEnterFileSystem();
-    NpAcquireSharedVcb();
 
     Result = NpCommonRead(FileObject,
                           Buffer,
@@ -227,7 +264,6 @@ NpFastRead(
     else
         ++NpFastReadFalse;
 
-    NpReleaseVcb();
     NpCompleteDeferredIrps(&DeferredList);
     FsRtlExitFileSystem();
 
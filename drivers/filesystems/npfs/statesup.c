@@ -298,6 +298,8 @@ NpSetClosingPipeState(IN PNP_CCB Ccb,
 
         case FILE_PIPE_CLOSING_STATE:
 
+            ExWaitForRundownProtectionRelease(&NonPagedCcb->RundownRef);
+
             if (NamedPipeEnd == FILE_PIPE_SERVER_END)
             {
                 DataQueue = &Ccb->DataQueue[FILE_PIPE_INBOUND];
@@ -337,6 +339,8 @@ NpSetClosingPipeState(IN PNP_CCB Ccb,
 
         case FILE_PIPE_CONNECTED_STATE:
 
+            ExAcquireResourceExclusiveLite(&NonPagedCcb->Lock, TRUE);
+
             if (NamedPipeEnd == FILE_PIPE_SERVER_END)
             {
                 ReadQueue = &Ccb->DataQueue[FILE_PIPE_INBOUND];
@@ -379,6 +383,8 @@ NpSetClosingPipeState(IN PNP_CCB Ccb,
             }
 
             if (EventBuffer) KeSetEvent(EventBuffer->Event, IO_NO_INCREMENT, FALSE);
+
+            ExReleaseResourceLite(&NonPagedCcb->Lock);
             break;
 
         default:
@@ -98,6 +98,9 @@ NpDeleteCcb(IN PNP_CCB Ccb,
     RootDcbCcb = (PNP_ROOT_DCB_FCB)Ccb;
     if (Ccb->NodeType == NPFS_NTC_CCB)
     {
+        /* Wait for reads and writes that looked up this CCB to be done with it */
+        ExWaitForRundownProtectionRelease(&Ccb->NonPagedCcb->RundownRef);
+
         RemoveEntryList(&Ccb->CcbEntry);
         --Ccb->Fcb->CurrentInstances;
 
@@ -360,6 +363,7 @@ NpCreateCcb(IN PNP_FCB Fcb,
     Fcb->ServerOpenCount++;
     InitializeListHead(&Ccb->IrpList);
     ExInitializeResourceLite(&Ccb->NonPagedCcb->Lock);
+    ExInitializeRundownProtection(&Ccb->NonPagedCcb->RundownRef);
     *NewCcb = Ccb;
     return STATUS_SUCCESS;
 }
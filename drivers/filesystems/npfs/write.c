@@ -42,21 +42,38 @@ NpCommonWrite(IN PFILE_OBJECT FileObject,
     PAGED_CODE();
 
     IoStatus->Information = 0;
+
+    NpAcquireSharedVcb();
     NodeType = NpDecodeFileObject(FileObject, NULL, &Ccb, &NamedPipeEnd);
 
     if (!NodeType)
     {
+        NpReleaseVcb();
         IoStatus->Status = STATUS_PIPE_DISCONNECTED;
         return TRUE;
     }
 
     if (NodeType != NPFS_NTC_CCB)
     {
+        NpReleaseVcb();
         IoStatus->Status = STATUS_INVALID_PARAMETER;
         return TRUE;
     }
 
+    /*
+     * The VCB is only needed to look the CCB up. The rundown reference
+     * keeps the CCB alive and its own lock protects the data queues, so
+     * I/O on unrelated pipes doesn't serialize on the VCB.
+     */
     NonPagedCcb = Ccb->NonPagedCcb;
+    if (!ExAcquireRundownProtection(&NonPagedCcb->RundownRef))
+    {
+        NpReleaseVcb();
+        IoStatus->Status = STATUS_PIPE_DISCONNECTED;
+        return TRUE;
+    }
+
+    NpReleaseVcb();
     ExAcquireResourceExclusiveLite(&NonPagedCcb->Lock, TRUE);
 
     if (Ccb->NamedPipeState != FILE_PIPE_CONNECTED_STATE)
@@ -166,7 +183,8 @@ NpCommonWrite(IN PFILE_OBJECT FileObject,
     WriteOk = TRUE;
 
 Quickie:
-    ExReleaseResourceLite(&Ccb->NonPagedCcb->Lock);
+    ExReleaseResourceLite(&NonPagedCcb->Lock);
+    ExReleaseRundownProtection(&NonPagedCcb->RundownRef);
     return WriteOk;
 }
 
@@ -185,7 +203,6 @@ NpFsdWrite(IN PDEVICE_OBJECT DeviceObject,
     IoStack = IoGetCurrentIrpStackLocation(Irp);
 
     FsRtlEnterFileSystem();
-    NpAcquireSharedVcb();
 
     NpCommonWrite(IoStack->FileObject,
                   Irp->UserBuffer,
@@ -195,7 +212,6 @@ NpFsdWrite(IN PDEVICE_OBJECT DeviceObject,
                   Irp,
                   &DeferredList);
 
-    NpReleaseVcb();
     NpCompleteDeferredIrps(&DeferredList);
     FsRtlExitFileSystem();
 
@@ -231,7 +247,6 @@ NpFastWrite(
     InitializeListHead(&DeferredList);
 
     FsRtlEnterFileSystem();
-    NpAcquireSharedVcb();
 
     Result = NpCommonWrite(FileObject,
                            Buffer,
@@ -245,7 +260,6 @@ NpFastWrite(
     else
         ++NpFastWriteFalse;
 
-    NpReleaseVcb();
     NpCompleteDeferredIrps(&DeferredList);
     FsRtlExitFileSystem();
 
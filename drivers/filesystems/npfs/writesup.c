@@ -80,11 +80,24 @@ NpWriteDataQueue(IN PNP_DATA_QUEUE WriteQueue,
         BufferSize = *BytesNotWritten;
         if (BufferSize >= DataSize) BufferSize = DataSize;
 
+        Buffer = NULL;
+        AllocatedBuffer = FALSE;
+
         if (DataEntry->DataEntryType != Unbuffered && BufferSize)
         {
-            Buffer = ExAllocatePoolWithTag(NonPagedPool, BufferSize, NPFS_DATA_ENTRY_TAG);
-            if (!Buffer) return STATUS_INSUFFICIENT_RESOURCES;
-            AllocatedBuffer = TRUE;
+            /* Hand the data straight to a pending read that locked its buffer */
+            if (IoStack->MajorFunction == IRP_MJ_READ && DataEntry->Irp->MdlAddress)
+            {
+                Buffer = MmGetSystemAddressForMdlSafe(DataEntry->Irp->MdlAddress,
+                                                      NormalPagePriority);
+            }
+
+            if (!Buffer)
+            {
+                Buffer = ExAllocatePoolWithTag(NonPagedPool, BufferSize, NPFS_DATA_ENTRY_TAG);
+                if (!Buffer) return STATUS_INSUFFICIENT_RESOURCES;
+                AllocatedBuffer = TRUE;
+            }
         }
         else
         {
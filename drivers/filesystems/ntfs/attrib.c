@@ -636,6 +636,8 @@ AddRun(PNTFS_VCB Vcb,
     }
     _SEH2_END;
 
+    InvalidateAttributeRunCache(AttrContext);
+
     RunBuffer = ExAllocatePoolWithTag(NonPagedPool, Vcb->NtfsInfo.BytesPerFileRecord, TAG_NTFS);
     if (!RunBuffer)
     {
@@ -1142,6 +1144,7 @@ FreeClusters(PNTFS_VCB Vcb,
             RtlClearBits(&Bitmap, LargeLbn, 1);
         }
         FsRtlTruncateLargeMcb(&AttrContext->DataRunsMCB, AttrContext->pRecord->NonResident.HighestVCN);
+        InvalidateAttributeRunCache(AttrContext);
 
         // decrement HighestVCN, but don't let it go below 0
         AttrContext->pRecord->NonResident.HighestVCN = min(AttrContext->pRecord->NonResident.HighestVCN, AttrContext->pRecord->NonResident.HighestVCN - 1);
@@ -107,6 +107,9 @@ NtfsCreateFCB(PCWSTR FileName,
 
     Fcb->RFCB.Resource = &(Fcb->MainResource);
 
+    ExInitializeFastMutex(&Fcb->CompressionUnitLock);
+    Fcb->CompressionUnit = (ULONGLONG)-1;
+
     return Fcb;
 }
 
@@ -119,6 +122,9 @@ NtfsDestroyFCB(PNTFS_FCB Fcb)
 
     ExDeleteResourceLite(&Fcb->MainResource);
 
+    if (Fcb->CompressionUnitBuffer != NULL)
+        ExFreePoolWithTag(Fcb->CompressionUnitBuffer, TAG_NTFS);
+
     ExFreeToNPagedLookasideList(&NtfsGlobalData->FcbLookasideList, Fcb);
 }
 
@@ -459,6 +459,8 @@ NtfsMountVolume(PDEVICE_OBJECT DeviceObject,
     Vcb->Identifier.Type = NTFS_TYPE_VCB;
     Vcb->Identifier.Size = sizeof(NTFS_TYPE_VCB);
 
+    NtfsInitializeRecordCache(Vcb);
+
     Status = NtfsGetVolumeData(DeviceToMount,
                                Vcb);
     if (!NT_SUCCESS(Status))
@@ -567,6 +569,9 @@ ByeBye:
         if (Lookaside)
             ExDeleteNPagedLookasideList(&Vcb->FileRecLookasideList);
 
+        if (Vcb)
+            NtfsUninitializeRecordCache(Vcb);
+
         if (NewDeviceObject)
             IoDeleteDevice(NewDeviceObject);
     }
@@ -61,31 +61,14 @@ PrepareAttributeContext(PNTFS_ATTR_RECORD AttrRecord)
     // Copy the attribute
     RtlCopyMemory(Context->pRecord, AttrRecord, AttrRecord->Length);
 
+    KeInitializeSpinLock(&Context->CacheRunLock);
+    Context->CacheRunLength = 0;
+
     if (AttrRecord->IsNonResident)
     {
-        LONGLONG DataRunOffset;
-        ULONGLONG DataRunLength;
         ULONGLONG NextVBN = 0;
         PUCHAR DataRun = (PUCHAR)((ULONG_PTR)Context->pRecord + Context->pRecord->NonResident.MappingPairsOffset);
 
-        Context->CacheRun = DataRun;
-        Context->CacheRunOffset = 0;
-        Context->CacheRun = DecodeRun(Context->CacheRun, &DataRunOffset, &DataRunLength);
-        Context->CacheRunLength = DataRunLength;
-        if (DataRunOffset != -1)
-        {
-            /* Normal run. */
-            Context->CacheRunStartLCN =
-            Context->CacheRunLastLCN = DataRunOffset;
-        }
-        else
-        {
-            /* Sparse run. */
-            Context->CacheRunStartLCN = -1;
-            Context->CacheRunLastLCN = 0;
-        }
-        Context->CacheRunCurrentOffset = 0;
-
         // Convert the data runs to a map control block
         if (!NT_SUCCESS(ConvertDataRunsToLargeMCB(DataRun, &Context->DataRunsMCB, &NextVBN)))
         {
@@ -117,6 +100,92 @@ ReleaseAttributeContext(PNTFS_ATTR_CONTEXT Context)
 }
 
 
+/**
+* @name InvalidateAttributeRunCache
+* @implemented
+*
+* Forgets the run cached by LookupAttributeRun(). Must be called whenever
+* DataRunsMCB of the attribute is changed.
+*/
+VOID
+InvalidateAttributeRunCache(PNTFS_ATTR_CONTEXT Context)
+{
+    KIRQL OldIrql;
+
+    KeAcquireSpinLock(&Context->CacheRunLock, &OldIrql);
+    Context->CacheRunLength = 0;
+    KeReleaseSpinLock(&Context->CacheRunLock, OldIrql);
+}
+
+
+/**
+* @name LookupAttributeRun
+* @implemented
+*
+* Maps a VCN of a non-resident attribute to its LCN.
+*
+* @param Context
+* Attribute context; the run found is cached in it, as reads tend to
+* stay in the same run. The $MFT context is shared between threads.
+*
+* @param Vcn
+* Virtual cluster number to look up.
+*
+* @param Lcn
+* Receives the logical cluster number, or -1 if Vcn is in a sparse run.
+*
+* @param ClusterCount
+* Receives the number of clusters from Vcn to the end of the run.
+*
+* @return
+* FALSE if Vcn is past the last mapped run, TRUE otherwise.
+*/
+static
+BOOLEAN
+LookupAttributeRun(PNTFS_ATTR_CONTEXT Context,
+                   ULONGLONG Vcn,
+                   PLONGLONG Lcn,
+                   PULONGLONG ClusterCount)
+{
+    LONGLONG RunLcn, ClustersFromVcn, StartingLcn, RunLength;
+    ULONGLONG Delta;
+    KIRQL OldIrql;
+
+    KeAcquireSpinLock(&Context->CacheRunLock, &OldIrql);
+    if (Vcn >= Context->CacheRunVCN &&
+        Vcn - Context->CacheRunVCN < Context->CacheRunLength)
+    {
+        Delta = Vcn - Context->CacheRunVCN;
+        *Lcn = (Context->CacheRunStartLCN == -1) ? -1 : Context->CacheRunStartLCN + Delta;
+        *ClusterCount = Context->CacheRunLength - Delta;
+        KeReleaseSpinLock(&Context->CacheRunLock, OldIrql);
+        return TRUE;
+    }
+    KeReleaseSpinLock(&Context->CacheRunLock, OldIrql);
+
+    if (!FsRtlLookupLargeMcbEntry(&Context->DataRunsMCB,
+                                  Vcn,
+                                  &RunLcn,
+                                  &ClustersFromVcn,
+                                  &StartingLcn,
+                                  &RunLength,
+                                  NULL))
+    {
+        return FALSE;
+    }
+
+    KeAcquireSpinLock(&Context->CacheRunLock, &OldIrql);
+    Context->CacheRunVCN = Vcn + ClustersFromVcn - RunLength;
+    Context->CacheRunStartLCN = StartingLcn;
+    Context->CacheRunLength = RunLength;
+    KeReleaseSpinLock(&Context->CacheRunLock, OldIrql);
+
+    *Lcn = RunLcn;
+    *ClusterCount = ClustersFromVcn;
+    return TRUE;
+}
+
+
 /**
 * @name FindAttribute
 * @implemented
@@ -998,6 +1067,7 @@ SetResidentAttributeDataLength(PDEVICE_EXTENSION Vcb,
                 _SEH2_TRY
                 {
                     FsRtlInitializeLargeMcb(&AttrContext->DataRunsMCB, NonPagedPool);
+                    InvalidateAttributeRunCache(AttrContext);
                 }
                 _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER) 
                 {
@@ -1068,18 +1138,13 @@ ReadAttribute(PDEVICE_EXTENSION Vcb,
               PCHAR Buffer,
               ULONG Length)
 {
-    ULONGLONG LastLCN;
-    PUCHAR DataRun;
-    LONGLONG DataRunOffset;
-    ULONGLONG DataRunLength;
-    LONGLONG DataRunStartLCN;
-    ULONGLONG CurrentOffset;
+    ULONG BytesPerCluster = Vcb->NtfsInfo.BytesPerCluster;
+    ULONGLONG Vcn, ClusterCount, AllocatedClusters;
+    LONGLONG Lcn;
+    ULONG RunOffset;
     ULONG ReadLength;
     ULONG AlreadyRead;
     NTSTATUS Status;
-    
-    //TEMPTEMP
-    PUCHAR TempBuffer;
 
     if (!Context->pRecord->IsNonResident)
     {
@@ -1098,175 +1163,147 @@ ReadAttribute(PDEVICE_EXTENSION Vcb,
     }
 
     /*
-     * Non-resident attribute
-     */
-
-    /*
-     * I. Find the corresponding start data run.
+     * Non-resident attribute. Map each VCN through the MCB and read
+     * as much of the run it falls in as requested, in a single I/O.
      */
 
     AlreadyRead = 0;
 
-    // FIXME: Cache seems to be non-working. Disable it for now
-    //if(Context->CacheRunOffset <= Offset && Offset < Context->CacheRunOffset + Context->CacheRunLength * Volume->ClusterSize)
-    if (0)
-    {
-        DataRun = Context->CacheRun;
-        LastLCN = Context->CacheRunLastLCN;
-        DataRunStartLCN = Context->CacheRunStartLCN;
-        DataRunLength = Context->CacheRunLength;
-        CurrentOffset = Context->CacheRunCurrentOffset;
-    }
-    else
+    while (Length > 0)
     {
-        //TEMPTEMP
-        ULONG UsedBufferSize;
-        TempBuffer = ExAllocatePoolWithTag(NonPagedPool, Vcb->NtfsInfo.BytesPerFileRecord, TAG_NTFS);
-        if (TempBuffer == NULL)
-        {
-            return STATUS_INSUFFICIENT_RESOURCES;
-        }
-
-        LastLCN = 0;
-        CurrentOffset = 0;
-
-        // This will be rewritten in the next iteration to just use the DataRuns MCB directly
-        ConvertLargeMCBToDataRuns(&Context->DataRunsMCB,
-                                  TempBuffer,
-                                  Vcb->NtfsInfo.BytesPerFileRecord,
-                                  &UsedBufferSize);
+        Vcn = Offset / BytesPerCluster;
+        RunOffset = (ULONG)(Offset % BytesPerCluster);
 
-        DataRun = TempBuffer;
-
-        while (1)
+        if (!LookupAttributeRun(Context, Vcn, &Lcn, &ClusterCount))
         {
-            DataRun = DecodeRun(DataRun, &DataRunOffset, &DataRunLength);
-            if (DataRunOffset != -1)
-            {
-                /* Normal data run. */
-                DataRunStartLCN = LastLCN + DataRunOffset;
-                LastLCN = DataRunStartLCN;
-            }
-            else
-            {
-                /* Sparse data run. */
-                DataRunStartLCN = -1;
-            }
-
-            if (Offset >= CurrentOffset &&
-                Offset < CurrentOffset + (DataRunLength * Vcb->NtfsInfo.BytesPerCluster))
-            {
+            /* Sparse runs at the end of the attribute aren't in the MCB */
+            AllocatedClusters = Context->pRecord->NonResident.AllocatedSize / BytesPerCluster;
+            if (Vcn >= AllocatedClusters)
                 break;
-            }
 
-            if (*DataRun == 0)
-            {
-                ExFreePoolWithTag(TempBuffer, TAG_NTFS);
-                return AlreadyRead;
-            }
+            Lcn = -1;
+            ClusterCount = AllocatedClusters - Vcn;
+        }
 
-            CurrentOffset += DataRunLength * Vcb->NtfsInfo.BytesPerCluster;
+        ReadLength = (ULONG)min(ClusterCount * BytesPerCluster - RunOffset, Length);
+        if (Lcn == -1)
+        {
+            /* Sparse data run. */
+            RtlZeroMemory(Buffer, ReadLength);
+        }
+        else
+        {
+            Status = NtfsReadDisk(Vcb->StorageDevice,
+                                  Lcn * BytesPerCluster + RunOffset,
+                                  ReadLength,
+                                  Vcb->NtfsInfo.BytesPerSector,
+                                  (PVOID)Buffer,
+                                  FALSE);
+            if (!NT_SUCCESS(Status))
+                break;
         }
+
+        Length -= ReadLength;
+        Buffer += ReadLength;
+        Offset += ReadLength;
+        AlreadyRead += ReadLength;
     }
 
-    /*
-     * II. Go through the run list and read the data
-     */
+    return AlreadyRead;
+}
 
-    ReadLength = (ULONG)min(DataRunLength * Vcb->NtfsInfo.BytesPerCluster - (Offset - CurrentOffset), Length);
-    if (DataRunStartLCN == -1)
-    {
-        RtlZeroMemory(Buffer, ReadLength);
-        Status = STATUS_SUCCESS;
-    }
-    else
+
+/**
+* @name ReadCompressionUnit
+* @implemented
+*
+* Reads and decompresses one compression unit of a compressed non-resident attribute.
+*
+* @param Context
+* Pointer to an NTFS_ATTR_CONTEXT of an attribute with a non-zero CompressionUnit.
+*
+* @param Unit
+* Index of the compression unit in the attribute.
+*
+* @param Buffer
+* Receives the uncompressed unit, BytesPerCluster << CompressionUnit bytes.
+*
+* @remarks A unit is stored as is when all its clusters are allocated, holds LZNT1
+* data in its leading clusters when it ends with a sparse run, and is all zeroes when
+* it's entirely sparse.
+*/
+NTSTATUS
+ReadCompressionUnit(PDEVICE_EXTENSION Vcb,
+                    PNTFS_ATTR_CONTEXT Context,
+                    ULONGLONG Unit,
+                    PUCHAR Buffer)
+{
+    ULONG BytesPerCluster = Vcb->NtfsInfo.BytesPerCluster;
+    ULONG UnitClusters = 1 << Context->pRecord->NonResident.CompressionUnit;
+    ULONG UnitSize = UnitClusters * BytesPerCluster;
+    ULONGLONG Vcn = Unit * UnitClusters;
+    ULONGLONG ClusterCount;
+    ULONG Allocated, Count, FinalSize;
+    PUCHAR CompressedData;
+    LONGLONG Lcn;
+    NTSTATUS Status;
+
+    DPRINT("ReadCompressionUnit(%p, %p, %I64u, %p)\n", Vcb, Context, Unit, Buffer);
+
+    // Read the allocated clusters at the start of the unit, in place
+    for (Allocated = 0; Allocated < UnitClusters; Allocated += Count)
     {
+        if (!LookupAttributeRun(Context, Vcn + Allocated, &Lcn, &ClusterCount) || Lcn == -1)
+            break;
+
+        Count = (ULONG)min(ClusterCount, UnitClusters - Allocated);
         Status = NtfsReadDisk(Vcb->StorageDevice,
-                              DataRunStartLCN * Vcb->NtfsInfo.BytesPerCluster + Offset - CurrentOffset,
-                              ReadLength,
+                              Lcn * BytesPerCluster,
+                              Count * BytesPerCluster,
                               Vcb->NtfsInfo.BytesPerSector,
-                              (PVOID)Buffer,
+                              Buffer + Allocated * BytesPerCluster,
                               FALSE);
+        if (!NT_SUCCESS(Status))
+            return Status;
     }
-    if (NT_SUCCESS(Status))
-    {
-        Length -= ReadLength;
-        Buffer += ReadLength;
-        AlreadyRead += ReadLength;
-
-        if (ReadLength == DataRunLength * Vcb->NtfsInfo.BytesPerCluster - (Offset - CurrentOffset))
-        {
-            CurrentOffset += DataRunLength * Vcb->NtfsInfo.BytesPerCluster;
-            DataRun = DecodeRun(DataRun, &DataRunOffset, &DataRunLength);
-            if (DataRunOffset != (ULONGLONG)-1)
-            {
-                DataRunStartLCN = LastLCN + DataRunOffset;
-                LastLCN = DataRunStartLCN;
-            }
-            else
-                DataRunStartLCN = -1;
-        }
-
-        while (Length > 0)
-        {
-            ReadLength = (ULONG)min(DataRunLength * Vcb->NtfsInfo.BytesPerCluster, Length);
-            if (DataRunStartLCN == -1)
-                RtlZeroMemory(Buffer, ReadLength);
-            else
-            {
-                Status = NtfsReadDisk(Vcb->StorageDevice,
-                                      DataRunStartLCN * Vcb->NtfsInfo.BytesPerCluster,
-                                      ReadLength,
-                                      Vcb->NtfsInfo.BytesPerSector,
-                                      (PVOID)Buffer,
-                                      FALSE);
-                if (!NT_SUCCESS(Status))
-                    break;
-            }
-
-            Length -= ReadLength;
-            Buffer += ReadLength;
-            AlreadyRead += ReadLength;
 
-            /* We finished this request, but there still data in this data run. */
-            if (Length == 0 && ReadLength != DataRunLength * Vcb->NtfsInfo.BytesPerCluster)
-                break;
+    if (Allocated == UnitClusters)
+    {
+        // Stored uncompressed
+        return STATUS_SUCCESS;
+    }
 
-            /*
-             * Go to next run in the list.
-             */
+    if (Allocated == 0)
+    {
+        // Sparse unit
+        RtlZeroMemory(Buffer, UnitSize);
+        return STATUS_SUCCESS;
+    }
 
-            if (*DataRun == 0)
-                break;
-            CurrentOffset += DataRunLength * Vcb->NtfsInfo.BytesPerCluster;
-            DataRun = DecodeRun(DataRun, &DataRunOffset, &DataRunLength);
-            if (DataRunOffset != -1)
-            {
-                /* Normal data run. */
-                DataRunStartLCN = LastLCN + DataRunOffset;
-                LastLCN = DataRunStartLCN;
-            }
-            else
-            {
-                /* Sparse data run. */
-                DataRunStartLCN = -1;
-            }
-        } /* while */
+    CompressedData = ExAllocatePoolWithTag(NonPagedPool, Allocated * BytesPerCluster, TAG_NTFS);
+    if (CompressedData == NULL)
+        return STATUS_INSUFFICIENT_RESOURCES;
 
-    } /* if Disk */
+    RtlCopyMemory(CompressedData, Buffer, Allocated * BytesPerCluster);
+    Status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1,
+                                 Buffer,
+                                 UnitSize,
+                                 CompressedData,
+                                 Allocated * BytesPerCluster,
+                                 &FinalSize);
+    ExFreePoolWithTag(CompressedData, TAG_NTFS);
 
-    // TEMPTEMP
-    if (Context->pRecord->IsNonResident)
-        ExFreePoolWithTag(TempBuffer, TAG_NTFS);
+    if (!NT_SUCCESS(Status))
+    {
+        DPRINT1("Compression unit %I64u is corrupt (Status 0x%08lx)\n", Unit, Status);
+        return Status;
+    }
 
-    Context->CacheRun = DataRun;
-    Context->CacheRunOffset = Offset + AlreadyRead;
-    Context->CacheRunStartLCN = DataRunStartLCN;
-    Context->CacheRunLength = DataRunLength;
-    Context->CacheRunLastLCN = LastLCN;
-    Context->CacheRunCurrentOffset = CurrentOffset;
+    // The data may end before the unit does
+    if (FinalSize < UnitSize)
+        RtlZeroMemory(Buffer + FinalSize, UnitSize - FinalSize);
 
-    return AlreadyRead;
+    return STATUS_SUCCESS;
 }
 
 
@@ -1331,6 +1368,7 @@ WriteAttribute(PDEVICE_EXTENSION Vcb,
     PUCHAR SourceBuffer = Buffer;
     LONGLONG StartingOffset;
     BOOLEAN FileRecordAllocated = FALSE;
+    ULONG TotalLength = Length;
     
     //TEMPTEMP
     PUCHAR TempBuffer;
@@ -1517,12 +1555,6 @@ WriteAttribute(PDEVICE_EXTENSION Vcb,
     // Did the write fail?
     if (!NT_SUCCESS(Status))
     {
-        Context->CacheRun = DataRun;
-        Context->CacheRunOffset = Offset;
-        Context->CacheRunStartLCN = DataRunStartLCN;
-        Context->CacheRunLength = DataRunLength;
-        Context->CacheRunLastLCN = LastLCN;
-        Context->CacheRunCurrentOffset = CurrentOffset;
 
         goto Cleanup;
     }
@@ -1612,14 +1644,18 @@ WriteAttribute(PDEVICE_EXTENSION Vcb,
         }
     } // end while (Length > 0) [more data to write]
 
-    Context->CacheRun = DataRun;
-    Context->CacheRunOffset = Offset + *RealLengthWritten;
-    Context->CacheRunStartLCN = DataRunStartLCN;
-    Context->CacheRunLength = DataRunLength;
-    Context->CacheRunLastLCN = LastLCN;
-    Context->CacheRunCurrentOffset = CurrentOffset;
-
 Cleanup:
+    // Drop cached copies of the file records or index buffers we overwrote. Do it after the
+    // write, even a failed one, so nobody caches what was on the disk before it again.
+    if (Context->FileMFTIndex == NTFS_FILE_MFT && Context->pRecord->Type == AttributeData)
+    {
+        NtfsRecordCacheInvalidate(Vcb, NTFS_CACHE_FILE_RECORD, 0, Offset, TotalLength);
+    }
+    else if (Context->pRecord->Type == AttributeIndexAllocation)
+    {
+        NtfsRecordCacheInvalidate(Vcb, NTFS_CACHE_INDEX_BUFFER, Context->FileMFTIndex, Offset, TotalLength);
+    }
+
     // TEMPTEMP
     if (Context->pRecord->IsNonResident)
         ExFreePoolWithTag(TempBuffer, TAG_NTFS);
@@ -1633,9 +1669,16 @@ ReadFileRecord(PDEVICE_EXTENSION Vcb,
                PFILE_RECORD_HEADER file)
 {
     ULONGLONG BytesRead;
+    ULONG Generation;
+    NTSTATUS Status;
 
     DPRINT("ReadFileRecord(%p, %I64x, %p)\n", Vcb, index, file);
 
+    if (NtfsRecordCacheLookup(Vcb, NTFS_CACHE_FILE_RECORD, index, 0, file, Vcb->NtfsInfo.BytesPerFileRecord, &Generation))
+    {
+        return STATUS_SUCCESS;
+    }
+
     BytesRead = ReadAttribute(Vcb, Vcb->MFTContext, index * Vcb->NtfsInfo.BytesPerFileRecord, (PCHAR)file, Vcb->NtfsInfo.BytesPerFileRecord);
     if (BytesRead != Vcb->NtfsInfo.BytesPerFileRecord)
     {
@@ -1645,7 +1688,101 @@ ReadFileRecord(PDEVICE_EXTENSION Vcb,
 
     /* Apply update sequence array fixups. */
     DPRINT("Sequence number: %u\n", file->SequenceNumber);
-    return FixupUpdateSequenceArray(Vcb, &file->Ntfs);
+    Status = FixupUpdateSequenceArray(Vcb, &file->Ntfs);
+    if (NT_SUCCESS(Status))
+    {
+        NtfsRecordCacheInsert(Vcb, NTFS_CACHE_FILE_RECORD, index, 0, file, Vcb->NtfsInfo.BytesPerFileRecord, Generation);
+    }
+
+    return Status;
+}
+
+static
+BOOLEAN
+IsValidFileRecord(PDEVICE_EXTENSION Vcb,
+                  PFILE_RECORD_HEADER FileRecord)
+{
+    ULONG UsaCount = Vcb->NtfsInfo.BytesPerFileRecord / Vcb->NtfsInfo.BytesPerSector + 1;
+
+    return FileRecord->Ntfs.Type == NRH_FILE_TYPE &&
+           FileRecord->Ntfs.UsaCount == UsaCount &&
+           FileRecord->Ntfs.UsaOffset >= sizeof(NTFS_RECORD_HEADER) &&
+           FileRecord->Ntfs.UsaOffset + UsaCount * sizeof(USHORT) <= Vcb->NtfsInfo.BytesPerSector;
+}
+
+/**
+* @name ReadFileRecordReadAhead
+* @implemented
+*
+* Same as ReadFileRecord(), but on a cache miss reads NTFS_MFT_READ_AHEAD
+* consecutive file records at once and caches the ones in use. Used while
+* enumerating directories, whose entries tend to sit next to each other
+* in the MFT.
+*/
+NTSTATUS
+ReadFileRecordReadAhead(PDEVICE_EXTENSION Vcb,
+                        ULONGLONG index,
+                        PFILE_RECORD_HEADER file)
+{
+    ULONG BytesPerFileRecord = Vcb->NtfsInfo.BytesPerFileRecord;
+    ULONGLONG MftLength, BytesRead;
+    ULONG Count, i, Generation;
+    PFILE_RECORD_HEADER FileRecord;
+    PUCHAR Buffer;
+    NTSTATUS Status;
+
+    DPRINT("ReadFileRecordReadAhead(%p, %I64x, %p)\n", Vcb, index, file);
+
+    if (NtfsRecordCacheLookup(Vcb, NTFS_CACHE_FILE_RECORD, index, 0, file, BytesPerFileRecord, &Generation))
+    {
+        return STATUS_SUCCESS;
+    }
+
+    MftLength = AttributeDataLength(Vcb->MFTContext->pRecord);
+    if ((index + 1) * BytesPerFileRecord > MftLength)
+    {
+        return ReadFileRecord(Vcb, index, file);
+    }
+
+    Count = (ULONG)min(NTFS_MFT_READ_AHEAD, MftLength / BytesPerFileRecord - index);
+    Buffer = ExAllocatePoolWithTag(NonPagedPool, Count * BytesPerFileRecord, TAG_NTFS);
+    if (Buffer == NULL)
+    {
+        return ReadFileRecord(Vcb, index, file);
+    }
+
+    BytesRead = ReadAttribute(Vcb, Vcb->MFTContext, index * BytesPerFileRecord, (PCHAR)Buffer, Count * BytesPerFileRecord);
+    if (BytesRead < BytesPerFileRecord)
+    {
+        ExFreePoolWithTag(Buffer, TAG_NTFS);
+        return ReadFileRecord(Vcb, index, file);
+    }
+    Count = (ULONG)(BytesRead / BytesPerFileRecord);
+
+    /* The requested record gets the usual checks, the others are only
+     * cached if they look like file records in use */
+    RtlCopyMemory(file, Buffer, BytesPerFileRecord);
+    Status = FixupUpdateSequenceArray(Vcb, &file->Ntfs);
+    if (NT_SUCCESS(Status))
+    {
+        NtfsRecordCacheInsert(Vcb, NTFS_CACHE_FILE_RECORD, index, 0, file, BytesPerFileRecord, Generation);
+    }
+
+    for (i = 1; i < Count; i++)
+    {
+        FileRecord = (PFILE_RECORD_HEADER)(Buffer + i * BytesPerFileRecord);
+        if (!IsValidFileRecord(Vcb, FileRecord) || !(FileRecord->Flags & FRH_IN_USE))
+            continue;
+
+        if (NT_SUCCESS(FixupUpdateSequenceArray(Vcb, &FileRecord->Ntfs)))
+        {
+            NtfsRecordCacheInsert(Vcb, NTFS_CACHE_FILE_RECORD, index + i, 0, FileRecord, BytesPerFileRecord, Generation);
+        }
+    }
+
+    ExFreePoolWithTag(Buffer, TAG_NTFS);
+
+    return Status;
 }
 
 
@@ -2852,6 +2989,7 @@ BrowseSubNodeIndexEntries(PNTFS_VCB Vcb,
     PINDEX_BUFFER IndexRecord;
     ULONGLONG Offset;
     ULONG BytesRead;
+    ULONG Generation;
     PINDEX_ENTRY_ATTRIBUTE FirstEntry;
     PINDEX_ENTRY_ATTRIBUTE LastEntry;
     PINDEX_ENTRY_ATTRIBUTE IndexEntry;
@@ -2894,25 +3032,43 @@ BrowseSubNodeIndexEntries(PNTFS_VCB Vcb,
     // Calculate offset of index record
     Offset = VCN * Vcb->NtfsInfo.BytesPerCluster;
 
-    // Read the index record
-    BytesRead = ReadAttribute(Vcb, IndexAllocationContext, Offset, (PCHAR)IndexRecord, IndexBlockSize);
-    if (BytesRead != IndexBlockSize)
-    {
-        DPRINT1("Unable to read index record!\n");
-        ExFreePoolWithTag(IndexRecord, TAG_NTFS);
-        return STATUS_UNSUCCESSFUL;
-    }
+    // Try the cache first, it holds index records with the fixups already applied
+    if (!NtfsRecordCacheLookup(Vcb,
+                               NTFS_CACHE_INDEX_BUFFER,
+                               IndexAllocationContext->FileMFTIndex,
+                               Offset,
+                               IndexRecord,
+                               IndexBlockSize,
+                               &Generation))
+    {
+        // Read the index record
+        BytesRead = ReadAttribute(Vcb, IndexAllocationContext, Offset, (PCHAR)IndexRecord, IndexBlockSize);
+        if (BytesRead != IndexBlockSize)
+        {
+            DPRINT1("Unable to read index record!\n");
+            ExFreePoolWithTag(IndexRecord, TAG_NTFS);
+            return STATUS_UNSUCCESSFUL;
+        }
 
-    // Assert that we're dealing with an index record here
-    ASSERT(IndexRecord->Ntfs.Type == NRH_INDX_TYPE);
+        // Assert that we're dealing with an index record here
+        ASSERT(IndexRecord->Ntfs.Type == NRH_INDX_TYPE);
 
-    // Apply the fixup array to the index record
-    Status = FixupUpdateSequenceArray(Vcb, &((PFILE_RECORD_HEADER)IndexRecord)->Ntfs);
-    if (!NT_SUCCESS(Status))
-    {
-        ExFreePoolWithTag(IndexRecord, TAG_NTFS);
-        DPRINT1("Failed to apply fixup array!\n");
-        return Status;
+        // Apply the fixup array to the index record
+        Status = FixupUpdateSequenceArray(Vcb, &((PFILE_RECORD_HEADER)IndexRecord)->Ntfs);
+        if (!NT_SUCCESS(Status))
+        {
+            ExFreePoolWithTag(IndexRecord, TAG_NTFS);
+            DPRINT1("Failed to apply fixup array!\n");
+            return Status;
+        }
+
+        NtfsRecordCacheInsert(Vcb,
+                              NTFS_CACHE_INDEX_BUFFER,
+                              IndexAllocationContext->FileMFTIndex,
+                              Offset,
+                              IndexRecord,
+                              IndexBlockSize,
+                              Generation);
     }
 
     ASSERT(IndexRecord->Header.AllocatedSize + FIELD_OFFSET(INDEX_BUFFER, Header) == IndexBlockSize);
@@ -3385,7 +3541,7 @@ NtfsFindFileAt(PDEVICE_EXTENSION Vcb,
         return STATUS_INSUFFICIENT_RESOURCES;
     }
 
-    Status = ReadFileRecord(Vcb, CurrentMFTIndex, *FileRecord);
+    Status = ReadFileRecordReadAhead(Vcb, CurrentMFTIndex, *FileRecord);
     if (!NT_SUCCESS(Status))
     {
         DPRINT("NtfsFindFileAt: Can't read MFT record\n");
@@ -0,0 +1,323 @@
+/*
+ * PROJECT:     ReactOS NTFS filesystem driver
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Cache of fixed-up file records and index buffers
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+/* INCLUDES *****************************************************************/
+
+#include "ntfs.h"
+
+#define NDEBUG
+#include <debug.h>
+
+/* GLOBALS *****************************************************************/
+
+typedef struct _NTFS_RECORD_CACHE_ENTRY
+{
+    LIST_ENTRY LruEntry;
+    LIST_ENTRY HashEntry;
+    ULONG Type;
+    ULONG Length;
+    ULONGLONG Key;
+    ULONGLONG Offset;
+    UCHAR Data[ANYSIZE_ARRAY];
+} NTFS_RECORD_CACHE_ENTRY, *PNTFS_RECORD_CACHE_ENTRY;
+
+/* FUNCTIONS ****************************************************************/
+
+static
+ULONG
+NtfsRecordCacheHash(ULONG Type,
+                    ULONGLONG Key,
+                    ULONGLONG Offset)
+{
+    ULONGLONG Hash;
+
+    Hash = (Key * 0x9E3779B97F4A7C15ULL) ^ (Offset >> 9) ^ Type;
+    return (ULONG)(Hash ^ (Hash >> 32)) & (NTFS_RECORD_CACHE_BUCKETS - 1);
+}
+
+/*
+ * Index buffers are keyed on the MFT index of their attribute context,
+ * which FindAttribute() takes from the MFTRecordNumber field of the file
+ * record. Only NTFS 3.1 and later store the record number there, so the
+ * index buffers of older volumes aren't cached.
+ */
+static
+BOOLEAN
+NtfsRecordCacheKeyValid(PNTFS_VCB Vcb,
+                        ULONG Type)
+{
+    if (Type != NTFS_CACHE_INDEX_BUFFER)
+        return TRUE;
+
+    return Vcb->NtfsInfo.MajorVersion > 3 ||
+           (Vcb->NtfsInfo.MajorVersion == 3 && Vcb->NtfsInfo.MinorVersion >= 1);
+}
+
+static
+PNTFS_RECORD_CACHE_ENTRY
+NtfsRecordCacheFind(PNTFS_RECORD_CACHE Cache,
+                    ULONG Type,
+                    ULONGLONG Key,
+                    ULONGLONG Offset)
+{
+    PLIST_ENTRY BucketHead, Entry;
+    PNTFS_RECORD_CACHE_ENTRY CacheEntry;
+
+    BucketHead = &Cache->HashTable[NtfsRecordCacheHash(Type, Key, Offset)];
+    for (Entry = BucketHead->Flink; Entry != BucketHead; Entry = Entry->Flink)
+    {
+        CacheEntry = CONTAINING_RECORD(Entry, NTFS_RECORD_CACHE_ENTRY, HashEntry);
+        if (CacheEntry->Type == Type &&
+            CacheEntry->Key == Key &&
+            CacheEntry->Offset == Offset)
+        {
+            return CacheEntry;
+        }
+    }
+
+    return NULL;
+}
+
+static
+VOID
+NtfsRecordCacheRemove(PNTFS_RECORD_CACHE Cache,
+                      PNTFS_RECORD_CACHE_ENTRY CacheEntry)
+{
+    RemoveEntryList(&CacheEntry->LruEntry);
+    RemoveEntryList(&CacheEntry->HashEntry);
+    Cache->Size -= CacheEntry->Length;
+    ExFreePoolWithTag(CacheEntry, TAG_RECORD_CACHE);
+}
+
+VOID
+NtfsInitializeRecordCache(PNTFS_VCB Vcb)
+{
+    PNTFS_RECORD_CACHE Cache = &Vcb->RecordCache;
+    ULONG i;
+
+    ExInitializeFastMutex(&Cache->Lock);
+    InitializeListHead(&Cache->LruList);
+    for (i = 0; i < NTFS_RECORD_CACHE_BUCKETS; i++)
+    {
+        InitializeListHead(&Cache->HashTable[i]);
+    }
+    Cache->Size = 0;
+    Cache->MaximumSize = NTFS_RECORD_CACHE_SIZE;
+    Cache->Generation = 0;
+    Cache->Hits = 0;
+    Cache->Misses = 0;
+}
+
+VOID
+NtfsUninitializeRecordCache(PNTFS_VCB Vcb)
+{
+    PNTFS_RECORD_CACHE Cache = &Vcb->RecordCache;
+
+    DPRINT("Record cache: %lu hits, %lu misses\n", Cache->Hits, Cache->Misses);
+
+    ExAcquireFastMutex(&Cache->Lock);
+
+    while (!IsListEmpty(&Cache->LruList))
+    {
+        NtfsRecordCacheRemove(Cache,
+                              CONTAINING_RECORD(Cache->LruList.Flink,
+                                                NTFS_RECORD_CACHE_ENTRY,
+                                                LruEntry));
+    }
+
+    /* Don't cache anything anymore */
+    Cache->MaximumSize = 0;
+
+    ExReleaseFastMutex(&Cache->Lock);
+}
+
+/**
+* @name NtfsRecordCacheLookup
+* @implemented
+*
+* Copies a cached record into Buffer.
+*
+* @param Type
+* NTFS_CACHE_FILE_RECORD or NTFS_CACHE_INDEX_BUFFER.
+*
+* @param Key
+* MFT index of the file record, or of the directory owning the index buffer.
+* Index buffers are never found on volumes older than NTFS 3.1.
+*
+* @param Offset
+* 0 for file records, byte offset of the buffer in $INDEX_ALLOCATION otherwise.
+*
+* @param Generation
+* Receives the invalidation count of the cache, to be passed to
+* NtfsRecordCacheInsert() once the record has been read from the disk.
+*
+* @return
+* TRUE if the record was cached and Length bytes of it have been copied.
+*/
+BOOLEAN
+NtfsRecordCacheLookup(PNTFS_VCB Vcb,
+                      ULONG Type,
+                      ULONGLONG Key,
+                      ULONGLONG Offset,
+                      PVOID Buffer,
+                      ULONG Length,
+                      PULONG Generation)
+{
+    PNTFS_RECORD_CACHE Cache = &Vcb->RecordCache;
+    PNTFS_RECORD_CACHE_ENTRY CacheEntry;
+    BOOLEAN Found = FALSE;
+
+    if (!NtfsRecordCacheKeyValid(Vcb, Type))
+    {
+        *Generation = 0;
+        return FALSE;
+    }
+
+    ExAcquireFastMutex(&Cache->Lock);
+
+    CacheEntry = NtfsRecordCacheFind(Cache, Type, Key, Offset);
+    if (CacheEntry != NULL && CacheEntry->Length == Length)
+    {
+        /* Keep the LRU list ordered, most recently used first */
+        RemoveEntryList(&CacheEntry->LruEntry);
+        InsertHeadList(&Cache->LruList, &CacheEntry->LruEntry);
+
+        RtlCopyMemory(Buffer, CacheEntry->Data, Length);
+        Cache->Hits++;
+        Found = TRUE;
+    }
+    else
+    {
+        Cache->Misses++;
+    }
+    *Generation = Cache->Generation;
+
+    ExReleaseFastMutex(&Cache->Lock);
+
+    return Found;
+}
+
+/**
+* @name NtfsRecordCacheInsert
+* @implemented
+*
+* Adds a copy of a fixed-up record to the cache, replacing any older copy
+* and evicting the least recently used records if the cache is full.
+* Failing to allocate isn't an error, the record just isn't cached.
+* Neither is a record read before the last invalidation, which may be
+* older than what a concurrent write put on the disk.
+*/
+VOID
+NtfsRecordCacheInsert(PNTFS_VCB Vcb,
+                      ULONG Type,
+                      ULONGLONG Key,
+                      ULONGLONG Offset,
+                      PVOID Buffer,
+                      ULONG Length,
+                      ULONG Generation)
+{
+    PNTFS_RECORD_CACHE Cache = &Vcb->RecordCache;
+    PNTFS_RECORD_CACHE_ENTRY CacheEntry, OldEntry;
+
+    if (Length > Cache->MaximumSize || !NtfsRecordCacheKeyValid(Vcb, Type))
+        return;
+
+    CacheEntry = ExAllocatePoolWithTag(NonPagedPool,
+                                       FIELD_OFFSET(NTFS_RECORD_CACHE_ENTRY, Data[Length]),
+                                       TAG_RECORD_CACHE);
+    if (CacheEntry == NULL)
+        return;
+
+    CacheEntry->Type = Type;
+    CacheEntry->Length = Length;
+    CacheEntry->Key = Key;
+    CacheEntry->Offset = Offset;
+    RtlCopyMemory(CacheEntry->Data, Buffer, Length);
+
+    ExAcquireFastMutex(&Cache->Lock);
+
+    if (Cache->Generation != Generation || Length > Cache->MaximumSize)
+    {
+        ExReleaseFastMutex(&Cache->Lock);
+        ExFreePoolWithTag(CacheEntry, TAG_RECORD_CACHE);
+        return;
+    }
+
+    OldEntry = NtfsRecordCacheFind(Cache, Type, Key, Offset);
+    if (OldEntry != NULL)
+    {
+        NtfsRecordCacheRemove(Cache, OldEntry);
+    }
+
+    while (Cache->Size + Length > Cache->MaximumSize)
+    {
+        NtfsRecordCacheRemove(Cache,
+                              CONTAINING_RECORD(Cache->LruList.Blink,
+                                                NTFS_RECORD_CACHE_ENTRY,
+                                                LruEntry));
+    }
+
+    InsertHeadList(&Cache->LruList, &CacheEntry->LruEntry);
+    InsertHeadList(&Cache->HashTable[NtfsRecordCacheHash(Type, Key, Offset)],
+                   &CacheEntry->HashEntry);
+    Cache->Size += Length;
+
+    ExReleaseFastMutex(&Cache->Lock);
+}
+
+/**
+* @name NtfsRecordCacheInvalidate
+* @implemented
+*
+* Drops the cached records of the given type and key that overlap the
+* byte range [Offset, Offset + Length). For file records, Key is ignored
+* and the range is in the $MFT data stream. Called once the range has
+* been written, records read before that are not cached anymore.
+*/
+VOID
+NtfsRecordCacheInvalidate(PNTFS_VCB Vcb,
+                          ULONG Type,
+                          ULONGLONG Key,
+                          ULONGLONG Offset,
+                          ULONG Length)
+{
+    PNTFS_RECORD_CACHE Cache = &Vcb->RecordCache;
+    PNTFS_RECORD_CACHE_ENTRY CacheEntry;
+    ULONGLONG First, Last, Unit, Index;
+
+    if (Length == 0)
+        return;
+
+    if (Type == NTFS_CACHE_FILE_RECORD)
+        Unit = Vcb->NtfsInfo.BytesPerFileRecord;
+    else
+        Unit = Vcb->NtfsInfo.BytesPerIndexRecord;
+
+    First = Offset / Unit;
+    Last = (Offset + Length - 1) / Unit;
+
+    ExAcquireFastMutex(&Cache->Lock);
+
+    Cache->Generation++;
+
+    for (Index = First; Index <= Last; Index++)
+    {
+        if (Type == NTFS_CACHE_FILE_RECORD)
+            CacheEntry = NtfsRecordCacheFind(Cache, Type, Index, 0);
+        else
+            CacheEntry = NtfsRecordCacheFind(Cache, Type, Key, Index * Unit);
+
+        if (CacheEntry != NULL)
+        {
+            NtfsRecordCacheRemove(Cache, CacheEntry);
+        }
+    }
+
+    ExReleaseFastMutex(&Cache->Lock);
+}
+
+/* EOF */
@@ -15,6 +15,7 @@
 #define TAG_IRP_CTXT 'iftN'
 #define TAG_ATT_CTXT 'aftN'
 #define TAG_FILE_REC 'rftN'
+#define TAG_RECORD_CACHE 'RftN'
 
 #define ROUND_UP(N, S) ((((N) + (S) - 1) / (S)) * (S))
 #define ROUND_DOWN(N, S) ((N) - ((N) % (S)))
@@ -96,6 +97,27 @@ typedef struct
     ULONG Size;
 } NTFSIDENTIFIER, *PNTFSIDENTIFIER;
 
+#define NTFS_CACHE_FILE_RECORD  1
+#define NTFS_CACHE_INDEX_BUFFER 2
+
+#define NTFS_RECORD_CACHE_BUCKETS 64
+#define NTFS_RECORD_CACHE_SIZE (2 * 1024 * 1024)
+
+/* Number of file records read at once when enumerating a directory */
+#define NTFS_MFT_READ_AHEAD 16
+
+typedef struct _NTFS_RECORD_CACHE
+{
+    FAST_MUTEX Lock;
+    LIST_ENTRY LruList;
+    LIST_ENTRY HashTable[NTFS_RECORD_CACHE_BUCKETS];
+    ULONG Size;
+    ULONG MaximumSize;
+    ULONG Generation;
+    ULONG Hits;
+    ULONG Misses;
+} NTFS_RECORD_CACHE, *PNTFS_RECORD_CACHE;
+
 typedef struct
 {
     NTFSIDENTIFIER Identifier;
@@ -117,6 +139,7 @@ typedef struct
     NTFS_INFO NtfsInfo;
 
     NPAGED_LOOKASIDE_LIST FileRecLookasideList;
+    NTFS_RECORD_CACHE RecordCache;
 
     ULONG MftDataOffset;
     ULONG Flags;
@@ -125,6 +148,7 @@ typedef struct
 } DEVICE_EXTENSION, *PDEVICE_EXTENSION, NTFS_VCB, *PNTFS_VCB;
 
 #define VCB_VOLUME_LOCKED       0x0001
+#define VCB_DISMOUNT_PENDING    0x0002
 
 typedef struct
 {
@@ -489,12 +513,11 @@ typedef struct
 
 typedef struct _NTFS_ATTR_CONTEXT
 {
-    PUCHAR            CacheRun;
-    ULONGLONG            CacheRunOffset;
+    /* Last run found in DataRunsMCB, CacheRunLength is 0 when there's none */
+    KSPIN_LOCK          CacheRunLock;
+    ULONGLONG           CacheRunVCN;
     LONGLONG            CacheRunStartLCN;
-    ULONGLONG            CacheRunLength;
-    LONGLONG            CacheRunLastLCN;
-    ULONGLONG            CacheRunCurrentOffset;
+    ULONGLONG           CacheRunLength;
     LARGE_MCB           DataRunsMCB;
     ULONGLONG           FileMFTIndex;
     ULONGLONG           FileOwnerMFTIndex; /* If attribute list attribute, reference the original file */
@@ -537,6 +560,12 @@ typedef struct _FCB
 
     FILENAME_ATTRIBUTE Entry;
 
+    /* Last decompressed compression unit of a compressed stream */
+    FAST_MUTEX CompressionUnitLock;
+    PUCHAR CompressionUnitBuffer;
+    ULONG CompressionUnitSize;
+    ULONGLONG CompressionUnit;
+
 } NTFS_FCB, *PNTFS_FCB;
 
 typedef struct _FIND_ATTR_CONTXT
@@ -1035,6 +1064,9 @@ PrepareAttributeContext(PNTFS_ATTR_RECORD AttrRecord);
 VOID
 ReleaseAttributeContext(PNTFS_ATTR_CONTEXT Context);
 
+VOID
+InvalidateAttributeRunCache(PNTFS_ATTR_CONTEXT Context);
+
 ULONG
 ReadAttribute(PDEVICE_EXTENSION Vcb,
               PNTFS_ATTR_CONTEXT Context,
@@ -1042,6 +1074,12 @@ ReadAttribute(PDEVICE_EXTENSION Vcb,
               PCHAR Buffer,
               ULONG Length);
 
+NTSTATUS
+ReadCompressionUnit(PDEVICE_EXTENSION Vcb,
+                    PNTFS_ATTR_CONTEXT Context,
+                    ULONGLONG Unit,
+                    PUCHAR Buffer);
+
 NTSTATUS
 WriteAttribute(PDEVICE_EXTENSION Vcb,
                PNTFS_ATTR_CONTEXT Context,
@@ -1111,6 +1149,11 @@ ReadFileRecord(PDEVICE_EXTENSION Vcb,
                ULONGLONG index,
                PFILE_RECORD_HEADER file);
 
+NTSTATUS
+ReadFileRecordReadAhead(PDEVICE_EXTENSION Vcb,
+                        ULONGLONG index,
+                        PFILE_RECORD_HEADER file);
+
 NTSTATUS
 UpdateIndexEntryFileNameSize(PDEVICE_EXTENSION Vcb,
                              PFILE_RECORD_HEADER MftRecord,
@@ -1213,6 +1256,41 @@ NtfsFindMftRecord(PDEVICE_EXTENSION Vcb,
                   BOOLEAN CaseSensitive,
                   ULONGLONG *OutMFTIndex);
 
+
+/* mftcache.c */
+
+VOID
+NtfsInitializeRecordCache(PNTFS_VCB Vcb);
+
+VOID
+NtfsUninitializeRecordCache(PNTFS_VCB Vcb);
+
+BOOLEAN
+NtfsRecordCacheLookup(PNTFS_VCB Vcb,
+                      ULONG Type,
+                      ULONGLONG Key,
+                      ULONGLONG Offset,
+                      PVOID Buffer,
+                      ULONG Length,
+                      PULONG Generation);
+
+VOID
+NtfsRecordCacheInsert(PNTFS_VCB Vcb,
+                      ULONG Type,
+                      ULONGLONG Key,
+                      ULONGLONG Offset,
+                      PVOID Buffer,
+                      ULONG Length,
+                      ULONG Generation);
+
+VOID
+NtfsRecordCacheInvalidate(PNTFS_VCB Vcb,
+                          ULONG Type,
+                          ULONGLONG Key,
+                          ULONGLONG Offset,
+                          ULONG Length);
+
+
 /* misc.c */
 
 BOOLEAN
@@ -35,6 +35,80 @@
 
 /* FUNCTIONS ****************************************************************/
 
+/*
+ * FUNCTION: Reads data from a compressed stream, a compression unit at a time
+ */
+static
+NTSTATUS
+NtfsReadCompressedData(PDEVICE_EXTENSION DeviceExt,
+                       PNTFS_FCB Fcb,
+                       PNTFS_ATTR_CONTEXT DataContext,
+                       PUCHAR Buffer,
+                       ULONG ReadOffset,
+                       ULONG Length)
+{
+    ULONG UnitSize = DeviceExt->NtfsInfo.BytesPerCluster << DataContext->pRecord->NonResident.CompressionUnit;
+    ULONG UnitOffset, CopyLength;
+    ULONGLONG Unit;
+    NTSTATUS Status = STATUS_SUCCESS;
+
+    ExAcquireFastMutex(&Fcb->CompressionUnitLock);
+
+    if (Fcb->CompressionUnitSize != UnitSize)
+    {
+        if (Fcb->CompressionUnitBuffer != NULL)
+            ExFreePoolWithTag(Fcb->CompressionUnitBuffer, TAG_NTFS);
+
+        Fcb->CompressionUnit = (ULONGLONG)-1;
+        Fcb->CompressionUnitSize = 0;
+        Fcb->CompressionUnitBuffer = ExAllocatePoolWithTag(NonPagedPool, UnitSize, TAG_NTFS);
+        if (Fcb->CompressionUnitBuffer == NULL)
+        {
+            ExReleaseFastMutex(&Fcb->CompressionUnitLock);
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+        Fcb->CompressionUnitSize = UnitSize;
+    }
+
+    while (Length > 0)
+    {
+        Unit = ReadOffset / UnitSize;
+        UnitOffset = ReadOffset % UnitSize;
+        CopyLength = min(UnitSize - UnitOffset, Length);
+
+        if (Unit == Fcb->CompressionUnit)
+        {
+            RtlCopyMemory(Buffer, Fcb->CompressionUnitBuffer + UnitOffset, CopyLength);
+        }
+        else if (CopyLength == UnitSize)
+        {
+            /* Whole units go straight to the caller, nobody will read them again soon */
+            Status = ReadCompressionUnit(DeviceExt, DataContext, Unit, Buffer);
+            if (!NT_SUCCESS(Status))
+                break;
+        }
+        else
+        {
+            /* Keep partially read units, the next read will likely want the rest */
+            Fcb->CompressionUnit = (ULONGLONG)-1;
+            Status = ReadCompressionUnit(DeviceExt, DataContext, Unit, Fcb->CompressionUnitBuffer);
+            if (!NT_SUCCESS(Status))
+                break;
+            Fcb->CompressionUnit = Unit;
+
+            RtlCopyMemory(Buffer, Fcb->CompressionUnitBuffer + UnitOffset, CopyLength);
+        }
+
+        Buffer += CopyLength;
+        ReadOffset += CopyLength;
+        Length -= CopyLength;
+    }
+
+    ExReleaseFastMutex(&Fcb->CompressionUnitLock);
+
+    return Status;
+}
+
 /*
  * FUNCTION: Reads data from a file
  */
@@ -72,13 +146,6 @@ NtfsReadFile(PDEVICE_EXTENSION DeviceExt,
 
     Fcb = (PNTFS_FCB)FileObject->FsContext;
 
-    if (NtfsFCBIsCompressed(Fcb))
-    {
-        DPRINT1("Compressed file!\n");
-        UNIMPLEMENTED;
-        return STATUS_NOT_IMPLEMENTED;
-    }
-
     FileRecord = ExAllocateFromNPagedLookasideList(&DeviceExt->FileRecLookasideList);
     if (FileRecord == NULL)
     {
@@ -139,6 +206,26 @@ NtfsReadFile(PDEVICE_EXTENSION DeviceExt,
     if (ReadOffset + Length > StreamSize)
         ToRead = StreamSize - ReadOffset;
 
+    if (DataContext->pRecord->IsNonResident && DataContext->pRecord->NonResident.CompressionUnit != 0)
+    {
+        DPRINT("Compressed read: %lu at %lu for stream '%S'\n", ToRead, ReadOffset, Fcb->Stream);
+        Status = NtfsReadCompressedData(DeviceExt, Fcb, DataContext, Buffer, ReadOffset, ToRead);
+        ReleaseAttributeContext(DataContext);
+        ExFreeToNPagedLookasideList(&DeviceExt->FileRecLookasideList, FileRecord);
+        if (!NT_SUCCESS(Status))
+        {
+            DPRINT1("Compressed read failure!\n");
+            return Status;
+        }
+
+        *LengthRead = ToRead;
+        if (ToRead != Length)
+        {
+            RtlZeroMemory(Buffer + ToRead, Length - ToRead);
+        }
+        return STATUS_SUCCESS;
+    }
+
     RealReadOffset = ReadOffset;
     RealLength = ToRead;
 
@@ -83,6 +83,12 @@ typedef struct _RAMDISK_EXTENSION
     LIST_ENTRY DiskList;
 } RAMDISK_EXTENSION, *PRAMDISK_EXTENSION;
 
+typedef struct _RAMDISK_VIEW
+{
+    PVOID BaseAddress;
+    PMDL Mdl;
+} RAMDISK_VIEW, *PRAMDISK_VIEW;
+
 typedef struct _RAMDISK_BUS_EXTENSION
 {
     RAMDISK_EXTENSION;
@@ -104,6 +110,15 @@ typedef struct _RAMDISK_DRIVE_EXTENSION
     WCHAR DriveLetter;
     ULONG BasePage;
 
+    /* Views of the backing pages, mapped on first use and then kept */
+    PRAMDISK_VIEW Views;
+    ULONG ViewCount;
+    ULONG ViewLength;
+    LONG MappedViewCount;
+
+    /* Held shared for I/O, exclusive to free trimmed views */
+    ERESOURCE DiscardLock;
+
     /* Data we get from the disk */
     ULONG BytesPerSector;
     ULONG SectorsPerTrack;
@@ -128,6 +143,20 @@ PDEVICE_OBJECT RamdiskBusFdo;
 
 /* FUNCTIONS ******************************************************************/
 
+PVOID
+NTAPI
+RamdiskMapPages(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
+                IN LARGE_INTEGER Offset,
+                IN ULONG Length,
+                OUT PULONG OutputLength);
+
+VOID
+NTAPI
+RamdiskUnmapPages(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
+                  IN PVOID BaseAddress,
+                  IN LARGE_INTEGER Offset,
+                  IN ULONG Length);
+
 VOID
 NTAPI
 QueryParameters(IN PUNICODE_STRING RegistryPath)
@@ -264,6 +293,168 @@ QueryParameters(IN PUNICODE_STRING RegistryPath)
     }
 }
 
+static
+ULONG
+RamdiskGetViewLength(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
+                     IN ULONG ViewIndex)
+{
+    ULONGLONG ViewOffset;
+
+    /* The last view of a boot disk only spans the rest of the image */
+    ViewOffset = (ULONGLONG)ViewIndex * DeviceExtension->ViewLength;
+    if ((DeviceExtension->DiskType == RAMDISK_BOOT_DISK) &&
+        (DeviceExtension->DiskLength.QuadPart - ViewOffset < DeviceExtension->ViewLength))
+    {
+        return (ULONG)(DeviceExtension->DiskLength.QuadPart - ViewOffset);
+    }
+
+    return DeviceExtension->ViewLength;
+}
+
+BOOLEAN
+NTAPI
+RamdiskInitializeViews(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension)
+{
+    ULONGLONG ViewCount;
+    SIZE_T Size;
+
+    /* Split the disk into views of the default view length */
+    DeviceExtension->ViewLength = ROUND_TO_PAGES(DefaultViewLength);
+    ViewCount = (DeviceExtension->DiskLength.QuadPart + DeviceExtension->ViewLength - 1) /
+                DeviceExtension->ViewLength;
+    if (!ViewCount || (ViewCount > MAXULONG / sizeof(RAMDISK_VIEW))) return FALSE;
+
+    /* Allocate the view table, nothing is mapped yet */
+    Size = (SIZE_T)ViewCount * sizeof(RAMDISK_VIEW);
+    DeviceExtension->Views = ExAllocatePoolWithTag(NonPagedPool, Size, 'dmaR');
+    if (!DeviceExtension->Views) return FALSE;
+    RtlZeroMemory(DeviceExtension->Views, Size);
+
+    DeviceExtension->ViewCount = (ULONG)ViewCount;
+    DeviceExtension->MappedViewCount = 0;
+    return TRUE;
+}
+
+PVOID
+NTAPI
+RamdiskGetView(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
+               IN ULONG ViewIndex,
+               IN BOOLEAN Allocate)
+{
+    PRAMDISK_VIEW View;
+    PVOID BaseAddress, CurrentAddress;
+    PHYSICAL_ADDRESS LowAddress, HighAddress, SkipBytes;
+    LARGE_INTEGER ViewOffset;
+    ULONG ViewLength, MappedLength;
+    PMDL Mdl = NULL;
+
+    ASSERT(ViewIndex < DeviceExtension->ViewCount);
+    View = &DeviceExtension->Views[ViewIndex];
+
+    /* Most of the time the view is already there */
+    BaseAddress = *(volatile PVOID *)&View->BaseAddress;
+    if (BaseAddress) return BaseAddress;
+
+    ViewOffset.QuadPart = (ULONGLONG)ViewIndex * DeviceExtension->ViewLength;
+    ViewLength = RamdiskGetViewLength(DeviceExtension, ViewIndex);
+    MappedLength = 0;
+    if (DeviceExtension->DiskType == RAMDISK_BOOT_DISK)
+    {
+        /* Don't map more of the image than we may keep mapped */
+        if ((ULONGLONG)InterlockedIncrement(&DeviceExtension->MappedViewCount) *
+            DeviceExtension->ViewLength > MaximumPerDiskViewLength)
+        {
+            InterlockedDecrement(&DeviceExtension->MappedViewCount);
+            return NULL;
+        }
+
+        BaseAddress = RamdiskMapPages(DeviceExtension,
+                                      ViewOffset,
+                                      ViewLength,
+                                      &MappedLength);
+        if (!BaseAddress)
+        {
+            InterlockedDecrement(&DeviceExtension->MappedViewCount);
+            return NULL;
+        }
+    }
+    else
+    {
+        /* Pages of a virtual disk only come to life when written to */
+        if (!Allocate) return NULL;
+
+        LowAddress.QuadPart = 0;
+        HighAddress.QuadPart = -1;
+        SkipBytes.QuadPart = 0;
+        Mdl = MmAllocatePagesForMdlEx(LowAddress,
+                                      HighAddress,
+                                      SkipBytes,
+                                      ViewLength,
+                                      MmCached,
+                                      0);
+        if (!Mdl) return NULL;
+
+        /* We need all of them, and a mapping we can keep */
+        BaseAddress = NULL;
+        if (MmGetMdlByteCount(Mdl) == ViewLength)
+        {
+            BaseAddress = MmMapLockedPagesSpecifyCache(Mdl,
+                                                       KernelMode,
+                                                       MmCached,
+                                                       NULL,
+                                                       FALSE,
+                                                       NormalPagePriority);
+        }
+        if (!BaseAddress)
+        {
+            MmFreePagesFromMdl(Mdl);
+            ExFreePool(Mdl);
+            return NULL;
+        }
+    }
+
+    /* Publish the view, unless another request was faster */
+    CurrentAddress = InterlockedCompareExchangePointer(&View->BaseAddress,
+                                                       BaseAddress,
+                                                       NULL);
+    if (CurrentAddress)
+    {
+        if (Mdl)
+        {
+            MmUnmapLockedPages(BaseAddress, Mdl);
+            MmFreePagesFromMdl(Mdl);
+            ExFreePool(Mdl);
+        }
+        else
+        {
+            RamdiskUnmapPages(DeviceExtension, BaseAddress, ViewOffset, MappedLength);
+            InterlockedDecrement(&DeviceExtension->MappedViewCount);
+        }
+        return CurrentAddress;
+    }
+
+    View->Mdl = Mdl;
+    return BaseAddress;
+}
+
+static
+VOID
+RamdiskFreeView(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
+                IN ULONG ViewIndex)
+{
+    PRAMDISK_VIEW View = &DeviceExtension->Views[ViewIndex];
+
+    /* Only virtual disks own their pages, and the caller holds the discard lock */
+    ASSERT(DeviceExtension->DiskType == RAMDISK_VIRTUAL_DISK);
+    if (!View->BaseAddress) return;
+
+    MmUnmapLockedPages(View->BaseAddress, View->Mdl);
+    MmFreePagesFromMdl(View->Mdl);
+    ExFreePool(View->Mdl);
+    View->BaseAddress = NULL;
+    View->Mdl = NULL;
+}
+
 PVOID
 NTAPI
 RamdiskMapPages(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
@@ -278,7 +469,28 @@ RamdiskMapPages(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
     LARGE_INTEGER ActualOffset;
     LARGE_INTEGER ActualPages;
 
-    /* We only support boot disks for now */
+    /* Virtual disks are always mapped, use the view holding the offset */
+    if (DeviceExtension->DiskType == RAMDISK_VIRTUAL_DISK)
+    {
+        KeEnterCriticalRegion();
+        ExAcquireResourceSharedLite(&DeviceExtension->DiscardLock, TRUE);
+
+        PageOffset = (ULONG)(Offset.QuadPart % DeviceExtension->ViewLength);
+        MappedBase = RamdiskGetView(DeviceExtension,
+                                    (ULONG)(Offset.QuadPart / DeviceExtension->ViewLength),
+                                    TRUE);
+        if (!MappedBase)
+        {
+            ExReleaseResourceLite(&DeviceExtension->DiscardLock);
+            KeLeaveCriticalRegion();
+            return NULL;
+        }
+
+        *OutputLength = min(Length, DeviceExtension->ViewLength - PageOffset);
+        return (PVOID)((ULONG_PTR)MappedBase + PageOffset);
+    }
+
+    /* Otherwise we only support boot disks for now */
     ASSERT(DeviceExtension->DiskType == RAMDISK_BOOT_DISK);
 
     /* Calculate the actual offset in the drive */
@@ -322,7 +534,15 @@ RamdiskUnmapPages(IN PRAMDISK_DRIVE_EXTENSION DeviceExtension,
     SIZE_T ActualLength;
     ULONG PageOffset;
 
-    /* We only support boot disks for now */
+    /* Virtual disk views stay mapped, just let TRIM in again */
+    if (DeviceExtension->DiskType == RAMDISK_VIRTUAL_DISK)
+    {
+        ExReleaseResourceLite(&DeviceExtension->DiscardLock);
+        KeLeaveCriticalRegion();
+        return;
+    }
+
+    /* Otherwise we only support boot disks for now */
     ASSERT(DeviceExtension->DiskType == RAMDISK_BOOT_DISK);
 
     /* Calculate the actual offset in the drive */
@@ -385,6 +605,16 @@ RamdiskCreateDiskDevice(IN PRAMDISK_BUS_EXTENSION DeviceExtension,
             Input->Options.NoDosDevice = FALSE;
             Input->Options.NoDriveLetter = IsWinPEBoot ? TRUE : FALSE;
         }
+        else if (DiskType == RAMDISK_VIRTUAL_DISK)
+        {
+            /* We allocate the pages ourselves, so we need to know how many */
+            if (Input->DiskLength.QuadPart <= 0) return STATUS_INVALID_PARAMETER;
+
+            /* Sanitize disk options */
+            Input->Options.Fixed = TRUE;
+            Input->Options.Readonly = FALSE;
+            Input->Options.ExportAsCd = FALSE;
+        }
         else
         {
             /* The only other possibility is a WIM disk */
@@ -535,6 +765,16 @@ RamdiskCreateDiskDevice(IN PRAMDISK_BUS_EXTENSION DeviceExtension,
         SymbolicLinkName.Buffer = NULL;
         GuidString.Buffer = NULL;
 
+        /* Set up the views of the backing pages */
+        ExInitializeResourceLite(&DriveExtension->DiscardLock);
+        if (!RamdiskInitializeViews(DriveExtension) &&
+            (Input->DiskType == RAMDISK_VIRTUAL_DISK))
+        {
+            /* A virtual disk has no other storage */
+            Status = STATUS_INSUFFICIENT_RESOURCES;
+            goto FailCreate;
+        }
+
         /* Check if this is a boot disk, or a registry ram drive */
         if (!(Input->Options.ExportAsCd) &&
             (Input->DiskType == RAMDISK_BOOT_DISK))
@@ -940,11 +1180,11 @@ RamdiskReadWriteReal(IN PIRP Irp,
                      IN PRAMDISK_DRIVE_EXTENSION DeviceExtension)
 {
     PMDL Mdl;
-    PVOID CurrentBase, SystemVa, BaseAddress;
+    PVOID CurrentBase, SystemVa, BaseAddress, ViewBase;
     PIO_STACK_LOCATION IoStackLocation;
     LARGE_INTEGER CurrentOffset;
-    ULONG BytesRead, BytesLeft, CopyLength;
-    PVOID Source, Destination;
+    ULONG BytesRead, BytesLeft, CopyLength, ViewIndex, ViewOffset;
+    BOOLEAN IsWrite, IsVirtual;
     NTSTATUS Status;
 
     /* Get the MDL and check if it's mapped */
@@ -978,56 +1218,179 @@ RamdiskReadWriteReal(IN PIRP Irp,
     BytesLeft = IoStackLocation->Parameters.Read.Length;
     if (!BytesLeft) return STATUS_INVALID_PARAMETER;
 
-    /* Do the copy loop */
-    while (TRUE)
+    /* Check if this was a read or write */
+    if (IoStackLocation->MajorFunction == IRP_MJ_WRITE)
+        IsWrite = TRUE;
+    else if (IoStackLocation->MajorFunction == IRP_MJ_READ)
+        IsWrite = FALSE;
+    else
+        return STATUS_INVALID_PARAMETER;
+
+    /* Requests run concurrently, only TRIM of a virtual disk waits for them */
+    IsVirtual = (DeviceExtension->DiskType == RAMDISK_VIRTUAL_DISK);
+    if (IsVirtual)
     {
-        /* Map the pages */
-        BaseAddress = RamdiskMapPages(DeviceExtension,
-                                      CurrentOffset,
-                                      BytesLeft,
-                                      &BytesRead);
-        if (!BaseAddress) return STATUS_INSUFFICIENT_RESOURCES;
+        KeEnterCriticalRegion();
+        ExAcquireResourceSharedLite(&DeviceExtension->DiscardLock, TRUE);
+    }
 
-        /* Update our lengths */
-        Irp->IoStatus.Information += BytesRead;
-        CopyLength = BytesRead;
+    /* Do the copy loop */
+    Status = STATUS_SUCCESS;
+    while (BytesLeft)
+    {
+        /* Find the view holding the current offset */
+        ViewBase = NULL;
+        ViewOffset = 0;
+        CopyLength = BytesLeft;
+        if (DeviceExtension->Views)
+        {
+            ViewIndex = (ULONG)(CurrentOffset.QuadPart / DeviceExtension->ViewLength);
+            ViewOffset = (ULONG)(CurrentOffset.QuadPart % DeviceExtension->ViewLength);
+            CopyLength = min(BytesLeft, DeviceExtension->ViewLength - ViewOffset);
+            ViewBase = RamdiskGetView(DeviceExtension, ViewIndex, IsWrite);
+        }
 
-        /* Check if this was a read or write */
-        Status = STATUS_SUCCESS;
-        if (IoStackLocation->MajorFunction == IRP_MJ_READ)
+        if (ViewBase)
         {
-            /* Set our copy parameters */
-            Destination = CurrentBase;
-            Source = BaseAddress;
-            goto DoCopy;
+            /* Copy straight from or to the view */
+            BaseAddress = (PVOID)((ULONG_PTR)ViewBase + ViewOffset);
+            if (IsWrite)
+                RtlCopyMemory(BaseAddress, CurrentBase, CopyLength);
+            else
+                RtlCopyMemory(CurrentBase, BaseAddress, CopyLength);
         }
-        else if (IoStackLocation->MajorFunction == IRP_MJ_WRITE)
+        else if (IsVirtual)
         {
-            /* Set our copy parameters */
-            Destination = BaseAddress;
-            Source = CurrentBase;
-DoCopy:
-            /* Copy the data */
-            RtlCopyMemory(Destination, Source, CopyLength);
+            /* Never written or trimmed pages read as zeroes */
+            if (IsWrite)
+            {
+                Status = STATUS_INSUFFICIENT_RESOURCES;
+                break;
+            }
+            RtlZeroMemory(CurrentBase, CopyLength);
         }
         else
         {
-            /* Prepare us for failure */
-            BytesLeft = CopyLength;
-            Status = STATUS_INVALID_PARAMETER;
-        }
+            /* No view available, map the pages for this piece only */
+            BaseAddress = RamdiskMapPages(DeviceExtension,
+                                          CurrentOffset,
+                                          CopyLength,
+                                          &BytesRead);
+            if (!BaseAddress)
+            {
+                Status = STATUS_INSUFFICIENT_RESOURCES;
+                break;
+            }
 
-        /* Unmap the pages */
-        RamdiskUnmapPages(DeviceExtension, BaseAddress, CurrentOffset, BytesRead);
+            CopyLength = BytesRead;
+            if (IsWrite)
+                RtlCopyMemory(BaseAddress, CurrentBase, CopyLength);
+            else
+                RtlCopyMemory(CurrentBase, BaseAddress, CopyLength);
+
+            /* Unmap the pages */
+            RamdiskUnmapPages(DeviceExtension, BaseAddress, CurrentOffset, BytesRead);
+        }
 
         /* Update offset and bytes left */
-        BytesLeft -= BytesRead;
-        CurrentOffset.QuadPart += BytesRead;
-        CurrentBase = (PVOID)((ULONG_PTR)CurrentBase + BytesRead);
+        Irp->IoStatus.Information += CopyLength;
+        BytesLeft -= CopyLength;
+        CurrentOffset.QuadPart += CopyLength;
+        CurrentBase = (PVOID)((ULONG_PTR)CurrentBase + CopyLength);
+    }
 
-        /* Check if we are done */
-        if (!BytesLeft) return Status;
+    if (IsVirtual)
+    {
+        ExReleaseResourceLite(&DeviceExtension->DiscardLock);
+        KeLeaveCriticalRegion();
     }
+
+    return Status;
+}
+
+NTSTATUS
+NTAPI
+RamdiskTrim(IN PIRP Irp,
+            IN PRAMDISK_DRIVE_EXTENSION DeviceExtension)
+{
+    PIO_STACK_LOCATION IoStackLocation;
+    PDEVICE_MANAGE_DATA_SET_ATTRIBUTES Attributes;
+    PDEVICE_DATA_SET_RANGE Ranges;
+    DEVICE_DATA_SET_RANGE EntireDisk;
+    ULONG InputLength, RangeCount, i, ViewIndex, ViewOffset, Length;
+    ULONGLONG Offset, End, ViewEnd;
+    PVOID ViewBase;
+
+    /* Validate the input */
+    IoStackLocation = IoGetCurrentIrpStackLocation(Irp);
+    InputLength = IoStackLocation->Parameters.DeviceIoControl.InputBufferLength;
+    Attributes = Irp->AssociatedIrp.SystemBuffer;
+    if ((InputLength < sizeof(DEVICE_MANAGE_DATA_SET_ATTRIBUTES)) ||
+        (Attributes->DataSetRangesOffset > InputLength) ||
+        (Attributes->DataSetRangesLength > InputLength - Attributes->DataSetRangesOffset))
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    /* Other actions are only hints, nothing to do for them */
+    if (Attributes->Action != DeviceDsmAction_Trim) return STATUS_SUCCESS;
+
+    /* Only pages we allocated can be released */
+    if (DeviceExtension->DiskOptions.Readonly) return STATUS_MEDIA_WRITE_PROTECTED;
+    if (DeviceExtension->DiskType != RAMDISK_VIRTUAL_DISK) return STATUS_SUCCESS;
+
+    if (Attributes->Flags & DEVICE_DSM_FLAG_ENTIRE_DATA_SET_RANGE)
+    {
+        EntireDisk.StartingOffset = 0;
+        EntireDisk.LengthInBytes = DeviceExtension->DiskLength.QuadPart;
+        Ranges = &EntireDisk;
+        RangeCount = 1;
+    }
+    else
+    {
+        Ranges = (PDEVICE_DATA_SET_RANGE)((ULONG_PTR)Attributes + Attributes->DataSetRangesOffset);
+        RangeCount = Attributes->DataSetRangesLength / sizeof(DEVICE_DATA_SET_RANGE);
+    }
+
+    /* This waits for the requests in flight, so it's safe on a mounted volume */
+    KeEnterCriticalRegion();
+    ExAcquireResourceExclusiveLite(&DeviceExtension->DiscardLock, TRUE);
+
+    for (i = 0; i < RangeCount; i++)
+    {
+        /* Clip the range to the disk */
+        if (Ranges[i].StartingOffset < 0) continue;
+        Offset = Ranges[i].StartingOffset;
+        if (Offset >= (ULONGLONG)DeviceExtension->DiskLength.QuadPart) continue;
+        End = Offset + min(Ranges[i].LengthInBytes,
+                           DeviceExtension->DiskLength.QuadPart - Offset);
+
+        while (Offset < End)
+        {
+            ViewIndex = (ULONG)(Offset / DeviceExtension->ViewLength);
+            ViewOffset = (ULONG)(Offset % DeviceExtension->ViewLength);
+            ViewEnd = Offset - ViewOffset + DeviceExtension->ViewLength;
+            Length = (ULONG)(min(End, ViewEnd) - Offset);
+
+            if ((ViewOffset == 0) && (Length == DeviceExtension->ViewLength))
+            {
+                /* The whole view goes, give its pages back */
+                RamdiskFreeView(DeviceExtension, ViewIndex);
+            }
+            else
+            {
+                /* Keep the view, but trimmed data must read as zeroes */
+                ViewBase = RamdiskGetView(DeviceExtension, ViewIndex, FALSE);
+                if (ViewBase) RtlZeroMemory((PUCHAR)ViewBase + ViewOffset, Length);
+            }
+
+            Offset += Length;
+        }
+    }
+
+    ExReleaseResourceLite(&DeviceExtension->DiscardLock);
+    KeLeaveCriticalRegion();
+    return STATUS_SUCCESS;
 }
 
 NTSTATUS
@@ -1048,8 +1411,8 @@ RamdiskReadWrite(IN PDEVICE_OBJECT DeviceObject,
                  IN PIRP Irp)
 {
     PRAMDISK_DRIVE_EXTENSION DeviceExtension;
-    // ULONG Length;
-    // LARGE_INTEGER ByteOffset;
+    ULONG Length;
+    LARGE_INTEGER ByteOffset;
     PIO_STACK_LOCATION IoStackLocation;
     NTSTATUS Status, ReturnStatus;
 
@@ -1064,10 +1427,17 @@ RamdiskReadWrite(IN PDEVICE_OBJECT DeviceObject,
 
     /* Capture parameters */
     IoStackLocation = IoGetCurrentIrpStackLocation(Irp);
-    // Length = IoStackLocation->Parameters.Read.Length;
-    // ByteOffset = IoStackLocation->Parameters.Read.ByteOffset;
+    Length = IoStackLocation->Parameters.Read.Length;
+    ByteOffset = IoStackLocation->Parameters.Read.ByteOffset;
 
-    /* FIXME: Validate offset */
+    /* Validate offset */
+    if ((ByteOffset.QuadPart < 0) ||
+        (Length > DeviceExtension->DiskLength.QuadPart) ||
+        (ByteOffset.QuadPart > DeviceExtension->DiskLength.QuadPart - Length))
+    {
+        Status = STATUS_INVALID_PARAMETER;
+        goto Complete;
+    }
 
     /* FIXME: Validate sector */
 
@@ -1315,6 +1685,12 @@ RamdiskDeviceControl(IN PDEVICE_OBJECT DeviceObject,
                 break;
             }
 
+            case IOCTL_STORAGE_MANAGE_DATA_SET_ATTRIBUTES:
+            {
+                Status = RamdiskTrim(Irp, DriveExtension);
+                break;
+            }
+
             case IOCTL_DISK_GET_DRIVE_LAYOUT:
             case IOCTL_DISK_IS_WRITABLE:
             case IOCTL_SCSI_MINIPORT:
@@ -139,6 +139,14 @@ PortFdoStartMiniport(
         return Status;
     }
 
+    /* The SRB extension size is final now, set up the request queue */
+    Status = PortInitializeRequestQueue(DeviceExtension);
+    if (!NT_SUCCESS(Status))
+    {
+        DPRINT1("PortInitializeRequestQueue() failed (Status 0x%08lx)\n", Status);
+        return Status;
+    }
+
     /* Connect the configured interrupt */
     Status = PortFdoConnectInterrupt(DeviceExtension);
     if (!NT_SUCCESS(Status))
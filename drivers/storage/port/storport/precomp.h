@@ -31,6 +31,17 @@
 #define TAG_ADDRESS_MAPPING 'MAtS'
 #define TAG_INQUIRY_DATA    'QItS'
 #define TAG_SENSE_DATA      'NStS'
+#define TAG_SG_LIST         'GStS'
+#define TAG_REQUEST         'QRtS'
+
+/* Default number of outstanding requests per LUN, the miniport can change it */
+#define STORPORT_DEFAULT_QUEUE_DEPTH 20
+
+/* Queue tags are a UCHAR and SP_UNTAGGED is reserved */
+#define STORPORT_MAX_QUEUE_TAGS 255
+
+/* Scatter/gather elements kept in each request, bigger lists come from pool */
+#define STORPORT_INLINE_SG_ELEMENTS 17
 
 typedef enum
 {
@@ -87,6 +98,20 @@ typedef struct _UNIT_DATA
     INQUIRYDATA InquiryData;
 } UNIT_DATA, *PUNIT_DATA;
 
+typedef struct _PORT_REQUEST
+{
+    SLIST_ENTRY CompletionEntry;
+    LIST_ENTRY ListEntry;
+    PIRP Irp;
+    PSCSI_REQUEST_BLOCK Srb;
+    struct _PDO_DEVICE_EXTENSION *PdoExtension;
+    PVOID OriginalDataBuffer;
+    PSTOR_SCATTER_GATHER_LIST SgList;
+    BOOLEAN SgListAllocated;
+    BOOLEAN Started;
+    UCHAR QueueTag;
+} PORT_REQUEST, *PPORT_REQUEST;
+
 typedef struct _FDO_DEVICE_EXTENSION
 {
     EXTENSION_TYPE ExtensionType;
@@ -115,6 +140,16 @@ typedef struct _FDO_DEVICE_EXTENSION
     KSPIN_LOCK PdoListLock;
     LIST_ENTRY PdoListHead;
     ULONG PdoCount;
+
+    /* Request queueing and completion, see queue.c */
+    KSPIN_LOCK StartIoLock;
+    SLIST_HEADER CompletionList;
+    SLIST_HEADER RestartList;
+    KDPC CompletionDpc;
+    NPAGED_LOOKASIDE_LIST RequestLookaside;
+    BOOLEAN RequestLookasideInitialized;
+    ULONG SgListOffset;
+    ULONG SrbExtensionOffset;
 } FDO_DEVICE_EXTENSION, *PFDO_DEVICE_EXTENSION;
 
 
@@ -132,7 +167,16 @@ typedef struct _PDO_DEVICE_EXTENSION
     ULONG Lun;
     PINQUIRYDATA InquiryBuffer;
 
+    /* Queued for the completion DPC after a queue depth change */
+    SLIST_ENTRY RestartEntry;
+    LONG RestartQueued;
 
+    /* Request queue, protected by the adapter's StartIoLock */
+    LIST_ENTRY PendingListHead;
+    ULONG QueueDepth;
+    ULONG ActiveCount;
+    RTL_BITMAP QueueTagBitmap;
+    ULONG QueueTagBuffer[256 / 32];
 } PDO_DEVICE_EXTENSION, *PPDO_DEVICE_EXTENSION;
 
 
@@ -261,6 +305,47 @@ PortPdoPnp(
     _In_ PIRP Irp);
 
 
+/* queue.c */
+
+NTSTATUS
+PortInitializeRequestQueue(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension);
+
+VOID
+PortInitializeLunQueue(
+    _In_ PPDO_DEVICE_EXTENSION PdoExtension);
+
+NTSTATUS
+PortQueueRequest(
+    _In_ PPDO_DEVICE_EXTENSION PdoExtension,
+    _In_ PIRP Irp,
+    _In_ PSCSI_REQUEST_BLOCK Srb);
+
+VOID
+PortRequestComplete(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PSCSI_REQUEST_BLOCK Srb);
+
+VOID
+NTAPI
+PortCompletionDpc(
+    _In_ PKDPC Dpc,
+    _In_opt_ PVOID DeferredContext,
+    _In_opt_ PVOID SystemArgument1,
+    _In_opt_ PVOID SystemArgument2);
+
+PSTOR_SCATTER_GATHER_LIST
+PortGetScatterGatherList(
+    _In_ PSCSI_REQUEST_BLOCK Srb);
+
+BOOLEAN
+PortSetDeviceQueueDepth(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ UCHAR PathId,
+    _In_ UCHAR TargetId,
+    _In_ UCHAR Lun,
+    _In_ ULONG Depth);
+
 /* storport.c */
 
 PHW_INITIALIZATION_DATA
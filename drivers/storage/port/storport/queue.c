@@ -0,0 +1,599 @@
+/*
+ * PROJECT:     ReactOS Storport Driver
+ * LICENSE:     GPL-2.0+ (https://spdx.org/licenses/GPL-2.0+)
+ * PURPOSE:     Storport request queueing and completion
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+/*
+ * Every LUN has its own queue of pending requests. Up to QueueDepth of
+ * them are handed to the miniport at a time, each with its own queue
+ * tag, so miniports like storahci can keep several commands (NCQ) in
+ * flight. The queues and HwStartIo calls are serialized by the adapter's
+ * StartIoLock.
+ *
+ * StorPortNotification(RequestComplete) may be called at any IRQL, so
+ * completed requests are pushed on a lock-free list and finished by a
+ * DPC. Completions that arrive while the DPC is queued are handled in
+ * the same run, which also starts the next requests of the LUNs.
+ */
+
+/* INCLUDES *******************************************************************/
+
+#include "precomp.h"
+
+#define NDEBUG
+#include <debug.h>
+
+
+/* FUNCTIONS ******************************************************************/
+
+static
+PPORT_REQUEST
+PortGetRequest(
+    _In_ PSCSI_REQUEST_BLOCK Srb)
+{
+    PIRP Irp = (PIRP)Srb->OriginalRequest;
+
+    if (Irp == NULL)
+        return NULL;
+
+    return (PPORT_REQUEST)Irp->Tail.Overlay.DriverContext[0];
+}
+
+
+NTSTATUS
+PortInitializeRequestQueue(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension)
+{
+    ULONG RequestSize;
+
+    DPRINT1("PortInitializeRequestQueue(%p)\n", FdoExtension);
+
+    if (FdoExtension->RequestLookasideInitialized)
+        return STATUS_SUCCESS;
+
+    /* A request is followed by its inline scatter/gather list and the
+       miniport's SRB extension */
+    FdoExtension->SgListOffset = ALIGN_UP_BY(sizeof(PORT_REQUEST), 16);
+    FdoExtension->SrbExtensionOffset =
+        ALIGN_UP_BY(FdoExtension->SgListOffset +
+                    FIELD_OFFSET(STOR_SCATTER_GATHER_LIST, List) +
+                    STORPORT_INLINE_SG_ELEMENTS * sizeof(STOR_SCATTER_GATHER_ELEMENT),
+                    16);
+    RequestSize = FdoExtension->SrbExtensionOffset +
+                  FdoExtension->Miniport.PortConfig.SrbExtensionSize;
+
+    DPRINT1("SrbExtensionSize: %lu  RequestSize: %lu\n",
+            FdoExtension->Miniport.PortConfig.SrbExtensionSize, RequestSize);
+
+    ExInitializeNPagedLookasideList(&FdoExtension->RequestLookaside,
+                                    NULL,
+                                    NULL,
+                                    0,
+                                    RequestSize,
+                                    TAG_REQUEST,
+                                    0);
+    FdoExtension->RequestLookasideInitialized = TRUE;
+
+    return STATUS_SUCCESS;
+}
+
+
+VOID
+PortInitializeLunQueue(
+    _In_ PPDO_DEVICE_EXTENSION PdoExtension)
+{
+    InitializeListHead(&PdoExtension->PendingListHead);
+    PdoExtension->QueueDepth = STORPORT_DEFAULT_QUEUE_DEPTH;
+    PdoExtension->ActiveCount = 0;
+
+    /* Never hand out SP_UNTAGGED */
+    RtlInitializeBitMap(&PdoExtension->QueueTagBitmap,
+                        PdoExtension->QueueTagBuffer,
+                        256);
+    RtlClearAllBits(&PdoExtension->QueueTagBitmap);
+    RtlSetBits(&PdoExtension->QueueTagBitmap,
+               STORPORT_MAX_QUEUE_TAGS,
+               256 - STORPORT_MAX_QUEUE_TAGS);
+}
+
+
+static
+VOID
+PortAddSgElement(
+    _Inout_ PSTOR_SCATTER_GATHER_LIST SgList,
+    _In_ ULONGLONG Address,
+    _In_ ULONG Length)
+{
+    PSTOR_SCATTER_GATHER_ELEMENT Element;
+
+    /* Merge physically contiguous pages */
+    if (SgList->NumberOfElements != 0)
+    {
+        Element = &SgList->List[SgList->NumberOfElements - 1];
+        if ((ULONGLONG)Element->PhysicalAddress.QuadPart + Element->Length == Address)
+        {
+            Element->Length += Length;
+            return;
+        }
+    }
+
+    Element = &SgList->List[SgList->NumberOfElements++];
+    Element->PhysicalAddress.QuadPart = Address;
+    Element->Length = Length;
+    Element->Reserved = 0;
+}
+
+
+static
+NTSTATUS
+PortPrepareDataBuffer(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PPORT_REQUEST Request)
+{
+    PSCSI_REQUEST_BLOCK Srb = Request->Srb;
+    PMDL Mdl = Request->Irp->MdlAddress;
+    PSTOR_SCATTER_GATHER_LIST SgList;
+    PPFN_NUMBER Pfns;
+    PUCHAR Buffer, SystemBuffer;
+    ULONG_PTR Offset = 0;
+    ULONG Length, Chunk, MaxElements, PageOffset;
+    BOOLEAN InMdl = FALSE;
+
+    SgList = (PSTOR_SCATTER_GATHER_LIST)((PUCHAR)Request + FdoExtension->SgListOffset);
+    SgList->NumberOfElements = 0;
+    SgList->Reserved = 0;
+    Request->SgList = SgList;
+
+    Buffer = Srb->DataBuffer;
+    Length = Srb->DataTransferLength;
+    if (Buffer == NULL || Length == 0)
+        return STATUS_SUCCESS;
+
+    MaxElements = ADDRESS_AND_SIZE_TO_SPAN_PAGES(Buffer, Length);
+    if (MaxElements > STORPORT_INLINE_SG_ELEMENTS)
+    {
+        SgList = ExAllocatePoolWithTag(NonPagedPool,
+                                       FIELD_OFFSET(STOR_SCATTER_GATHER_LIST, List) +
+                                       MaxElements * sizeof(STOR_SCATTER_GATHER_ELEMENT),
+                                       TAG_SG_LIST);
+        if (SgList == NULL)
+            return STATUS_INSUFFICIENT_RESOURCES;
+
+        SgList->NumberOfElements = 0;
+        SgList->Reserved = 0;
+        Request->SgList = SgList;
+        Request->SgListAllocated = TRUE;
+    }
+
+    if (Mdl != NULL &&
+        Buffer >= (PUCHAR)MmGetMdlVirtualAddress(Mdl) &&
+        Buffer + Length <= (PUCHAR)MmGetMdlVirtualAddress(Mdl) + MmGetMdlByteCount(Mdl))
+    {
+        InMdl = TRUE;
+        Offset = Buffer - (PUCHAR)MmGetMdlVirtualAddress(Mdl);
+    }
+
+    if (InMdl)
+    {
+        /* The buffer is described by the (locked) MDL of the IRP */
+        Pfns = MmGetMdlPfnArray(Mdl) + ((MmGetMdlByteOffset(Mdl) + Offset) >> PAGE_SHIFT);
+        PageOffset = (MmGetMdlByteOffset(Mdl) + Offset) & (PAGE_SIZE - 1);
+        while (Length != 0)
+        {
+            Chunk = min(PAGE_SIZE - PageOffset, Length);
+            PortAddSgElement(SgList,
+                             ((ULONGLONG)*Pfns << PAGE_SHIFT) + PageOffset,
+                             Chunk);
+            Pfns++;
+            PageOffset = 0;
+            Length -= Chunk;
+        }
+
+        /* Give the miniport a system address if it touches the data */
+        if (FdoExtension->Miniport.PortConfig.MapBuffers != STOR_MAP_NO_BUFFERS)
+        {
+            SystemBuffer = MmGetSystemAddressForMdlSafe(Mdl, NormalPagePriority);
+            if (SystemBuffer == NULL)
+                return STATUS_INSUFFICIENT_RESOURCES;
+
+            Srb->DataBuffer = SystemBuffer + Offset;
+        }
+    }
+    else
+    {
+        /* A nonpaged system buffer, like the one of our own INQUIRY */
+        while (Length != 0)
+        {
+            Chunk = min(PAGE_SIZE - BYTE_OFFSET(Buffer), Length);
+            PortAddSgElement(SgList,
+                             MmGetPhysicalAddress(Buffer).QuadPart,
+                             Chunk);
+            Buffer += Chunk;
+            Length -= Chunk;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+
+static
+VOID
+PortFreeRequest(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PPORT_REQUEST Request)
+{
+    Request->Irp->Tail.Overlay.DriverContext[0] = NULL;
+
+    if (Request->SgListAllocated)
+        ExFreePoolWithTag(Request->SgList, TAG_SG_LIST);
+
+    ExFreeToNPagedLookasideList(&FdoExtension->RequestLookaside, Request);
+}
+
+
+static
+BOOLEAN
+PortCallStartIo(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PSCSI_REQUEST_BLOCK Srb)
+{
+    KIRQL OldIrql;
+    BOOLEAN Started;
+
+    /* In half duplex mode HwStartIo also excludes the interrupt routine */
+    if (FdoExtension->Miniport.PortConfig.SynchronizationModel == StorSynchronizeHalfDuplex &&
+        FdoExtension->Interrupt != NULL)
+    {
+        OldIrql = KeAcquireInterruptSpinLock(FdoExtension->Interrupt);
+        Started = MiniportStartIo(&FdoExtension->Miniport, Srb);
+        KeReleaseInterruptSpinLock(FdoExtension->Interrupt, OldIrql);
+    }
+    else
+    {
+        Started = MiniportStartIo(&FdoExtension->Miniport, Srb);
+    }
+
+    if (!Started)
+        DPRINT1("HwStartIo() rejected Srb %p\n", Srb);
+
+    return Started;
+}
+
+
+/* Called with the StartIoLock held */
+static
+VOID
+PortStartLunRequests(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PPDO_DEVICE_EXTENSION PdoExtension)
+{
+    PPORT_REQUEST Request;
+    PLIST_ENTRY Entry;
+    ULONG Tag;
+
+    while (!IsListEmpty(&PdoExtension->PendingListHead) &&
+           PdoExtension->ActiveCount < PdoExtension->QueueDepth)
+    {
+        Tag = RtlFindClearBitsAndSet(&PdoExtension->QueueTagBitmap, 1, 0);
+        if (Tag == MAXULONG)
+            break;
+
+        Entry = RemoveHeadList(&PdoExtension->PendingListHead);
+        Request = CONTAINING_RECORD(Entry, PORT_REQUEST, ListEntry);
+
+        Request->QueueTag = (UCHAR)Tag;
+        Request->Srb->QueueTag = (UCHAR)Tag;
+        Request->Started = TRUE;
+        PdoExtension->ActiveCount++;
+
+        if (!PortCallStartIo(FdoExtension, Request->Srb))
+        {
+            /* The miniport won't complete it, give the tag back and fail
+               the request as busy so the class driver retries it */
+            Request->Started = FALSE;
+            PdoExtension->ActiveCount--;
+            RtlClearBit(&PdoExtension->QueueTagBitmap, Tag);
+
+            Request->Srb->SrbStatus = SRB_STATUS_BUSY;
+            PortRequestComplete(FdoExtension, Request->Srb);
+
+            /* Leave the other requests for the completion DPC */
+            break;
+        }
+    }
+}
+
+
+NTSTATUS
+PortQueueRequest(
+    _In_ PPDO_DEVICE_EXTENSION PdoExtension,
+    _In_ PIRP Irp,
+    _In_ PSCSI_REQUEST_BLOCK Srb)
+{
+    PFDO_DEVICE_EXTENSION FdoExtension = PdoExtension->FdoExtension;
+    PMINIPORT Miniport = &FdoExtension->Miniport;
+    KLOCK_QUEUE_HANDLE LockHandle;
+    PPORT_REQUEST Request;
+    KIRQL OldIrql;
+    BOOLEAN Built;
+    NTSTATUS Status;
+
+    DPRINT("PortQueueRequest(%p %p %p)\n", PdoExtension, Irp, Srb);
+
+    if (FdoExtension->PnpState != dsStarted || !FdoExtension->RequestLookasideInitialized)
+    {
+        Srb->SrbStatus = SRB_STATUS_NO_DEVICE;
+        Status = STATUS_DEVICE_NOT_READY;
+        goto done;
+    }
+
+    Request = ExAllocateFromNPagedLookasideList(&FdoExtension->RequestLookaside);
+    if (Request == NULL)
+    {
+        Srb->SrbStatus = SRB_STATUS_ERROR;
+        Status = STATUS_INSUFFICIENT_RESOURCES;
+        goto done;
+    }
+
+    RtlZeroMemory(Request, sizeof(PORT_REQUEST));
+    Request->Irp = Irp;
+    Request->Srb = Srb;
+    Request->PdoExtension = PdoExtension;
+    Request->OriginalDataBuffer = Srb->DataBuffer;
+    Irp->Tail.Overlay.DriverContext[0] = Request;
+
+    Status = PortPrepareDataBuffer(FdoExtension, Request);
+    if (!NT_SUCCESS(Status))
+    {
+        Srb->DataBuffer = Request->OriginalDataBuffer;
+        PortFreeRequest(FdoExtension, Request);
+        Srb->SrbStatus = SRB_STATUS_ERROR;
+        goto done;
+    }
+
+    if (Miniport->PortConfig.SrbExtensionSize != 0)
+    {
+        Srb->SrbExtension = (PUCHAR)Request + FdoExtension->SrbExtensionOffset;
+        RtlZeroMemory(Srb->SrbExtension, Miniport->PortConfig.SrbExtensionSize);
+    }
+
+    Srb->OriginalRequest = Irp;
+    Srb->SrbStatus = SRB_STATUS_PENDING;
+    Srb->QueueTag = SP_UNTAGGED;
+
+    IoMarkIrpPending(Irp);
+
+    /* HwBuildIo prepares the request without holding any lock */
+    if (Miniport->InitData->HwBuildIo != NULL)
+    {
+        KeRaiseIrql(DISPATCH_LEVEL, &OldIrql);
+        Built = Miniport->InitData->HwBuildIo(&Miniport->MiniportExtension->HwDeviceExtension, Srb);
+        KeLowerIrql(OldIrql);
+
+        /* If it failed, the miniport has completed the request already */
+        if (!Built)
+            return STATUS_PENDING;
+    }
+
+    KeAcquireInStackQueuedSpinLock(&FdoExtension->StartIoLock, &LockHandle);
+    InsertTailList(&PdoExtension->PendingListHead, &Request->ListEntry);
+    PortStartLunRequests(FdoExtension, PdoExtension);
+    KeReleaseInStackQueuedSpinLock(&LockHandle);
+
+    return STATUS_PENDING;
+
+done:
+    Irp->IoStatus.Information = 0;
+    Irp->IoStatus.Status = Status;
+    IoCompleteRequest(Irp, IO_NO_INCREMENT);
+    return Status;
+}
+
+
+VOID
+PortRequestComplete(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ PSCSI_REQUEST_BLOCK Srb)
+{
+    PPORT_REQUEST Request;
+
+    Request = PortGetRequest(Srb);
+    if (Request == NULL)
+    {
+        DPRINT1("Srb %p was not queued by us\n", Srb);
+        return;
+    }
+
+    /* This may run at DIRQL, leave everything else to the DPC */
+    InterlockedPushEntrySList(&FdoExtension->CompletionList,
+                              &Request->CompletionEntry);
+    KeInsertQueueDpc(&FdoExtension->CompletionDpc, NULL, NULL);
+}
+
+
+static
+NTSTATUS
+PortSrbStatusToNtStatus(
+    _In_ UCHAR SrbStatus)
+{
+    switch (SRB_STATUS(SrbStatus))
+    {
+        case SRB_STATUS_SUCCESS:
+        case SRB_STATUS_DATA_OVERRUN:
+            return STATUS_SUCCESS;
+
+        case SRB_STATUS_INVALID_REQUEST:
+        case SRB_STATUS_BAD_FUNCTION:
+        case SRB_STATUS_BAD_SRB_BLOCK_LENGTH:
+            return STATUS_INVALID_DEVICE_REQUEST;
+
+        case SRB_STATUS_NO_DEVICE:
+        case SRB_STATUS_INVALID_LUN:
+        case SRB_STATUS_INVALID_TARGET_ID:
+        case SRB_STATUS_SELECTION_TIMEOUT:
+            return STATUS_DEVICE_DOES_NOT_EXIST;
+
+        case SRB_STATUS_TIMEOUT:
+        case SRB_STATUS_COMMAND_TIMEOUT:
+            return STATUS_IO_TIMEOUT;
+
+        case SRB_STATUS_BUSY:
+            return STATUS_DEVICE_BUSY;
+
+        default:
+            return STATUS_IO_DEVICE_ERROR;
+    }
+}
+
+
+VOID
+NTAPI
+PortCompletionDpc(
+    _In_ PKDPC Dpc,
+    _In_opt_ PVOID DeferredContext,
+    _In_opt_ PVOID SystemArgument1,
+    _In_opt_ PVOID SystemArgument2)
+{
+    PFDO_DEVICE_EXTENSION FdoExtension = (PFDO_DEVICE_EXTENSION)DeferredContext;
+    PSLIST_ENTRY Entry, Next, Completed = NULL;
+    KLOCK_QUEUE_HANDLE LockHandle;
+    PPDO_DEVICE_EXTENSION PdoExtension;
+    PPORT_REQUEST Request;
+    PSCSI_REQUEST_BLOCK Srb;
+    PIRP Irp;
+
+    UNREFERENCED_PARAMETER(Dpc);
+    UNREFERENCED_PARAMETER(SystemArgument1);
+    UNREFERENCED_PARAMETER(SystemArgument2);
+
+    /* Take the whole batch and put it back in completion order */
+    Entry = InterlockedFlushSList(&FdoExtension->CompletionList);
+    while (Entry != NULL)
+    {
+        Next = Entry->Next;
+        Entry->Next = Completed;
+        Completed = Entry;
+        Entry = Next;
+    }
+
+    /* Retire the requests, then refill the LUN queues in one go */
+    KeAcquireInStackQueuedSpinLockAtDpcLevel(&FdoExtension->StartIoLock, &LockHandle);
+
+    for (Entry = Completed; Entry != NULL; Entry = Entry->Next)
+    {
+        Request = CONTAINING_RECORD(Entry, PORT_REQUEST, CompletionEntry);
+        if (Request->Started)
+        {
+            PdoExtension = Request->PdoExtension;
+            PdoExtension->ActiveCount--;
+            RtlClearBit(&PdoExtension->QueueTagBitmap, Request->QueueTag);
+        }
+    }
+
+    for (Entry = Completed; Entry != NULL; Entry = Entry->Next)
+    {
+        Request = CONTAINING_RECORD(Entry, PORT_REQUEST, CompletionEntry);
+        PortStartLunRequests(FdoExtension, Request->PdoExtension);
+    }
+
+    /* LUNs whose queue depth changed may be able to start more */
+    Entry = InterlockedFlushSList(&FdoExtension->RestartList);
+    while (Entry != NULL)
+    {
+        PdoExtension = CONTAINING_RECORD(Entry, PDO_DEVICE_EXTENSION, RestartEntry);
+        Entry = Entry->Next;
+
+        InterlockedExchange(&PdoExtension->RestartQueued, FALSE);
+        PortStartLunRequests(FdoExtension, PdoExtension);
+    }
+
+    KeReleaseInStackQueuedSpinLockFromDpcLevel(&LockHandle);
+
+    /* Complete the IRPs without holding any lock */
+    while (Completed != NULL)
+    {
+        Request = CONTAINING_RECORD(Completed, PORT_REQUEST, CompletionEntry);
+        Completed = Completed->Next;
+
+        Irp = Request->Irp;
+        Srb = Request->Srb;
+        Srb->DataBuffer = Request->OriginalDataBuffer;
+
+        Irp->IoStatus.Status = PortSrbStatusToNtStatus(Srb->SrbStatus);
+        Irp->IoStatus.Information = NT_SUCCESS(Irp->IoStatus.Status) ? Srb->DataTransferLength : 0;
+
+        PortFreeRequest(FdoExtension, Request);
+        IoCompleteRequest(Irp, IO_DISK_INCREMENT);
+    }
+}
+
+
+PSTOR_SCATTER_GATHER_LIST
+PortGetScatterGatherList(
+    _In_ PSCSI_REQUEST_BLOCK Srb)
+{
+    PPORT_REQUEST Request;
+
+    Request = PortGetRequest(Srb);
+    if (Request == NULL)
+        return NULL;
+
+    return Request->SgList;
+}
+
+
+BOOLEAN
+PortSetDeviceQueueDepth(
+    _In_ PFDO_DEVICE_EXTENSION FdoExtension,
+    _In_ UCHAR PathId,
+    _In_ UCHAR TargetId,
+    _In_ UCHAR Lun,
+    _In_ ULONG Depth)
+{
+    PPDO_DEVICE_EXTENSION PdoExtension = NULL;
+    KLOCK_QUEUE_HANDLE LockHandle;
+    PLIST_ENTRY ListEntry;
+    BOOLEAN Found = FALSE;
+
+    if (Depth == 0)
+        return FALSE;
+
+    if (Depth > STORPORT_MAX_QUEUE_TAGS)
+        Depth = STORPORT_MAX_QUEUE_TAGS;
+
+    /* Miniports call this from HwStartIo and completion paths, so don't
+       take the StartIoLock. The DPC picks up the new depth. */
+    KeAcquireInStackQueuedSpinLock(&FdoExtension->PdoListLock, &LockHandle);
+    for (ListEntry = FdoExtension->PdoListHead.Flink;
+         ListEntry != &FdoExtension->PdoListHead;
+         ListEntry = ListEntry->Flink)
+    {
+        PdoExtension = CONTAINING_RECORD(ListEntry, PDO_DEVICE_EXTENSION, PdoListEntry);
+        if (PdoExtension->Bus == PathId &&
+            PdoExtension->Target == TargetId &&
+            PdoExtension->Lun == Lun)
+        {
+            InterlockedExchange((PLONG)&PdoExtension->QueueDepth, (LONG)Depth);
+            Found = TRUE;
+            break;
+        }
+    }
+    KeReleaseInStackQueuedSpinLock(&LockHandle);
+
+    if (Found)
+    {
+        if (!InterlockedExchange(&PdoExtension->RestartQueued, TRUE))
+        {
+            InterlockedPushEntrySList(&FdoExtension->RestartList,
+                                      &PdoExtension->RestartEntry);
+        }
+        KeInsertQueueDpc(&FdoExtension->CompletionDpc, NULL, NULL);
+    }
+
+    return Found;
+}
+
+/* EOF */
@@ -117,10 +117,14 @@ PortAcquireSpinLock(
     {
         case DpcLock: /* 1, */
             DPRINT1("DpcLock\n");
+            KeAcquireInStackQueuedSpinLock((PKSPIN_LOCK)&((PSTOR_DPC)LockContext)->Lock,
+                                           (PKLOCK_QUEUE_HANDLE)&LockHandle->Context);
             break;
 
         case StartIoLock: /* 2 */
             DPRINT1("StartIoLock\n");
+            KeAcquireInStackQueuedSpinLock(&DeviceExtension->StartIoLock,
+                                           (PKLOCK_QUEUE_HANDLE)&LockHandle->Context);
             break;
 
         case InterruptLock: /* 3 */
@@ -147,10 +151,12 @@ PortReleaseSpinLock(
     {
         case DpcLock: /* 1, */
             DPRINT1("DpcLock\n");
+            KeReleaseInStackQueuedSpinLock((PKLOCK_QUEUE_HANDLE)&LockHandle->Context);
             break;
 
         case StartIoLock: /* 2 */
             DPRINT1("StartIoLock\n");
+            KeReleaseInStackQueuedSpinLock((PKLOCK_QUEUE_HANDLE)&LockHandle->Context);
             break;
 
         case InterruptLock: /* 3 */
@@ -226,6 +232,13 @@ PortAddDevice(
     KeInitializeSpinLock(&DeviceExtension->PdoListLock);
     InitializeListHead(&DeviceExtension->PdoListHead);
 
+    KeInitializeSpinLock(&DeviceExtension->StartIoLock);
+    InitializeSListHead(&DeviceExtension->CompletionList);
+    InitializeSListHead(&DeviceExtension->RestartList);
+    KeInitializeDpc(&DeviceExtension->CompletionDpc,
+                    PortCompletionDpc,
+                    DeviceExtension);
+
     /* Attach the FDO to the device stack */
     Status = IoAttachDeviceToDeviceStackSafe(Fdo,
                                              PhysicalDeviceObject,
@@ -838,7 +851,7 @@ StorPortGetPhysicalAddress(
 
 
 /*
- * @unimplemented
+ * @implemented
  */
 STORPORT_API
 PSTOR_SCATTER_GATHER_LIST
@@ -847,9 +860,10 @@ StorPortGetScatterGatherList(
     _In_ PVOID DeviceExtension,
     _In_ PSCSI_REQUEST_BLOCK Srb)
 {
-    DPRINT1("StorPortGetScatterGatherList()\n");
-    UNIMPLEMENTED;
-    return NULL;
+    DPRINT("StorPortGetScatterGatherList(%p %p)\n",
+           DeviceExtension, Srb);
+
+    return PortGetScatterGatherList(Srb);
 }
 
 
@@ -1100,8 +1114,11 @@ StorPortNotification(
     PHW_PASSIVE_INITIALIZE_ROUTINE HwPassiveInitRoutine;
     PSTORPORT_EXTENDED_FUNCTIONS *ppExtendedFunctions;
     PBOOLEAN Result;
+    PLONG Inserted;
     PSTOR_DPC Dpc;
     PHW_DPC_ROUTINE HwDpcRoutine;
+    PVOID SystemArgument1;
+    PVOID SystemArgument2;
     va_list ap;
 
     STOR_SPINLOCK SpinLock;
@@ -1131,12 +1148,9 @@ StorPortNotification(
         case RequestComplete:
             DPRINT1("RequestComplete\n");
             Srb = (PSCSI_REQUEST_BLOCK)va_arg(ap, PSCSI_REQUEST_BLOCK);
-            DPRINT1("Srb %p\n", Srb);
-            if (Srb->OriginalRequest != NULL)
-            {
-                DPRINT1("Need to complete the IRP!\n");
-
-            }
+            DPRINT("Srb %p\n", Srb);
+            if (DeviceExtension != NULL)
+                PortRequestComplete(DeviceExtension, Srb);
             break;
 
         case GetExtendedFunctionTable:
@@ -1169,10 +1183,24 @@ StorPortNotification(
             HwDpcRoutine = (PHW_DPC_ROUTINE)va_arg(ap, PHW_DPC_ROUTINE);
             DPRINT1("HwDpcRoutine %p\n", HwDpcRoutine);
 
+            /* The DPC routine gets the miniport device extension */
             KeInitializeDpc((PRKDPC)&Dpc->Dpc,
                             (PKDEFERRED_ROUTINE)HwDpcRoutine,
-                            (PVOID)DeviceExtension);
-            KeInitializeSpinLock(&Dpc->Lock);
+                            HwDeviceExtension);
+            KeInitializeSpinLock((PKSPIN_LOCK)&Dpc->Lock);
+            break;
+
+        case IssueDpc:
+            DPRINT("IssueDpc\n");
+            Dpc = (PSTOR_DPC)va_arg(ap, PSTOR_DPC);
+            SystemArgument1 = (PVOID)va_arg(ap, PVOID);
+            SystemArgument2 = (PVOID)va_arg(ap, PVOID);
+            Inserted = (PLONG)va_arg(ap, PLONG);
+            DPRINT("Dpc %p\n", Dpc);
+
+            *Inserted = KeInsertQueueDpc((PRKDPC)&Dpc->Dpc,
+                                       SystemArgument1,
+                                       SystemArgument2);
             break;
 
         case AcquireSpinLock:
@@ -1390,7 +1418,7 @@ StorPortSetBusDataByOffset(
 
 
 /*
- * @unimplemented
+ * @implemented
  */
 STORPORT_API
 BOOLEAN
@@ -1402,9 +1430,21 @@ StorPortSetDeviceQueueDepth(
     _In_ UCHAR Lun,
     _In_ ULONG Depth)
 {
-    DPRINT1("StorPortSetDeviceQueueDepth()\n");
-    UNIMPLEMENTED;
-    return FALSE;
+    PMINIPORT_DEVICE_EXTENSION MiniportExtension;
+
+    DPRINT("StorPortSetDeviceQueueDepth(%p %u %u %u %lu)\n",
+           HwDeviceExtension, PathId, TargetId, Lun, Depth);
+
+    /* Get the miniport extension */
+    MiniportExtension = CONTAINING_RECORD(HwDeviceExtension,
+                                          MINIPORT_DEVICE_EXTENSION,
+                                          HwDeviceExtension);
+
+    return PortSetDeviceQueueDepth(MiniportExtension->Miniport->DeviceExtension,
+                                   PathId,
+                                   TargetId,
+                                   Lun,
+                                   Depth);
 }
 
 
@@ -1422,7 +1462,7 @@ StorPortStallExecution(
 
 
 /*
- * @unimplemented
+ * @implemented
  */
 STORPORT_API
 VOID
@@ -1432,8 +1472,31 @@ StorPortSynchronizeAccess(
     _In_ PSTOR_SYNCHRONIZED_ACCESS SynchronizedAccessRoutine,
     _In_opt_ PVOID Context)
 {
-    DPRINT1("StorPortSynchronizeAccess()\n");
-    UNIMPLEMENTED;
+    PMINIPORT_DEVICE_EXTENSION MiniportExtension;
+    PFDO_DEVICE_EXTENSION DeviceExtension;
+    KIRQL OldIrql;
+
+    DPRINT("StorPortSynchronizeAccess(%p %p %p)\n",
+           HwDeviceExtension, SynchronizedAccessRoutine, Context);
+
+    /* Get the miniport extension */
+    MiniportExtension = CONTAINING_RECORD(HwDeviceExtension,
+                                          MINIPORT_DEVICE_EXTENSION,
+                                          HwDeviceExtension);
+
+    DeviceExtension = MiniportExtension->Miniport->DeviceExtension;
+
+    /* Run the routine synchronized with the interrupt service routine */
+    if (DeviceExtension->Interrupt != NULL)
+    {
+        OldIrql = KeAcquireInterruptSpinLock(DeviceExtension->Interrupt);
+        SynchronizedAccessRoutine(HwDeviceExtension, Context);
+        KeReleaseInterruptSpinLock(DeviceExtension->Interrupt, OldIrql);
+    }
+    else
+    {
+        SynchronizedAccessRoutine(HwDeviceExtension, Context);
+    }
 }
 
 
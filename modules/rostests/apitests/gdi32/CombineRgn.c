@@ -301,6 +301,36 @@ void Test_CombineRgn_DIFF()
     ok_long(CombineRgn(hrgn1, hrgn1, hrgn3, RGN_DIFF), COMPLEXREGION);
     ok_long(CombineRgn(hrgn1, hrgn1, hrgn2, RGN_DIFF), NULLREGION);
 
+    /* A hole in a rect gives 4 rects in 3 bands */
+    {
+        static const RECT arcExpected[] =
+            {{0, 0, 10, 2}, {0, 2, 3, 7}, {6, 2, 10, 7}, {0, 7, 10, 10}};
+        struct
+        {
+            RGNDATAHEADER rdh;
+            RECT arc[8];
+        } rgndata;
+        ULONG i;
+
+        SetRectRgn(hrgn3, 3, 2, 6, 7);
+        ok_long(CombineRgn(hrgn1, hrgn2, hrgn3, RGN_DIFF), COMPLEXREGION);
+        ok(GetRegionData(hrgn1, sizeof(rgndata), (LPRGNDATA)&rgndata) != 0, "GetRegionData failed\n");
+        ok_long(rgndata.rdh.nCount, 4);
+        for (i = 0; i < 4; i++)
+        {
+            ok(EqualRect(&rgndata.arc[i], &arcExpected[i]),
+               "Rect %lu is (%ld,%ld,%ld,%ld)\n", i,
+               rgndata.arc[i].left, rgndata.arc[i].top,
+               rgndata.arc[i].right, rgndata.arc[i].bottom);
+        }
+
+        /* The same in place */
+        ok_long(CombineRgn(hrgn1, hrgn2, NULL, RGN_COPY), SIMPLEREGION);
+        ok_long(CombineRgn(hrgn1, hrgn1, hrgn3, RGN_DIFF), COMPLEXREGION);
+        ok(GetRegionData(hrgn1, sizeof(rgndata), (LPRGNDATA)&rgndata) != 0, "GetRegionData failed\n");
+        ok(memcmp(rgndata.arc, arcExpected, sizeof(arcExpected)) == 0, "Region is not correct\n");
+    }
+
 
 }
 
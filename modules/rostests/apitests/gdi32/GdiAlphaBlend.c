@@ -0,0 +1,264 @@
+/*
+ * PROJECT:     ReactOS api tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for GdiAlphaBlend between 32bpp DIB sections
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+typedef struct
+{
+    BITMAPINFOHEADER bmiHeader;
+    DWORD Masks[3];
+} BITMAPINFO_MASKS;
+
+/* Same colors whatever the source layout is, only the xlate differs */
+static HBITMAP
+CreateDib32(HDC hdc, LONG Width, LONG Height, BOOL RgbOrder, PULONG *Bits)
+{
+    BITMAPINFO_MASKS bmi;
+    HBITMAP hbmp;
+
+    ZeroMemory(&bmi, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = Width;
+    bmi.bmiHeader.biHeight = -Height;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    if (RgbOrder)
+    {
+        bmi.bmiHeader.biCompression = BI_BITFIELDS;
+        bmi.Masks[0] = 0x000000FF;
+        bmi.Masks[1] = 0x0000FF00;
+        bmi.Masks[2] = 0x00FF0000;
+    }
+    else
+    {
+        bmi.bmiHeader.biCompression = BI_RGB;
+    }
+
+    hbmp = CreateDIBSection(hdc, (BITMAPINFO *)&bmi, DIB_RGB_COLORS, (PVOID *)Bits, NULL, 0);
+    ok(hbmp != NULL, "CreateDIBSection failed: %lu\n", GetLastError());
+    return hbmp;
+}
+
+static ULONG
+SwapRedBlue(ULONG Pixel)
+{
+    return (Pixel & 0xFF00FF00) | ((Pixel >> 16) & 0xFF) | ((Pixel & 0xFF) << 16);
+}
+
+static ULONG
+RandomPixel(void)
+{
+    return ((ULONG)(rand() & 0xFF) << 24) | ((ULONG)(rand() & 0xFF) << 16) |
+           ((ULONG)(rand() & 0xFF) << 8) | (ULONG)(rand() & 0xFF);
+}
+
+static BOOL
+Blend(HDC hdcDst, LONG DstWidth, LONG DstHeight,
+      HDC hdcSrc, LONG SrcWidth, LONG SrcHeight,
+      BYTE ConstAlpha, BYTE AlphaFormat)
+{
+    BLENDFUNCTION BlendFunc;
+    BOOL Ret;
+
+    BlendFunc.BlendOp = AC_SRC_OVER;
+    BlendFunc.BlendFlags = 0;
+    BlendFunc.SourceConstantAlpha = ConstAlpha;
+    BlendFunc.AlphaFormat = AlphaFormat;
+
+    Ret = GdiAlphaBlend(hdcDst, 0, 0, DstWidth, DstHeight,
+                        hdcSrc, 0, 0, SrcWidth, SrcHeight, BlendFunc);
+    GdiFlush();
+    return Ret;
+}
+
+/*
+ * An untranslated 32bpp source takes the direct path of the 32bpp blender,
+ * the same colors in RGB order go through the xlate and the per-pixel code.
+ * Both have to give the same result, also when stretching.
+ */
+static void
+Test_ConstantAlpha(void)
+{
+    static const LONG Sizes[][4] =
+    {
+        { 16, 8, 16, 8 }, { 1, 1, 1, 1 }, { 7, 5, 23, 11 }, { 23, 11, 7, 5 },
+        { 100, 3, 333, 4 }, { 333, 4, 100, 3 }, { 3, 64, 640, 2 },
+    };
+    static const BYTE ConstAlphas[] = { 0, 1, 127, 128, 200, 254, 255 };
+    HDC hdcSrc, hdcSrcRgb, hdcDst, hdcDstRef;
+    HBITMAP hbmSrc, hbmSrcRgb, hbmDst, hbmDstRef;
+    PULONG Src, SrcRgb, Dst, DstRef;
+    LONG s, a, i, SrcPixels, DstPixels;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcSrcRgb = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hdcDstRef = CreateCompatibleDC(NULL);
+    ok(hdcSrc && hdcSrcRgb && hdcDst && hdcDstRef, "CreateCompatibleDC failed\n");
+
+    for (s = 0; s < _countof(Sizes); s++)
+    {
+        hbmSrc = CreateDib32(hdcSrc, Sizes[s][0], Sizes[s][1], FALSE, &Src);
+        hbmSrcRgb = CreateDib32(hdcSrcRgb, Sizes[s][0], Sizes[s][1], TRUE, &SrcRgb);
+        hbmDst = CreateDib32(hdcDst, Sizes[s][2], Sizes[s][3], FALSE, &Dst);
+        hbmDstRef = CreateDib32(hdcDstRef, Sizes[s][2], Sizes[s][3], FALSE, &DstRef);
+        if (!hbmSrc || !hbmSrcRgb || !hbmDst || !hbmDstRef)
+        {
+            skip("Bitmaps not created\n");
+            DeleteObject(hbmSrc);
+            DeleteObject(hbmSrcRgb);
+            DeleteObject(hbmDst);
+            DeleteObject(hbmDstRef);
+            continue;
+        }
+
+        SelectObject(hdcSrc, hbmSrc);
+        SelectObject(hdcSrcRgb, hbmSrcRgb);
+        SelectObject(hdcDst, hbmDst);
+        SelectObject(hdcDstRef, hbmDstRef);
+        SrcPixels = Sizes[s][0] * Sizes[s][1];
+        DstPixels = Sizes[s][2] * Sizes[s][3];
+
+        for (a = 0; a < _countof(ConstAlphas); a++)
+        {
+            /* The xlate drops the source alpha, so leave it zero in both */
+            for (i = 0; i < SrcPixels; i++)
+            {
+                Src[i] = RandomPixel() & 0x00FFFFFF;
+                SrcRgb[i] = SwapRedBlue(Src[i]);
+            }
+            for (i = 0; i < DstPixels; i++)
+                Dst[i] = DstRef[i] = RandomPixel();
+
+            ok(Blend(hdcDst, Sizes[s][2], Sizes[s][3], hdcSrc, Sizes[s][0], Sizes[s][1], ConstAlphas[a], 0),
+               "GdiAlphaBlend failed\n");
+            ok(Blend(hdcDstRef, Sizes[s][2], Sizes[s][3], hdcSrcRgb, Sizes[s][0], Sizes[s][1], ConstAlphas[a], 0),
+               "GdiAlphaBlend failed\n");
+
+            for (i = 0; i < DstPixels; i++)
+            {
+                if (Dst[i] != DstRef[i])
+                    break;
+            }
+            ok(i == DstPixels, "%ldx%ld -> %ldx%ld, alpha %u: pixel %ld is 0x%08lx, expected 0x%08lx\n",
+               Sizes[s][0], Sizes[s][1], Sizes[s][2], Sizes[s][3], ConstAlphas[a],
+               i, i < DstPixels ? Dst[i] : 0, i < DstPixels ? DstRef[i] : 0);
+        }
+
+        SelectObject(hdcSrc, GetStockObject(DEFAULT_BITMAP));
+        SelectObject(hdcSrcRgb, GetStockObject(DEFAULT_BITMAP));
+        SelectObject(hdcDst, GetStockObject(DEFAULT_BITMAP));
+        SelectObject(hdcDstRef, GetStockObject(DEFAULT_BITMAP));
+        DeleteObject(hbmSrc);
+        DeleteObject(hbmSrcRgb);
+        DeleteObject(hbmDst);
+        DeleteObject(hbmDstRef);
+    }
+
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcSrcRgb);
+    DeleteDC(hdcDst);
+    DeleteDC(hdcDstRef);
+}
+
+/* Dst = Src * ConstAlpha + Dst * (1 - SrcAlpha * ConstAlpha), per channel */
+static BOOL
+CheckPixel(ULONG Result, ULONG Src, ULONG Dst, BYTE ConstAlpha)
+{
+    ULONG Alpha = (Src >> 24) * ConstAlpha / 255;
+    ULONG Shift, Expected, Channel;
+
+    for (Shift = 0; Shift < 32; Shift += 8)
+    {
+        Expected = (((Src >> Shift) & 0xFF) * ConstAlpha / 255) +
+                   (((Dst >> Shift) & 0xFF) * (255 - Alpha) / 255);
+        if (Expected > 255)
+            Expected = 255;
+
+        /* Leave room for rounding instead of truncating */
+        Channel = (Result >> Shift) & 0xFF;
+        if (Channel + 1 < Expected || Channel > Expected + 1)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+Test_SourceAlpha(void)
+{
+    static const BYTE ConstAlphas[] = { 1, 127, 128, 200, 255 };
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PULONG Src, Dst;
+    ULONG Saved[640];
+    LONG a, i, Bad;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateDib32(hdcSrc, _countof(Saved), 1, FALSE, &Src);
+    hbmDst = CreateDib32(hdcDst, _countof(Saved), 1, FALSE, &Dst);
+    if (!hdcSrc || !hdcDst || !hbmSrc || !hbmDst)
+    {
+        skip("Bitmaps not created\n");
+        goto Cleanup;
+    }
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    for (a = 0; a < _countof(ConstAlphas); a++)
+    {
+        /* Opaque and transparent pixels, premultiplied and saturating ones */
+        for (i = 0; i < _countof(Saved); i++)
+        {
+            Src[i] = RandomPixel();
+            switch (i % 4)
+            {
+                case 0: Src[i] |= 0xFF000000; break;
+                case 1: Src[i] = (i & 4) ? 0 : (Src[i] & 0x00FFFFFF); break;
+            }
+            Dst[i] = Saved[i] = RandomPixel();
+        }
+
+        ok(Blend(hdcDst, _countof(Saved), 1, hdcSrc, _countof(Saved), 1, ConstAlphas[a], AC_SRC_ALPHA),
+           "GdiAlphaBlend failed\n");
+
+        Bad = 0;
+        for (i = 0; i < _countof(Saved); i++)
+        {
+            if (!CheckPixel(Dst[i], Src[i], Saved[i], ConstAlphas[a]) && Bad++ < 5)
+            {
+                ok(0, "alpha %u: pixel %ld from 0x%08lx over 0x%08lx is 0x%08lx\n",
+                   ConstAlphas[a], i, Src[i], Saved[i], Dst[i]);
+            }
+
+            /* These have no rounding to leave room for */
+            if (ConstAlphas[a] == 255 && (Src[i] >> 24) == 255)
+                ok(Dst[i] == Src[i], "pixel %ld is 0x%08lx, expected 0x%08lx\n", i, Dst[i], Src[i]);
+            else if (Src[i] == 0)
+                ok(Dst[i] == Saved[i], "pixel %ld is 0x%08lx, expected 0x%08lx\n", i, Dst[i], Saved[i]);
+        }
+        ok(Bad == 0, "alpha %u: %ld pixels off\n", ConstAlphas[a], Bad);
+    }
+
+    SelectObject(hdcSrc, GetStockObject(DEFAULT_BITMAP));
+    SelectObject(hdcDst, GetStockObject(DEFAULT_BITMAP));
+
+Cleanup:
+    DeleteObject(hbmSrc);
+    DeleteObject(hbmDst);
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+}
+
+START_TEST(GdiAlphaBlend)
+{
+    srand(12345);
+
+    Test_ConstantAlpha();
+    Test_SourceAlpha();
+}
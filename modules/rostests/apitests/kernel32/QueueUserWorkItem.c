@@ -0,0 +1,150 @@
+/*
+ * PROJECT:     ReactOS api tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Tests for QueueUserWorkItem
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+#define NESTED_ITEMS 32
+
+typedef struct _NESTED_WORK
+{
+    HANDLE InnerDone;
+    HANDLE OuterDone;
+    DWORD WaitResult;
+    BOOL Queued;
+} NESTED_WORK, *PNESTED_WORK;
+
+static LONG s_ChainCount;
+static HANDLE s_ChainDone;
+
+static DWORD WINAPI InnerWork(LPVOID Param)
+{
+    PNESTED_WORK Work = Param;
+
+    SetEvent(Work->InnerDone);
+    return 0;
+}
+
+/* Queues another item from a worker thread and blocks until it ran */
+static DWORD WINAPI OuterWork(LPVOID Param)
+{
+    PNESTED_WORK Work = Param;
+
+    Work->Queued = QueueUserWorkItem(InnerWork, Work, WT_EXECUTEDEFAULT);
+    if (Work->Queued)
+        Work->WaitResult = WaitForSingleObject(Work->InnerDone, 10000);
+    SetEvent(Work->OuterDone);
+    return 0;
+}
+
+static DWORD WINAPI ChainWork(LPVOID Param)
+{
+    if (InterlockedDecrement(&s_ChainCount) == 0)
+    {
+        SetEvent(s_ChainDone);
+        return 0;
+    }
+
+    if (!QueueUserWorkItem(ChainWork, NULL, WT_EXECUTEDEFAULT))
+        SetEvent(s_ChainDone);
+    return 0;
+}
+
+static void InitNestedWork(PNESTED_WORK Work)
+{
+    Work->InnerDone = CreateEventW(NULL, TRUE, FALSE, NULL);
+    Work->OuterDone = CreateEventW(NULL, TRUE, FALSE, NULL);
+    Work->WaitResult = WAIT_FAILED;
+    Work->Queued = FALSE;
+    ok(Work->InnerDone != NULL && Work->OuterDone != NULL, "CreateEventW failed: %lu\n", GetLastError());
+}
+
+static void FreeNestedWork(PNESTED_WORK Work)
+{
+    CloseHandle(Work->InnerDone);
+    CloseHandle(Work->OuterDone);
+}
+
+static void Test_Nested(void)
+{
+    NESTED_WORK Work;
+    DWORD Result;
+
+    InitNestedWork(&Work);
+
+    ok(QueueUserWorkItem(OuterWork, &Work, WT_EXECUTEDEFAULT), "QueueUserWorkItem failed: %lu\n", GetLastError());
+    Result = WaitForSingleObject(Work.OuterDone, 20000);
+    ok(Result == WAIT_OBJECT_0, "Outer work item did not finish: %lu\n", Result);
+    if (Result == WAIT_OBJECT_0)
+    {
+        ok(Work.Queued, "Inner work item not queued\n");
+        ok(Work.WaitResult == WAIT_OBJECT_0, "Inner work item did not run: %lu\n", Work.WaitResult);
+    }
+
+    /* Don't free events a stuck work item still uses */
+    if (Result == WAIT_OBJECT_0)
+        FreeNestedWork(&Work);
+}
+
+/* Every worker blocks on an item it queued itself */
+static void Test_NestedAllWorkers(void)
+{
+    NESTED_WORK Work[NESTED_ITEMS];
+    DWORD Result;
+    BOOL Finished = TRUE;
+    UINT i;
+
+    for (i = 0; i < NESTED_ITEMS; i++)
+    {
+        InitNestedWork(&Work[i]);
+        ok(QueueUserWorkItem(OuterWork, &Work[i], WT_EXECUTEDEFAULT),
+           "QueueUserWorkItem #%u failed: %lu\n", i, GetLastError());
+    }
+
+    for (i = 0; i < NESTED_ITEMS; i++)
+    {
+        Result = WaitForSingleObject(Work[i].OuterDone, 20000);
+        ok(Result == WAIT_OBJECT_0, "Outer work item #%u did not finish: %lu\n", i, Result);
+        if (Result != WAIT_OBJECT_0)
+        {
+            Finished = FALSE;
+            continue;
+        }
+        ok(Work[i].Queued, "Inner work item #%u not queued\n", i);
+        ok(Work[i].WaitResult == WAIT_OBJECT_0, "Inner work item #%u did not run: %lu\n", i, Work[i].WaitResult);
+    }
+
+    if (Finished)
+    {
+        for (i = 0; i < NESTED_ITEMS; i++)
+            FreeNestedWork(&Work[i]);
+    }
+}
+
+/* Each work item queues the next one */
+static void Test_Chain(void)
+{
+    DWORD Result;
+
+    s_ChainCount = 1000;
+    s_ChainDone = CreateEventW(NULL, TRUE, FALSE, NULL);
+    ok(s_ChainDone != NULL, "CreateEventW failed: %lu\n", GetLastError());
+
+    ok(QueueUserWorkItem(ChainWork, NULL, WT_EXECUTEDEFAULT), "QueueUserWorkItem failed: %lu\n", GetLastError());
+    Result = WaitForSingleObject(s_ChainDone, 20000);
+    ok(Result == WAIT_OBJECT_0, "Work item chain did not finish: %lu\n", Result);
+    ok(s_ChainCount == 0, "s_ChainCount = %ld\n", s_ChainCount);
+
+    if (Result == WAIT_OBJECT_0)
+        CloseHandle(s_ChainDone);
+}
+
+START_TEST(QueueUserWorkItem)
+{
+    Test_Nested();
+    Test_NestedAllWorkers();
+    Test_Chain();
+}
@@ -0,0 +1,126 @@
+/*
+ * PROJECT:     ReactOS API tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test and startup benchmark for the loader module lookup
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+static PCWSTR TestModules[] =
+{
+    L"advapi32.dll", L"comctl32.dll", L"comdlg32.dll", L"crypt32.dll",
+    L"dbghelp.dll", L"gdi32.dll", L"imagehlp.dll", L"imm32.dll",
+    L"iphlpapi.dll", L"mpr.dll", L"msacm32.dll", L"msi.dll",
+    L"mswsock.dll", L"netapi32.dll", L"ole32.dll", L"oleaut32.dll",
+    L"psapi.dll", L"rpcrt4.dll", L"secur32.dll", L"setupapi.dll",
+    L"shell32.dll", L"shlwapi.dll", L"urlmon.dll", L"user32.dll",
+    L"userenv.dll", L"uxtheme.dll", L"version.dll", L"wininet.dll",
+    L"winmm.dll", L"winspool.drv", L"wintrust.dll", L"ws2_32.dll",
+};
+
+#define LOOKUP_ITERATIONS 2000
+
+static
+ULONGLONG
+ElapsedMicroseconds(
+    _In_ PLARGE_INTEGER Start,
+    _In_ PLARGE_INTEGER Frequency)
+{
+    LARGE_INTEGER End;
+
+    QueryPerformanceCounter(&End);
+    return (End.QuadPart - Start->QuadPart) * 1000000 / Frequency->QuadPart;
+}
+
+START_TEST(LdrGetDllHandle)
+{
+    HMODULE Modules[_countof(TestModules)];
+    WCHAR FullNames[_countof(TestModules)][MAX_PATH];
+    UNICODE_STRING Name;
+    LARGE_INTEGER Frequency, Start;
+    PVOID Handle;
+    NTSTATUS Status;
+    ULONG i, j, Loaded = 0;
+
+    QueryPerformanceFrequency(&Frequency);
+
+    /* Load everything, timing the whole batch */
+    QueryPerformanceCounter(&Start);
+    for (i = 0; i < _countof(TestModules); i++)
+    {
+        Modules[i] = LoadLibraryW(TestModules[i]);
+        if (Modules[i])
+            Loaded++;
+    }
+    trace("Loaded %lu modules in %I64u us\n", Loaded, ElapsedMicroseconds(&Start, &Frequency));
+    ok(Loaded == _countof(TestModules), "Loaded %lu of %u modules\n", Loaded, (UINT)_countof(TestModules));
+
+    /* Base name lookups must be case-insensitive and find the loaded module */
+    for (i = 0; i < _countof(TestModules); i++)
+    {
+        WCHAR UpperName[MAX_PATH];
+
+        if (!Modules[i])
+            continue;
+
+        StringCchCopyW(UpperName, _countof(UpperName), TestModules[i]);
+        _wcsupr(UpperName);
+
+        RtlInitUnicodeString(&Name, UpperName);
+        Handle = NULL;
+        Status = LdrGetDllHandle(NULL, NULL, &Name, &Handle);
+        ok(Status == STATUS_SUCCESS, "LdrGetDllHandle(%S) returned 0x%lx\n", UpperName, Status);
+        ok(Handle == Modules[i], "LdrGetDllHandle(%S) returned %p, expected %p\n", UpperName, Handle, Modules[i]);
+
+        /* And so must full path lookups */
+        FullNames[i][0] = UNICODE_NULL;
+        ok(GetModuleFileNameW(Modules[i], FullNames[i], MAX_PATH) != 0,
+           "GetModuleFileNameW failed for %S\n", TestModules[i]);
+        RtlInitUnicodeString(&Name, FullNames[i]);
+        Handle = NULL;
+        Status = LdrGetDllHandle(NULL, NULL, &Name, &Handle);
+        ok(Status == STATUS_SUCCESS, "LdrGetDllHandle(%S) returned 0x%lx\n", FullNames[i], Status);
+        ok(Handle == Modules[i], "LdrGetDllHandle(%S) returned %p, expected %p\n", FullNames[i], Handle, Modules[i]);
+    }
+
+    /* Something that isn't loaded must not be found */
+    RtlInitUnicodeString(&Name, L"ldrtest_does_not_exist.dll");
+    Handle = (PVOID)(ULONG_PTR)0xdeadbeef;
+    Status = LdrGetDllHandle(NULL, NULL, &Name, &Handle);
+    ok(Status == STATUS_DLL_NOT_FOUND, "LdrGetDllHandle returned 0x%lx\n", Status);
+
+    /* Benchmark base name lookups */
+    QueryPerformanceCounter(&Start);
+    for (j = 0; j < LOOKUP_ITERATIONS; j++)
+    {
+        for (i = 0; i < _countof(TestModules); i++)
+        {
+            RtlInitUnicodeString(&Name, TestModules[i]);
+            LdrGetDllHandle(NULL, NULL, &Name, &Handle);
+        }
+    }
+    trace("%u base name lookups in %I64u us\n",
+          LOOKUP_ITERATIONS * (UINT)_countof(TestModules), ElapsedMicroseconds(&Start, &Frequency));
+
+    /* Benchmark full path lookups */
+    QueryPerformanceCounter(&Start);
+    for (j = 0; j < LOOKUP_ITERATIONS; j++)
+    {
+        for (i = 0; i < _countof(TestModules); i++)
+        {
+            if (!Modules[i])
+                continue;
+            RtlInitUnicodeString(&Name, FullNames[i]);
+            LdrGetDllHandle(NULL, NULL, &Name, &Handle);
+        }
+    }
+    trace("%u full path lookups in %I64u us\n",
+          LOOKUP_ITERATIONS * (UINT)_countof(TestModules), ElapsedMicroseconds(&Start, &Frequency));
+
+    for (i = 0; i < _countof(TestModules); i++)
+    {
+        if (Modules[i])
+            FreeLibrary(Modules[i]);
+    }
+}
@@ -0,0 +1,173 @@
+/*
+ * PROJECT:     ReactOS API tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test and benchmark for LdrGetProcedureAddress export lookups
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+#define LOOKUP_ITERATIONS 50
+
+static
+BOOLEAN
+IsExportName(
+    _In_ HMODULE Module,
+    _In_ PIMAGE_EXPORT_DIRECTORY ExportDirectory,
+    _In_ PULONG NameTable,
+    _In_ PCSTR Name)
+{
+    ULONG i;
+
+    for (i = 0; i < ExportDirectory->NumberOfNames; i++)
+    {
+        if (!strcmp(Name, (PCSTR)((ULONG_PTR)Module + NameTable[i])))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static
+VOID
+TestWrongCase(
+    _In_ HMODULE Module,
+    _In_ PCWSTR ModuleName,
+    _In_ PIMAGE_EXPORT_DIRECTORY ExportDirectory,
+    _In_ PULONG NameTable)
+{
+    CHAR Buffer[256];
+    PCSTR ExportName;
+    ANSI_STRING Name;
+    PVOID Address;
+    NTSTATUS Status;
+    ULONG i, Tested = 0;
+    SIZE_T j;
+
+    /* Flip the case of every letter of a few names that don't clash with another export */
+    for (i = 0; i < ExportDirectory->NumberOfNames && Tested < 16; i++)
+    {
+        ExportName = (PCSTR)((ULONG_PTR)Module + NameTable[i]);
+        if (strlen(ExportName) >= sizeof(Buffer))
+            continue;
+
+        for (j = 0; ExportName[j]; j++)
+        {
+            if (ExportName[j] >= 'a' && ExportName[j] <= 'z')
+                Buffer[j] = ExportName[j] - 'a' + 'A';
+            else if (ExportName[j] >= 'A' && ExportName[j] <= 'Z')
+                Buffer[j] = ExportName[j] - 'A' + 'a';
+            else
+                Buffer[j] = ExportName[j];
+        }
+        Buffer[j] = ANSI_NULL;
+
+        if (!strcmp(Buffer, ExportName) ||
+            IsExportName(Module, ExportDirectory, NameTable, Buffer))
+        {
+            continue;
+        }
+
+        RtlInitAnsiString(&Name, Buffer);
+        Address = (PVOID)(ULONG_PTR)0xdeadbeef;
+        Status = LdrGetProcedureAddress(Module, &Name, 0, &Address);
+        ok(Status == STATUS_PROCEDURE_NOT_FOUND, "%S!%s: Status = 0x%lx\n", ModuleName, Buffer, Status);
+        Tested++;
+    }
+
+    ok(Tested != 0, "No name to test the case of in %S\n", ModuleName);
+}
+
+static
+VOID
+TestModule(
+    _In_ PCWSTR ModuleName)
+{
+    HMODULE Module;
+    PIMAGE_EXPORT_DIRECTORY ExportDirectory;
+    PULONG NameTable, FunctionTable;
+    PUSHORT OrdinalTable;
+    ULONG ExportSize, i, j, Mismatches = 0;
+    ANSI_STRING Name;
+    PVOID Address, Expected;
+    NTSTATUS Status;
+    LARGE_INTEGER Frequency, Start, End;
+
+    Module = LoadLibraryW(ModuleName);
+    ok(Module != NULL, "Failed to load %S\n", ModuleName);
+    if (!Module)
+        return;
+
+    ExportDirectory = RtlImageDirectoryEntryToData(Module,
+                                                   TRUE,
+                                                   IMAGE_DIRECTORY_ENTRY_EXPORT,
+                                                   &ExportSize);
+    ok(ExportDirectory != NULL, "No export directory in %S\n", ModuleName);
+    if (!ExportDirectory)
+    {
+        FreeLibrary(Module);
+        return;
+    }
+
+    NameTable = (PULONG)((ULONG_PTR)Module + ExportDirectory->AddressOfNames);
+    OrdinalTable = (PUSHORT)((ULONG_PTR)Module + ExportDirectory->AddressOfNameOrdinals);
+    FunctionTable = (PULONG)((ULONG_PTR)Module + ExportDirectory->AddressOfFunctions);
+
+    /* Every named export must resolve to its export table entry */
+    for (i = 0; i < ExportDirectory->NumberOfNames; i++)
+    {
+        RtlInitAnsiString(&Name, (PCSTR)((ULONG_PTR)Module + NameTable[i]));
+        Expected = (PVOID)((ULONG_PTR)Module + FunctionTable[OrdinalTable[i]]);
+
+        /* Skip forwarders, they resolve into another module */
+        if (((ULONG_PTR)Expected >= (ULONG_PTR)ExportDirectory) &&
+            ((ULONG_PTR)Expected < (ULONG_PTR)ExportDirectory + ExportSize))
+        {
+            continue;
+        }
+
+        Address = NULL;
+        Status = LdrGetProcedureAddress(Module, &Name, 0, &Address);
+        if ((Status != STATUS_SUCCESS) || (Address != Expected))
+        {
+            ok(0, "%S!%Z: Status 0x%lx, got %p, expected %p\n",
+               ModuleName, &Name, Status, Address, Expected);
+            Mismatches++;
+        }
+    }
+    ok(Mismatches == 0, "%lu mismatches in %S\n", Mismatches, ModuleName);
+
+    /* Unknown names must fail */
+    RtlInitAnsiString(&Name, "LdrTestDoesNotExist");
+    Status = LdrGetProcedureAddress(Module, &Name, 0, &Address);
+    ok(Status == STATUS_PROCEDURE_NOT_FOUND, "Status = 0x%lx\n", Status);
+
+    /* Names are case-sensitive */
+    TestWrongCase(Module, ModuleName, ExportDirectory, NameTable);
+
+    /* Benchmark resolving the whole table the way import snapping would */
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&Start);
+    for (j = 0; j < LOOKUP_ITERATIONS; j++)
+    {
+        for (i = 0; i < ExportDirectory->NumberOfNames; i++)
+        {
+            RtlInitAnsiString(&Name, (PCSTR)((ULONG_PTR)Module + NameTable[i]));
+            LdrGetProcedureAddress(Module, &Name, 0, &Address);
+        }
+    }
+    QueryPerformanceCounter(&End);
+    trace("%S: %lu lookups in %I64u us\n",
+          ModuleName,
+          LOOKUP_ITERATIONS * ExportDirectory->NumberOfNames,
+          (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    FreeLibrary(Module);
+}
+
+START_TEST(LdrGetProcedureAddress)
+{
+    TestModule(L"kernel32.dll");
+    TestModule(L"user32.dll");
+    TestModule(L"ntdll.dll");
+}
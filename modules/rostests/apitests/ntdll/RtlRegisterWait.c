@@ -0,0 +1,143 @@
+/*
+ * PROJECT:     ReactOS API tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for RtlRegisterWait
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+#define WAIT_COUNT 5000
+
+static volatile LONG SignaledCount;
+static volatile LONG TimedOutCount;
+static HANDLE DoneEvent;
+
+static
+VOID
+NTAPI
+WaitCallback(
+    _In_ PVOID Context,
+    _In_ BOOLEAN TimerOrWaitFired)
+{
+    if (TimerOrWaitFired)
+    {
+        InterlockedIncrement(&TimedOutCount);
+        return;
+    }
+
+    if (InterlockedIncrement(&SignaledCount) == (LONG)(ULONG_PTR)Context)
+        SetEvent(DoneEvent);
+}
+
+static
+VOID
+TestManyWaits(VOID)
+{
+    HANDLE *Events, *Waits;
+    NTSTATUS Status;
+    ULONG i, Registered = 0;
+    LARGE_INTEGER Frequency, Start, End;
+    DWORD Result;
+
+    Events = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, WAIT_COUNT * sizeof(HANDLE));
+    Waits = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, WAIT_COUNT * sizeof(HANDLE));
+    if (!Events || !Waits)
+    {
+        skip("Out of memory\n");
+        HeapFree(GetProcessHeap(), 0, Events);
+        HeapFree(GetProcessHeap(), 0, Waits);
+        return;
+    }
+
+    SignaledCount = 0;
+    TimedOutCount = 0;
+    DoneEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&Start);
+    for (i = 0; i < WAIT_COUNT; i++)
+    {
+        Events[i] = CreateEventW(NULL, FALSE, FALSE, NULL);
+        if (!Events[i])
+            break;
+
+        Status = RtlRegisterWait(&Waits[i],
+                                 Events[i],
+                                 WaitCallback,
+                                 (PVOID)(ULONG_PTR)WAIT_COUNT,
+                                 INFINITE,
+                                 WT_EXECUTEONLYONCE);
+        if (!NT_SUCCESS(Status))
+        {
+            CloseHandle(Events[i]);
+            Events[i] = NULL;
+            break;
+        }
+        Registered++;
+    }
+    QueryPerformanceCounter(&End);
+    ok(Registered == WAIT_COUNT, "Registered %lu of %u waits\n", Registered, WAIT_COUNT);
+    trace("Registered %lu waits in %I64u us\n",
+          Registered, (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    /* Fire all of them */
+    QueryPerformanceCounter(&Start);
+    for (i = 0; i < Registered; i++)
+        SetEvent(Events[i]);
+
+    Result = WaitForSingleObject(DoneEvent, 30000);
+    QueryPerformanceCounter(&End);
+    ok(Result == WAIT_OBJECT_0, "WaitForSingleObject returned %lu\n", Result);
+    ok(SignaledCount == (LONG)Registered, "SignaledCount = %ld\n", SignaledCount);
+    ok(TimedOutCount == 0, "TimedOutCount = %ld\n", TimedOutCount);
+    trace("Dispatched %ld callbacks in %I64u us\n",
+          SignaledCount, (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    for (i = 0; i < Registered; i++)
+    {
+        Status = RtlDeregisterWaitEx(Waits[i], INVALID_HANDLE_VALUE);
+        ok(Status == STATUS_SUCCESS, "RtlDeregisterWaitEx(%lu) returned 0x%lx\n", i, Status);
+        CloseHandle(Events[i]);
+    }
+
+    CloseHandle(DoneEvent);
+    HeapFree(GetProcessHeap(), 0, Events);
+    HeapFree(GetProcessHeap(), 0, Waits);
+}
+
+static
+VOID
+TestTimeout(VOID)
+{
+    HANDLE Event, Wait;
+    NTSTATUS Status;
+
+    SignaledCount = 0;
+    TimedOutCount = 0;
+    DoneEvent = NULL;
+
+    Event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    Status = RtlRegisterWait(&Wait, Event, WaitCallback, NULL, 50, 0);
+    ok(Status == STATUS_SUCCESS, "RtlRegisterWait returned 0x%lx\n", Status);
+    if (!NT_SUCCESS(Status))
+    {
+        CloseHandle(Event);
+        return;
+    }
+
+    /* The wait is periodic, it must time out repeatedly */
+    Sleep(500);
+    ok(TimedOutCount >= 2, "TimedOutCount = %ld\n", TimedOutCount);
+    ok(SignaledCount == 0, "SignaledCount = %ld\n", SignaledCount);
+
+    Status = RtlDeregisterWaitEx(Wait, INVALID_HANDLE_VALUE);
+    ok(Status == STATUS_SUCCESS, "RtlDeregisterWaitEx returned 0x%lx\n", Status);
+    CloseHandle(Event);
+}
+
+START_TEST(RtlRegisterWait)
+{
+    TestTimeout();
+    TestManyWaits();
+}
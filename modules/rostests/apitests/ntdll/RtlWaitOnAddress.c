@@ -0,0 +1,211 @@
+/*
+ * PROJECT:     ReactOS API tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for RtlWaitOnAddress, RtlWakeAddressSingle and RtlWakeAddressAll
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include "precomp.h"
+
+#define WAITER_COUNT 4
+
+static NTSTATUS (NTAPI *pRtlWaitOnAddress)(const volatile VOID *, PVOID, SIZE_T, PLARGE_INTEGER);
+static VOID (NTAPI *pRtlWakeAddressSingle)(const volatile VOID *);
+static VOID (NTAPI *pRtlWakeAddressAll)(const volatile VOID *);
+
+static volatile ULONG WaitValue;
+static LONG ReadyCount;
+static LONG WokenCount;
+
+static DWORD WINAPI WaiterThread(LPVOID Param)
+{
+    ULONG Compare = 0;
+    LARGE_INTEGER Timeout;
+    NTSTATUS Status;
+
+    Timeout.QuadPart = -10 * 1000 * 10000LL;
+
+    InterlockedIncrement(&ReadyCount);
+    Status = pRtlWaitOnAddress(&WaitValue, &Compare, sizeof(Compare), &Timeout);
+    ok(Status == STATUS_SUCCESS, "Status = 0x%lx\n", Status);
+    if (Status == STATUS_SUCCESS)
+        InterlockedIncrement(&WokenCount);
+
+    return 0;
+}
+
+static void StartWaiters(HANDLE *Threads)
+{
+    ULONG i;
+
+    WaitValue = 0;
+    ReadyCount = 0;
+    WokenCount = 0;
+
+    for (i = 0; i < WAITER_COUNT; i++)
+    {
+        Threads[i] = CreateThread(NULL, 0, WaiterThread, NULL, 0, NULL);
+        ok(Threads[i] != NULL, "CreateThread failed: %lu\n", GetLastError());
+    }
+
+    /* Let them get past the comparison and block */
+    while (ReadyCount != WAITER_COUNT)
+        Sleep(10);
+    Sleep(200);
+}
+
+static void StopWaiters(HANDLE *Threads)
+{
+    DWORD Result;
+    ULONG i;
+
+    Result = WaitForMultipleObjects(WAITER_COUNT, Threads, TRUE, 15000);
+    ok(Result == WAIT_OBJECT_0, "Waiters did not finish: %lu\n", Result);
+
+    for (i = 0; i < WAITER_COUNT; i++)
+        CloseHandle(Threads[i]);
+}
+
+static void Test_WakeSingle(void)
+{
+    HANDLE Threads[WAITER_COUNT];
+    ULONG i;
+
+    StartWaiters(Threads);
+    ok(WokenCount == 0, "WokenCount = %ld\n", WokenCount);
+
+    /* Each wake releases exactly one waiter, even if the value didn't change */
+    for (i = 1; i <= WAITER_COUNT; i++)
+    {
+        pRtlWakeAddressSingle(&WaitValue);
+        Sleep(200);
+        ok(WokenCount == (LONG)i, "After %lu wakes, WokenCount = %ld\n", i, WokenCount);
+    }
+
+    StopWaiters(Threads);
+}
+
+static void Test_WakeAll(void)
+{
+    HANDLE Threads[WAITER_COUNT];
+    ULONG Other = 0;
+
+    StartWaiters(Threads);
+    ok(WokenCount == 0, "WokenCount = %ld\n", WokenCount);
+
+    /* Waking another address must not release them */
+    pRtlWakeAddressAll(&Other);
+    Sleep(200);
+    ok(WokenCount == 0, "WokenCount = %ld\n", WokenCount);
+
+    WaitValue = 1;
+    pRtlWakeAddressAll(&WaitValue);
+    Sleep(200);
+    ok(WokenCount == WAITER_COUNT, "WokenCount = %ld\n", WokenCount);
+
+    StopWaiters(Threads);
+}
+
+static void Test_Timeout(void)
+{
+    ULONG Value = 0x12345678, Compare = 0x12345678;
+    LARGE_INTEGER Timeout;
+    ULONG Start, Elapsed;
+    NTSTATUS Status;
+
+    Timeout.QuadPart = 0;
+    Status = pRtlWaitOnAddress(&Value, &Compare, sizeof(Value), &Timeout);
+    ok(Status == STATUS_TIMEOUT, "Status = 0x%lx\n", Status);
+
+    Timeout.QuadPart = -200 * 10000LL;
+    Start = GetTickCount();
+    Status = pRtlWaitOnAddress(&Value, &Compare, sizeof(Value), &Timeout);
+    Elapsed = GetTickCount() - Start;
+    ok(Status == STATUS_TIMEOUT, "Status = 0x%lx\n", Status);
+    ok(Elapsed >= 150, "Returned after %lu ms\n", Elapsed);
+
+    /* The timed out waiters are gone, waking nobody is fine */
+    pRtlWakeAddressSingle(&Value);
+}
+
+static void Test_Sizes(void)
+{
+    static const SIZE_T Sizes[] = { 1, 2, 4, 8 };
+    union
+    {
+        UCHAR Bytes[16];
+        ULONGLONG Align;
+    } Value, Compare;
+    LARGE_INTEGER Timeout;
+    NTSTATUS Status;
+    ULONG Start, Elapsed, i;
+    SIZE_T Size;
+
+    for (i = 0; i < _countof(Sizes); i++)
+    {
+        Size = Sizes[i];
+        memset(&Value, 0xAA, sizeof(Value));
+        memset(&Compare, 0xAA, sizeof(Compare));
+
+        /* Only the first Size bytes are compared, the next one differing doesn't matter */
+        Compare.Bytes[Size] = 0x55;
+        Timeout.QuadPart = -50 * 10000LL;
+        Status = pRtlWaitOnAddress(&Value, &Compare, Size, &Timeout);
+        ok(Status == STATUS_TIMEOUT, "Size %Iu: Status = 0x%lx\n", Size, Status);
+
+        /* The value already differs in its last byte, return right away */
+        Compare.Bytes[Size] = 0xAA;
+        Compare.Bytes[Size - 1] = 0x55;
+        Timeout.QuadPart = -5 * 1000 * 10000LL;
+        Start = GetTickCount();
+        Status = pRtlWaitOnAddress(&Value, &Compare, Size, &Timeout);
+        Elapsed = GetTickCount() - Start;
+        ok(Status == STATUS_SUCCESS, "Size %Iu: Status = 0x%lx\n", Size, Status);
+        ok(Elapsed < 1000, "Size %Iu: Returned after %lu ms\n", Size, Elapsed);
+
+        /* Same for the first byte */
+        Compare.Bytes[Size - 1] = 0xAA;
+        Compare.Bytes[0] = 0x55;
+        Status = pRtlWaitOnAddress(&Value, &Compare, Size, &Timeout);
+        ok(Status == STATUS_SUCCESS, "Size %Iu: Status = 0x%lx\n", Size, Status);
+    }
+
+    /* Other sizes are rejected */
+    memset(&Value, 0, sizeof(Value));
+    memset(&Compare, 0, sizeof(Compare));
+    Timeout.QuadPart = 0;
+    Status = pRtlWaitOnAddress(&Value, &Compare, 3, &Timeout);
+    ok(Status == STATUS_INVALID_PARAMETER, "Status = 0x%lx\n", Status);
+    Status = pRtlWaitOnAddress(&Value, &Compare, 16, &Timeout);
+    ok(Status == STATUS_INVALID_PARAMETER, "Status = 0x%lx\n", Status);
+}
+
+START_TEST(RtlWaitOnAddress)
+{
+    HMODULE Module;
+
+    /* ReactOS keeps the NT 6+ functions in ntdll_vista */
+    Module = GetModuleHandleW(L"ntdll.dll");
+    pRtlWaitOnAddress = (PVOID)GetProcAddress(Module, "RtlWaitOnAddress");
+    if (!pRtlWaitOnAddress)
+    {
+        Module = LoadLibraryW(L"ntdll_vista.dll");
+        if (Module)
+            pRtlWaitOnAddress = (PVOID)GetProcAddress(Module, "RtlWaitOnAddress");
+    }
+    if (!pRtlWaitOnAddress)
+    {
+        win_skip("RtlWaitOnAddress not available\n");
+        return;
+    }
+    pRtlWakeAddressSingle = (PVOID)GetProcAddress(Module, "RtlWakeAddressSingle");
+    pRtlWakeAddressAll = (PVOID)GetProcAddress(Module, "RtlWakeAddressAll");
+    ok(pRtlWakeAddressSingle != NULL && pRtlWakeAddressAll != NULL, "Wake functions missing\n");
+    if (!pRtlWakeAddressSingle || !pRtlWakeAddressAll)
+        return;
+
+    Test_Sizes();
+    Test_Timeout();
+    Test_WakeSingle();
+    Test_WakeAll();
+}
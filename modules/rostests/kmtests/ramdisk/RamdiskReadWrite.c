@@ -0,0 +1,370 @@
+/*
+ * PROJECT:     ReactOS kernel-mode tests
+ * LICENSE:     LGPL-2.1-or-later (https://spdx.org/licenses/LGPL-2.1-or-later)
+ * PURPOSE:     Kernel-Mode Test Suite Ramdisk Read/Write test and benchmark
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include <kmt_test.h>
+#include <ntdddisk.h>
+#include <reactos/drivers/ntddrdsk.h>
+
+#define DISK_SIZE       (16 * 1024 * 1024)
+#define CHUNK_SIZE      (64 * 1024)
+#define VIEW_SIZE       (1024 * 1024)
+#define PASSES          8
+#define MAX_THREADS     4
+
+typedef struct _TRIM_INPUT
+{
+    DEVICE_MANAGE_DATA_SET_ATTRIBUTES Attributes;
+    DEVICE_DATA_SET_RANGE Range;
+} TRIM_INPUT;
+
+typedef struct _BENCH_CONTEXT
+{
+    BOOLEAN Write;
+    ULONG FirstChunk;
+    ULONG ChunkCount;
+    NTSTATUS Status;
+} BENCH_CONTEXT, *PBENCH_CONTEXT;
+
+/* The ramdisk driver can't remove disks, so every run uses the same one */
+static const GUID TestDiskGuid = { 0xfd43b091, 0x8534, 0x45b0, { 0xbd, 0xb8, 0xc9, 0x86, 0x79, 0xf8, 0xab, 0x86 } };
+
+static WCHAR DiskNameBuffer[64];
+static UNICODE_STRING DiskName;
+
+static
+NTSTATUS
+OpenDisk(
+    _Out_ PHANDLE DiskHandle)
+{
+    OBJECT_ATTRIBUTES ObjectAttributes;
+    IO_STATUS_BLOCK IoStatus;
+
+    InitializeObjectAttributes(&ObjectAttributes,
+                               &DiskName,
+                               OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+                               NULL,
+                               NULL);
+    return ZwOpenFile(DiskHandle,
+                      GENERIC_READ | GENERIC_WRITE | SYNCHRONIZE,
+                      &ObjectAttributes,
+                      &IoStatus,
+                      FILE_SHARE_READ | FILE_SHARE_WRITE,
+                      FILE_SYNCHRONOUS_IO_NONALERT | FILE_NO_INTERMEDIATE_BUFFERING);
+}
+
+static
+NTSTATUS
+OpenTestDisk(
+    _Out_ PHANDLE DiskHandle)
+{
+    NTSTATUS Status;
+    HANDLE BusHandle;
+    OBJECT_ATTRIBUTES ObjectAttributes;
+    IO_STATUS_BLOCK IoStatus;
+    UNICODE_STRING BusName = RTL_CONSTANT_STRING(L"\\Device\\Ramdisk");
+    UNICODE_STRING GuidString;
+    RAMDISK_CREATE_INPUT Input;
+
+    Status = RtlStringFromGUID(&TestDiskGuid, &GuidString);
+    if (!NT_SUCCESS(Status))
+        return Status;
+    RtlInitEmptyUnicodeString(&DiskName, DiskNameBuffer, sizeof(DiskNameBuffer));
+    RtlAppendUnicodeStringToString(&DiskName, &BusName);
+    RtlAppendUnicodeStringToString(&DiskName, &GuidString);
+    RtlFreeUnicodeString(&GuidString);
+
+    /* Left over from an earlier run */
+    Status = OpenDisk(DiskHandle);
+    if (Status != STATUS_OBJECT_NAME_NOT_FOUND)
+        return Status;
+
+    InitializeObjectAttributes(&ObjectAttributes,
+                               &BusName,
+                               OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+                               NULL,
+                               NULL);
+    Status = ZwOpenFile(&BusHandle,
+                        GENERIC_READ | GENERIC_WRITE | SYNCHRONIZE,
+                        &ObjectAttributes,
+                        &IoStatus,
+                        0,
+                        FILE_SYNCHRONOUS_IO_NONALERT);
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    RtlZeroMemory(&Input, sizeof(Input));
+    Input.Version = sizeof(Input);
+    Input.DiskGuid = TestDiskGuid;
+    Input.DiskType = RAMDISK_VIRTUAL_DISK;
+    Input.DiskLength.QuadPart = DISK_SIZE;
+    Input.Options.NoDriveLetter = TRUE;
+    Input.Options.NoDosDevice = TRUE;
+    Input.Options.Hidden = TRUE;
+
+    Status = ZwDeviceIoControlFile(BusHandle,
+                                   NULL,
+                                   NULL,
+                                   NULL,
+                                   &IoStatus,
+                                   FSCTL_CREATE_RAM_DISK,
+                                   &Input,
+                                   sizeof(Input),
+                                   NULL,
+                                   0);
+    ZwClose(BusHandle);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    Status = OpenDisk(DiskHandle);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    return Status;
+}
+
+static
+NTSTATUS
+DiskIo(
+    _In_ HANDLE DiskHandle,
+    _In_ BOOLEAN Write,
+    _In_ ULONG Offset,
+    _In_ PVOID Buffer,
+    _In_ ULONG Length)
+{
+    IO_STATUS_BLOCK IoStatus;
+    LARGE_INTEGER ByteOffset;
+
+    ByteOffset.QuadPart = Offset;
+    if (Write)
+        return ZwWriteFile(DiskHandle, NULL, NULL, NULL, &IoStatus, Buffer, Length, &ByteOffset, NULL);
+    else
+        return ZwReadFile(DiskHandle, NULL, NULL, NULL, &IoStatus, Buffer, Length, &ByteOffset, NULL);
+}
+
+static
+NTSTATUS
+TrimRange(
+    _In_ HANDLE DiskHandle,
+    _In_ LONGLONG Offset,
+    _In_ ULONGLONG Length)
+{
+    TRIM_INPUT Trim;
+    IO_STATUS_BLOCK IoStatus;
+
+    RtlZeroMemory(&Trim, sizeof(Trim));
+    Trim.Attributes.Size = sizeof(Trim.Attributes);
+    Trim.Attributes.Action = DeviceDsmAction_Trim;
+    Trim.Attributes.DataSetRangesOffset = FIELD_OFFSET(TRIM_INPUT, Range);
+    Trim.Attributes.DataSetRangesLength = sizeof(Trim.Range);
+    Trim.Range.StartingOffset = Offset;
+    Trim.Range.LengthInBytes = Length;
+
+    return ZwDeviceIoControlFile(DiskHandle,
+                                 NULL,
+                                 NULL,
+                                 NULL,
+                                 &IoStatus,
+                                 IOCTL_STORAGE_MANAGE_DATA_SET_ATTRIBUTES,
+                                 &Trim,
+                                 sizeof(Trim),
+                                 NULL,
+                                 0);
+}
+
+static
+BOOLEAN
+IsFilled(
+    _In_ PUCHAR Buffer,
+    _In_ ULONG Length,
+    _In_ UCHAR Value)
+{
+    ULONG i;
+
+    for (i = 0; i < Length; i++)
+    {
+        if (Buffer[i] != Value)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static
+VOID
+TestReadWriteTrim(
+    _In_ HANDLE DiskHandle,
+    _In_ PUCHAR Buffer)
+{
+    NTSTATUS Status;
+
+    /* Trimmed space reads as zeroes */
+    Status = TrimRange(DiskHandle, 0, DISK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    RtlFillMemory(Buffer, CHUNK_SIZE, 0x55);
+    Status = DiskIo(DiskHandle, FALSE, 0, Buffer, CHUNK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    ok(IsFilled(Buffer, CHUNK_SIZE, 0), "Trimmed disk not zeroed\n");
+
+    /* Writes crossing a view boundary come back the same */
+    RtlFillMemory(Buffer, CHUNK_SIZE, 0xA5);
+    Status = DiskIo(DiskHandle, TRUE, VIEW_SIZE - CHUNK_SIZE / 2, Buffer, CHUNK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    RtlZeroMemory(Buffer, CHUNK_SIZE);
+    Status = DiskIo(DiskHandle, FALSE, VIEW_SIZE - CHUNK_SIZE / 2, Buffer, CHUNK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    ok(IsFilled(Buffer, CHUNK_SIZE, 0xA5), "Data mismatch across views\n");
+
+    /* Out of range requests fail */
+    Status = DiskIo(DiskHandle, FALSE, DISK_SIZE - CHUNK_SIZE / 2, Buffer, CHUNK_SIZE);
+    ok_eq_hex(Status, STATUS_INVALID_PARAMETER);
+
+    /* Trimming the first view whole and a part of the second one */
+    Status = TrimRange(DiskHandle, 0, VIEW_SIZE + CHUNK_SIZE / 4);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    Status = DiskIo(DiskHandle, FALSE, VIEW_SIZE - CHUNK_SIZE / 2, Buffer, CHUNK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    ok(IsFilled(Buffer, 3 * CHUNK_SIZE / 4, 0), "Trimmed data not zeroed\n");
+    ok(IsFilled(Buffer + 3 * CHUNK_SIZE / 4, CHUNK_SIZE / 4, 0xA5), "Data after the trimmed range lost\n");
+}
+
+static
+VOID
+NTAPI
+BenchThread(
+    _In_ PVOID Context)
+{
+    PBENCH_CONTEXT Bench = Context;
+    HANDLE DiskHandle;
+    PUCHAR Buffer;
+    ULONG Pass, Chunk;
+
+    /* A handle per thread, synchronous file objects serialize their I/O */
+    Bench->Status = OpenDisk(&DiskHandle);
+    if (!NT_SUCCESS(Bench->Status))
+        PsTerminateSystemThread(Bench->Status);
+
+    Buffer = ExAllocatePoolWithTag(NonPagedPool, CHUNK_SIZE, 'RmtK');
+    if (!Buffer)
+    {
+        ZwClose(DiskHandle);
+        Bench->Status = STATUS_INSUFFICIENT_RESOURCES;
+        PsTerminateSystemThread(Bench->Status);
+    }
+    RtlFillMemory(Buffer, CHUNK_SIZE, 0x3C);
+
+    Bench->Status = STATUS_SUCCESS;
+    for (Pass = 0; Pass < PASSES && NT_SUCCESS(Bench->Status); Pass++)
+    {
+        for (Chunk = Bench->FirstChunk;
+             Chunk < Bench->FirstChunk + Bench->ChunkCount;
+             Chunk++)
+        {
+            Bench->Status = DiskIo(DiskHandle,
+                                   Bench->Write,
+                                   Chunk * CHUNK_SIZE,
+                                   Buffer,
+                                   CHUNK_SIZE);
+            if (!NT_SUCCESS(Bench->Status))
+                break;
+        }
+    }
+
+    ExFreePoolWithTag(Buffer, 'RmtK');
+    ZwClose(DiskHandle);
+    PsTerminateSystemThread(Bench->Status);
+}
+
+static
+VOID
+Benchmark(
+    _In_ BOOLEAN Write,
+    _In_ ULONG ThreadCount)
+{
+    BENCH_CONTEXT Contexts[MAX_THREADS];
+    PVOID Threads[MAX_THREADS];
+    HANDLE ThreadHandle;
+    LARGE_INTEGER Start, End, Frequency;
+    ULONG i, ChunksPerThread;
+    ULONGLONG Bytes, Microseconds;
+    NTSTATUS Status;
+
+    ChunksPerThread = DISK_SIZE / CHUNK_SIZE / ThreadCount;
+    Start = KeQueryPerformanceCounter(&Frequency);
+    for (i = 0; i < ThreadCount; i++)
+    {
+        Contexts[i].Write = Write;
+        Contexts[i].FirstChunk = i * ChunksPerThread;
+        Contexts[i].ChunkCount = ChunksPerThread;
+        Contexts[i].Status = STATUS_UNSUCCESSFUL;
+
+        Threads[i] = NULL;
+        Status = PsCreateSystemThread(&ThreadHandle,
+                                      SYNCHRONIZE,
+                                      NULL,
+                                      NULL,
+                                      NULL,
+                                      BenchThread,
+                                      &Contexts[i]);
+        ok_eq_hex(Status, STATUS_SUCCESS);
+        if (!NT_SUCCESS(Status))
+            continue;
+        Status = ObReferenceObjectByHandle(ThreadHandle,
+                                           SYNCHRONIZE,
+                                           *PsThreadType,
+                                           KernelMode,
+                                           &Threads[i],
+                                           NULL);
+        ok_eq_hex(Status, STATUS_SUCCESS);
+        ZwClose(ThreadHandle);
+    }
+
+    for (i = 0; i < ThreadCount; i++)
+    {
+        if (!Threads[i])
+            continue;
+        KeWaitForSingleObject(Threads[i], Executive, KernelMode, FALSE, NULL);
+        ObDereferenceObject(Threads[i]);
+        ok_eq_hex(Contexts[i].Status, STATUS_SUCCESS);
+    }
+    End = KeQueryPerformanceCounter(NULL);
+
+    Bytes = (ULONGLONG)ChunksPerThread * ThreadCount * CHUNK_SIZE * PASSES;
+    Microseconds = (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart;
+    trace("%s, %lu thread(s): %I64u KB in %I64u us, %I64u MB/s\n",
+          Write ? "Write" : "Read",
+          ThreadCount,
+          Bytes / 1024,
+          Microseconds,
+          Microseconds ? Bytes / Microseconds : 0);
+}
+
+START_TEST(RamdiskReadWrite)
+{
+    NTSTATUS Status;
+    HANDLE DiskHandle;
+    PUCHAR Buffer;
+
+    /* The bus only exists when the ramdisk driver is loaded */
+    Status = OpenTestDisk(&DiskHandle);
+    if (skip(NT_SUCCESS(Status), "No ramdisk (0x%08lx)\n", Status))
+        return;
+
+    Buffer = ExAllocatePoolWithTag(NonPagedPool, CHUNK_SIZE, 'RmtK');
+    if (!skip(Buffer != NULL, "Out of memory\n"))
+    {
+        TestReadWriteTrim(DiskHandle, Buffer);
+        ExFreePoolWithTag(Buffer, 'RmtK');
+    }
+
+    Benchmark(TRUE, 1);
+    Benchmark(FALSE, 1);
+    Benchmark(TRUE, MAX_THREADS);
+    Benchmark(FALSE, MAX_THREADS);
+
+    /* Give the pages back, the disk itself stays for the next run */
+    Status = TrimRange(DiskHandle, 0, DISK_SIZE);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    ZwClose(DiskHandle);
+}
@@ -0,0 +1,157 @@
+/*
+ * PROJECT:     ReactOS btrfs regression tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for the btrfs RAID6 Galois field kernels
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <windows.h>
+#include <wine/test.h>
+
+#include <galois.h>
+
+#define STRIPE_SIZE 65536
+#define NUM_STRIPES 8 /* 6 data stripes, P and Q */
+
+static void FillRandom(uint8_t* data, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        data[i] = (uint8_t)rand();
+}
+
+/* What the kernels must compute, one field operation per byte */
+static void ExpectDouble(uint8_t* data, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        data[i] = gmul(2, data[i]);
+}
+
+static void ExpectDivpower(uint8_t* data, uint8_t div, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        data[i] = gdiv(data[i], gpow2(div));
+}
+
+static void ExpectRecover2(uint8_t* qxy, const uint8_t* pxy, const uint8_t* p, const uint8_t* q,
+                           uint8_t a, uint8_t b, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        qxy[i] = gmul(a, p[i] ^ pxy[i]) ^ gmul(b, q[i] ^ qxy[i]);
+}
+
+/* Every alignment and tail length, nothing outside the range may change */
+static void TestKernels(void)
+{
+    static uint8_t data[300], expect[300], pxy[300], p[300], q[300];
+    uint32_t offset, len;
+    unsigned int div;
+
+    for (offset = 0; offset < 16; offset++) {
+        for (len = 0; len <= 100; len++) {
+            FillRandom(data, sizeof(data));
+            memcpy(expect, data, sizeof(data));
+            galois_double(data + offset, len);
+            ExpectDouble(expect + offset, len);
+            ok(!memcmp(data, expect, sizeof(data)), "galois_double offset %u len %u\n", offset, len);
+
+            div = rand() % 256;
+            galois_divpower(data + offset, (uint8_t)div, len);
+            ExpectDivpower(expect + offset, (uint8_t)div, len);
+            ok(!memcmp(data, expect, sizeof(data)), "galois_divpower offset %u len %u div %u\n", offset, len, div);
+
+            FillRandom(pxy, sizeof(pxy));
+            FillRandom(p, sizeof(p));
+            FillRandom(q, sizeof(q));
+            div = rand();
+            galois_recover2(data + offset, pxy, p + offset, q, (uint8_t)div, (uint8_t)(div >> 8), len);
+            ExpectRecover2(expect + offset, pxy, p + offset, q, (uint8_t)div, (uint8_t)(div >> 8), len);
+            ok(!memcmp(data, expect, sizeof(data)), "galois_recover2 offset %u len %u\n", offset, len);
+        }
+    }
+
+    /* Every byte value with every divisor */
+    for (div = 0; div < 256; div++) {
+        for (len = 0; len < 256; len++)
+            data[len] = expect[len] = (uint8_t)len;
+
+        galois_divpower(data, (uint8_t)div, 256);
+        ExpectDivpower(expect, (uint8_t)div, 256);
+        ok(!memcmp(data, expect, 256), "galois_divpower all bytes div %u\n", div);
+    }
+}
+
+static void XorInto(uint8_t* dst, const uint8_t* src, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        dst[i] ^= src[i];
+}
+
+/* Same steps as raid6_recover2 in read.c, for two lost data stripes */
+static void TestRecovery(void)
+{
+    static uint8_t stripes[NUM_STRIPES][STRIPE_SIZE], lost[2][STRIPE_SIZE], pxy[STRIPE_SIZE], qxy[STRIPE_SIZE];
+    uint8_t gyx, gx, denom, a, b;
+    int stripe, x = 1, y = 4;
+
+    for (stripe = 0; stripe < NUM_STRIPES - 2; stripe++)
+        FillRandom(stripes[stripe], STRIPE_SIZE);
+
+    /* Generate P and Q the way the write path does */
+    stripe = NUM_STRIPES - 3;
+    memcpy(stripes[NUM_STRIPES - 2], stripes[stripe], STRIPE_SIZE);
+    memcpy(stripes[NUM_STRIPES - 1], stripes[stripe], STRIPE_SIZE);
+    while (stripe-- > 0) {
+        galois_double(stripes[NUM_STRIPES - 1], STRIPE_SIZE);
+        XorInto(stripes[NUM_STRIPES - 1], stripes[stripe], STRIPE_SIZE);
+        XorInto(stripes[NUM_STRIPES - 2], stripes[stripe], STRIPE_SIZE);
+    }
+
+    memcpy(lost[0], stripes[x], STRIPE_SIZE);
+    memcpy(lost[1], stripes[y], STRIPE_SIZE);
+    memset(stripes[x], 0, STRIPE_SIZE);
+    memset(stripes[y], 0, STRIPE_SIZE);
+
+    stripe = NUM_STRIPES - 3;
+    memcpy(qxy, stripes[stripe], STRIPE_SIZE);
+    memcpy(pxy, stripes[stripe], STRIPE_SIZE);
+    while (stripe-- > 0) {
+        galois_double(qxy, STRIPE_SIZE);
+        if (stripe != x && stripe != y) {
+            XorInto(qxy, stripes[stripe], STRIPE_SIZE);
+            XorInto(pxy, stripes[stripe], STRIPE_SIZE);
+        }
+    }
+
+    gyx = gpow2(y > x ? (y - x) : (255 - x + y));
+    gx = gpow2(255 - x);
+    denom = gdiv(1, gyx ^ 1);
+    a = gmul(gyx, denom);
+    b = gmul(gx, denom);
+
+    galois_recover2(qxy, pxy, stripes[NUM_STRIPES - 2], stripes[NUM_STRIPES - 1], a, b, STRIPE_SIZE);
+    ok(!memcmp(qxy, lost[0], STRIPE_SIZE), "first lost stripe not recovered\n");
+
+    XorInto(pxy, qxy, STRIPE_SIZE);
+    XorInto(pxy, stripes[NUM_STRIPES - 2], STRIPE_SIZE);
+    ok(!memcmp(pxy, lost[1], STRIPE_SIZE), "second lost stripe not recovered\n");
+}
+
+START_TEST(raid6)
+{
+    srand(1);
+    TestKernels();
+    TestRecovery();
+}
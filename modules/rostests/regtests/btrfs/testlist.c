@@ -0,0 +1,12 @@
+/* Automatically generated file; DO NOT EDIT!! */
+
+#define STANDALONE
+#include <wine/test.h>
+
+extern void func_raid6(void);
+
+const struct test winetest_testlist[] =
+{
+    { "raid6", func_raid6 },
+    { 0, 0 }
+};
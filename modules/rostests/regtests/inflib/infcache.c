@@ -0,0 +1,228 @@
+/*
+ * PROJECT:     ReactOS inflib regression tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for the inflib section and key lookups
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Loads a generated INF with many sections and repeated keys, and checks
+ * that the hash tables and Id arrays find every section and the first
+ * line of every key, ignoring case. Then builds a section with repeated
+ * keys through the put functions, so that the key hash has to grow.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inflib.h"
+#include "infros.h"
+
+#include <wine/test.h>
+
+#define SECTIONS 200
+#define KEYS     20    /* distinct keys per section */
+
+static ULONG LinesOf(ULONG Section)
+{
+    return 1 + (Section * 7) % 60;
+}
+
+/* Every seventh line has no key, the others cycle through the keys */
+static BOOLEAN LineHasKey(ULONG Line)
+{
+    return (Line % 7) != 6;
+}
+
+static ULONG FirstLineOfKey(ULONG Section, ULONG Key)
+{
+    ULONG Line;
+
+    for (Line = Key; Line < LinesOf(Section); Line += KEYS)
+    {
+        if (LineHasKey(Line))
+            return Line + 1;
+    }
+
+    return 0;
+}
+
+static PCHAR BuildInf(PULONG Size)
+{
+    PCHAR Buffer, p;
+    ULONG Section, Line;
+
+    Buffer = malloc(SECTIONS * (16 + 60 * 32));
+    if (Buffer == NULL)
+        return NULL;
+
+    p = Buffer;
+    for (Section = 0; Section < SECTIONS; Section++)
+    {
+        p += sprintf(p, "[Sect%03lu]\r\n", Section);
+        for (Line = 0; Line < LinesOf(Section); Line++)
+        {
+            if (LineHasKey(Line))
+                p += sprintf(p, "Key%lu = value%lu\r\n", Line % KEYS, Line);
+            else
+                p += sprintf(p, "value%lu\r\n", Line);
+        }
+    }
+
+    *Size = (ULONG)(p - Buffer);
+    return Buffer;
+}
+
+/* Lowercase letters become uppercase and the other way round */
+static void MakeName(PWCHAR Name, const char *Format, ULONG Value, BOOLEAN SwapCase)
+{
+    char Ansi[32];
+    ULONG i;
+
+    sprintf(Ansi, Format, Value);
+    for (i = 0; Ansi[i] != 0; i++)
+    {
+        Name[i] = (WCHAR)Ansi[i];
+        if (SwapCase && Ansi[i] >= 'a' && Ansi[i] <= 'z')
+            Name[i] -= 'a' - 'A';
+        else if (SwapCase && Ansi[i] >= 'A' && Ansi[i] <= 'Z')
+            Name[i] += 'a' - 'A';
+    }
+    Name[i] = 0;
+}
+
+static void TestLookups(PINFCACHE Cache)
+{
+    static const WCHAR Missing[] = { 'N','o','S','u','c','h','N','a','m','e',0 };
+    PINFCACHESECTION Section;
+    PINFCACHELINE Line;
+    WCHAR Name[32];
+    ULONG i, Key, Id;
+
+    for (i = 0; i < SECTIONS; i++)
+    {
+        MakeName(Name, "Sect%03lu", i, FALSE);
+        Section = InfpFindSection(Cache, Name);
+        ok(Section != NULL && Section->Id == i + 1, "section %lu not found\n", i);
+        MakeName(Name, "Sect%03lu", i, TRUE);
+        ok(InfpFindSection(Cache, Name) == Section, "section %lu not found ignoring case\n", i);
+        if (Section == NULL)
+            continue;
+
+        ok(Section->LineCount == (LONG)LinesOf(i), "section %lu has %ld lines\n", i, Section->LineCount);
+
+        for (Key = 0; Key < KEYS; Key++)
+        {
+            Id = FirstLineOfKey(i, Key);
+
+            MakeName(Name, "Key%lu", Key, FALSE);
+            Line = InfpFindKeyLine(Section, Name);
+            ok(Id ? (Line != NULL && Line->Id == Id) : (Line == NULL),
+               "section %lu: key %lu found on line %u, expected %lu\n", i, Key, Line ? Line->Id : 0, Id);
+            MakeName(Name, "Key%lu", Key, TRUE);
+            ok(InfpFindKeyLine(Section, Name) == Line, "section %lu: key %lu not found ignoring case\n", i, Key);
+        }
+        ok(InfpFindKeyLine(Section, Missing) == NULL, "section %lu: missing key found\n", i);
+
+        for (Id = 0; Id <= LinesOf(i) + 1; Id++)
+        {
+            Line = InfpFindLineById(Section, Id);
+            if (Id == 0 || Id > LinesOf(i))
+                ok(Line == NULL, "section %lu: line %lu found by Id\n", i, Id);
+            else
+                ok(Line != NULL && Line->Id == Id, "section %lu: line %lu not found by Id\n", i, Id);
+        }
+    }
+    ok(InfpFindSection(Cache, Missing) == NULL, "missing section found\n");
+
+    for (Id = 0; Id <= SECTIONS + 1; Id++)
+    {
+        Section = InfpFindSectionById(Cache, Id);
+        if (Id == 0 || Id > SECTIONS)
+            ok(Section == NULL, "section %lu found by Id\n", Id);
+        else
+            ok(Section != NULL && Section->Id == Id, "section %lu not found by Id\n", Id);
+    }
+}
+
+/* Repeated keys must still find their first line, also after the key hash grew */
+static void TestPut(void)
+{
+    static const char Inf[] = "[Other]\r\nKey = 1\r\n";
+    static const WCHAR SectionName[] = { 'P','u','t',0 };
+    WCHAR Key[16];
+    PINFCONTEXT Context, Found;
+    PINFCACHESECTION Section;
+    PINFCACHELINE Line;
+    PINFCACHE Cache;
+    HINF InfHandle = NULL;
+    ULONG ErrorLine;
+    int i;
+
+    ok(INF_SUCCESS(InfOpenBufferedFile(&InfHandle, (PVOID)Inf, sizeof(Inf) - 1, 0, &ErrorLine)),
+       "INF not loaded, error on line %lu\n", ErrorLine);
+    if (InfHandle == NULL)
+        return;
+    Cache = (PINFCACHE)InfHandle;
+
+    ok(INF_SUCCESS(InfpFindOrAddSection(Cache, SectionName, &Context)), "section not added\n");
+    for (i = 0; i < 1000; i++)
+    {
+        Key[0] = 'k';
+        Key[1] = (i % 2) ? 'E' : 'e';
+        Key[2] = 'y';
+        Key[3] = (WCHAR)('0' + (i % 300) / 100);
+        Key[4] = (WCHAR)('0' + (i % 100) / 10);
+        Key[5] = (WCHAR)('0' + i % 10);
+        Key[6] = 0;
+        ok(INF_SUCCESS(InfpAddLineWithKey(Context, Key)), "line %d not added\n", i);
+        ok(INF_SUCCESS(InfpAddField(Context, Key)), "field %d not added\n", i);
+    }
+    InfpFreeContext(Context);
+
+    Section = InfpFindSection(Cache, SectionName);
+    ok(Section != NULL && Section->LineCount == 1000, "section not found after adding lines\n");
+    if (Section != NULL)
+    {
+        for (Line = Section->FirstLine; Line != NULL; Line = Line->Next)
+        {
+            PINFCACHELINE First = InfpFindKeyLine(Section, Line->Key);
+
+            ok(First != NULL && First->Id == (Line->Id - 1) % 300 + 1,
+               "added key of line %u not found on its first line\n", Line->Id);
+        }
+    }
+
+    ok(INF_SUCCESS(InfpFindFirstLine(Cache, SectionName, NULL, &Context)), "first line not found\n");
+    Found = malloc(sizeof(INFCONTEXT));
+    ok(INF_SUCCESS(InfpFindFirstMatchLine(Context, L"KEY299", Found)) && Found->Line == 300, "first match not found\n");
+    ok(INF_SUCCESS(InfpFindNextMatchLine(Found, L"key299", Found)) && Found->Line == 300, "match line not found\n");
+    ok(InfpGetLineCount(InfHandle, L"pUT") == 1000, "wrong line count\n");
+    free(Found);
+    InfpFreeContext(Context);
+
+    InfCloseFile(InfHandle);
+}
+
+START_TEST(infcache)
+{
+    HINF InfHandle = NULL;
+    ULONG Size, ErrorLine;
+    PCHAR Buffer;
+
+    Buffer = BuildInf(&Size);
+    if (Buffer == NULL)
+    {
+        skip("Out of memory\n");
+        return;
+    }
+
+    ok(INF_SUCCESS(InfOpenBufferedFile(&InfHandle, Buffer, Size, 0, &ErrorLine)),
+       "INF not loaded, error on line %lu\n", ErrorLine);
+    free(Buffer);
+    if (InfHandle != NULL)
+    {
+        TestLookups((PINFCACHE)InfHandle);
+        InfCloseFile(InfHandle);
+    }
+
+    TestPut();
+}
@@ -0,0 +1,12 @@
+/* Automatically generated file; DO NOT EDIT!! */
+
+#define STANDALONE
+#include <wine/test.h>
+
+extern void func_infcache(void);
+
+const struct test winetest_testlist[] =
+{
+    { "infcache", func_infcache },
+    { 0, 0 }
+};
@@ -0,0 +1,276 @@
+/*
+ * PROJECT:     ReactOS RTL regression tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Test for the LZNT1 decompressor of RtlDecompressBuffer
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WIN32_NO_STATUS
+#include <windows.h>
+#include <ndk/rtlfuncs.h>
+#include <ntstatus.h>
+#include <wine/test.h>
+
+#define CHUNK_SIZE 0x1000
+#define DATA_SIZE (256 * 1024)
+#define GUARD_SIZE 16
+
+/* Greedy LZNT1 encoder, good enough to produce every kind of token */
+static ULONG
+MatchLength(const UCHAR *src, ULONG pos, ULONG size, ULONG disp, ULONG max_len)
+{
+    ULONG len;
+
+    for (len = 0; len < max_len && pos + len < size && src[pos + len] == src[pos + len - disp]; len++);
+    return len;
+}
+
+static ULONG
+CompressChunk(const UCHAR *src, ULONG size, UCHAR *dst)
+{
+    static short head[4096], prev[CHUNK_SIZE];
+    ULONG pos = 0, out = 2, flags_pos, token, bits, max_disp, max_len;
+    ULONG best_len, best_disp, len, disp, hash, depth;
+    long cand;
+    UCHAR flags;
+
+    memset(head, 0xff, sizeof(head));
+
+    while (pos < size)
+    {
+        flags_pos = out++;
+        flags = 0;
+        for (token = 0; token < 8 && pos < size; token++)
+        {
+            for (bits = 4; bits < 12 && (1UL << bits) < pos; bits++);
+            max_disp = min(1UL << bits, pos);
+            max_len = (1UL << (16 - bits)) + 2;
+
+            /* Short periods first, then the positions with the same three bytes */
+            best_len = 0;
+            best_disp = 0;
+            for (disp = 1; disp <= 3 && disp <= max_disp; disp++)
+            {
+                len = MatchLength(src, pos, size, disp, max_len);
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_disp = disp;
+                }
+            }
+
+            hash = (pos + 2 < size) ? ((src[pos] << 4) ^ (src[pos + 1] << 2) ^ src[pos + 2]) & 0xfff : 0;
+            for (cand = head[hash], depth = 0;
+                 pos + 2 < size && cand >= 0 && pos - cand <= max_disp && depth < 32;
+                 cand = prev[cand], depth++)
+            {
+                len = MatchLength(src, pos, size, pos - cand, max_len);
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_disp = pos - cand;
+                }
+            }
+
+            len = (best_len >= 3) ? best_len : 1;
+            if (best_len >= 3)
+            {
+                *(WORD *)(dst + out) = (WORD)(((best_disp - 1) << (16 - bits)) | (best_len - 3));
+                out += 2;
+                flags |= 1 << token;
+            }
+            else
+            {
+                dst[out++] = src[pos];
+            }
+
+            /* Index the positions we're moving over */
+            for (; len > 0; len--, pos++)
+            {
+                if (pos + 2 < size)
+                {
+                    hash = ((src[pos] << 4) ^ (src[pos + 1] << 2) ^ src[pos + 2]) & 0xfff;
+                    prev[pos] = head[hash];
+                    head[hash] = (short)pos;
+                }
+            }
+        }
+        dst[flags_pos] = flags;
+    }
+
+    if (out - 2 >= size)
+    {
+        /* Not worth it, store the chunk */
+        *(WORD *)dst = (WORD)(0x3000 | (size - 1));
+        memcpy(dst + 2, src, size);
+        return size + 2;
+    }
+
+    *(WORD *)dst = (WORD)(0xB000 | (out - 2 - 1));
+    return out;
+}
+
+static ULONG
+Compress(const UCHAR *src, ULONG size, UCHAR *dst)
+{
+    ULONG pos, out = 0;
+
+    for (pos = 0; pos < size; pos += CHUNK_SIZE)
+        out += CompressChunk(src + pos, min(CHUNK_SIZE, size - pos), dst + out);
+
+    return out;
+}
+
+static void
+Generate(UCHAR *data, ULONG size, int kind)
+{
+    ULONG i, j, len, period;
+
+    for (i = 0; i < size; )
+    {
+        switch (kind)
+        {
+            case 0: /* incompressible */
+                data[i++] = (UCHAR)rand();
+                break;
+
+            case 1: /* single byte runs */
+                len = 1 + rand() % 300;
+                memset(data + i, rand(), min(len, size - i));
+                i += min(len, size - i);
+                break;
+
+            case 2: /* short periods, displacements 2 and 3 */
+                len = 1 + rand() % 200;
+                period = 2 + rand() % 2;
+                for (j = 0; j < len && i < size; j++, i++)
+                    data[i] = "abc"[j % period];
+                break;
+
+            default: /* text made of a small vocabulary */
+            {
+                static const char *Words[] = { "ReactOS ", "NTFS ", "compression ",
+                                               "unit ", "cluster ", "\r\n", "the " };
+                const char *w = Words[rand() % (sizeof(Words) / sizeof(Words[0]))];
+                for (j = 0; w[j] && i < size; j++)
+                    data[i++] = w[j];
+                if (rand() % 16 == 0 && i < size)
+                    data[i++] = (UCHAR)rand();
+                break;
+            }
+        }
+    }
+}
+
+static void
+TestVectors(void)
+{
+    static UCHAR Backref[] = { 0x06, 0xB0, 0x10, 'W', 'i', 'n', 'e', 0x05, 0x30 };
+    static UCHAR BadRef[] = { 0x03, 0xB0, 0x01, 0x00, 0x00 };
+    UCHAR out[16];
+    ULONG final_size;
+    NTSTATUS status;
+
+    status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, sizeof(out), Backref, sizeof(Backref), &final_size);
+    ok(status == STATUS_SUCCESS && final_size == 12 && !memcmp(out, "WineWineWine", 12),
+       "overlapping reference: status 0x%08lx, size %lu\n", status, final_size);
+
+    status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, 10, Backref, sizeof(Backref), &final_size);
+    ok(status == STATUS_SUCCESS && final_size == 10 && !memcmp(out, "WineWineWi", 10),
+       "truncated reference: status 0x%08lx, size %lu\n", status, final_size);
+
+    status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, sizeof(out), BadRef, sizeof(BadRef), &final_size);
+    ok(status == STATUS_BAD_COMPRESSION_BUFFER, "reference before start: status 0x%08lx\n", status);
+}
+
+/* Nothing may be written past the output buffer */
+static BOOL
+GuardIntact(const UCHAR *out, ULONG out_size)
+{
+    ULONG i;
+
+    for (i = 0; i < GUARD_SIZE; i++)
+    {
+        if (out[out_size + i] != 0xcc)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+TestData(int kind, const char *name, UCHAR *data, UCHAR *comp, UCHAR *out)
+{
+    ULONG comp_size, final_size, size, i;
+    NTSTATUS status;
+    int n;
+
+    Generate(data, DATA_SIZE, kind);
+    comp_size = Compress(data, DATA_SIZE, comp);
+
+    /* Round trip */
+    status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, DATA_SIZE, comp, comp_size, &final_size);
+    ok(status == STATUS_SUCCESS, "%s: round trip status 0x%08lx\n", name, status);
+    ok(final_size == DATA_SIZE, "%s: round trip size %lu\n", name, final_size);
+    ok(!memcmp(out, data, DATA_SIZE), "%s: round trip output differs\n", name);
+
+    /* Output buffers ending anywhere, within a literal or a reference, get the start of the data */
+    for (n = 0; n < 200; n++)
+    {
+        size = 1 + rand() % (3 * CHUNK_SIZE);
+        memset(out, 0xcc, size + GUARD_SIZE);
+        final_size = 0xdeadbeef;
+        status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, size, comp, comp_size, &final_size);
+        ok(status == STATUS_SUCCESS, "%s, output %lu: status 0x%08lx\n", name, size, status);
+        ok(final_size == size, "%s, output %lu: size %lu\n", name, size, final_size);
+        ok(!memcmp(out, data, size), "%s, output %lu: output differs\n", name, size);
+        ok(GuardIntact(out, size), "%s, output %lu: written past the buffer\n", name, size);
+    }
+
+    /* Corrupted input must be rejected or decoded within bounds, corruptions pile up */
+    size = min(comp_size, 2 * CHUNK_SIZE);
+    for (n = 0; n < 2000; n++)
+    {
+        i = rand() % size;
+        comp[i] ^= (UCHAR)(1 + rand() % 255);
+        memset(out, 0xcc, 2 * CHUNK_SIZE + GUARD_SIZE);
+        final_size = 0;
+        status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, 2 * CHUNK_SIZE, comp, size, &final_size);
+        ok(status == STATUS_SUCCESS || status == STATUS_BAD_COMPRESSION_BUFFER,
+           "%s, corrupted byte %lu: status 0x%08lx\n", name, i, status);
+        if (status == STATUS_SUCCESS)
+            ok(final_size <= 2 * CHUNK_SIZE, "%s, corrupted byte %lu: size %lu\n", name, i, final_size);
+        ok(GuardIntact(out, 2 * CHUNK_SIZE), "%s, corrupted byte %lu: written past the buffer\n", name, i);
+    }
+}
+
+START_TEST(lznt1)
+{
+    static const char *Kinds[] = { "random", "runs", "periods", "text" };
+    UCHAR *data, *comp, *out;
+    int kind;
+
+    data = malloc(DATA_SIZE);
+    comp = malloc(DATA_SIZE + DATA_SIZE / CHUNK_SIZE * 2 + 2);
+    out = malloc(DATA_SIZE + GUARD_SIZE);
+    if (!data || !comp || !out)
+    {
+        skip("Out of memory\n");
+        free(data);
+        free(comp);
+        free(out);
+        return;
+    }
+
+    srand(1);
+    TestVectors();
+    for (kind = 0; kind < 4; kind++)
+        TestData(kind, Kinds[kind], data, comp, out);
+
+    free(data);
+    free(comp);
+    free(out);
+}
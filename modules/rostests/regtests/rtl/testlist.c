@@ -0,0 +1,12 @@
+/* Automatically generated file; DO NOT EDIT!! */
+
+#define STANDALONE
+#include <wine/test.h>
+
+extern void func_lznt1(void);
+
+const struct test winetest_testlist[] =
+{
+    { "lznt1", func_lznt1 },
+    { 0, 0 }
+};
@@ -0,0 +1,132 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Sequential read benchmark for fragmented files
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Times unbuffered sequential reads of a file, so that every read goes
+ * through the file system's run mapping, and prints how many extents
+ * the file has. Meant for large fragmented files on an NTFS image
+ * attached to a QEMU VM. Such a file can be made on the host by
+ * growing it and a filler file in turns with write-through, then
+ * deleting the filler.
+ *
+ * Usage: readbench file [passes]
+ */
+
+#include <windows.h>
+#include <winioctl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define READ_SIZE (64 * 1024)
+
+static DWORD
+CountExtents(const char *pszFile)
+{
+    STARTING_VCN_INPUT_BUFFER Input;
+    struct
+    {
+        RETRIEVAL_POINTERS_BUFFER Header;
+        LARGE_INTEGER Extents[2 * 255];
+    } Output;
+    HANDLE hFile;
+    DWORD cbReturned, cExtents = 0;
+    BOOL bMore;
+
+    hFile = CreateFileA(pszFile, FILE_READ_ATTRIBUTES, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, 0, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return 0;
+
+    Input.StartingVcn.QuadPart = 0;
+    do
+    {
+        bMore = !DeviceIoControl(hFile, FSCTL_GET_RETRIEVAL_POINTERS,
+                                 &Input, sizeof(Input), &Output, sizeof(Output),
+                                 &cbReturned, NULL);
+        if (bMore && GetLastError() != ERROR_MORE_DATA)
+            break;
+        if (Output.Header.ExtentCount == 0)
+            break;
+        cExtents += Output.Header.ExtentCount;
+        Input.StartingVcn = Output.Header.Extents[Output.Header.ExtentCount - 1].NextVcn;
+    } while (bMore);
+
+    CloseHandle(hFile);
+    return cExtents;
+}
+
+static double
+TimeRead(const char *pszFile, DWORD dwFlags, PBYTE pBuffer, PLONGLONG pcbTotal)
+{
+    LARGE_INTEGER liFrequency, liStart, liEnd;
+    HANDLE hFile;
+    DWORD cbRead;
+
+    *pcbTotal = 0;
+    hFile = CreateFileA(pszFile, GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, dwFlags, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return -1.0;
+
+    QueryPerformanceFrequency(&liFrequency);
+    QueryPerformanceCounter(&liStart);
+    while (ReadFile(hFile, pBuffer, READ_SIZE, &cbRead, NULL) && cbRead != 0)
+        *pcbTotal += cbRead;
+    QueryPerformanceCounter(&liEnd);
+    CloseHandle(hFile);
+
+    return (double)(liEnd.QuadPart - liStart.QuadPart) / liFrequency.QuadPart;
+}
+
+static void
+PrintResult(const char *pszPass, double dSeconds, LONGLONG cbTotal)
+{
+    double dMegabytes = (double)cbTotal / (1024 * 1024);
+
+    if (dSeconds < 0)
+    {
+        printf("%s: open failed: %lu\n", pszPass, GetLastError());
+        return;
+    }
+    printf("%s: %.1f MB in %.3fs, %.1f MB/s\n", pszPass, dMegabytes, dSeconds,
+           dSeconds > 0 ? dMegabytes / dSeconds : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    LONG cPasses = 3, i;
+    LONGLONG cbTotal;
+    PBYTE pBuffer;
+    double dSeconds;
+    char szPass[32];
+
+    if (argc >= 3)
+        cPasses = atol(argv[2]);
+    if (argc < 2 || cPasses <= 0)
+    {
+        printf("Usage: readbench file [passes]\n");
+        return 1;
+    }
+
+    printf("%s: %lu extents\n", argv[1], CountExtents(argv[1]));
+
+    /* Unbuffered I/O needs a sector aligned buffer */
+    pBuffer = VirtualAlloc(NULL, READ_SIZE, MEM_COMMIT, PAGE_READWRITE);
+    if (!pBuffer)
+        return 1;
+
+    for (i = 0; i < cPasses; i++)
+    {
+        dSeconds = TimeRead(argv[1], FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, pBuffer, &cbTotal);
+        _snprintf(szPass, sizeof(szPass), "unbuffered pass %ld", i + 1);
+        PrintResult(szPass, dSeconds, cbTotal);
+    }
+
+    dSeconds = TimeRead(argv[1], FILE_FLAG_SEQUENTIAL_SCAN, pBuffer, &cbTotal);
+    PrintResult("cached", dSeconds, cbTotal);
+
+    VirtualFree(pBuffer, 0, MEM_RELEASE);
+    return 0;
+}
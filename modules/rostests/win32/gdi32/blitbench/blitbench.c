@@ -0,0 +1,166 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     BitBlt throughput benchmark per format and ROP
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Blits between DIB sections of every supported depth with a set of
+ * ROPs and prints the throughput in MPixels/s. Indexed sources exercise
+ * the table xlate path, equal depths the trivial one and mixed direct
+ * color depths the converting one. The brush is solid, like most brushes
+ * the ROPs with a pattern are used with.
+ *
+ * Usage: blitbench [width height [iterations]]
+ */
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct
+{
+    DWORD dwRop;
+    const char *pszName;
+} ROPINFO;
+
+static const ROPINFO Rops[] =
+{
+    { SRCCOPY, "SRCCOPY" },
+    { SRCAND, "SRCAND" },
+    { SRCINVERT, "SRCINVERT" },
+    { SRCPAINT, "SRCPAINT" },
+    { MERGECOPY, "MERGECOPY" },
+    { PATINVERT, "PATINVERT" },
+    { 0x00B8074A, "PSDPxax" }, /* Generic D,S,P ternary ROP */
+};
+
+static const WORD Depths[] = { 1, 4, 8, 16, 24, 32 };
+
+static HBITMAP
+CreateSection(HDC hdc, WORD wBitCount, LONG cx, LONG cy)
+{
+    struct
+    {
+        BITMAPINFOHEADER bmiHeader;
+        RGBQUAD bmiColors[256];
+    } bmi;
+    HBITMAP hbm;
+    PBYTE pjBits;
+    ULONG i, cjSize;
+
+    ZeroMemory(&bmi, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = cx;
+    bmi.bmiHeader.biHeight = -cy;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = wBitCount;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    /* Some palette that isn't an identity mapping */
+    if (wBitCount <= 8)
+    {
+        for (i = 0; i < (1UL << wBitCount); i++)
+        {
+            bmi.bmiColors[i].rgbRed = (BYTE)(i * 37);
+            bmi.bmiColors[i].rgbGreen = (BYTE)(i * 91);
+            bmi.bmiColors[i].rgbBlue = (BYTE)(255 - i);
+        }
+    }
+
+    hbm = CreateDIBSection(hdc, (BITMAPINFO*)&bmi, DIB_RGB_COLORS, (PVOID*)&pjBits, NULL, 0);
+    if (!hbm)
+        return NULL;
+
+    cjSize = ((cx * wBitCount + 31) / 32) * 4 * cy;
+    for (i = 0; i < cjSize; i++)
+        pjBits[i] = (BYTE)rand();
+
+    return hbm;
+}
+
+int main(int argc, char *argv[])
+{
+    LONG cx = 512, cy = 512, cIterations = 20;
+    LARGE_INTEGER liFrequency, liStart, liEnd;
+    HDC hdcScreen, hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst, hbmSrcOld, hbmDstOld;
+    HBRUSH hbr, hbrOld;
+    ULONG iSrc, iDst, iRop;
+    LONG i;
+    double dSeconds;
+
+    if (argc >= 3)
+    {
+        cx = atol(argv[1]);
+        cy = atol(argv[2]);
+    }
+    if (argc >= 4)
+        cIterations = atol(argv[3]);
+    if (cx <= 0 || cy <= 0 || cIterations <= 0)
+    {
+        printf("Usage: blitbench [width height [iterations]]\n");
+        return 1;
+    }
+
+    QueryPerformanceFrequency(&liFrequency);
+    hdcScreen = GetDC(NULL);
+    hdcSrc = CreateCompatibleDC(hdcScreen);
+    hdcDst = CreateCompatibleDC(hdcScreen);
+    hbr = CreateSolidBrush(RGB(0x40, 0x80, 0xC0));
+    hbrOld = SelectObject(hdcDst, hbr);
+
+    printf("%ldx%ld, %ld iterations, MPixels/s\n", cx, cy, cIterations);
+    printf("src dst");
+    for (iRop = 0; iRop < _countof(Rops); iRop++)
+        printf(" %10s", Rops[iRop].pszName);
+    printf("\n");
+
+    for (iSrc = 0; iSrc < _countof(Depths); iSrc++)
+    {
+        for (iDst = 0; iDst < _countof(Depths); iDst++)
+        {
+            hbmSrc = CreateSection(hdcScreen, Depths[iSrc], cx, cy);
+            hbmDst = CreateSection(hdcScreen, Depths[iDst], cx, cy);
+            if (!hbmSrc || !hbmDst)
+            {
+                printf("Failed to create %u/%u bpp sections\n", Depths[iSrc], Depths[iDst]);
+                if (hbmSrc) DeleteObject(hbmSrc);
+                if (hbmDst) DeleteObject(hbmDst);
+                continue;
+            }
+            hbmSrcOld = SelectObject(hdcSrc, hbmSrc);
+            hbmDstOld = SelectObject(hdcDst, hbmDst);
+
+            printf("%3u %3u", Depths[iSrc], Depths[iDst]);
+            for (iRop = 0; iRop < _countof(Rops); iRop++)
+            {
+                /* Warm up, then time */
+                BitBlt(hdcDst, 0, 0, cx, cy, hdcSrc, 0, 0, Rops[iRop].dwRop);
+                GdiFlush();
+
+                QueryPerformanceCounter(&liStart);
+                for (i = 0; i < cIterations; i++)
+                    BitBlt(hdcDst, 0, 0, cx, cy, hdcSrc, 0, 0, Rops[iRop].dwRop);
+                GdiFlush();
+                QueryPerformanceCounter(&liEnd);
+
+                dSeconds = (double)(liEnd.QuadPart - liStart.QuadPart) / liFrequency.QuadPart;
+                printf(" %10.1f", dSeconds > 0 ?
+                       (double)cx * cy * cIterations / dSeconds / 1000000.0 : 0.0);
+            }
+            printf("\n");
+
+            SelectObject(hdcSrc, hbmSrcOld);
+            SelectObject(hdcDst, hbmDstOld);
+            DeleteObject(hbmSrc);
+            DeleteObject(hbmDst);
+        }
+    }
+
+    SelectObject(hdcDst, hbrOld);
+    DeleteObject(hbr);
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    ReleaseDC(NULL, hdcScreen);
+    return 0;
+}
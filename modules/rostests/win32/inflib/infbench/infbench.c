@@ -0,0 +1,158 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Benchmark for the inflib section and key lookups
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Generates an INF the size of txtsetup.sif, then times loading it and
+ * looking up every section and key by name and every line by Id, which
+ * is what setup does through SetupFindFirstLine and SetupGetLineByIndex.
+ *
+ * Usage: infbench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inflib.h"
+#include "infros.h"
+
+#define SECTIONS 400
+#define LINES    100   /* per section */
+#define KEYS     50    /* distinct keys per section */
+
+static PCHAR BuildInf(PULONG Size)
+{
+    PCHAR Buffer, p;
+    ULONG Section, Line;
+
+    Buffer = malloc(SECTIONS * (16 + LINES * 32));
+    if (Buffer == NULL)
+        return NULL;
+
+    p = Buffer;
+    for (Section = 0; Section < SECTIONS; Section++)
+    {
+        p += sprintf(p, "[Section%03lu]\r\n", Section);
+        for (Line = 0; Line < LINES; Line++)
+            p += sprintf(p, "Key%lu = value%lu\r\n", Line % KEYS, Line);
+    }
+
+    *Size = (ULONG)(p - Buffer);
+    return Buffer;
+}
+
+static void MakeName(PWCHAR Name, const char *Format, ULONG Value)
+{
+    char Ansi[32];
+    ULONG i;
+
+    sprintf(Ansi, Format, Value);
+    for (i = 0; Ansi[i] != 0; i++)
+        Name[i] = (WCHAR)Ansi[i];
+    Name[i] = 0;
+}
+
+static double Seconds(LARGE_INTEGER *Start)
+{
+    LARGE_INTEGER End, Frequency;
+
+    QueryPerformanceCounter(&End);
+    QueryPerformanceFrequency(&Frequency);
+    return (double)(End.QuadPart - Start->QuadPart) / Frequency.QuadPart;
+}
+
+int main(int argc, char *argv[])
+{
+    PINFCACHESECTION Section;
+    LARGE_INTEGER Start;
+    HINF InfHandle = NULL;
+    ULONG Rounds = 10, Round, Size, ErrorLine, Missed = 0, i, j;
+    WCHAR Name[32];
+    PCHAR Buffer;
+    double Time;
+
+    if (argc > 1)
+        Rounds = strtoul(argv[1], NULL, 0);
+    if (Rounds == 0)
+    {
+        printf("Usage: infbench [rounds]\n");
+        return 1;
+    }
+
+    Buffer = BuildInf(&Size);
+    if (Buffer == NULL)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    QueryPerformanceCounter(&Start);
+    for (Round = 0; Round < Rounds; Round++)
+    {
+        if (InfHandle != NULL)
+            InfCloseFile(InfHandle);
+        if (!INF_SUCCESS(InfOpenBufferedFile(&InfHandle, Buffer, Size, 0, &ErrorLine)))
+        {
+            printf("INF not loaded, error on line %lu\n", ErrorLine);
+            free(Buffer);
+            return 1;
+        }
+    }
+    Time = Seconds(&Start);
+    free(Buffer);
+    printf("Load:           %8.3f ms (%lu bytes)\n", Time * 1000 / Rounds, Size);
+
+    QueryPerformanceCounter(&Start);
+    for (Round = 0; Round < Rounds; Round++)
+    {
+        for (i = 0; i < SECTIONS; i++)
+        {
+            MakeName(Name, "Section%03lu", i);
+            Section = InfpFindSection((PINFCACHE)InfHandle, Name);
+            if (Section == NULL)
+            {
+                Missed++;
+                continue;
+            }
+            for (j = 0; j < KEYS; j++)
+            {
+                MakeName(Name, "Key%lu", j);
+                if (InfpFindKeyLine(Section, Name) == NULL)
+                    Missed++;
+            }
+        }
+    }
+    Time = Seconds(&Start);
+    printf("Lookup by name: %8.3f ms (%d sections, %d keys)\n", Time * 1000 / Rounds, SECTIONS, SECTIONS * KEYS);
+
+    QueryPerformanceCounter(&Start);
+    for (Round = 0; Round < Rounds; Round++)
+    {
+        for (i = 1; i <= SECTIONS; i++)
+        {
+            Section = InfpFindSectionById((PINFCACHE)InfHandle, i);
+            if (Section == NULL)
+            {
+                Missed++;
+                continue;
+            }
+            for (j = 1; j <= LINES; j++)
+            {
+                if (InfpFindLineById(Section, j) == NULL)
+                    Missed++;
+            }
+        }
+    }
+    Time = Seconds(&Start);
+    printf("Lookup by Id:   %8.3f ms (%d sections, %d lines)\n", Time * 1000 / Rounds, SECTIONS, SECTIONS * LINES);
+
+    InfCloseFile(InfHandle);
+
+    if (Missed != 0)
+    {
+        printf("%lu lookups failed\n", Missed);
+        return 1;
+    }
+    return 0;
+}
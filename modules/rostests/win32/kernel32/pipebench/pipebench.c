@@ -0,0 +1,240 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Named pipe latency and throughput benchmark
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * An echo thread serves each message-mode pipe instance. The ping-pong
+ * test sends messages of increasing size and waits for each echo, so
+ * the echo thread always has a read pending when the data arrives. The
+ * parallel test runs several client/echo pairs on separate pipes at the
+ * same time, which shows whether unrelated pipes contend with each other.
+ *
+ * Usage: pipebench [round trips] [pipes]
+ */
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_MESSAGE_SIZE 65536
+#define MAX_PIPES        16
+
+typedef struct _PIPE_PAIR
+{
+    HANDLE hServer;
+    HANDLE hClient;
+    HANDLE hEchoThread;
+    HANDLE hClientThread;
+    LONG cRoundTrips;
+    LONG cDone;
+} PIPE_PAIR, *PPIPE_PAIR;
+
+static HANDLE hStartEvent;
+
+/* Reads messages and writes them back until the client goes away */
+static DWORD WINAPI
+EchoThread(LPVOID lpParameter)
+{
+    PPIPE_PAIR pPair = lpParameter;
+    PBYTE Buffer;
+    DWORD cbRead, cbWritten;
+
+    Buffer = malloc(MAX_MESSAGE_SIZE);
+    if (!Buffer)
+        return 1;
+
+    if (ConnectNamedPipe(pPair->hServer, NULL) ||
+        GetLastError() == ERROR_PIPE_CONNECTED)
+    {
+        while (ReadFile(pPair->hServer, Buffer, MAX_MESSAGE_SIZE, &cbRead, NULL))
+        {
+            if (!WriteFile(pPair->hServer, Buffer, cbRead, &cbWritten, NULL))
+                break;
+        }
+
+        DisconnectNamedPipe(pPair->hServer);
+    }
+
+    free(Buffer);
+    return 0;
+}
+
+static BOOL
+OpenPipePair(PPIPE_PAIR pPair, LONG Index)
+{
+    CHAR szName[MAX_PATH];
+    DWORD dwMode = PIPE_READMODE_MESSAGE;
+
+    ZeroMemory(pPair, sizeof(*pPair));
+    sprintf(szName, "\\\\.\\pipe\\pipebench_%lu_%ld", GetCurrentProcessId(), Index);
+
+    pPair->hServer = CreateNamedPipeA(szName,
+                                      PIPE_ACCESS_DUPLEX,
+                                      PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+                                      1,
+                                      4096,
+                                      4096,
+                                      0,
+                                      NULL);
+    if (pPair->hServer == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    pPair->hEchoThread = CreateThread(NULL, 0, EchoThread, pPair, 0, NULL);
+    if (!pPair->hEchoThread)
+        return FALSE;
+
+    if (!WaitNamedPipeA(szName, 5000))
+        return FALSE;
+
+    pPair->hClient = CreateFileA(szName,
+                                 GENERIC_READ | GENERIC_WRITE,
+                                 0,
+                                 NULL,
+                                 OPEN_EXISTING,
+                                 0,
+                                 NULL);
+    if (pPair->hClient == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    return SetNamedPipeHandleState(pPair->hClient, &dwMode, NULL, NULL);
+}
+
+static VOID
+ClosePipePair(PPIPE_PAIR pPair)
+{
+    CloseHandle(pPair->hClient);
+    WaitForSingleObject(pPair->hEchoThread, INFINITE);
+    CloseHandle(pPair->hEchoThread);
+    CloseHandle(pPair->hServer);
+}
+
+static LONG
+PingPong(PPIPE_PAIR pPair, PBYTE Buffer, DWORD cbMessage, LONG cRoundTrips)
+{
+    DWORD cbDone;
+    LONG i;
+
+    for (i = 0; i < cRoundTrips; i++)
+    {
+        if (!WriteFile(pPair->hClient, Buffer, cbMessage, &cbDone, NULL))
+            break;
+        if (!ReadFile(pPair->hClient, Buffer, cbMessage, &cbDone, NULL) ||
+            cbDone != cbMessage)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static DWORD WINAPI
+ClientThread(LPVOID lpParameter)
+{
+    PPIPE_PAIR pPair = lpParameter;
+    BYTE Buffer[64] = { 0 };
+
+    WaitForSingleObject(hStartEvent, INFINITE);
+    pPair->cDone = PingPong(pPair, Buffer, sizeof(Buffer), pPair->cRoundTrips);
+    return 0;
+}
+
+static double
+Elapsed(const LARGE_INTEGER *pliStart)
+{
+    LARGE_INTEGER liFrequency, liEnd;
+
+    QueryPerformanceCounter(&liEnd);
+    QueryPerformanceFrequency(&liFrequency);
+    return (double)(liEnd.QuadPart - pliStart->QuadPart) / liFrequency.QuadPart;
+}
+
+int main(int argc, char *argv[])
+{
+    static const DWORD MessageSizes[] = { 16, 512, 4096, MAX_MESSAGE_SIZE };
+    static PIPE_PAIR Pairs[MAX_PIPES];
+    LONG cRoundTrips = 20000, cPipes = 4, cTrips, cTotal, i;
+    LARGE_INTEGER liStart;
+    PBYTE Buffer;
+    double dSeconds;
+
+    if (argc >= 2)
+        cRoundTrips = atol(argv[1]);
+    if (argc >= 3)
+        cPipes = atol(argv[2]);
+    if (cRoundTrips <= 0 || cPipes <= 0 || cPipes > MAX_PIPES)
+    {
+        printf("Usage: pipebench [round trips] [pipes (1-%d)]\n", MAX_PIPES);
+        return 1;
+    }
+
+    Buffer = malloc(MAX_MESSAGE_SIZE);
+    hStartEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    if (!Buffer || !hStartEvent || !OpenPipePair(&Pairs[0], 0))
+    {
+        printf("Setup failed: %lu\n", GetLastError());
+        return 1;
+    }
+    FillMemory(Buffer, MAX_MESSAGE_SIZE, 0x5A);
+
+    /* Warm up */
+    PingPong(&Pairs[0], Buffer, 16, 100);
+
+    for (i = 0; i < (LONG)ARRAYSIZE(MessageSizes); i++)
+    {
+        /* Keep the amount of data roughly constant for the large messages */
+        cTrips = cRoundTrips;
+        if (MessageSizes[i] > 4096)
+            cTrips = max(cRoundTrips / 16, 1);
+
+        QueryPerformanceCounter(&liStart);
+        cTrips = PingPong(&Pairs[0], Buffer, MessageSizes[i], cTrips);
+        dSeconds = Elapsed(&liStart);
+
+        printf("ping-pong %5lu bytes: %ld round trips in %.3fs, %.1f us each, %.1f MB/s\n",
+               MessageSizes[i], cTrips, dSeconds,
+               cTrips ? dSeconds * 1e6 / cTrips : 0.0,
+               dSeconds > 0 ? 2.0 * MessageSizes[i] * cTrips / dSeconds / (1024 * 1024) : 0.0);
+    }
+
+    ClosePipePair(&Pairs[0]);
+
+    for (i = 0; i < cPipes; i++)
+    {
+        if (!OpenPipePair(&Pairs[i], i))
+        {
+            printf("Opening pipe %ld failed: %lu\n", i, GetLastError());
+            return 1;
+        }
+        Pairs[i].cRoundTrips = cRoundTrips;
+        Pairs[i].hClientThread = CreateThread(NULL, 0, ClientThread, &Pairs[i], 0, NULL);
+        if (!Pairs[i].hClientThread)
+        {
+            printf("CreateThread failed: %lu\n", GetLastError());
+            return 1;
+        }
+    }
+
+    QueryPerformanceCounter(&liStart);
+    SetEvent(hStartEvent);
+
+    cTotal = 0;
+    for (i = 0; i < cPipes; i++)
+    {
+        WaitForSingleObject(Pairs[i].hClientThread, INFINITE);
+        CloseHandle(Pairs[i].hClientThread);
+        cTotal += Pairs[i].cDone;
+    }
+    dSeconds = Elapsed(&liStart);
+
+    printf("parallel %ld pipes: %ld round trips in %.3fs, %.0f/s\n",
+           cPipes, cTotal, dSeconds, dSeconds > 0 ? cTotal / dSeconds : 0.0);
+
+    for (i = 0; i < cPipes; i++)
+        ClosePipePair(&Pairs[i]);
+
+    CloseHandle(hStartEvent);
+    free(Buffer);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     LZNT1 decompression benchmark for RtlDecompressBuffer
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Compresses generated data of four kinds with a small LZNT1 encoder
+ * (RtlCompressBuffer only stores chunks in ReactOS) and prints how fast
+ * RtlDecompressBuffer expands it, so that ntdll builds can be compared.
+ *
+ * Usage: lzntbench [rounds]
+ */
+
+#define WIN32_NO_STATUS
+#include <windows.h>
+#include <ndk/rtlfuncs.h>
+#include <ntstatus.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHUNK_SIZE 0x1000
+#define DATA_SIZE (1024 * 1024)
+
+/* Greedy LZNT1 encoder, good enough to produce every kind of token */
+static ULONG
+MatchLength(const UCHAR *src, ULONG pos, ULONG size, ULONG disp, ULONG max_len)
+{
+    ULONG len;
+
+    for (len = 0; len < max_len && pos + len < size && src[pos + len] == src[pos + len - disp]; len++);
+    return len;
+}
+
+static ULONG
+CompressChunk(const UCHAR *src, ULONG size, UCHAR *dst)
+{
+    static short head[4096], prev[CHUNK_SIZE];
+    ULONG pos = 0, out = 2, flags_pos, token, bits, max_disp, max_len;
+    ULONG best_len, best_disp, len, disp, hash, depth;
+    long cand;
+    UCHAR flags;
+
+    memset(head, 0xff, sizeof(head));
+
+    while (pos < size)
+    {
+        flags_pos = out++;
+        flags = 0;
+        for (token = 0; token < 8 && pos < size; token++)
+        {
+            for (bits = 4; bits < 12 && (1UL << bits) < pos; bits++);
+            max_disp = min(1UL << bits, pos);
+            max_len = (1UL << (16 - bits)) + 2;
+
+            /* Short periods first, then the positions with the same three bytes */
+            best_len = 0;
+            best_disp = 0;
+            for (disp = 1; disp <= 3 && disp <= max_disp; disp++)
+            {
+                len = MatchLength(src, pos, size, disp, max_len);
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_disp = disp;
+                }
+            }
+
+            hash = (pos + 2 < size) ? ((src[pos] << 4) ^ (src[pos + 1] << 2) ^ src[pos + 2]) & 0xfff : 0;
+            for (cand = head[hash], depth = 0;
+                 pos + 2 < size && cand >= 0 && pos - cand <= max_disp && depth < 32;
+                 cand = prev[cand], depth++)
+            {
+                len = MatchLength(src, pos, size, pos - cand, max_len);
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_disp = pos - cand;
+                }
+            }
+
+            len = (best_len >= 3) ? best_len : 1;
+            if (best_len >= 3)
+            {
+                *(WORD *)(dst + out) = (WORD)(((best_disp - 1) << (16 - bits)) | (best_len - 3));
+                out += 2;
+                flags |= 1 << token;
+            }
+            else
+            {
+                dst[out++] = src[pos];
+            }
+
+            /* Index the positions we're moving over */
+            for (; len > 0; len--, pos++)
+            {
+                if (pos + 2 < size)
+                {
+                    hash = ((src[pos] << 4) ^ (src[pos + 1] << 2) ^ src[pos + 2]) & 0xfff;
+                    prev[pos] = head[hash];
+                    head[hash] = (short)pos;
+                }
+            }
+        }
+        dst[flags_pos] = flags;
+    }
+
+    if (out - 2 >= size)
+    {
+        /* Not worth it, store the chunk */
+        *(WORD *)dst = (WORD)(0x3000 | (size - 1));
+        memcpy(dst + 2, src, size);
+        return size + 2;
+    }
+
+    *(WORD *)dst = (WORD)(0xB000 | (out - 2 - 1));
+    return out;
+}
+
+static ULONG
+Compress(const UCHAR *src, ULONG size, UCHAR *dst)
+{
+    ULONG pos, out = 0;
+
+    for (pos = 0; pos < size; pos += CHUNK_SIZE)
+        out += CompressChunk(src + pos, min(CHUNK_SIZE, size - pos), dst + out);
+
+    return out;
+}
+
+static void
+Generate(UCHAR *data, ULONG size, int kind)
+{
+    ULONG i, j, len, period;
+
+    for (i = 0; i < size; )
+    {
+        switch (kind)
+        {
+            case 0: /* incompressible */
+                data[i++] = (UCHAR)rand();
+                break;
+
+            case 1: /* single byte runs */
+                len = 1 + rand() % 300;
+                memset(data + i, rand(), min(len, size - i));
+                i += min(len, size - i);
+                break;
+
+            case 2: /* short periods, displacements 2 and 3 */
+                len = 1 + rand() % 200;
+                period = 2 + rand() % 2;
+                for (j = 0; j < len && i < size; j++, i++)
+                    data[i] = "abc"[j % period];
+                break;
+
+            default: /* text made of a small vocabulary */
+            {
+                static const char *Words[] = { "ReactOS ", "NTFS ", "compression ",
+                                               "unit ", "cluster ", "\r\n", "the " };
+                const char *w = Words[rand() % (sizeof(Words) / sizeof(Words[0]))];
+                for (j = 0; w[j] && i < size; j++)
+                    data[i++] = w[j];
+                if (rand() % 16 == 0 && i < size)
+                    data[i++] = (UCHAR)rand();
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *Kinds[] = { "random", "runs", "periods", "text" };
+    LARGE_INTEGER liFrequency, liStart, liEnd;
+    UCHAR *data, *comp, *out;
+    ULONG comp_size, final_size;
+    NTSTATUS status;
+    double dSeconds;
+    LONG lRounds = 20, i;
+    int kind;
+
+    if (argc >= 2)
+        lRounds = atol(argv[1]);
+    if (lRounds <= 0)
+    {
+        printf("Usage: lzntbench [rounds]\n");
+        return 1;
+    }
+
+    data = malloc(DATA_SIZE);
+    comp = malloc(DATA_SIZE + DATA_SIZE / CHUNK_SIZE * 2 + 2);
+    out = malloc(DATA_SIZE);
+    if (!data || !comp || !out)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    QueryPerformanceFrequency(&liFrequency);
+    srand(1);
+
+    for (kind = 0; kind < 4; kind++)
+    {
+        Generate(data, DATA_SIZE, kind);
+        comp_size = Compress(data, DATA_SIZE, comp);
+
+        status = RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, DATA_SIZE, comp, comp_size, &final_size);
+        if (status != STATUS_SUCCESS || final_size != DATA_SIZE || memcmp(out, data, DATA_SIZE) != 0)
+        {
+            printf("%s: decompression failed, status 0x%08lx, size %lu\n", Kinds[kind], status, final_size);
+            continue;
+        }
+
+        QueryPerformanceCounter(&liStart);
+        for (i = 0; i < lRounds; i++)
+            RtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, out, DATA_SIZE, comp, comp_size, &final_size);
+        QueryPerformanceCounter(&liEnd);
+
+        dSeconds = (double)(liEnd.QuadPart - liStart.QuadPart) / liFrequency.QuadPart;
+        printf("%-8s ratio %5.1f%%, %7.1f MB/s\n", Kinds[kind], 100.0 * comp_size / DATA_SIZE,
+               dSeconds > 0 ? lRounds * (double)DATA_SIZE / dSeconds / (1024 * 1024) : 0.0);
+    }
+
+    free(data);
+    free(comp);
+    free(out);
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * PROJECT:     ReactOS Tests
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     PostMessage/GetMessage throughput benchmark
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Two threads with a message-only window each. In the ping-pong test
+ * every posted message is answered with a post back, so each round trip
+ * includes a wake of the other thread. In the burst test the producer
+ * posts batches without waiting, the way high-rate producers do.
+ *
+ * Usage: postbench [messages]
+ */
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WM_PING     (WM_APP + 1)
+#define WM_PONG     (WM_APP + 2)
+#define WM_BURST    (WM_APP + 3)
+#define WM_BURSTEND (WM_APP + 4)
+
+#define BURST_SIZE 256
+
+static HWND hwndConsumer;
+static HANDLE hReadyEvent;
+
+static HWND
+CreateMessageWindow(VOID)
+{
+    return CreateWindowExA(0, "Static", NULL, 0, 0, 0, 0, 0,
+                           HWND_MESSAGE, NULL, GetModuleHandleA(NULL), NULL);
+}
+
+/* Echoes pings back and acknowledges the end of each burst */
+static DWORD WINAPI
+ConsumerThread(LPVOID lpParameter)
+{
+    MSG msg;
+
+    hwndConsumer = CreateMessageWindow();
+    SetEvent(hReadyEvent);
+    if (!hwndConsumer)
+        return 1;
+
+    while (GetMessageA(&msg, NULL, 0, 0) > 0)
+    {
+        if (msg.message == WM_PING || msg.message == WM_BURSTEND)
+            PostMessageA((HWND)msg.lParam, WM_PONG, msg.wParam, 0);
+    }
+
+    DestroyWindow(hwndConsumer);
+    return 0;
+}
+
+static BOOL
+WaitForPong(VOID)
+{
+    MSG msg;
+
+    while (GetMessageA(&msg, NULL, 0, 0) > 0)
+    {
+        if (msg.message == WM_PONG)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static double
+Elapsed(const LARGE_INTEGER *pliStart)
+{
+    LARGE_INTEGER liFrequency, liEnd;
+
+    QueryPerformanceCounter(&liEnd);
+    QueryPerformanceFrequency(&liFrequency);
+    return (double)(liEnd.QuadPart - pliStart->QuadPart) / liFrequency.QuadPart;
+}
+
+int main(int argc, char *argv[])
+{
+    LONG cMessages = 100000, i, j;
+    LARGE_INTEGER liStart;
+    HANDLE hThread;
+    HWND hwndProducer;
+    double dSeconds;
+
+    if (argc >= 2)
+        cMessages = atol(argv[1]);
+    if (cMessages <= 0)
+    {
+        printf("Usage: postbench [messages]\n");
+        return 1;
+    }
+
+    hwndProducer = CreateMessageWindow();
+    hReadyEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    hThread = CreateThread(NULL, 0, ConsumerThread, NULL, 0, NULL);
+    if (!hwndProducer || !hReadyEvent || !hThread)
+    {
+        printf("Setup failed: %lu\n", GetLastError());
+        return 1;
+    }
+    WaitForSingleObject(hReadyEvent, INFINITE);
+    if (!hwndConsumer)
+    {
+        printf("Consumer window creation failed\n");
+        return 1;
+    }
+
+    /* Warm up */
+    PostMessageA(hwndConsumer, WM_PING, 0, (LPARAM)hwndProducer);
+    WaitForPong();
+
+    QueryPerformanceCounter(&liStart);
+    for (i = 0; i < cMessages; i++)
+    {
+        PostMessageA(hwndConsumer, WM_PING, i, (LPARAM)hwndProducer);
+        if (!WaitForPong())
+            break;
+    }
+    dSeconds = Elapsed(&liStart);
+    printf("ping-pong: %ld round trips in %.3fs, %.0f/s\n",
+           i, dSeconds, dSeconds > 0 ? i / dSeconds : 0.0);
+
+    QueryPerformanceCounter(&liStart);
+    for (i = 0; i < cMessages; i += BURST_SIZE)
+    {
+        for (j = 0; j < BURST_SIZE - 1; j++)
+            PostMessageA(hwndConsumer, WM_BURST, i + j, (LPARAM)hwndProducer);
+        PostMessageA(hwndConsumer, WM_BURSTEND, i + j, (LPARAM)hwndProducer);
+        if (!WaitForPong())
+            break;
+    }
+    dSeconds = Elapsed(&liStart);
+    printf("burst of %d: %ld messages in %.3fs, %.0f/s\n",
+           BURST_SIZE, i, dSeconds, dSeconds > 0 ? i / dSeconds : 0.0);
+
+    PostMessageA(hwndConsumer, WM_QUIT, 0, 0);
+    WaitForSingleObject(hThread, INFINITE);
+    CloseHandle(hThread);
+    CloseHandle(hReadyEvent);
+    DestroyWindow(hwndProducer);
+    return 0;
+}
@@ -14,7 +14,9 @@
 
 /* INTERNAL TYPES *************************************************************/
 
-#define NUM_KEY_HASH_BUCKETS 23
+/* Must be a power of two, see ExpKeyedEventHashIndex */
+#define NUM_KEY_HASH_BUCKETS_SHIFT 7
+#define NUM_KEY_HASH_BUCKETS (1 << NUM_KEY_HASH_BUCKETS_SHIFT)
 typedef struct _EX_KEYED_EVENT
 {
     struct
@@ -41,6 +43,31 @@ GENERIC_MAPPING ExpKeyedEventMapping =
 
 /* FUNCTIONS *****************************************************************/
 
+FORCEINLINE
+ULONG
+ExpKeyedEventHashIndex(
+    _In_ PVOID KeyedWaitValue,
+    _In_ PEPROCESS Process)
+{
+    ULONG_PTR Value;
+    ULONG Hash;
+
+    /* Keys are two-byte aligned and processes are pool allocations, so
+       drop the always-zero low bits before mixing in the process. This
+       keeps the same key used by different processes in different
+       buckets, so one process' contention doesn't lengthen another's. */
+    Value = ((ULONG_PTR)KeyedWaitValue >> 1) ^ ((ULONG_PTR)Process >> 4);
+#ifdef _WIN64
+    Hash = (ULONG)Value ^ (ULONG)(Value >> 32);
+#else
+    Hash = (ULONG)Value;
+#endif
+
+    /* Multiplicative hash: neighbouring keys (e.g. adjacent locks in an
+       array) end up in different buckets */
+    return (Hash * 0x9E3779B1UL) >> (32 - NUM_KEY_HASH_BUCKETS_SHIFT);
+}
+
 _IRQL_requires_max_(APC_LEVEL)
 INIT_FUNCTION
 BOOLEAN
@@ -121,16 +148,14 @@ ExpReleaseOrWaitForKeyedEvent(
     PEPROCESS CurrentProcess;
     PLIST_ENTRY ListEntry, WaitListHead1, WaitListHead2;
     NTSTATUS Status;
-    ULONG_PTR HashIndex;
+    ULONG HashIndex;
     PVOID PreviousKeyedWaitValue;
 
     /* Get the current process */
     CurrentProcess = PsGetCurrentProcess();
 
     /* Calculate the hash index */
-    HashIndex = (ULONG_PTR)KeyedWaitValue >> 5;
-    HashIndex ^= (ULONG_PTR)CurrentProcess >> 6;
-    HashIndex %= NUM_KEY_HASH_BUCKETS;
+    HashIndex = ExpKeyedEventHashIndex(KeyedWaitValue, CurrentProcess);
 
     /* Lock the lists */
     KeEnterCriticalRegion();
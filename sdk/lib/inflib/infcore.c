@@ -18,6 +18,7 @@
 #define MAX_FIELD_LEN         511  /* larger fields get silently truncated */
 /* actual string limit is MAX_INF_STRING_LENGTH+1 (plus terminating null) under Windows */
 #define MAX_STRING_LEN        (MAX_INF_STRING_LENGTH+1)
+#define MIN_TABLE_SIZE        16   /* initial size of the hash tables and Id arrays */
 
 
 /* parser definitions */
@@ -133,25 +134,200 @@ InfpFreeSection (PINFCACHESECTION Section)
     }
   Section->LastLine = NULL;
 
+  if (Section->KeyHash != NULL)
+    {
+      FREE (Section->KeyHash);
+    }
+
+  if (Section->LineById != NULL)
+    {
+      FREE (Section->LineById);
+    }
+
   FREE (Section);
 
   return Next;
 }
 
 
+VOID
+InfpFreeCache (PINFCACHE Cache)
+{
+  while (Cache->FirstSection != NULL)
+    {
+      Cache->FirstSection = InfpFreeSection(Cache->FirstSection);
+    }
+  Cache->LastSection = NULL;
+
+  if (Cache->SectionHash != NULL)
+    {
+      FREE (Cache->SectionHash);
+    }
+
+  if (Cache->SectionById != NULL)
+    {
+      FREE (Cache->SectionById);
+    }
+
+  FREE (Cache);
+}
+
+
+/* hash a section name or key ignoring case, the same way strcmpiW compares them */
+static ULONG
+InfpHashName(PCWSTR Name)
+{
+  ULONG Hash = 0;
+
+  while (*Name != 0)
+    {
+      Hash = Hash * 31 + tolowerW(*Name);
+      Name++;
+    }
+
+  return Hash;
+}
+
+
+/* make room for Count entries in an Id array, doubling its size when it is full */
+static PVOID
+InfpGrowIdArray(PVOID Array,
+                PULONG Size,
+                ULONG Count)
+{
+  PVOID NewArray;
+  ULONG NewSize;
+
+  if (Count <= *Size)
+    {
+      return Array;
+    }
+
+  NewSize = (*Size != 0) ? *Size * 2 : MIN_TABLE_SIZE;
+  NewArray = MALLOC(NewSize * sizeof(PVOID));
+  if (NewArray == NULL)
+    {
+      DPRINT("MALLOC() failed\n");
+      return NULL;
+    }
+  ZEROMEMORY(NewArray,
+             NewSize * sizeof(PVOID));
+
+  if (Array != NULL)
+    {
+      MEMCPY(NewArray, Array, *Size * sizeof(PVOID));
+      FREE(Array);
+    }
+
+  *Size = NewSize;
+
+  return NewArray;
+}
+
+
+/* double the section hash table once it holds as many sections as it has buckets */
+static BOOLEAN
+InfpGrowSectionHash(PINFCACHE Cache)
+{
+  PINFCACHESECTION *NewHash;
+  PINFCACHESECTION Section, Next;
+  ULONG NewSize, Bucket, i;
+
+  if (Cache->SectionCount < Cache->SectionHashSize)
+    {
+      return TRUE;
+    }
+
+  NewSize = (Cache->SectionHashSize != 0) ? Cache->SectionHashSize * 2 : MIN_TABLE_SIZE;
+  NewHash = (PINFCACHESECTION *)MALLOC(NewSize * sizeof(PINFCACHESECTION));
+  if (NewHash == NULL)
+    {
+      DPRINT("MALLOC() failed\n");
+      return FALSE;
+    }
+  ZEROMEMORY(NewHash,
+             NewSize * sizeof(PINFCACHESECTION));
+
+  for (i = 0; i < Cache->SectionHashSize; i++)
+    {
+      for (Section = Cache->SectionHash[i]; Section != NULL; Section = Next)
+        {
+          Next = Section->NextName;
+          Bucket = InfpHashName(Section->Name) & (NewSize - 1);
+          Section->NextName = NewHash[Bucket];
+          NewHash[Bucket] = Section;
+        }
+    }
+
+  if (Cache->SectionHash != NULL)
+    {
+      FREE(Cache->SectionHash);
+    }
+  Cache->SectionHash = NewHash;
+  Cache->SectionHashSize = NewSize;
+
+  return TRUE;
+}
+
+
+/* double the key hash table of a section once it holds as many keys as it has buckets */
+static BOOLEAN
+InfpGrowKeyHash(PINFCACHESECTION Section)
+{
+  PINFCACHELINE *NewHash;
+  PINFCACHELINE Line, Next;
+  ULONG NewSize, Bucket, i;
+
+  if (Section->KeyCount < Section->KeyHashSize)
+    {
+      return TRUE;
+    }
+
+  NewSize = (Section->KeyHashSize != 0) ? Section->KeyHashSize * 2 : MIN_TABLE_SIZE;
+  NewHash = (PINFCACHELINE *)MALLOC(NewSize * sizeof(PINFCACHELINE));
+  if (NewHash == NULL)
+    {
+      DPRINT("MALLOC() failed\n");
+      return FALSE;
+    }
+  ZEROMEMORY(NewHash,
+             NewSize * sizeof(PINFCACHELINE));
+
+  for (i = 0; i < Section->KeyHashSize; i++)
+    {
+      for (Line = Section->KeyHash[i]; Line != NULL; Line = Next)
+        {
+          Next = Line->NextKey;
+          Bucket = InfpHashName(Line->Key) & (NewSize - 1);
+          Line->NextKey = NewHash[Bucket];
+          NewHash[Bucket] = Line;
+        }
+    }
+
+  if (Section->KeyHash != NULL)
+    {
+      FREE(Section->KeyHash);
+    }
+  Section->KeyHash = NewHash;
+  Section->KeyHashSize = NewSize;
+
+  return TRUE;
+}
+
+
 PINFCACHESECTION
 InfpFindSection(PINFCACHE Cache,
                 PCWSTR Name)
 {
   PINFCACHESECTION Section = NULL;
 
-  if (Cache == NULL || Name == NULL)
+  if (Cache == NULL || Name == NULL || Cache->SectionHashSize == 0)
     {
       return NULL;
     }
 
-  /* iterate through list of sections */
-  Section = Cache->FirstSection;
+  /* iterate through the sections with the same hash */
+  Section = Cache->SectionHash[InfpHashName(Name) & (Cache->SectionHashSize - 1)];
   while (Section != NULL)
     {
       if (strcmpiW(Section->Name, Name) == 0)
@@ -160,7 +336,7 @@ InfpFindSection(PINFCACHE Cache,
         }
 
       /* get the next section*/
-      Section = Section->Next;
+      Section = Section->NextName;
     }
 
   return NULL;
@@ -172,6 +348,8 @@ InfpAddSection(PINFCACHE Cache,
                PCWSTR Name)
 {
   PINFCACHESECTION Section = NULL;
+  PINFCACHESECTION *Bucket;
+  PINFCACHESECTION *SectionById;
   ULONG Size;
 
   if (Cache == NULL || Name == NULL)
@@ -180,6 +358,21 @@ InfpAddSection(PINFCACHE Cache,
       return NULL;
     }
 
+  /* Make room for the new section in the lookup tables */
+  SectionById = (PINFCACHESECTION *)InfpGrowIdArray(Cache->SectionById,
+                                                    &Cache->SectionByIdSize,
+                                                    Cache->NextSectionId + 1);
+  if (SectionById == NULL)
+    {
+      return NULL;
+    }
+  Cache->SectionById = SectionById;
+
+  if (!InfpGrowSectionHash(Cache))
+    {
+      return NULL;
+    }
+
   /* Allocate and initialize the new section */
   Size = (ULONG)FIELD_OFFSET(INFCACHESECTION,
                              Name[strlenW(Name) + 1]);
@@ -209,6 +402,20 @@ InfpAddSection(PINFCACHE Cache,
       Cache->LastSection = Section;
     }
 
+  Cache->SectionById[Section->Id - 1] = Section;
+
+  /* Only the first section of a name is found by name */
+  Bucket = &Cache->SectionHash[InfpHashName(Name) & (Cache->SectionHashSize - 1)];
+  while (*Bucket != NULL && strcmpiW((*Bucket)->Name, Name) != 0)
+    {
+      Bucket = &(*Bucket)->NextName;
+    }
+  if (*Bucket == NULL)
+    {
+      *Bucket = Section;
+      Cache->SectionCount++;
+    }
+
   return Section;
 }
 
@@ -217,6 +424,7 @@ PINFCACHELINE
 InfpAddLine(PINFCACHESECTION Section)
 {
   PINFCACHELINE Line;
+  PINFCACHELINE *LineById;
 
   if (Section == NULL)
     {
@@ -224,6 +432,16 @@ InfpAddLine(PINFCACHESECTION Section)
       return NULL;
     }
 
+  /* Make room for the new line in the Id array */
+  LineById = (PINFCACHELINE *)InfpGrowIdArray(Section->LineById,
+                                              &Section->LineByIdSize,
+                                              Section->NextLineId + 1);
+  if (LineById == NULL)
+    {
+      return NULL;
+    }
+  Section->LineById = LineById;
+
   Line = (PINFCACHELINE)MALLOC(sizeof(INFCACHELINE));
   if (Line == NULL)
     {
@@ -247,6 +465,7 @@ InfpAddLine(PINFCACHESECTION Section)
       Section->LastLine = Line;
     }
   Section->LineCount++;
+  Section->LineById[Line->Id - 1] = Line;
 
   return Line;
 }
@@ -254,19 +473,12 @@ InfpAddLine(PINFCACHESECTION Section)
 PINFCACHESECTION
 InfpFindSectionById(PINFCACHE Cache, UINT Id)
 {
-    PINFCACHESECTION Section;
-
-    for (Section = Cache->FirstSection;
-         Section != NULL;
-         Section = Section->Next)
+    if (Id == 0 || Id > Cache->NextSectionId)
     {
-        if (Section->Id == Id)
-        {
-            return Section;
-        }
+        return NULL;
     }
 
-    return NULL;
+    return Cache->SectionById[Id - 1];
 }
 
 PINFCACHESECTION
@@ -291,19 +503,12 @@ InfpGetSectionForContext(PINFCONTEXT Context)
 PINFCACHELINE
 InfpFindLineById(PINFCACHESECTION Section, UINT Id)
 {
-    PINFCACHELINE Line;
-
-    for (Line = Section->FirstLine;
-         Line != NULL;
-         Line = Line->Next)
+    if (Id == 0 || Id > Section->NextLineId)
     {
-        if (Line->Id == Id)
-        {
-            return Line;
-        }
+        return NULL;
     }
 
-    return NULL;
+    return Section->LineById[Id - 1];
 }
 
 PINFCACHELINE
@@ -321,10 +526,13 @@ InfpGetLineForContext(PINFCONTEXT Context)
 }
 
 PVOID
-InfpAddKeyToLine(PINFCACHELINE Line,
+InfpAddKeyToLine(PINFCACHESECTION Section,
+                 PINFCACHELINE Line,
                  PCWSTR Key)
 {
-  if (Line == NULL)
+  PINFCACHELINE *Bucket;
+
+  if (Section == NULL || Line == NULL)
     {
       DPRINT1("Invalid Line\n");
       return NULL;
@@ -336,6 +544,11 @@ InfpAddKeyToLine(PINFCACHELINE Line,
       return NULL;
     }
 
+  if (!InfpGrowKeyHash(Section))
+    {
+      return NULL;
+    }
+
   Line->Key = (PWCHAR)MALLOC((strlenW(Key) + 1) * sizeof(WCHAR));
   if (Line->Key == NULL)
     {
@@ -345,6 +558,24 @@ InfpAddKeyToLine(PINFCACHELINE Line,
 
   strcpyW(Line->Key, Key);
 
+  /* The hash holds the first line of each key, which is the one InfpFindKeyLine returns */
+  Bucket = &Section->KeyHash[InfpHashName(Key) & (Section->KeyHashSize - 1)];
+  while (*Bucket != NULL && strcmpiW((*Bucket)->Key, Key) != 0)
+    {
+      Bucket = &(*Bucket)->NextKey;
+    }
+  if (*Bucket == NULL)
+    {
+      *Bucket = Line;
+      Section->KeyCount++;
+    }
+  else if ((*Bucket)->Id > Line->Id)
+    {
+      Line->NextKey = (*Bucket)->NextKey;
+      (*Bucket)->NextKey = NULL;
+      *Bucket = Line;
+    }
+
   return (PVOID)Line->Key;
 }
 
@@ -392,15 +623,20 @@ InfpFindKeyLine(PINFCACHESECTION Section,
 {
   PINFCACHELINE Line;
 
-  Line = Section->FirstLine;
+  if (Section->KeyHashSize == 0)
+    {
+      return NULL;
+    }
+
+  Line = Section->KeyHash[InfpHashName(Key) & (Section->KeyHashSize - 1)];
   while (Line != NULL)
     {
-      if (Line->Key != NULL && strcmpiW(Line->Key, Key) == 0)
+      if (strcmpiW(Line->Key, Key) == 0)
         {
           return Line;
         }
 
-      Line = Line->Next;
+      Line = Line->NextKey;
     }
 
   return NULL;
@@ -537,7 +773,7 @@ static struct field *add_field_from_token( struct parser *parser, int is_key )
 
   if (is_key)
     {
-      field = InfpAddKeyToLine(parser->line, parser->token);
+      field = InfpAddKeyToLine(parser->cur_section, parser->line, parser->token);
     }
   else
     {
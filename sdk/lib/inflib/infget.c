@@ -262,26 +262,18 @@ InfpFindFirstMatchLine(PINFCONTEXT ContextIn,
   if (Section == NULL)
       return INF_STATUS_INVALID_PARAMETER;
 
-  CacheLine = Section->FirstLine;
-  while (CacheLine != NULL)
-    {
-      if (CacheLine->Key != NULL && strcmpiW (CacheLine->Key, Key) == 0)
-        {
-
-          if (ContextIn != ContextOut)
-            {
-              ContextOut->Inf = ContextIn->Inf;
-              ContextOut->Section = ContextIn->Section;
-            }
-          ContextOut->Line = CacheLine->Id;
-
-          return INF_STATUS_SUCCESS;
-        }
+  CacheLine = InfpFindKeyLine(Section, Key);
+  if (CacheLine == NULL)
+    return INF_STATUS_NOT_FOUND;
 
-      CacheLine = CacheLine->Next;
+  if (ContextIn != ContextOut)
+    {
+      ContextOut->Inf = ContextIn->Inf;
+      ContextOut->Section = ContextIn->Section;
     }
+  ContextOut->Line = CacheLine->Id;
 
-  return INF_STATUS_NOT_FOUND;
+  return INF_STATUS_SUCCESS;
 }
 
 
@@ -338,23 +330,14 @@ InfpGetLineCount(HINF InfHandle,
 
   Cache = (PINFCACHE)InfHandle;
 
-  /* Iterate through list of sections */
-  CacheSection = Cache->FirstSection;
-  while (CacheSection != NULL)
+  CacheSection = InfpFindSection(Cache, Section);
+  if (CacheSection == NULL)
     {
-      /* Are the section names the same? */
-      if (strcmpiW(CacheSection->Name, Section) == 0)
-        {
-          return CacheSection->LineCount;
-        }
-
-      /* Get the next section */
-      CacheSection = CacheSection->Next;
+      DPRINT("Section not found\n");
+      return -1;
     }
 
-  DPRINT("Section not found\n");
-
-  return -1;
+  return CacheSection->LineCount;
 }
 
 
@@ -30,6 +30,7 @@ typedef struct _INFCACHELINE
 {
   struct _INFCACHELINE *Next;
   struct _INFCACHELINE *Prev;
+  struct _INFCACHELINE *NextKey;    /* next line in the same key hash bucket */
   UINT Id;
 
   LONG FieldCount;
@@ -45,6 +46,7 @@ typedef struct _INFCACHESECTION
 {
   struct _INFCACHESECTION *Next;
   struct _INFCACHESECTION *Prev;
+  struct _INFCACHESECTION *NextName; /* next section in the same name hash bucket */
 
   PINFCACHELINE FirstLine;
   PINFCACHELINE LastLine;
@@ -53,6 +55,15 @@ typedef struct _INFCACHESECTION
   LONG LineCount;
   UINT NextLineId;
 
+  /* First line of each key, hashed on the key ignoring case */
+  PINFCACHELINE *KeyHash;
+  ULONG KeyHashSize;
+  ULONG KeyCount;
+
+  /* Lines indexed by Id - 1 */
+  PINFCACHELINE *LineById;
+  ULONG LineByIdSize;
+
   WCHAR Name[1];
 } INFCACHESECTION, *PINFCACHESECTION;
 
@@ -64,6 +75,15 @@ typedef struct _INFCACHE
   UINT NextSectionId;
 
   PINFCACHESECTION StringsSection;
+
+  /* Sections hashed on their name ignoring case */
+  PINFCACHESECTION *SectionHash;
+  ULONG SectionHashSize;
+  ULONG SectionCount;
+
+  /* Sections indexed by Id - 1 */
+  PINFCACHESECTION *SectionById;
+  ULONG SectionByIdSize;
 } INFCACHE, *PINFCACHE;
 
 typedef struct _INFCONTEXT
@@ -83,10 +103,12 @@ extern INFSTATUS InfpParseBuffer(PINFCACHE file,
                                  const WCHAR *end,
                                  PULONG error_line);
 extern PINFCACHESECTION InfpFreeSection(PINFCACHESECTION Section);
+extern VOID InfpFreeCache(PINFCACHE Cache);
 extern PINFCACHESECTION InfpAddSection(PINFCACHE Cache,
                                        PCWSTR Name);
 extern PINFCACHELINE InfpAddLine(PINFCACHESECTION Section);
-extern PVOID InfpAddKeyToLine(PINFCACHELINE Line,
+extern PVOID InfpAddKeyToLine(PINFCACHESECTION Section,
+                              PINFCACHELINE Line,
                               PCWSTR Key);
 extern PVOID InfpAddFieldToLine(PINFCACHELINE Line,
                                 PCWSTR Data);
@@ -146,6 +168,8 @@ extern INFSTATUS InfpAddLineWithKey(PINFCONTEXT Context, PCWSTR Key);
 extern INFSTATUS InfpAddField(PINFCONTEXT Context, PCWSTR Data);
 
 extern VOID InfpFreeContext(PINFCONTEXT Context);
+PINFCACHESECTION
+InfpFindSectionById(PINFCACHE Cache, UINT Id);
 PINFCACHELINE
 InfpFindLineById(PINFCACHESECTION Section, UINT Id);
 PINFCACHESECTION
@@ -241,7 +241,7 @@ InfpAddLineWithKey(PINFCONTEXT Context, PCWSTR Key)
     }
   Context->Line = Line->Id;
 
-  if (NULL != Key && NULL == InfpAddKeyToLine(Line, Key))
+  if (NULL != Key && NULL == InfpAddKeyToLine(Section, Line, Key))
     {
       DPRINT("Failed to add key\n");
       return INF_STATUS_NO_MEMORY;
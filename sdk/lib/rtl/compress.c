@@ -30,7 +30,7 @@
 /* decompress a single LZNT1 chunk */
 static PUCHAR lznt1_decompress_chunk(UCHAR *dst, ULONG dst_size, UCHAR *src, ULONG src_size)
 {
-    UCHAR *src_cur, *src_end, *dst_cur, *dst_end;
+    UCHAR *src_cur, *src_end, *dst_cur, *dst_end, *dst_split, *ref;
     ULONG displacement_bits, length_bits;
     ULONG code_displacement, code_length;
     WORD flags, code;
@@ -40,12 +40,26 @@ static PUCHAR lznt1_decompress_chunk(UCHAR *dst, ULONG dst_size, UCHAR *src, ULO
     dst_cur = dst;
     dst_end = dst + dst_size;
 
+    /* The displacement gets one more bit each time the output grows past
+     * the next power of two, starting with 4 bits for the first 16 bytes */
+    displacement_bits = 4;
+    dst_split = dst + 16;
+
     /* Partial decompression is no error on Windows. */
     while (src_cur < src_end && dst_cur < dst_end)
     {
         /* read flags header */
         flags = 0x8000 | *src_cur++;
 
+        /* eight literals in a row are common in poorly compressible data */
+        if (flags == 0x8000 && src_end - src_cur >= 8 && dst_end - dst_cur >= 8)
+        {
+            memcpy(dst_cur, src_cur, 8);
+            dst_cur += 8;
+            src_cur += 8;
+            continue;
+        }
+
         /* parse following 8 entities, either uncompressed data or backwards reference */
         while ((flags & 0xFF00) && src_cur < src_end)
         {
@@ -54,12 +68,15 @@ static PUCHAR lznt1_decompress_chunk(UCHAR *dst, ULONG dst_size, UCHAR *src, ULO
                 /* backwards reference */
                 if (src_cur + sizeof(WORD) > src_end)
                     return NULL;
-                code = *(WORD *)src_cur;
+                code = *(WORD UNALIGNED *)src_cur;
                 src_cur += sizeof(WORD);
 
                 /* find length / displacement bits */
-                for (displacement_bits = 12; displacement_bits > 4; displacement_bits--)
-                    if ((1 << (displacement_bits - 1)) < dst_cur - dst) break;
+                while (dst_cur > dst_split && displacement_bits < 12)
+                {
+                    displacement_bits++;
+                    dst_split = dst + (1 << displacement_bits);
+                }
                 length_bits       = 16 - displacement_bits;
                 code_length       = (code & ((1 << length_bits) - 1)) + 3;
                 code_displacement = (code >> length_bits) + 1;
@@ -70,11 +87,37 @@ static PUCHAR lznt1_decompress_chunk(UCHAR *dst, ULONG dst_size, UCHAR *src, ULO
 
                 /* copy bytes of chunk - we can't use memcpy()
                  * since source and dest can be overlapping */
-                while (code_length--)
+                ref = dst_cur - code_displacement;
+                if (code_length > (ULONG)(dst_end - dst_cur))
+                {
+                    /* the output ends in the middle of the reference */
+                    while (dst_cur < dst_end)
+                        *dst_cur++ = *ref++;
+                    return dst_cur;
+                }
+                if (code_displacement == 1)
+                {
+                    /* run of a single byte */
+                    memset(dst_cur, *ref, code_length);
+                    dst_cur += code_length;
+                }
+                else if (code_displacement >= sizeof(ULONG))
+                {
+                    /* a word at a time never reads bytes it hasn't written yet */
+                    while (code_length >= sizeof(ULONG))
+                    {
+                        *(ULONG UNALIGNED *)dst_cur = *(ULONG UNALIGNED *)ref;
+                        dst_cur += sizeof(ULONG);
+                        ref += sizeof(ULONG);
+                        code_length -= sizeof(ULONG);
+                    }
+                    while (code_length--)
+                        *dst_cur++ = *ref++;
+                }
+                else
                 {
-                    if (dst_cur >= dst_end) return dst_cur;
-                    *dst_cur = *(dst_cur - code_displacement);
-                    dst_cur++;
+                    while (code_length--)
+                        *dst_cur++ = *ref++;
                 }
             }
             else
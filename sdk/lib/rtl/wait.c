@@ -16,88 +16,406 @@
 #define NDEBUG
 #include <debug.h>
 
+/* Slot 0 of every wait thread is used by its control event */
+#define RTLP_WAITS_PER_BUCKET   (MAXIMUM_WAIT_OBJECTS - 1)
+#define RTLP_WAIT_EXPIRE_NEVER  (~(ULONGLONG)0)
+
+typedef struct _RTLP_WAIT_BUCKET *PRTLP_WAIT_BUCKET;
+
 typedef struct _RTLP_WAIT
 {
     HANDLE Object;
+    PRTLP_WAIT_BUCKET Bucket;
+    LONG RefCount;
     BOOLEAN CallbackInProgress;
-    HANDLE CancelEvent;
-    LONG DeleteCount;
+    BOOLEAN TimerOrWaitFired;
+    BOOLEAN Deleted;
     HANDLE CompletionEvent;
     ULONG Flags;
     WAITORTIMERCALLBACKFUNC Callback;
     PVOID Context;
     ULONG Milliseconds;
+    ULONGLONG DueTime;
 } RTLP_WAIT, *PRTLP_WAIT;
 
+typedef struct _RTLP_WAIT_BUCKET
+{
+    LIST_ENTRY ListEntry;
+    HANDLE ControlEvent;
+    ULONG WaitCount;
+    PRTLP_WAIT Waits[RTLP_WAITS_PER_BUCKET];
+} RTLP_WAIT_BUCKET;
+
+extern PRTL_START_POOL_THREAD RtlpStartThreadFunc;
+extern PRTL_EXIT_POOL_THREAD RtlpExitThreadFunc;
+
+static LONG WaitPoolInitialized = 0;
+static RTL_CRITICAL_SECTION WaitPoolLock;
+
+/* Buckets with free slots are kept at the head of this list */
+static LIST_ENTRY WaitBucketList;
+
+#define IsWaitPoolInitialized() (*((volatile LONG*)&WaitPoolInitialized) == 1)
+
 /* PRIVATE FUNCTIONS *******************************************************/
 
-static inline PLARGE_INTEGER get_nt_timeout( PLARGE_INTEGER pTime, ULONG timeout )
+static NTSTATUS
+RtlpInitializeWaitPool(VOID)
+{
+    NTSTATUS Status = STATUS_SUCCESS;
+    LONG InitStatus;
+
+    do
+    {
+        InitStatus = InterlockedCompareExchange(&WaitPoolInitialized,
+                                                 2,
+                                                 0);
+        if (InitStatus == 0)
+        {
+            /* We're the first thread to initialize the wait pool */
+            InitializeListHead(&WaitBucketList);
+
+            /* Initialize the lock */
+            Status = RtlInitializeCriticalSection(&WaitPoolLock);
+
+            /* Initialization done, let the next caller retry on failure */
+            InterlockedExchange(&WaitPoolInitialized,
+                                NT_SUCCESS(Status) ? 1 : 0);
+            break;
+        }
+        else if (InitStatus == 2)
+        {
+            LARGE_INTEGER Timeout;
+
+            /* Another thread is currently initializing the wait pool!
+               Poll after a short period of time to see if the initialization
+               was completed */
+
+            Timeout.QuadPart = -10000LL; /* Wait for a millisecond */
+            NtDelayExecution(FALSE,
+                             &Timeout);
+        }
+    } while (InitStatus != 1);
+
+    return Status;
+}
+
+static inline ULONGLONG
+RtlpGetWaitTime(VOID)
+{
+    LARGE_INTEGER Now, Frequency;
+    NtQueryPerformanceCounter(&Now, &Frequency);
+
+    /* Split the conversion, Now * 1000 overflows after a few days of uptime */
+    return (Now.QuadPart / Frequency.QuadPart) * 1000 +
+           (Now.QuadPart % Frequency.QuadPart) * 1000 / Frequency.QuadPart;
+}
+
+static inline VOID
+RtlpSetWaitDueTime(IN PRTLP_WAIT Wait,
+                   IN ULONGLONG Now)
+{
+    if (Wait->Milliseconds == INFINITE)
+        Wait->DueTime = RTLP_WAIT_EXPIRE_NEVER;
+    else
+        Wait->DueTime = Now + Wait->Milliseconds;
+}
+
+static VOID
+RtlpDereferenceWait(IN PRTLP_WAIT Wait)
+{
+    if (InterlockedDecrement(&Wait->RefCount) == 0)
+    {
+        RtlFreeHeap(RtlGetProcessHeap(), 0, Wait);
+    }
+}
+
+static VOID
+RtlpRemoveWaitFromBucket(IN PRTLP_WAIT Wait)
+{
+    /* We MUST hold the wait pool lock while calling this function */
+    PRTLP_WAIT_BUCKET Bucket = Wait->Bucket;
+    ULONG i;
+
+    if (!Bucket) return;
+
+    for (i = 0; i < Bucket->WaitCount; i++)
+    {
+        if (Bucket->Waits[i] == Wait)
+        {
+            /* Move the last wait into the free slot */
+            Bucket->Waits[i] = Bucket->Waits[--Bucket->WaitCount];
+
+            /* A full bucket just got a free slot, make it available again */
+            if (Bucket->WaitCount == RTLP_WAITS_PER_BUCKET - 1)
+            {
+                RemoveEntryList(&Bucket->ListEntry);
+                InsertHeadList(&WaitBucketList, &Bucket->ListEntry);
+            }
+            break;
+        }
+    }
+
+    /* Release the reference held by the bucket */
+    Wait->Bucket = NULL;
+    RtlpDereferenceWait(Wait);
+}
+
+static VOID
+RtlpWaitCallbackDone(IN PRTLP_WAIT Wait)
 {
-    if (timeout == INFINITE) return NULL;
-    pTime->QuadPart = (ULONGLONG)timeout * -10000;
-    return pTime;
+    HANDLE CompletionEvent;
+
+    RtlEnterCriticalSection(&WaitPoolLock);
+
+    Wait->CallbackInProgress = FALSE;
+    CompletionEvent = Wait->CompletionEvent;
+    Wait->CompletionEvent = NULL;
+
+    /* Have the wait thread put this wait back into its wait set */
+    if (Wait->Bucket && !Wait->Deleted)
+        NtSetEvent(Wait->Bucket->ControlEvent, NULL);
+
+    RtlLeaveCriticalSection(&WaitPoolLock);
+
+    if (CompletionEvent) NtSetEvent(CompletionEvent, NULL);
+
+    /* Release the reference held by the callback */
+    RtlpDereferenceWait(Wait);
+}
+
+static VOID
+NTAPI
+RtlpWaitCallback(IN PVOID Arg)
+{
+    PRTLP_WAIT Wait = (PRTLP_WAIT)Arg;
+
+    Wait->Callback(Wait->Context, Wait->TimerOrWaitFired);
+    RtlpWaitCallbackDone(Wait);
 }
 
 static VOID
+RtlpFireWait(IN PRTLP_WAIT Wait,
+             IN BOOLEAN TimerOrWaitFired,
+             IN ULONGLONG Now)
+{
+    NTSTATUS Status;
+    ULONG Flags;
+
+    RtlEnterCriticalSection(&WaitPoolLock);
+
+    /* Don't call back into waits that were deregistered in the meantime */
+    if (Wait->Deleted)
+    {
+        RtlLeaveCriticalSection(&WaitPoolLock);
+        return;
+    }
+
+    /* The wait stays out of the wait set until its callback has returned */
+    Wait->CallbackInProgress = TRUE;
+    Wait->TimerOrWaitFired = TimerOrWaitFired;
+    InterlockedIncrement(&Wait->RefCount);
+    RtlpSetWaitDueTime(Wait, Now);
+
+    /* One-shot waits give their slot back right away */
+    if (Wait->Flags & WT_EXECUTEONLYONCE)
+        RtlpRemoveWaitFromBucket(Wait);
+
+    RtlLeaveCriticalSection(&WaitPoolLock);
+
+    if (Wait->Flags & WT_EXECUTEINWAITTHREAD)
+    {
+        RtlpWaitCallback(Wait);
+        return;
+    }
+
+    Flags = Wait->Flags & (WT_EXECUTEINIOTHREAD | WT_EXECUTEINPERSISTENTTHREAD |
+                           WT_EXECUTELONGFUNCTION | WT_TRANSFER_IMPERSONATION);
+
+    Status = RtlQueueWorkItem(RtlpWaitCallback, Wait, Flags);
+    if (!NT_SUCCESS(Status))
+    {
+        DPRINT1("Failed to queue wait callback: 0x%lx\n", Status);
+        RtlpWaitCallbackDone(Wait);
+    }
+}
+
+static ULONG
 NTAPI
-Wait_thread_proc(LPVOID Arg)
+RtlpWaitThreadProc(IN PVOID Parameter)
 {
-    PRTLP_WAIT Wait = (PRTLP_WAIT) Arg;
+    PRTLP_WAIT_BUCKET Bucket = (PRTLP_WAIT_BUCKET)Parameter;
+    HANDLE Handles[MAXIMUM_WAIT_OBJECTS];
+    PRTLP_WAIT ActiveWaits[RTLP_WAITS_PER_BUCKET];
+    PRTLP_WAIT Wait;
+    ULONG ActiveCount, i;
+    ULONGLONG Now, NextDueTime;
+    LARGE_INTEGER Timeout;
     NTSTATUS Status;
-    BOOLEAN alertable = (Wait->Flags & WT_EXECUTEINIOTHREAD) != 0;
-    HANDLE handles[2] = { Wait->CancelEvent, Wait->Object };
-    LARGE_INTEGER timeout;
-    HANDLE completion_event;
 
-//    TRACE("\n");
+    Handles[0] = Bucket->ControlEvent;
 
     while (TRUE)
     {
-        Status = NtWaitForMultipleObjects( 2,
-                                           handles,
-                                           WaitAny,
-                                           alertable,
-                                           get_nt_timeout( &timeout, Wait->Milliseconds ) );
+        RtlEnterCriticalSection(&WaitPoolLock);
 
-        if (Status == STATUS_WAIT_1 || Status == STATUS_TIMEOUT)
+        /* Drop the waits that got deregistered and build the wait set */
+        i = 0;
+        ActiveCount = 0;
+        NextDueTime = RTLP_WAIT_EXPIRE_NEVER;
+        while (i < Bucket->WaitCount)
         {
-            BOOLEAN TimerOrWaitFired;
-
-            if (Status == STATUS_WAIT_1)
+            Wait = Bucket->Waits[i];
+            if (Wait->Deleted)
             {
-   //             TRACE( "object %p signaled, calling callback %p with context %p\n",
-   //                 Wait->Object, Wait->Callback,
-   //                 Wait->Context );
-                TimerOrWaitFired = FALSE;
+                /* This moves another wait into slot i */
+                RtlpRemoveWaitFromBucket(Wait);
+                continue;
             }
-            else
+            i++;
+
+            if (Wait->CallbackInProgress) continue;
+
+            ActiveWaits[ActiveCount] = Wait;
+            Handles[++ActiveCount] = Wait->Object;
+            if (Wait->DueTime < NextDueTime) NextDueTime = Wait->DueTime;
+        }
+
+        /* Retire this thread once it has nothing left to wait on */
+        if (!Bucket->WaitCount)
+        {
+            RemoveEntryList(&Bucket->ListEntry);
+            RtlLeaveCriticalSection(&WaitPoolLock);
+            break;
+        }
+
+        RtlLeaveCriticalSection(&WaitPoolLock);
+
+        if (NextDueTime != RTLP_WAIT_EXPIRE_NEVER)
+        {
+            Now = RtlpGetWaitTime();
+            Timeout.QuadPart = (NextDueTime > Now) ? (LONGLONG)(NextDueTime - Now) * -10000 : 0;
+        }
+
+        Status = NtWaitForMultipleObjects(ActiveCount + 1,
+                                          Handles,
+                                          WaitAny,
+                                          FALSE,
+                                          (NextDueTime != RTLP_WAIT_EXPIRE_NEVER) ? &Timeout : NULL);
+        Now = RtlpGetWaitTime();
+
+        if (Status == STATUS_WAIT_0 || Status == STATUS_ABANDONED_WAIT_0)
+        {
+            /* The set of waits changed */
+            continue;
+        }
+        else if (Status > STATUS_WAIT_0 && Status <= STATUS_WAIT_0 + ActiveCount)
+        {
+            RtlpFireWait(ActiveWaits[Status - STATUS_WAIT_0 - 1], FALSE, Now);
+        }
+        else if (Status > STATUS_ABANDONED_WAIT_0 && Status <= STATUS_ABANDONED_WAIT_0 + ActiveCount)
+        {
+            RtlpFireWait(ActiveWaits[Status - STATUS_ABANDONED_WAIT_0 - 1], FALSE, Now);
+        }
+        else if (Status == STATUS_TIMEOUT)
+        {
+            for (i = 0; i < ActiveCount; i++)
             {
-    //            TRACE( "wait for object %p timed out, calling callback %p with context %p\n",
-    //                Wait->Object, Wait->Callback,
-    //                Wait->Context );
-                TimerOrWaitFired = TRUE;
+                if (ActiveWaits[i]->DueTime <= Now)
+                    RtlpFireWait(ActiveWaits[i], TRUE, Now);
             }
-            Wait->CallbackInProgress = TRUE;
-            Wait->Callback( Wait->Context, TimerOrWaitFired );
-            Wait->CallbackInProgress = FALSE;
+        }
+        else
+        {
+            /* One of the handles is bad, find out which one */
+            DPRINT1("Wait thread %p failed to wait: 0x%lx\n", Bucket, Status);
 
-            if (Wait->Flags & WT_EXECUTEONLYONCE)
-                break;
+            Timeout.QuadPart = 0;
+            for (i = 0; i < ActiveCount; i++)
+            {
+                Status = NtWaitForSingleObject(Handles[i + 1], FALSE, &Timeout);
+                if (Status == STATUS_WAIT_0 || Status == STATUS_ABANDONED_WAIT_0)
+                {
+                    RtlpFireWait(ActiveWaits[i], FALSE, Now);
+                }
+                else if (Status != STATUS_TIMEOUT)
+                {
+                    /* Stop waiting on it, like a dedicated wait thread would */
+                    RtlEnterCriticalSection(&WaitPoolLock);
+                    RtlpRemoveWaitFromBucket(ActiveWaits[i]);
+                    RtlLeaveCriticalSection(&WaitPoolLock);
+                }
+            }
         }
-        else if (Status != STATUS_USER_APC)
-            break;
     }
 
-    completion_event = Wait->CompletionEvent;
-    if (completion_event) NtSetEvent( completion_event, NULL );
+    NtClose(Bucket->ControlEvent);
+    RtlFreeHeap(RtlGetProcessHeap(), 0, Bucket);
+    RtlpExitThreadFunc(STATUS_SUCCESS);
+    return 0;
+}
+
+static NTSTATUS
+RtlpInsertWait(IN PRTLP_WAIT Wait)
+{
+    /* We MUST hold the wait pool lock while calling this function */
+    PRTLP_WAIT_BUCKET Bucket = NULL;
+    HANDLE ThreadHandle;
+    NTSTATUS Status;
 
-    if (InterlockedIncrement( &Wait->DeleteCount ) == 2 )
+    /* Buckets with free slots are at the head of the list */
+    if (!IsListEmpty(&WaitBucketList))
     {
-       NtClose( Wait->CancelEvent );
-       RtlFreeHeap( RtlGetProcessHeap(), 0, Wait );
+        Bucket = CONTAINING_RECORD(WaitBucketList.Flink, RTLP_WAIT_BUCKET, ListEntry);
+        if (Bucket->WaitCount == RTLP_WAITS_PER_BUCKET) Bucket = NULL;
     }
-}
 
+    if (!Bucket)
+    {
+        /* All wait threads are busy, start a new one */
+        Bucket = RtlAllocateHeap(RtlGetProcessHeap(), 0, sizeof(RTLP_WAIT_BUCKET));
+        if (!Bucket)
+            return STATUS_NO_MEMORY;
+
+        Bucket->WaitCount = 0;
+        Status = NtCreateEvent(&Bucket->ControlEvent,
+                               EVENT_ALL_ACCESS,
+                               NULL,
+                               SynchronizationEvent,
+                               FALSE);
+        if (!NT_SUCCESS(Status))
+        {
+            RtlFreeHeap(RtlGetProcessHeap(), 0, Bucket);
+            return Status;
+        }
+
+        Status = RtlpStartThreadFunc(RtlpWaitThreadProc, Bucket, &ThreadHandle);
+        if (!NT_SUCCESS(Status))
+        {
+            NtClose(Bucket->ControlEvent);
+            RtlFreeHeap(RtlGetProcessHeap(), 0, Bucket);
+            return Status;
+        }
+
+        /* It will block on our lock until we're done */
+        InsertHeadList(&WaitBucketList, &Bucket->ListEntry);
+        NtResumeThread(ThreadHandle, NULL);
+        NtClose(ThreadHandle);
+    }
+
+    /* Add the wait and move the bucket out of the way once it's full */
+    Bucket->Waits[Bucket->WaitCount++] = Wait;
+    Wait->Bucket = Bucket;
+    if (Bucket->WaitCount == RTLP_WAITS_PER_BUCKET)
+    {
+        RemoveEntryList(&Bucket->ListEntry);
+        InsertTailList(&WaitBucketList, &Bucket->ListEntry);
+    }
+
+    /* Let the wait thread pick it up */
+    NtSetEvent(Bucket->ControlEvent, NULL);
+    return STATUS_SUCCESS;
+}
 
 /* FUNCTIONS ***************************************************************/
 
@@ -129,7 +447,7 @@ Wait_thread_proc(LPVOID Arg)
  */
 NTSTATUS
 NTAPI
-RtlRegisterWait(PHANDLE NewWaitObject, 
+RtlRegisterWait(PHANDLE NewWaitObject,
                 HANDLE Object,
                 WAITORTIMERCALLBACKFUNC Callback,
                 PVOID Context,
@@ -141,6 +459,13 @@ RtlRegisterWait(PHANDLE NewWaitObject,
 
     //TRACE( "(%p, %p, %p, %p, %d, 0x%x)\n", NewWaitObject, Object, Callback, Context, Milliseconds, Flags );
 
+    if (!IsWaitPoolInitialized())
+    {
+        Status = RtlpInitializeWaitPool();
+        if (!NT_SUCCESS(Status))
+            return Status;
+    }
+
     Wait = RtlAllocateHeap( RtlGetProcessHeap(), 0, sizeof(RTLP_WAIT) );
     if (!Wait)
         return STATUS_NO_MEMORY;
@@ -151,31 +476,22 @@ RtlRegisterWait(PHANDLE NewWaitObject,
     Wait->Milliseconds = Milliseconds;
     Wait->Flags = Flags;
     Wait->CallbackInProgress = FALSE;
-    Wait->DeleteCount = 0;
+    Wait->TimerOrWaitFired = FALSE;
+    Wait->Deleted = FALSE;
     Wait->CompletionEvent = NULL;
+    Wait->Bucket = NULL;
+    RtlpSetWaitDueTime(Wait, RtlpGetWaitTime());
 
-    Status = NtCreateEvent( &Wait->CancelEvent, 
-                             EVENT_ALL_ACCESS, 
-                             NULL,
-                             NotificationEvent,
-                             FALSE );
-
-    if (Status != STATUS_SUCCESS)
-    {
-        RtlFreeHeap( RtlGetProcessHeap(), 0, Wait );
-        return Status;
-    }
-
-    Flags = Flags & (WT_EXECUTEINIOTHREAD | WT_EXECUTEINPERSISTENTTHREAD |
-                     WT_EXECUTELONGFUNCTION | WT_TRANSFER_IMPERSONATION);
+    /* One reference for the caller and one for the wait thread */
+    Wait->RefCount = 2;
 
-    Status = RtlQueueWorkItem( Wait_thread_proc,
-                               Wait,
-                               Flags );
+    /* Hand it to a wait thread with a free slot */
+    RtlEnterCriticalSection(&WaitPoolLock);
+    Status = RtlpInsertWait(Wait);
+    RtlLeaveCriticalSection(&WaitPoolLock);
 
-    if (Status != STATUS_SUCCESS)
+    if (!NT_SUCCESS(Status))
     {
-        NtClose( Wait->CancelEvent );
         RtlFreeHeap( RtlGetProcessHeap(), 0, Wait );
         return Status;
     }
@@ -204,51 +520,57 @@ RtlDeregisterWaitEx(HANDLE WaitHandle,
 {
     PRTLP_WAIT Wait = (PRTLP_WAIT) WaitHandle;
     NTSTATUS Status = STATUS_SUCCESS;
+    HANDLE LocalEvent = NULL;
 
     //TRACE( "(%p)\n", WaitHandle );
 
-    NtSetEvent( Wait->CancelEvent, NULL );
+    RtlEnterCriticalSection(&WaitPoolLock);
+
+    /* The wait thread will drop it from its wait set */
+    Wait->Deleted = TRUE;
+    if (Wait->Bucket)
+        NtSetEvent( Wait->Bucket->ControlEvent, NULL );
+
     if (Wait->CallbackInProgress)
     {
-        if (CompletionEvent != NULL)
+        if (CompletionEvent == INVALID_HANDLE_VALUE)
         {
-            if (CompletionEvent == INVALID_HANDLE_VALUE)
-            {
-                Status = NtCreateEvent( &CompletionEvent,
-                                         EVENT_ALL_ACCESS,
-                                         NULL,
-                                         NotificationEvent,
-                                         FALSE );
-
-                if (Status != STATUS_SUCCESS)
-                    return Status;
-
-                (void)InterlockedExchangePointer( &Wait->CompletionEvent, CompletionEvent );
-
-                if (Wait->CallbackInProgress)
-                    NtWaitForSingleObject( CompletionEvent, FALSE, NULL );
-
-                NtClose( CompletionEvent );
-            }
-            else
-            {
-                (void)InterlockedExchangePointer( &Wait->CompletionEvent, CompletionEvent );
-
-                if (Wait->CallbackInProgress)
-                    Status = STATUS_PENDING;
-            }
+            Status = NtCreateEvent( &LocalEvent,
+                                     EVENT_ALL_ACCESS,
+                                     NULL,
+                                     NotificationEvent,
+                                     FALSE );
+            if (NT_SUCCESS(Status))
+                Wait->CompletionEvent = LocalEvent;
+        }
+        else if (CompletionEvent != NULL)
+        {
+            Wait->CompletionEvent = CompletionEvent;
+            Status = STATUS_PENDING;
         }
         else
+        {
             Status = STATUS_PENDING;
+        }
     }
+    else if (CompletionEvent != NULL && CompletionEvent != INVALID_HANDLE_VALUE)
+    {
+        /* No callback is running, so it's already complete */
+        NtSetEvent( CompletionEvent, NULL );
+    }
+
+    RtlLeaveCriticalSection(&WaitPoolLock);
 
-    if (InterlockedIncrement( &Wait->DeleteCount ) == 2 )
+    if (LocalEvent)
     {
-        Status = STATUS_SUCCESS;
-        NtClose( Wait->CancelEvent );
-        RtlFreeHeap( RtlGetProcessHeap(), 0, Wait );
+        /* Block until the running callback has returned */
+        NtWaitForSingleObject( LocalEvent, FALSE, NULL );
+        NtClose( LocalEvent );
     }
 
+    /* Release the reference returned by RtlRegisterWait */
+    RtlpDereferenceWait(Wait);
+
     return Status;
 }
 
@@ -47,6 +47,9 @@ PRTL_EXIT_POOL_THREAD RtlpExitThreadFunc = RtlpExitThread;
 
 #define MAX_WORKERTHREADS   0x100
 #define WORKERTHREAD_CREATION_THRESHOLD 0x5
+#define WORKERTHREAD_INJECTION_INTERVAL 500 /* ms without progress before adding a worker */
+#define GATETHREAD_IDLE_INTERVALS 20 /* intervals without work before the gate thread exits */
+#define MAX_CACHED_WORKITEMS 0x100
 
 typedef struct _RTLP_IOWORKERTHREAD
 {
@@ -57,12 +60,19 @@ typedef struct _RTLP_IOWORKERTHREAD
 
 typedef struct _RTLP_WORKITEM
 {
+    SLIST_ENTRY ItemEntry;
     WORKERCALLBACKFUNC Function;
     PVOID Context;
     ULONG Flags;
     HANDLE TokenHandle;
 } RTLP_WORKITEM, *PRTLP_WORKITEM;
 
+typedef struct _RTLP_WORKER_QUEUE
+{
+    SLIST_HEADER LocalItems;
+    HANDLE ThreadId;
+} RTLP_WORKER_QUEUE, *PRTLP_WORKER_QUEUE;
+
 static LONG ThreadPoolInitialized = 0;
 static RTL_CRITICAL_SECTION ThreadPoolLock;
 static PRTLP_IOWORKERTHREAD PersistentIoThread;
@@ -74,6 +84,14 @@ static LONG ThreadPoolWorkerThreadsLongRequests;
 static LONG ThreadPoolIOWorkerThreads;
 static LONG ThreadPoolIOWorkerThreadsRequests;
 static LONG ThreadPoolIOWorkerThreadsLongRequests;
+static LONG ThreadPoolIdleWorkerThreads;
+static LONG ThreadPoolCompletedWorkItems;
+static LONG ThreadPoolLastCompletedWorkItems;
+static ULONG ThreadPoolLastInjectionTime;
+static BOOLEAN ThreadPoolGateThreadRunning;
+static SLIST_HEADER ThreadPoolFreeWorkItems;
+static RTLP_WORKER_QUEUE ThreadPoolWorkerQueues[MAX_WORKERTHREADS];
+static LONG ThreadPoolWorkerQueuesHighWater;
 
 #define IsThreadPoolInitialized() (*((volatile LONG*)&ThreadPoolInitialized) == 1)
 
@@ -82,6 +100,7 @@ RtlpInitializeThreadPool(VOID)
 {
     NTSTATUS Status = STATUS_SUCCESS;
     LONG InitStatus;
+    ULONG i;
 
     do
     {
@@ -102,13 +121,28 @@ RtlpInitializeThreadPool(VOID)
             ThreadPoolIOWorkerThreads = 0;
             ThreadPoolIOWorkerThreadsRequests = 0;
             ThreadPoolIOWorkerThreadsLongRequests = 0;
+            ThreadPoolIdleWorkerThreads = 0;
+            ThreadPoolCompletedWorkItems = 0;
+            ThreadPoolLastCompletedWorkItems = 0;
+            ThreadPoolLastInjectionTime = 0;
+            ThreadPoolGateThreadRunning = FALSE;
+
+            /* Initialize the work item cache and the per-worker queues */
+            RtlInitializeSListHead(&ThreadPoolFreeWorkItems);
+            for (i = 0; i < MAX_WORKERTHREADS; i++)
+            {
+                RtlInitializeSListHead(&ThreadPoolWorkerQueues[i].LocalItems);
+                ThreadPoolWorkerQueues[i].ThreadId = NULL;
+            }
+            ThreadPoolWorkerQueuesHighWater = 0;
 
             /* Initialize the lock */
             Status = RtlInitializeCriticalSection(&ThreadPoolLock);
             if (!NT_SUCCESS(Status))
                 goto Finish;
 
-            /* Create the complection port */
+            /* Create the completion port, it caps the number of
+               concurrently running workers to the number of processors */
             Status = NtCreateIoCompletion(&ThreadPoolCompletionPort,
                                           IO_COMPLETION_ALL_ACCESS,
                                           NULL,
@@ -160,6 +194,118 @@ RtlpGetImpersonationToken(OUT PHANDLE TokenHandle)
     return Status;
 }
 
+static PRTLP_WORKITEM
+RtlpAllocateWorkItem(VOID)
+{
+    PSLIST_ENTRY Entry;
+
+    /* Reuse a previously freed work item if we have one */
+    Entry = RtlInterlockedPopEntrySList(&ThreadPoolFreeWorkItems);
+    if (Entry != NULL)
+        return CONTAINING_RECORD(Entry, RTLP_WORKITEM, ItemEntry);
+
+    return RtlAllocateHeap(RtlGetProcessHeap(),
+                           0,
+                           sizeof(RTLP_WORKITEM));
+}
+
+static VOID
+RtlpFreeWorkItem(IN PRTLP_WORKITEM WorkItem)
+{
+    /* Cache it for the next RtlQueueWorkItem, unless we already have plenty */
+    if (RtlQueryDepthSList(&ThreadPoolFreeWorkItems) < MAX_CACHED_WORKITEMS)
+    {
+        RtlInterlockedPushEntrySList(&ThreadPoolFreeWorkItems,
+                                     &WorkItem->ItemEntry);
+        return;
+    }
+
+    RtlFreeHeap(RtlGetProcessHeap(),
+                0,
+                WorkItem);
+}
+
+/* Each worker keeps a pointer to its local queue in the TEB field that
+   became ThreadPoolData in NT6 */
+#if (NTDDI_VERSION >= NTDDI_LONGHORN)
+#define RtlpWorkerQueueOfTeb(Teb) ((Teb)->ThreadPoolData)
+#else
+#define RtlpWorkerQueueOfTeb(Teb) ((Teb)->SoftPatchPtr2)
+#endif
+
+static PRTLP_WORKER_QUEUE
+RtlpGetCurrentWorkerQueue(VOID)
+{
+    /* NULL unless we're running on one of the worker threads */
+    return (PRTLP_WORKER_QUEUE)RtlpWorkerQueueOfTeb(NtCurrentTeb());
+}
+
+static PRTLP_WORKITEM
+RtlpDequeueLocalWorkItem(IN PRTLP_WORKER_QUEUE WorkerQueue)
+{
+    PRTLP_WORKER_QUEUE Victim;
+    PSLIST_ENTRY Entry;
+    LONG i, Count, Start;
+
+    /* Run the work this worker queued itself first, it's still cache-hot */
+    Entry = RtlInterlockedPopEntrySList(&WorkerQueue->LocalItems);
+    if (Entry != NULL)
+        return CONTAINING_RECORD(Entry, RTLP_WORKITEM, ItemEntry);
+
+    /* Otherwise steal from the other workers */
+    Count = *((volatile LONG*)&ThreadPoolWorkerQueuesHighWater);
+    Start = (LONG)(WorkerQueue - ThreadPoolWorkerQueues);
+    for (i = 1; i < Count; i++)
+    {
+        Victim = &ThreadPoolWorkerQueues[(Start + i) % Count];
+        if (RtlQueryDepthSList(&Victim->LocalItems) == 0)
+            continue;
+
+        Entry = RtlInterlockedPopEntrySList(&Victim->LocalItems);
+        if (Entry != NULL)
+            return CONTAINING_RECORD(Entry, RTLP_WORKITEM, ItemEntry);
+    }
+
+    return NULL;
+}
+
+static BOOLEAN
+RtlpShouldInjectWorkerThread(IN LONG FreeWorkers)
+{
+    /* We MUST hold the thread pool lock while calling this function */
+    LONG Completed;
+    ULONG Now;
+    BOOLEAN Progress;
+
+    /* Every worker is tied up in a long function */
+    if (FreeWorkers <= 0)
+        return TRUE;
+
+    /* Somebody is idle and will pick the work item up */
+    if (*((volatile LONG*)&ThreadPoolIdleWorkerThreads) != 0)
+        return FALSE;
+
+    /* Ramp up to one worker per processor right away, the completion port
+       keeps the number of running ones in check */
+    if (FreeWorkers < (LONG)NtCurrentPeb()->NumberOfProcessors)
+        return TRUE;
+
+    /* Beyond that, only add workers if the queued work stopped making progress */
+    if (ThreadPoolWorkerThreadsRequests <= ThreadPoolWorkerThreads)
+        return FALSE;
+
+    Now = NtGetTickCount();
+    if (Now - ThreadPoolLastInjectionTime < WORKERTHREAD_INJECTION_INTERVAL)
+        return FALSE;
+
+    Completed = *((volatile LONG*)&ThreadPoolCompletedWorkItems);
+    Progress = (Completed != ThreadPoolLastCompletedWorkItems);
+    ThreadPoolLastCompletedWorkItems = Completed;
+    ThreadPoolLastInjectionTime = Now;
+
+    return !Progress;
+}
+
 static NTSTATUS
 RtlpStartWorkerThread(PTHREAD_START_ROUTINE StartRoutine)
 {
@@ -199,9 +345,7 @@ RtlpExecuteWorkItem(IN OUT PVOID NormalContext,
     BOOLEAN Impersonated = FALSE;
     RTLP_WORKITEM WorkItem = *(volatile RTLP_WORKITEM *)SystemArgument2;
 
-    RtlFreeHeap(RtlGetProcessHeap(),
-                0,
-                SystemArgument2);
+    RtlpFreeWorkItem((PRTLP_WORKITEM)SystemArgument2);
 
     if (WorkItem.TokenHandle != NULL)
     {
@@ -244,8 +388,9 @@ RtlpExecuteWorkItem(IN OUT PVOID NormalContext,
         }
     }
 
-    /* update the requests counter */
+    /* update the requests and throughput counters */
     InterlockedDecrement(&ThreadPoolWorkerThreadsRequests);
+    InterlockedIncrement(&ThreadPoolCompletedWorkItems);
 
     if (WorkItem.Flags & WT_EXECUTELONGFUNCTION)
     {
@@ -257,6 +402,7 @@ RtlpExecuteWorkItem(IN OUT PVOID NormalContext,
 static NTSTATUS
 RtlpQueueWorkerThread(IN OUT PRTLP_WORKITEM WorkItem)
 {
+    PRTLP_WORKER_QUEUE WorkerQueue;
     NTSTATUS Status = STATUS_SUCCESS;
 
     InterlockedIncrement(&ThreadPoolWorkerThreadsRequests);
@@ -280,6 +426,23 @@ RtlpQueueWorkerThread(IN OUT PRTLP_WORKITEM WorkItem)
                                       WorkItem);
         }
     }
+    else if (!(WorkItem->Flags & WT_EXECUTELONGFUNCTION) &&
+             (WorkerQueue = RtlpGetCurrentWorkerQueue()) != NULL)
+    {
+        /* Work queued by a worker stays on that worker's queue */
+        RtlInterlockedPushEntrySList(&WorkerQueue->LocalItems,
+                                     &WorkItem->ItemEntry);
+
+        /* Always post a wake up packet. This worker may be about to block on
+           the item it just queued, and a worker that goes idle after the push
+           still finds the packet and steals the item. The item is queued
+           even if this fails, this worker runs it once it's done */
+        NtSetIoCompletion(ThreadPoolCompletionPort,
+                          NULL,
+                          NULL,
+                          STATUS_SUCCESS,
+                          0);
+    }
     else
     {
         /* Queue an IO completion message */
@@ -316,9 +479,7 @@ RtlpExecuteIoWorkItem(IN OUT PVOID NormalContext,
 
     ASSERT(IoThread != NULL);
 
-    RtlFreeHeap(RtlGetProcessHeap(),
-                0,
-                SystemArgument2);
+    RtlpFreeWorkItem((PRTLP_WORKITEM)SystemArgument2);
 
     if (WorkItem.TokenHandle != NULL)
     {
@@ -683,10 +844,17 @@ RtlpWorkerThreadProc(IN PVOID Parameter)
     IO_STATUS_BLOCK IoStatusBlock;
     ULONG TimeoutCount = 0;
     PKNORMAL_ROUTINE ApcRoutine;
+    PRTLP_WORKER_QUEUE WorkerQueue = NULL;
+    PRTLP_WORKITEM WorkItem;
+    PSLIST_ENTRY Entry;
+    HANDLE ThreadId;
+    LONG i, HighWater;
     NTSTATUS Status = STATUS_SUCCESS;
 
     if (InterlockedIncrement(&ThreadPoolWorkerThreads) > MAX_WORKERTHREADS)
     {
+        InterlockedDecrement(&ThreadPoolWorkerThreads);
+
         /* Signal initialization completion */
         InterlockedExchange((PLONG)Parameter,
                              1);
@@ -696,25 +864,79 @@ RtlpWorkerThreadProc(IN PVOID Parameter)
         return 0;
     }
 
+    /* Claim a local work queue, there's one for every possible worker */
+    ThreadId = NtCurrentTeb()->ClientId.UniqueThread;
+    for (i = 0; i < MAX_WORKERTHREADS; i++)
+    {
+        if (InterlockedCompareExchangePointer(&ThreadPoolWorkerQueues[i].ThreadId,
+                                              ThreadId,
+                                              NULL) == NULL)
+        {
+            WorkerQueue = &ThreadPoolWorkerQueues[i];
+            break;
+        }
+    }
+    ASSERT(WorkerQueue != NULL);
+
+    /* Make it visible to the thieves */
+    do
+    {
+        HighWater = *((volatile LONG*)&ThreadPoolWorkerQueuesHighWater);
+        if (i < HighWater)
+            break;
+    } while (InterlockedCompareExchange(&ThreadPoolWorkerQueuesHighWater,
+                                        i + 1,
+                                        HighWater) != HighWater);
+
+    /* Find it again without scanning the queues when queueing work */
+    RtlpWorkerQueueOfTeb(NtCurrentTeb()) = (ULONG_PTR)WorkerQueue;
+
     /* Signal initialization completion */
     InterlockedExchange((PLONG)Parameter,
                          1);
 
     for (;;)
     {
+        /* Run local and stolen work before going to the completion port */
+        WorkItem = RtlpDequeueLocalWorkItem(WorkerQueue);
+        if (WorkItem != NULL)
+        {
+            TimeoutCount = 0;
+
+            _SEH2_TRY
+            {
+                RtlpExecuteWorkItem(NULL,
+                                    NULL,
+                                    WorkItem);
+            }
+            _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+            {
+                (void)0;
+            }
+            _SEH2_END;
+
+            continue;
+        }
+
         Timeout.QuadPart = -50000000LL; /* Wait for 5 seconds by default */
 
         /* Dequeue a completion message */
+        InterlockedIncrement(&ThreadPoolIdleWorkerThreads);
         Status = NtRemoveIoCompletion(ThreadPoolCompletionPort,
                                       (PVOID*)&ApcRoutine,
                                       &SystemArgument2,
                                       &IoStatusBlock,
                                       &Timeout);
+        InterlockedDecrement(&ThreadPoolIdleWorkerThreads);
 
         if (Status == STATUS_SUCCESS)
         {
             TimeoutCount = 0;
 
+            /* A packet without a routine only asks us to go stealing */
+            if (ApcRoutine == NULL)
+                continue;
+
             _SEH2_TRY
             {
                 /* Call the APC routine */
@@ -735,13 +957,11 @@ RtlpWorkerThreadProc(IN PVOID Parameter)
             if (!NT_SUCCESS(RtlEnterCriticalSection(&ThreadPoolLock)))
                 continue;
 
-            /* FIXME - this should be optimized, check if there's requests, etc */
-
             if (Status == STATUS_TIMEOUT)
             {
-                /* FIXME - we might want to optimize this */
+                /* Retire workers that stayed idle, but keep one per processor */
                 if (TimeoutCount++ > 2 &&
-                    *((volatile LONG*)&ThreadPoolWorkerThreads) - *((volatile LONG*)&ThreadPoolWorkerThreadsLongRequests) >= WORKERTHREAD_CREATION_THRESHOLD)
+                    *((volatile LONG*)&ThreadPoolWorkerThreads) - *((volatile LONG*)&ThreadPoolWorkerThreadsLongRequests) > (LONG)NtCurrentPeb()->NumberOfProcessors)
                 {
                     Terminate = TRUE;
                 }
@@ -766,11 +986,91 @@ RtlpWorkerThreadProc(IN PVOID Parameter)
         }
     }
 
+    /* Only we push to our local queue, but hand over anything left anyway */
+    while ((Entry = RtlInterlockedPopEntrySList(&WorkerQueue->LocalItems)) != NULL)
+    {
+        NtSetIoCompletion(ThreadPoolCompletionPort,
+                          RtlpExecuteWorkItem,
+                          CONTAINING_RECORD(Entry, RTLP_WORKITEM, ItemEntry),
+                          STATUS_SUCCESS,
+                          0);
+    }
+
+    /* Give the local queue back */
+    RtlpWorkerQueueOfTeb(NtCurrentTeb()) = 0;
+    InterlockedExchangePointer(&WorkerQueue->ThreadId, NULL);
+
     RtlpExitThreadFunc(Status);
     return 0;
 
 }
 
+static ULONG
+NTAPI
+RtlpGateThreadProc(IN PVOID Parameter)
+{
+    LARGE_INTEGER Interval;
+    ULONG IdleIntervals = 0;
+    BOOLEAN Exit = FALSE;
+
+    Interval.QuadPart = -10000LL * WORKERTHREAD_INJECTION_INTERVAL;
+
+    /* Workers blocked on work that sits behind them don't queue anything
+       that could make RtlQueueWorkItem add a worker, so check on them */
+    while (!Exit)
+    {
+        NtDelayExecution(FALSE,
+                         &Interval);
+
+        if (!NT_SUCCESS(RtlEnterCriticalSection(&ThreadPoolLock)))
+            continue;
+
+        if (*((volatile LONG*)&ThreadPoolWorkerThreadsRequests) == 0)
+        {
+            /* Leave once the pool stayed without work for a while */
+            if (++IdleIntervals >= GATETHREAD_IDLE_INTERVALS)
+            {
+                ThreadPoolGateThreadRunning = FALSE;
+                Exit = TRUE;
+            }
+        }
+        else
+        {
+            IdleIntervals = 0;
+
+            /* Same rule as for queueing, work is waiting and nothing completed */
+            if (ThreadPoolWorkerThreads < MAX_WORKERTHREADS &&
+                ThreadPoolWorkerThreadsRequests > ThreadPoolWorkerThreads &&
+                RtlpShouldInjectWorkerThread(ThreadPoolWorkerThreads - ThreadPoolWorkerThreadsLongRequests))
+            {
+                RtlpStartWorkerThread(RtlpWorkerThreadProc);
+            }
+        }
+
+        RtlLeaveCriticalSection(&ThreadPoolLock);
+    }
+
+    RtlpExitThreadFunc(STATUS_SUCCESS);
+    return 0;
+}
+
+static NTSTATUS
+RtlpStartGateThread(VOID)
+{
+    NTSTATUS Status;
+    HANDLE ThreadHandle;
+
+    /* We MUST hold the thread pool lock while calling this function */
+    Status = RtlpStartThreadFunc(RtlpGateThreadProc, NULL, &ThreadHandle);
+    if (NT_SUCCESS(Status))
+    {
+        NtResumeThread(ThreadHandle, NULL);
+        NtClose(ThreadHandle);
+    }
+
+    return Status;
+}
+
 /*
  * @implemented
  */
@@ -796,9 +1096,7 @@ RtlQueueWorkItem(IN WORKERCALLBACKFUNC Function,
     }
 
     /* Allocate a work item */
-    WorkItem = RtlAllocateHeap(RtlGetProcessHeap(),
-                               0,
-                               sizeof(RTLP_WORKITEM));
+    WorkItem = RtlpAllocateWorkItem();
     if (WorkItem == NULL)
         return STATUS_NO_MEMORY;
 
@@ -864,7 +1162,7 @@ RtlQueueWorkItem(IN WORKERCALLBACKFUNC Function,
 
             /* See if it's a good idea to grow the pool */
             if (ThreadPoolWorkerThreads < MAX_WORKERTHREADS &&
-                (FreeWorkers <= 0 || ThreadPoolWorkerThreads - ThreadPoolWorkerThreadsRequests < WORKERTHREAD_CREATION_THRESHOLD))
+                RtlpShouldInjectWorkerThread(FreeWorkers))
             {
                 /* Grow the thread pool */
                 Status = RtlpStartWorkerThread(RtlpWorkerThreadProc);
@@ -882,6 +1180,12 @@ RtlQueueWorkItem(IN WORKERCALLBACKFUNC Function,
                 /* Queue a normal worker thread */
                 Status = RtlpQueueWorkerThread(WorkItem);
             }
+
+            /* Keep an eye on the workers while there's work around */
+            if (NT_SUCCESS(Status) && !ThreadPoolGateThreadRunning)
+            {
+                ThreadPoolGateThreadRunning = NT_SUCCESS(RtlpStartGateThread());
+            }
         }
 
         RtlLeaveCriticalSection(&ThreadPoolLock);
@@ -895,9 +1199,7 @@ RtlQueueWorkItem(IN WORKERCALLBACKFUNC Function,
         }
 
 Cleanup:
-        RtlFreeHeap(RtlGetProcessHeap(),
-                    0,
-                    WorkItem);
+        RtlpFreeWorkItem(WorkItem);
     }
 
     return Status;
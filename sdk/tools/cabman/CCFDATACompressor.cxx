@@ -0,0 +1,388 @@
+/*
+ * PROJECT:     ReactOS cabinet manager
+ * LICENSE:     GPL-2.0+ (https://spdx.org/licenses/GPL-2.0+)
+ * PURPOSE:     CCFDATACompressor class implementation
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Data blocks are compressed by a pool of threads, each with its own
+ * codec. The blocks are queued in a ring and handed back in the order
+ * they were queued, so the cabinet is the same as when the blocks are
+ * compressed one after the other.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cabinet.h"
+
+#if !defined(CAB_READ_ONLY)
+
+#if defined(_WIN32)
+#define LockAcquire(Lock)           EnterCriticalSection(Lock)
+#define LockRelease(Lock)           LeaveCriticalSection(Lock)
+#define ConditionWait(Cond, Lock)   SleepConditionVariableCS(Cond, Lock, INFINITE)
+#define ConditionSignal(Cond)       WakeConditionVariable(Cond)
+#define ConditionBroadcast(Cond)    WakeAllConditionVariable(Cond)
+#else
+#define LockAcquire(Lock)           pthread_mutex_lock(Lock)
+#define LockRelease(Lock)           pthread_mutex_unlock(Lock)
+#define ConditionWait(Cond, Lock)   pthread_cond_wait(Cond, Lock)
+#define ConditionSignal(Cond)       pthread_cond_signal(Cond)
+#define ConditionBroadcast(Cond)    pthread_cond_broadcast(Cond)
+#endif
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Default constructor
+*/
+CCFDATACompressor::CCFDATACompressor()
+{
+    Jobs = NULL;
+    JobCount = 0;
+    ThreadCount = 0;
+    CodecId = -1;
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Default destructor
+*/
+CCFDATACompressor::~CCFDATACompressor()
+{
+    ASSERT(Jobs == NULL);
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Returns the number of processors of the host
+*
+* @return
+* Number of processors, at least 1
+*/
+ULONG CCFDATACompressor::GetProcessorCount()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO SystemInfo;
+
+    GetSystemInfo(&SystemInfo);
+    return SystemInfo.dwNumberOfProcessors;
+#else
+    long Count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (Count > 0) ? (ULONG)Count : 1;
+#endif
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Starts the compression threads
+*
+* @param CodecId
+* Codec to compress the blocks with (CAB_CODEC_*)
+*
+* @param ThreadCount
+* Number of compression threads
+*
+* @return
+* Status of operation
+*/
+ULONG CCFDATACompressor::Create(LONG CodecId, ULONG ThreadCount)
+{
+    ASSERT(Jobs == NULL);
+
+    if (ThreadCount > CAB_MAX_THREADS)
+        ThreadCount = CAB_MAX_THREADS;
+
+    /* Keep a second block queued for each thread while the first one is compressed */
+    JobCount = ThreadCount * 2;
+    Jobs = (PCFDATA_JOB)malloc(JobCount * sizeof(CFDATA_JOB));
+    if (!Jobs)
+    {
+        DPRINT(MIN_TRACE, ("Insufficient memory.\n"));
+        return CAB_STATUS_NOMEMORY;
+    }
+
+    this->CodecId = CodecId;
+    this->ThreadCount = 0;
+    Head = Next = Tail = 0;
+    Stopping = false;
+    CompressTime = 0;
+
+#if defined(_WIN32)
+    InitializeCriticalSection(&Lock);
+    InitializeConditionVariable(&WorkAvailable);
+    InitializeConditionVariable(&BlockDone);
+#else
+    pthread_mutex_init(&Lock, NULL);
+    pthread_cond_init(&WorkAvailable, NULL);
+    pthread_cond_init(&BlockDone, NULL);
+#endif
+
+    while (this->ThreadCount < ThreadCount)
+    {
+#if defined(_WIN32)
+        Threads[this->ThreadCount] = CreateThread(NULL, 0, ThreadProc, this, 0, NULL);
+        if (Threads[this->ThreadCount] == NULL)
+            break;
+#else
+        if (pthread_create(&Threads[this->ThreadCount], NULL, ThreadProc, this) != 0)
+            break;
+#endif
+        this->ThreadCount++;
+    }
+
+    if (this->ThreadCount < ThreadCount)
+    {
+        DPRINT(MIN_TRACE, ("Cannot create compression thread.\n"));
+        Destroy();
+        return CAB_STATUS_NOMEMORY;
+    }
+
+    return CAB_STATUS_SUCCESS;
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Stops the compression threads. Blocks that are still queued are discarded
+*
+* @return
+* Status of operation
+*/
+ULONG CCFDATACompressor::Destroy()
+{
+    ULONG i;
+
+    if (Jobs == NULL)
+        return CAB_STATUS_SUCCESS;
+
+    LockAcquire(&Lock);
+    Stopping = true;
+    ConditionBroadcast(&WorkAvailable);
+    LockRelease(&Lock);
+
+    for (i = 0; i < ThreadCount; i++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(Threads[i], INFINITE);
+        CloseHandle(Threads[i]);
+#else
+        pthread_join(Threads[i], NULL);
+#endif
+    }
+    ThreadCount = 0;
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&Lock);
+#else
+    pthread_cond_destroy(&BlockDone);
+    pthread_cond_destroy(&WorkAvailable);
+    pthread_mutex_destroy(&Lock);
+#endif
+
+    free(Jobs);
+    Jobs = NULL;
+
+    return CAB_STATUS_SUCCESS;
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Returns whether there are no queued blocks
+*/
+bool CCFDATACompressor::IsEmpty()
+{
+    /* Only the thread queuing the blocks changes Head and Tail */
+    return (Head == Tail);
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Returns whether no more blocks can be queued until the oldest one is released
+*/
+bool CCFDATACompressor::IsFull()
+{
+    return (Tail - Head == JobCount);
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Queues a data block for compression
+*
+* @param Buffer
+* Uncompressed data, it is copied so the buffer may be reused at once
+*
+* @param Size
+* Size of the uncompressed data
+*
+* @param FolderNode
+* Folder the data block belongs to
+*
+* @return
+* Status of operation
+*/
+ULONG CCFDATACompressor::QueueBlock(void* Buffer, ULONG Size, PCFFOLDER_NODE FolderNode)
+{
+    PCFDATA_JOB Job;
+
+    ASSERT(!IsFull());
+    ASSERT(Size <= CAB_BLOCKSIZE);
+
+    /* No thread looks at the slots past Tail */
+    Job = &Jobs[Tail % JobCount];
+    memcpy(Job->InputBuffer, Buffer, Size);
+    Job->InputSize  = Size;
+    Job->OutputSize = 0;
+    Job->Status     = CS_SUCCESS;
+    Job->FolderNode = FolderNode;
+    Job->Done       = false;
+
+    LockAcquire(&Lock);
+    Tail++;
+    ConditionSignal(&WorkAvailable);
+    LockRelease(&Lock);
+
+    return CAB_STATUS_SUCCESS;
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Waits until the oldest queued block is compressed
+*
+* @return
+* The oldest queued block. It stays valid until ReleaseBlock is called
+*/
+PCFDATA_JOB CCFDATACompressor::WaitForBlock()
+{
+    PCFDATA_JOB Job;
+
+    ASSERT(!IsEmpty());
+
+    Job = &Jobs[Head % JobCount];
+
+    LockAcquire(&Lock);
+    while (!Job->Done)
+        ConditionWait(&BlockDone, &Lock);
+    LockRelease(&Lock);
+
+    return Job;
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Frees the slot of the oldest queued block
+*/
+void CCFDATACompressor::ReleaseBlock()
+{
+    ASSERT(!IsEmpty());
+
+    LockAcquire(&Lock);
+    Head++;
+    LockRelease(&Lock);
+}
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Returns the time spent compressing, summed over all threads
+*/
+double CCFDATACompressor::GetCompressTime()
+{
+    double Time;
+
+    LockAcquire(&Lock);
+    Time = CompressTime;
+    LockRelease(&Lock);
+
+    return Time;
+}
+
+#if defined(_WIN32)
+DWORD WINAPI CCFDATACompressor::ThreadProc(LPVOID Context)
+{
+    ((CCFDATACompressor*)Context)->CompressBlocks();
+    return 0;
+}
+#else
+void* CCFDATACompressor::ThreadProc(void* Context)
+{
+    ((CCFDATACompressor*)Context)->CompressBlocks();
+    return NULL;
+}
+#endif
+
+/**
+* @name CCFDATACompressor class
+* @implemented
+*
+* Compression thread. Takes the queued blocks in order until the compressor is destroyed
+*/
+void CCFDATACompressor::CompressBlocks()
+{
+    CCABCodec* Codec;
+    PCFDATA_JOB Job;
+    double Start, Elapsed;
+
+    /* Each thread has its own codec, so its state is reused from block to block */
+    Codec = CCabinet::CreateCodec(CodecId);
+
+    LockAcquire(&Lock);
+    for (;;)
+    {
+        while ((Next == Tail) && !Stopping)
+            ConditionWait(&WorkAvailable, &Lock);
+
+        if (Stopping)
+            break;
+
+        Job = &Jobs[Next % JobCount];
+        Next++;
+        LockRelease(&Lock);
+
+        Start = GetTimeInSeconds();
+        if (Codec)
+        {
+            Job->Status = Codec->Compress(Job->OutputBuffer,
+                                          Job->InputBuffer,
+                                          Job->InputSize,
+                                          &Job->OutputSize);
+        }
+        else
+        {
+            Job->Status = CS_NOMEMORY;
+        }
+        Elapsed = GetTimeInSeconds() - Start;
+
+        LockAcquire(&Lock);
+        CompressTime += Elapsed;
+        Job->Done = true;
+        ConditionBroadcast(&BlockDone);
+    }
+    LockRelease(&Lock);
+
+    delete Codec;
+}
+
+#endif /* CAB_READ_ONLY */
+
+/* EOF */
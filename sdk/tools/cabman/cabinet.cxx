@@ -105,6 +105,10 @@ CCabinet::CCabinet()
     BytesLeftInBlock = 0;
     ReuseBlock       = false;
     CurrentDataNode  = NULL;
+
+    Compressor  = NULL;
+    ThreadCount = 0;
+    memset(PhaseTime, 0, sizeof(PhaseTime));
 }
 
 
@@ -122,6 +126,14 @@ CCabinet::~CCabinet()
 
     if (CodecSelected)
         delete Codec;
+
+#ifndef CAB_READ_ONLY
+    if (Compressor)
+    {
+        Compressor->Destroy();
+        delete Compressor;
+    }
+#endif /* CAB_READ_ONLY */
 }
 
 bool CCabinet::IsSeparator(char Char)
@@ -1106,6 +1118,28 @@ bool CCabinet::IsCodecSelected()
     return CodecSelected;
 }
 
+CCABCodec* CCabinet::CreateCodec(LONG Id)
+/*
+ * FUNCTION: Creates an instance of a codec engine
+ * ARGUMENTS:
+ *     Id = Codec identifier
+ * RETURNS:
+ *     Pointer to the codec, NULL if the identifier is unknown
+ */
+{
+    switch (Id)
+    {
+        case CAB_CODEC_RAW:
+            return new CRawCodec();
+
+        case CAB_CODEC_MSZIP:
+            return new CMSZipCodec();
+
+        default:
+            return NULL;
+    }
+}
+
 void CCabinet::SelectCodec(LONG Id)
 /*
  * FUNCTION: Selects codec engine to use
@@ -1120,22 +1154,23 @@ void CCabinet::SelectCodec(LONG Id)
 
         CodecSelected = false;
         delete Codec;
-    }
-
-    switch (Id)
-    {
-        case CAB_CODEC_RAW:
-            Codec = new CRawCodec();
-            break;
-
-        case CAB_CODEC_MSZIP:
-            Codec = new CMSZipCodec();
-            break;
 
-        default:
-            return;
+#ifndef CAB_READ_ONLY
+        /* The compression threads use their own instances of the codec */
+        if (Compressor)
+        {
+            FlushDataBlocks();
+            Compressor->Destroy();
+            delete Compressor;
+            Compressor = NULL;
+        }
+#endif /* CAB_READ_ONLY */
     }
 
+    Codec = CreateCodec(Id);
+    if (!Codec)
+        return;
+
     CodecId       = Id;
     CodecSelected = true;
 }
@@ -1153,6 +1188,7 @@ ULONG CCabinet::NewCabinet()
  */
 {
     ULONG Status;
+    ULONG Count;
 
     CurrentDiskNumber = 0;
 
@@ -1166,6 +1202,19 @@ ULONG CCabinet::NewCabinet()
     CurrentIBuffer     = InputBuffer;
     CurrentIBufferSize = 0;
 
+    Count = ThreadCount ? ThreadCount : CCFDATACompressor::GetProcessorCount();
+    if (!Compressor && (Count > 1))
+    {
+        Compressor = new CCFDATACompressor;
+        Status = Compressor->Create(CodecId, Count);
+        if (Status != CAB_STATUS_SUCCESS)
+        {
+            /* Compress the blocks one after the other */
+            delete Compressor;
+            Compressor = NULL;
+        }
+    }
+
     CABHeader.Signature     = CAB_SIGNATURE;
     CABHeader.Reserved1     = 0;            // Not used
     CABHeader.CabinetSize   = 0;            // Not yet known
@@ -1223,6 +1272,12 @@ ULONG CCabinet::NewDisk()
  *     Status of operation
  */
 {
+    ULONG Status;
+
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
     // NextFolderNumber is 0-based
     NextFolderNumber = 1;
 
@@ -1247,8 +1302,14 @@ ULONG CCabinet::NewFolder()
  *     Status of operation
  */
 {
+    ULONG Status;
+
     DPRINT(MAX_TRACE, ("Creating new folder.\n"));
 
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
     CurrentFolderNode = NewFolderNode();
     if (!CurrentFolderNode)
     {
@@ -1298,6 +1359,7 @@ ULONG CCabinet::WriteFileToScratchStorage(PCFFILE_NODE FileNode)
     ULONG BytesRead;
     ULONG Status;
     ULONG Size;
+    double Start;
 
     if (!ContinueFile)
     {
@@ -1347,7 +1409,11 @@ ULONG CCabinet::WriteFileToScratchStorage(PCFFILE_NODE FileNode)
             else
                 BytesToRead = TotalBytesLeft;
 
-            if ( (BytesRead = fread(CurrentIBuffer, 1, BytesToRead, SourceFile)) != BytesToRead )
+            Start = GetTimeInSeconds();
+            BytesRead = fread(CurrentIBuffer, 1, BytesToRead, SourceFile);
+            PhaseTime[CAB_PHASE_READ] += GetTimeInSeconds() - Start;
+
+            if (BytesRead != BytesToRead)
             {
                 DPRINT(MIN_TRACE, ("Cannot read from file. BytesToRead (%u)  BytesRead (%u)  CurrentIBufferSize (%u).\n",
                     (UINT)BytesToRead, (UINT)BytesRead, (UINT)CurrentIBufferSize));
@@ -1496,6 +1562,14 @@ ULONG CCabinet::CommitDisk(ULONG MoreDisks)
 {
     PCFFOLDER_NODE FolderNode;
     ULONG Status;
+    double Start;
+
+    /* The file entries and the folder sizes need all data blocks */
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
+    Start = GetTimeInSeconds();
 
     OnCabinetName(CurrentDiskNumber, CabinetName);
 
@@ -1550,6 +1624,8 @@ ULONG CCabinet::CommitDisk(ULONG MoreDisks)
 
     ScratchFile->Truncate();
 
+    PhaseTime[CAB_PHASE_COMMIT] += GetTimeInSeconds() - Start;
+
     return CAB_STATUS_SUCCESS;
 }
 
@@ -1581,6 +1657,14 @@ ULONG CCabinet::CloseCabinet()
 {
     ULONG Status;
 
+    if (Compressor)
+    {
+        PhaseTime[CAB_PHASE_COMPRESS] += Compressor->GetCompressTime();
+        Compressor->Destroy();
+        delete Compressor;
+        Compressor = NULL;
+    }
+
     DestroyFileNodes();
 
     DestroyFolderNodes();
@@ -1829,6 +1913,34 @@ cleanup2:
     return bRet;
 }
 
+void CCabinet::SetThreadCount(ULONG Count)
+/*
+ * FUNCTION: Sets the number of threads used for compression
+ * ARGUMENTS:
+ *     Count = Number of threads, 1 to compress the blocks in the main
+ *             thread, 0 for one thread per processor
+ */
+{
+    ThreadCount = Count;
+}
+
+
+double CCabinet::GetPhaseTime(ULONG Phase)
+/*
+ * FUNCTION: Returns the time spent in a phase of cabinet creation
+ * ARGUMENTS:
+ *     Phase = Phase identifier (CAB_PHASE_*)
+ * RETURNS:
+ *     Time in seconds
+ */
+{
+    if (Phase >= CAB_PHASE_COUNT)
+        return 0;
+
+    return PhaseTime[Phase];
+}
+
+
 void CCabinet::SetMaxDiskSize(ULONG Size)
 /*
  * FUNCTION: Sets the maximum size of the current disk
@@ -2983,15 +3095,42 @@ ULONG CCabinet::WriteDataBlock()
  */
 {
     ULONG Status;
-    ULONG BytesWritten;
-    PCFDATA_NODE DataNode;
+    double Start;
+
+    /* Without a disk size limit no block is ever split, so the blocks
+       can be compressed in parallel and written in order afterwards */
+    if (Compressor && (MaxDiskSize == 0) && !BlockIsSplit)
+    {
+        if (Compressor->IsFull())
+        {
+            Status = WriteCompressedBlock();
+            if (Status != CAB_STATUS_SUCCESS)
+                return Status;
+        }
+
+        Status = Compressor->QueueBlock(InputBuffer, CurrentIBufferSize, CurrentFolderNode);
+        if (Status != CAB_STATUS_SUCCESS)
+            return Status;
+
+        CurrentIBufferSize = 0;
+        CurrentIBuffer     = InputBuffer;
+
+        return CAB_STATUS_SUCCESS;
+    }
+
+    /* Blocks compressed in parallel come first */
+    Status = FlushDataBlocks();
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
 
     if (!BlockIsSplit)
     {
+        Start = GetTimeInSeconds();
         Status = Codec->Compress(OutputBuffer,
             InputBuffer,
             CurrentIBufferSize,
             &TotalCompSize);
+        PhaseTime[CAB_PHASE_COMPRESS] += GetTimeInSeconds() - Start;
 
         DPRINT(MAX_TRACE, ("Block compressed. CurrentIBufferSize (%u)  TotalCompSize(%u).\n",
             (UINT)CurrentIBufferSize, (UINT)TotalCompSize));
@@ -3000,7 +3139,36 @@ ULONG CCabinet::WriteDataBlock()
         CurrentOBufferSize = TotalCompSize;
     }
 
-    DataNode = NewDataNode(CurrentFolderNode);
+    Status = StoreDataBlock(CurrentFolderNode, CurrentIBufferSize);
+    if (Status != CAB_STATUS_SUCCESS)
+        return Status;
+
+    if (!BlockIsSplit)
+    {
+        CurrentIBufferSize = 0;
+        CurrentIBuffer     = InputBuffer;
+    }
+
+    return CAB_STATUS_SUCCESS;
+}
+
+
+ULONG CCabinet::StoreDataBlock(PCFFOLDER_NODE FolderNode, ULONG UncompSize)
+/*
+ * FUNCTION: Writes the compressed data in CurrentOBuffer to the scratch file
+ * ARGUMENTS:
+ *     FolderNode = Pointer to folder node the data block belongs to
+ *     UncompSize = Uncompressed size of the data block
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    ULONG Status;
+    ULONG BytesWritten;
+    PCFDATA_NODE DataNode;
+    double Start;
+
+    DataNode = NewDataNode(FolderNode);
     if (!DataNode)
     {
         DPRINT(MIN_TRACE, ("Insufficient memory.\n"));
@@ -3024,7 +3192,7 @@ ULONG CCabinet::WriteDataBlock()
     else
     {
         DataNode->Data.CompSize   = (USHORT)CurrentOBufferSize;
-        DataNode->Data.UncompSize = (USHORT)CurrentIBufferSize;
+        DataNode->Data.UncompSize = (USHORT)UncompSize;
     }
 
     DataNode->Data.Checksum = 0;
@@ -3038,25 +3206,85 @@ ULONG CCabinet::WriteDataBlock()
         DataNode->Data.CompSize,
         DataNode->Data.UncompSize));
 
+    Start = GetTimeInSeconds();
     Status = ScratchFile->WriteBlock(&DataNode->Data,
         CurrentOBuffer, &BytesWritten);
+    PhaseTime[CAB_PHASE_SCRATCH] += GetTimeInSeconds() - Start;
     if (Status != CAB_STATUS_SUCCESS)
         return Status;
 
     DiskSize += BytesWritten;
 
-    CurrentFolderNode->TotalFolderSize += (BytesWritten + sizeof(CFDATA));
-    CurrentFolderNode->Folder.DataBlockCount++;
+    FolderNode->TotalFolderSize += (BytesWritten + sizeof(CFDATA));
+    FolderNode->Folder.DataBlockCount++;
 
     CurrentOBuffer = (unsigned char*)CurrentOBuffer + DataNode->Data.CompSize;
     CurrentOBufferSize -= DataNode->Data.CompSize;
 
     LastBlockStart += DataNode->Data.UncompSize;
 
-    if (!BlockIsSplit)
+    return CAB_STATUS_SUCCESS;
+}
+
+
+ULONG CCabinet::WriteCompressedBlock()
+/*
+ * FUNCTION: Writes the oldest data block queued for parallel compression
+ *           to the scratch file, waiting until it is compressed
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    PCFDATA_JOB Job;
+    ULONG Status;
+    double Start;
+
+    Start = GetTimeInSeconds();
+    Job = Compressor->WaitForBlock();
+    PhaseTime[CAB_PHASE_WAIT] += GetTimeInSeconds() - Start;
+
+    if (Job->Status != CS_SUCCESS)
     {
-        CurrentIBufferSize = 0;
-        CurrentIBuffer     = InputBuffer;
+        DPRINT(MIN_TRACE, ("Cannot compress data block (%u).\n", (UINT)Job->Status));
+        Compressor->ReleaseBlock();
+        return (Job->Status == CS_NOMEMORY) ? CAB_STATUS_NOMEMORY : CAB_STATUS_FAILURE;
+    }
+
+    DPRINT(MAX_TRACE, ("Block compressed. InputSize (%u)  OutputSize(%u).\n",
+        (UINT)Job->InputSize, (UINT)Job->OutputSize));
+
+    CurrentOBuffer     = Job->OutputBuffer;
+    CurrentOBufferSize = Job->OutputSize;
+
+    Status = StoreDataBlock(Job->FolderNode, Job->InputSize);
+
+    /* The output buffer goes away with the block */
+    CurrentOBuffer     = OutputBuffer;
+    CurrentOBufferSize = 0;
+
+    Compressor->ReleaseBlock();
+
+    return Status;
+}
+
+
+ULONG CCabinet::FlushDataBlocks()
+/*
+ * FUNCTION: Writes all data blocks queued for parallel compression to the scratch file
+ * RETURNS:
+ *     Status of operation
+ */
+{
+    ULONG Status;
+
+    if (!Compressor)
+        return CAB_STATUS_SUCCESS;
+
+    while (!Compressor->IsEmpty())
+    {
+        Status = WriteCompressedBlock();
+        if (Status != CAB_STATUS_SUCCESS)
+            return Status;
     }
 
     return CAB_STATUS_SUCCESS;
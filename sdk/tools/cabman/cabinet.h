@@ -14,6 +14,7 @@
 #else
     #include <typedefs.h>
     #include <unistd.h>
+    #include <pthread.h>
 #endif
 
 #include <errno.h>
@@ -54,6 +55,22 @@ inline LONG GetSizeOfFile(FILE* handle)
     return size;
 }
 
+inline double GetTimeInSeconds()
+{
+#if defined(_WIN32)
+    LARGE_INTEGER Counter, Frequency;
+
+    QueryPerformanceCounter(&Counter);
+    QueryPerformanceFrequency(&Frequency);
+    return (double)Counter.QuadPart / Frequency.QuadPart;
+#else
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec + Time.tv_nsec / 1e9;
+#endif
+}
+
 /* Debugging */
 
 #define NORMAL_MASK    0x000000FF
@@ -293,6 +310,15 @@ public:
 #define CAB_CODEC_MSZIP 0x02
 
 
+/* Phases of cabinet creation that are timed */
+#define CAB_PHASE_READ      0   /* Reading the files to add */
+#define CAB_PHASE_COMPRESS  1   /* Compressing data blocks, summed over all threads */
+#define CAB_PHASE_WAIT      2   /* Waiting for the compression threads */
+#define CAB_PHASE_SCRATCH   3   /* Writing data blocks to the scratch file */
+#define CAB_PHASE_COMMIT    4   /* Writing the cabinet files */
+#define CAB_PHASE_COUNT     5
+
+
 
 /* Classes */
 
@@ -317,6 +343,68 @@ private:
     FILE* FileHandle;
 };
 
+#define CAB_MAX_THREADS      64
+
+#if defined(_WIN32)
+typedef HANDLE CAB_THREAD;
+typedef CRITICAL_SECTION CAB_LOCK;
+typedef CONDITION_VARIABLE CAB_CONDITION;
+#else
+typedef pthread_t CAB_THREAD;
+typedef pthread_mutex_t CAB_LOCK;
+typedef pthread_cond_t CAB_CONDITION;
+#endif
+
+typedef struct _CFDATA_JOB
+{
+    unsigned char InputBuffer[CAB_BLOCKSIZE + 12];
+    unsigned char OutputBuffer[CAB_BLOCKSIZE + 12];
+    ULONG InputSize;                    // Uncompressed size of the block
+    ULONG OutputSize;                   // Compressed size of the block
+    ULONG Status;                       // Codec status (CS_*)
+    PCFFOLDER_NODE FolderNode;          // Folder the block belongs to
+    bool Done;                          // true once the block is compressed
+} CFDATA_JOB, *PCFDATA_JOB;
+
+class CCFDATACompressor
+{
+public:
+    /* Default constructor */
+    CCFDATACompressor();
+    /* Default destructor */
+    virtual ~CCFDATACompressor();
+    /* Returns the number of processors of the host */
+    static ULONG GetProcessorCount();
+    ULONG Create(LONG CodecId, ULONG ThreadCount);
+    ULONG Destroy();
+    bool IsEmpty();
+    bool IsFull();
+    ULONG QueueBlock(void* Buffer, ULONG Size, PCFFOLDER_NODE FolderNode);
+    PCFDATA_JOB WaitForBlock();
+    void ReleaseBlock();
+    double GetCompressTime();
+private:
+#if defined(_WIN32)
+    static DWORD WINAPI ThreadProc(LPVOID Context);
+#else
+    static void* ThreadProc(void* Context);
+#endif
+    void CompressBlocks();
+    PCFDATA_JOB Jobs;
+    ULONG JobCount;
+    ULONG Head;                         // Sequence number of the oldest queued block
+    ULONG Next;                         // Sequence number of the next block to compress
+    ULONG Tail;                         // Sequence number of the next block to queue
+    bool Stopping;
+    LONG CodecId;
+    ULONG ThreadCount;
+    CAB_THREAD Threads[CAB_MAX_THREADS];
+    CAB_LOCK Lock;
+    CAB_CONDITION WorkAvailable;
+    CAB_CONDITION BlockDone;
+    double CompressTime;
+};
+
 #endif /* CAB_READ_ONLY */
 
 class CCabinet
@@ -362,6 +450,8 @@ public:
     ULONG ExtractFile(char* FileName);
     /* Select codec engine to use */
     void SelectCodec(LONG Id);
+    /* Creates an instance of a codec engine */
+    static CCABCodec* CreateCodec(LONG Id);
     /* Returns whether a codec engine is selected */
     bool IsCodecSelected();
     /* Adds a search criteria for adding files to a simple cabinet, displaying files in a cabinet or extracting them */
@@ -396,6 +486,10 @@ public:
     ULONG AddFile(char* FileName);
     /* Sets the maximum size of the current disk */
     void SetMaxDiskSize(ULONG Size);
+    /* Sets the number of threads used for compression, 0 for one per processor */
+    void SetThreadCount(ULONG Count);
+    /* Returns the time spent in a phase of cabinet creation (CAB_PHASE_*) */
+    double GetPhaseTime(ULONG Phase);
 #endif /* CAB_READ_ONLY */
 
     /* Default event handlers */
@@ -439,6 +533,9 @@ private:
     ULONG WriteFileEntries();
     ULONG CommitDataBlocks(PCFFOLDER_NODE FolderNode);
     ULONG WriteDataBlock();
+    ULONG StoreDataBlock(PCFFOLDER_NODE FolderNode, ULONG UncompSize);
+    ULONG WriteCompressedBlock();
+    ULONG FlushDataBlocks();
     ULONG GetAttributesOnFile(PCFFILE_NODE File);
     ULONG SetAttributesOnFile(char* FileName, USHORT FileAttributes);
     ULONG GetFileTimes(FILE* FileHandle, PCFFILE_NODE File);
@@ -504,6 +601,9 @@ private:
     ULONG TotalBytesLeft;
     bool BlockIsSplit;                  // true if current data block is split
     ULONG NextFolderNumber;     // Zero based folder number
+    CCFDATACompressor *Compressor;      // Compresses data blocks in parallel, NULL if not used
+    ULONG ThreadCount;
+    double PhaseTime[CAB_PHASE_COUNT];
 #endif /* CAB_READ_ONLY */
 };
 
@@ -31,6 +31,7 @@ private:
     bool CreateCabinet();
     bool DisplayCabinet();
     bool ExtractFromCabinet();
+    void PrintTimings(double TotalTime);
     /* Event handlers */
     virtual bool OnOverwrite(PCFFILE File, char* FileName);
     virtual void OnExtract(PCFFILE File, char* FileName);
@@ -42,6 +43,7 @@ private:
     bool PromptOnOverwrite;
     char FileName[PATH_MAX];
     bool Verbose;
+    bool ShowTimings;
 };
 
 extern CCABManager CABMgr;
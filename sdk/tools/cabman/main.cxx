@@ -174,6 +174,7 @@ CCABManager::CCABManager()
     Mode = CM_MODE_DISPLAY;
     FileName[0] = 0;
     Verbose = false;
+    ShowTimings = false;
 }
 
 
@@ -192,8 +193,8 @@ void CCABManager::Usage()
 {
     printf("ReactOS Cabinet Manager\n\n");
     printf("CABMAN [-D | -E] [-A] [-L dir] cabinet [filename ...]\n");
-    printf("CABMAN [-M mode] -C dirfile [-I] [-RC file] [-P dir]\n");
-    printf("CABMAN [-M mode] -S cabinet filename [...]\n");
+    printf("CABMAN [-M mode] [-J n] [-T] -C dirfile [-I] [-RC file] [-P dir]\n");
+    printf("CABMAN [-M mode] [-J n] [-T] -S cabinet filename [...]\n");
     printf("  cabinet   Cabinet file.\n");
     printf("  filename  Name of the file to add to or extract from the cabinet.\n");
     printf("            Wild cards and multiple filenames\n");
@@ -207,6 +208,8 @@ void CCABManager::Usage()
     printf("  -D        Display cabinet directory.\n");
     printf("  -E        Extract files from cabinet.\n");
     printf("  -I        Don't create the cabinet, only the .inf file.\n");
+    printf("  -J n      Number of threads to compress with\n");
+    printf("            (default is one per processor, 1 compresses in the main thread).\n");
     printf("  -L dir    Location to place extracted or generated files\n");
     printf("            (default is current directory).\n");
     printf("  -M mode   Specify the compression method to use:\n");
@@ -217,6 +220,7 @@ void CCABManager::Usage()
     printf("            (size must be less than 64KB).\n");
     printf("  -S        Create simple cabinet.\n");
     printf("  -P dir    Files in the .dff are relative to this directory.\n");
+    printf("  -T        Show how long each phase of creating the cabinet took.\n");
     printf("  -V        Verbose mode (prints more messages).\n");
 }
 
@@ -267,6 +271,23 @@ bool CCABManager::ParseCmdline(int argc, char* argv[])
                     InfFileOnly = true;
                     break;
 
+                case 'j':
+                case 'J':
+                    if (argv[i][2] == 0)
+                    {
+                        i++;
+                        if (i >= argc)
+                        {
+                            printf("ERROR: Missing number of threads.\n");
+                            return false;
+                        }
+                        SetThreadCount(strtoul(&argv[i][0], NULL, 10));
+                    }
+                    else
+                        SetThreadCount(strtoul(&argv[i][2], NULL, 10));
+
+                    break;
+
                 case 'l':
                 case 'L':
                     if (argv[i][2] == 0)
@@ -336,6 +357,11 @@ bool CCABManager::ParseCmdline(int argc, char* argv[])
                     Mode = CM_MODE_CREATE_SIMPLE;
                     break;
 
+                case 't':
+                case 'T':
+                    ShowTimings = true;
+                    break;
+
                 case 'P':
                     if (argv[i][2] == 0)
                     {
@@ -555,11 +581,30 @@ bool CCABManager::ExtractFromCabinet()
 }
 
 
+void CCABManager::PrintTimings(double TotalTime)
+/*
+ * FUNCTION: Display the time spent in each phase of creating the cabinet
+ * ARGUMENTS:
+ *     TotalTime = Time spent in total, in seconds
+ */
+{
+    printf("Reading files          %8.3fs\n", GetPhaseTime(CAB_PHASE_READ));
+    printf("Compressing            %8.3fs (all threads)\n", GetPhaseTime(CAB_PHASE_COMPRESS));
+    printf("Waiting for threads    %8.3fs\n", GetPhaseTime(CAB_PHASE_WAIT));
+    printf("Writing scratch file   %8.3fs\n", GetPhaseTime(CAB_PHASE_SCRATCH));
+    printf("Writing cabinet        %8.3fs\n", GetPhaseTime(CAB_PHASE_COMMIT));
+    printf("Total                  %8.3fs\n", TotalTime);
+}
+
+
 bool CCABManager::Run()
 /*
  * FUNCTION: Process cabinet
  */
 {
+    bool Status;
+    double Start;
+
     if (Verbose)
     {
         printf("ReactOS Cabinet Manager\n\n");
@@ -568,7 +613,11 @@ bool CCABManager::Run()
     switch (Mode)
     {
         case CM_MODE_CREATE:
-            return CreateCabinet();
+            Start = GetTimeInSeconds();
+            Status = CreateCabinet();
+            if (ShowTimings)
+                PrintTimings(GetTimeInSeconds() - Start);
+            return Status;
 
         case CM_MODE_DISPLAY:
             return DisplayCabinet();
@@ -577,7 +626,11 @@ bool CCABManager::Run()
             return ExtractFromCabinet();
 
         case CM_MODE_CREATE_SIMPLE:
-            return CreateSimpleCabinet();
+            Start = GetTimeInSeconds();
+            Status = CreateSimpleCabinet();
+            if (ShowTimings)
+                PrintTimings(GetTimeInSeconds() - Start);
+            return Status;
 
         default:
             break;
@@ -35,6 +35,8 @@ public:
 private:
     int Status;
     z_stream ZStream; /* Zlib stream */
+    z_stream DeflateStream; /* Zlib stream for compression, reset for each block */
+    bool DeflateInitialized;
 };
 
 /* EOF */
@@ -6,6 +6,7 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <rsym.h>
 
@@ -34,67 +35,127 @@ fixup_offset(size_t ImageBase, size_t offset)
     return offset;
 }
 
+/* The entries are sorted on Address by rsym, so look for the last one <= offset */
 PROSSYM_ENTRY
 find_offset(void *data, size_t offset)
 {
     PSYMBOLFILE_HEADER RosSymHeader = (PSYMBOLFILE_HEADER)data;
     PROSSYM_ENTRY Entries = (PROSSYM_ENTRY)((char *)data + RosSymHeader->SymbolsOffset);
     size_t symbols = RosSymHeader->SymbolsLength / sizeof(ROSSYM_ENTRY);
-    size_t i;
+    size_t low = 0, high = symbols, mid;
 
-    for (i = 0; i < symbols; i++)
+    /* Find the first entry > offset */
+    while (low < high)
     {
-        if (Entries[i].Address > offset)
-        {
-            if (!i--)
-                return NULL;
-            else
-                return &Entries[i];
-        }
+        mid = low + (high - low) / 2;
+        if (Entries[mid].Address > offset)
+            high = mid;
+        else
+            low = mid + 1;
     }
-    return NULL;
+
+    /* Like before, an offset past the last entry is not found */
+    if (low == 0 || low == symbols)
+        return NULL;
+    return &Entries[low - 1];
 }
 
-PIMAGE_SECTION_HEADER
-get_sectionheader(const void *FileData)
+/* Reads only the .rossym section of an image, it is all the translation needs */
+int
+load_rossym(const char *fname, void **RosSym)
 {
-    PIMAGE_DOS_HEADER PEDosHeader;
-    PIMAGE_FILE_HEADER PEFileHeader;
-    PIMAGE_OPTIONAL_HEADER PEOptHeader;
+    IMAGE_DOS_HEADER PEDosHeader;
+    IMAGE_FILE_HEADER PEFileHeader;
     PIMAGE_SECTION_HEADER PESectionHeaders;
     PIMAGE_SECTION_HEADER PERosSymSectionHeader;
-    size_t ImageBase;
+    PSYMBOLFILE_HEADER RosSymHeader;
+    size_t size;
+    void *data;
+    FILE *fr;
+
+    *RosSym = NULL;
+    fr = fopen(fname, "rb");
+    if (!fr)
+    {
+        l2l_dbg(3, "load_rossym, cannot open '%s' (%s)\n", fname, strerror(errno));
+        return 1;
+    }
 
     /* Check if MZ header exists */
-    PEDosHeader = (PIMAGE_DOS_HEADER)FileData;
-    if (PEDosHeader->e_magic != IMAGE_DOS_MAGIC || PEDosHeader->e_lfanew == 0L)
+    if (fread(&PEDosHeader, sizeof(IMAGE_DOS_HEADER), 1, fr) != 1 ||
+        PEDosHeader.e_magic != IMAGE_DOS_MAGIC || PEDosHeader.e_lfanew == 0L)
     {
         l2l_dbg(0, "Input file is not a PE image.\n");
         summ.offset_errors++;
-        return NULL;
+        fclose(fr);
+        return 2;
     }
 
     /* Locate PE file header */
     /* sizeof(ULONG) = sizeof(MAGIC) */
-    PEFileHeader = (PIMAGE_FILE_HEADER)((char *)FileData + PEDosHeader->e_lfanew + sizeof(ULONG));
-
-    /* Locate optional header */
-    PEOptHeader = (PIMAGE_OPTIONAL_HEADER)(PEFileHeader + 1);
-    ImageBase = PEOptHeader->ImageBase;
+    if (fseek(fr, PEDosHeader.e_lfanew + sizeof(ULONG), SEEK_SET) ||
+        fread(&PEFileHeader, sizeof(IMAGE_FILE_HEADER), 1, fr) != 1)
+    {
+        l2l_dbg(0, "Input file is not a PE image.\n");
+        summ.offset_errors++;
+        fclose(fr);
+        return 2;
+    }
 
-    /* Locate PE section headers */
-    PESectionHeaders = (PIMAGE_SECTION_HEADER)((char *)PEOptHeader + PEFileHeader->SizeOfOptionalHeader);
+    /* Skip the optional header and read the section headers */
+    PESectionHeaders = malloc(PEFileHeader.NumberOfSections * sizeof(IMAGE_SECTION_HEADER));
+    if (!PESectionHeaders ||
+        fseek(fr, PEFileHeader.SizeOfOptionalHeader, SEEK_CUR) ||
+        fread(PESectionHeaders, sizeof(IMAGE_SECTION_HEADER), PEFileHeader.NumberOfSections, fr) != PEFileHeader.NumberOfSections)
+    {
+        l2l_dbg(1, "load_rossym %s, read error IMAGE_SECTION_HEADER (%s)\n", fname, strerror(errno));
+        free(PESectionHeaders);
+        fclose(fr);
+        return 1;
+    }
 
     /* find rossym section */
-    PERosSymSectionHeader = find_rossym_section(PEFileHeader, PESectionHeaders);
+    PERosSymSectionHeader = find_rossym_section(&PEFileHeader, PESectionHeaders);
     if (!PERosSymSectionHeader)
     {
         l2l_dbg(0, "Couldn't find rossym section in executable\n");
         summ.offset_errors++;
-        return NULL;
+        free(PESectionHeaders);
+        fclose(fr);
+        return 2;
+    }
+
+    size = PERosSymSectionHeader->SizeOfRawData;
+    data = malloc(size ? size : 1);
+    if (!data ||
+        fseek(fr, PERosSymSectionHeader->PointerToRawData, SEEK_SET) ||
+        fread(data, 1, size, fr) != size)
+    {
+        l2l_dbg(1, "load_rossym %s, read error .rossym (%s)\n", fname, strerror(errno));
+        free(data);
+        free(PESectionHeaders);
+        fclose(fr);
+        return 1;
     }
+    free(PESectionHeaders);
+    fclose(fr);
 
-    return PERosSymSectionHeader;
+    /* Don't trust the offsets further than the section goes */
+    RosSymHeader = (PSYMBOLFILE_HEADER)data;
+    if (size < sizeof(SYMBOLFILE_HEADER) ||
+        RosSymHeader->SymbolsOffset > size ||
+        RosSymHeader->SymbolsLength > size - RosSymHeader->SymbolsOffset ||
+        RosSymHeader->StringsOffset > size ||
+        RosSymHeader->StringsLength > size - RosSymHeader->StringsOffset)
+    {
+        l2l_dbg(0, "Invalid rossym section in executable\n");
+        summ.offset_errors++;
+        free(data);
+        return 2;
+    }
+
+    *RosSym = data;
+    return 0;
 }
 
 int
@@ -13,7 +13,7 @@ size_t fixup_offset(size_t ImageBase, size_t offset);
 
 PROSSYM_ENTRY find_offset(void *data, size_t offset);
 
-PIMAGE_SECTION_HEADER get_sectionheader(const void *FileData);
+int load_rossym(const char *fname, void **RosSym);
 
 int get_ImageBase(char *fname, size_t *ImageBase);
 
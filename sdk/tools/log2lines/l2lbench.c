@@ -0,0 +1,268 @@
+/*
+ * PROJECT:     ReactOS log2lines
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Benchmark for the log2lines translation
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ *
+ * Generates a set of images that only have a .rossym section and a sample
+ * debug log with backtrace addresses into them, then runs each log2lines
+ * given on the command line over the log. The output is checked against
+ * the lines the addresses map to, and the time each log2lines took is
+ * printed, so an older build can be compared with the current one.
+ *
+ * Usage: l2lbench <log2lines> [<log2lines> ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <rsym.h>
+
+#include "compat.h"
+
+#define WORK_DIR    "l2lbench.tmp"
+#define IMAGE_DIR   WORK_DIR "/images"
+#define SAMPLE_LOG  WORK_DIR "/sample.log"
+#define EXPECT_LOG  WORK_DIR "/expect.log"
+#define OUTPUT_LOG  WORK_DIR "/output.log"
+
+#define IMAGES      16
+#define SYMBOLS     20000   /* per image */
+#define FUNCTIONS   500
+#define FILES       40
+#define LOG_LINES   20000
+#define FIRST_ADDR  0x1000
+#define ADDR_STEP   16
+
+/* The strings of every image are the same, these are their offsets */
+static ULONG FunctionOffsets[FUNCTIONS], FileOffsets[FILES];
+
+static ULONG BuildStrings(char *Strings)
+{
+    ULONG Length = 0;
+    int i;
+
+    for (i = 0; i < FUNCTIONS; i++)
+    {
+        FunctionOffsets[i] = Length;
+        Length += sprintf(Strings + Length, "Function%d", i) + 1;
+    }
+    for (i = 0; i < FILES; i++)
+    {
+        FileOffsets[i] = Length;
+        Length += sprintf(Strings + Length, "sdk/lib/bench/file%d.c", i) + 1;
+    }
+
+    return Length;
+}
+
+static void SymbolOf(int Image, int Symbol, int *Function, int *File, ULONG *Line)
+{
+    *Function = (Image * 7 + Symbol / 40) % FUNCTIONS;
+    *File = (Image + Symbol / 500) % FILES;
+    *Line = Symbol + 1;
+}
+
+static int WriteImage(int Image)
+{
+    static char Strings[FUNCTIONS * 16 + FILES * 32];
+    static ROSSYM_ENTRY Entries[SYMBOLS];
+    IMAGE_DOS_HEADER DosHeader;
+    IMAGE_FILE_HEADER FileHeader;
+    IMAGE_OPTIONAL_HEADER OptHeader;
+    IMAGE_SECTION_HEADER SectionHeader;
+    SYMBOLFILE_HEADER RosSymHeader;
+    ULONG Signature = IMAGE_NT_SIGNATURE, StringsLength;
+    char Name[64];
+    FILE *f;
+    int i, File, Function;
+
+    StringsLength = BuildStrings(Strings);
+    for (i = 0; i < SYMBOLS; i++)
+    {
+        SymbolOf(Image, i, &Function, &File, &Entries[i].SourceLine);
+        Entries[i].Address = FIRST_ADDR + i * ADDR_STEP;
+        Entries[i].FunctionOffset = FunctionOffsets[Function];
+        Entries[i].FileOffset = FileOffsets[File];
+    }
+
+    memset(&DosHeader, 0, sizeof(DosHeader));
+    DosHeader.e_magic = IMAGE_DOS_MAGIC;
+    DosHeader.e_lfanew = sizeof(DosHeader);
+
+    memset(&FileHeader, 0, sizeof(FileHeader));
+    FileHeader.Machine = IMAGE_FILE_MACHINE_I386;
+    FileHeader.NumberOfSections = 1;
+    FileHeader.SizeOfOptionalHeader = sizeof(OptHeader);
+
+    memset(&OptHeader, 0, sizeof(OptHeader));
+    OptHeader.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+    OptHeader.ImageBase = 0x10000000 + Image * 0x100000;
+
+    RosSymHeader.SymbolsOffset = sizeof(RosSymHeader);
+    RosSymHeader.SymbolsLength = sizeof(Entries);
+    RosSymHeader.StringsOffset = RosSymHeader.SymbolsOffset + RosSymHeader.SymbolsLength;
+    RosSymHeader.StringsLength = StringsLength;
+
+    memset(&SectionHeader, 0, sizeof(SectionHeader));
+    strcpy((char *)SectionHeader.Name, ".rossym");
+    SectionHeader.PointerToRawData = sizeof(DosHeader) + sizeof(Signature) + sizeof(FileHeader) +
+                                     sizeof(OptHeader) + sizeof(SectionHeader);
+    SectionHeader.SizeOfRawData = RosSymHeader.StringsOffset + StringsLength;
+
+    sprintf(Name, IMAGE_DIR "/bench%02d.dll", Image);
+    f = fopen(Name, "wb");
+    if (!f)
+        return 0;
+    fwrite(&DosHeader, sizeof(DosHeader), 1, f);
+    fwrite(&Signature, sizeof(Signature), 1, f);
+    fwrite(&FileHeader, sizeof(FileHeader), 1, f);
+    fwrite(&OptHeader, sizeof(OptHeader), 1, f);
+    fwrite(&SectionHeader, sizeof(SectionHeader), 1, f);
+    fwrite(&RosSymHeader, sizeof(RosSymHeader), 1, f);
+    fwrite(Entries, sizeof(Entries), 1, f);
+    fwrite(Strings, StringsLength, 1, f);
+    return fclose(f) == 0;
+}
+
+/* Addresses before the first and past the last entry stay untranslated */
+static int WriteLogs(void)
+{
+    static char Strings[FUNCTIONS * 16 + FILES * 32];
+    FILE *Sample, *Expect;
+    ULONG Offset, Line;
+    int i, Image, Symbol, Function, File;
+
+    BuildStrings(Strings);
+    Sample = fopen(SAMPLE_LOG, "w");
+    Expect = fopen(EXPECT_LOG, "w");
+    if (!Sample || !Expect)
+        return 0;
+
+    for (i = 0; i < LOG_LINES; i++)
+    {
+        Image = rand() % IMAGES;
+        Offset = FIRST_ADDR - 0x100 + (((ULONG)rand() << 15) ^ (ULONG)rand()) % (SYMBOLS * ADDR_STEP + 0x200);
+
+        fprintf(Sample, "<bench%02d.dll:%x> Frame %d\n", Image, (unsigned int)Offset, i % 10);
+
+        Symbol = (int)((Offset - FIRST_ADDR) / ADDR_STEP);
+        if (Offset < FIRST_ADDR || Symbol >= SYMBOLS - 1)
+        {
+            fprintf(Expect, "<bench%02d.dll:%x> Frame %d\n", Image, (unsigned int)Offset, i % 10);
+            continue;
+        }
+
+        SymbolOf(Image, Symbol, &Function, &File, &Line);
+        fprintf(Expect, "<bench%02d.dll:%x (%s:%u (%s))> Frame %d\n",
+                Image, (unsigned int)Offset,
+                &Strings[FileOffsets[File]], (unsigned int)Line, &Strings[FunctionOffsets[Function]], i % 10);
+    }
+
+    return fclose(Sample) == 0 && fclose(Expect) == 0;
+}
+
+static int CompareLogs(const char *Tool)
+{
+    char Output[1024], Expect[1024];
+    FILE *fo, *fe;
+    int Line = 0, Same = 1;
+
+    fo = fopen(OUTPUT_LOG, "r");
+    fe = fopen(EXPECT_LOG, "r");
+    if (!fo || !fe)
+    {
+        fprintf(stderr, "%s: output not written\n", Tool);
+        return 0;
+    }
+
+    while (fgets(Expect, sizeof(Expect), fe))
+    {
+        Line++;
+        if (!fgets(Output, sizeof(Output), fo))
+        {
+            fprintf(stderr, "%s: output ends at line %d\n", Tool, Line);
+            Same = 0;
+            break;
+        }
+        if (strcmp(Output, Expect) != 0)
+        {
+            fprintf(stderr, "%s: line %d is\n  %s  expected\n  %s", Tool, Line, Output, Expect);
+            Same = 0;
+            break;
+        }
+    }
+
+    fclose(fo);
+    fclose(fe);
+    return Same;
+}
+
+static double Now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    char Command[1024];
+    double Start, Elapsed;
+    int i, Result = 0;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <log2lines> [<log2lines> ...]\n", argv[0]);
+        return 1;
+    }
+
+    srand(1);
+    MKDIR(WORK_DIR);
+    MKDIR(IMAGE_DIR);
+    for (i = 0; i < IMAGES; i++)
+    {
+        if (!WriteImage(i))
+        {
+            fprintf(stderr, "Image %d not written\n", i);
+            return 1;
+        }
+    }
+    if (!WriteLogs())
+    {
+        fprintf(stderr, "Sample log not written\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        /* Scan the images once, so only the translation is timed */
+        sprintf(Command, "%s -F -d %s", argv[i], IMAGE_DIR);
+        if (system(Command) != 0)
+        {
+            fprintf(stderr, "%s: cache not created\n", argv[i]);
+            Result = 1;
+            continue;
+        }
+
+        sprintf(Command, "%s -d %s < %s > %s", argv[i], IMAGE_DIR, SAMPLE_LOG, OUTPUT_LOG);
+        Start = Now();
+        if (system(Command) != 0)
+        {
+            fprintf(stderr, "%s: translation failed\n", argv[i]);
+            Result = 1;
+            continue;
+        }
+        Elapsed = Now() - Start;
+
+        if (CompareLogs(argv[i]))
+            printf("%s: %d lines in %.3f s, %.0f lines/s\n", argv[i], LOG_LINES, Elapsed, LOG_LINES / Elapsed);
+        else
+            Result = 1;
+    }
+
+    return Result;
+}
@@ -50,6 +50,8 @@ entry_delete(PLIST_MEMBER pentry)
         return NULL;
     if (pentry->buf)
         free(pentry->buf);
+    if (pentry->RosSym)
+        free(pentry->RosSym);
     free(pentry);
     return NULL;
 }
@@ -128,6 +130,7 @@ cache_entry_create(char *Line)
     pentry = malloc(sizeof(LIST_MEMBER));
     if (!pentry)
         return NULL;
+    pentry->RosSym = NULL;
 
     l = strlen(Line);
     pentry->buf = s = malloc(l + 1);
@@ -184,6 +187,7 @@ sources_entry_create(PLIST list, char *path, char *prefix)
     pentry = malloc(sizeof(LIST_MEMBER));
     if (!pentry)
         return NULL;
+    pentry->RosSym = NULL;
 
     l = strlen(path) + strlen(prefix);
     pentry->buf = s = malloc(l + 1);
@@ -216,4 +220,39 @@ sources_entry_create(PLIST list, char *path, char *prefix)
     return pentry;
 }
 
+/* Keeps the .rossym section of an image, so it is read only once */
+PLIST_MEMBER
+images_entry_create(PLIST list, const char *name, const char *path, void *RosSym)
+{
+    PLIST_MEMBER pentry;
+    char *s = NULL;
+    int l;
+
+    pentry = malloc(sizeof(LIST_MEMBER));
+    if (!pentry)
+        return NULL;
+    pentry->RosSym = NULL;
+
+    l = strlen(name) + 1 + strlen(path);
+    pentry->buf = s = malloc(l + 1);
+    if (!s)
+    {
+        l2l_dbg(1, "Alloc entry failed\n");
+        return entry_delete(pentry);
+    }
+
+    strcpy(s, name);
+    pentry->name = s;
+    s += strlen(name) + 1;
+    strcpy(s, path);
+    pentry->path = s;
+    pentry->ImageBase = INVALID_BASE;
+    pentry->RelBase = INVALID_BASE;
+    pentry->Size = 0;
+    pentry->RosSym = RosSym;
+
+    l2l_dbg(2, "Inserting image %s (%s)\n", pentry->name, pentry->path);
+    return entry_insert(list, pentry);
+}
+
 /* EOF */
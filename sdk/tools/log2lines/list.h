@@ -8,6 +8,7 @@ typedef struct entry_struct
     size_t ImageBase;
     size_t RelBase;
     size_t Size;
+    void *RosSym;
     struct entry_struct *pnext;
 } LIST_MEMBER, *PLIST_MEMBER;
 
@@ -22,6 +23,7 @@ PLIST_MEMBER entry_delete(PLIST_MEMBER pentry);
 PLIST_MEMBER entry_insert(PLIST list, PLIST_MEMBER pentry);
 PLIST_MEMBER cache_entry_create(char *Line);
 PLIST_MEMBER sources_entry_create(PLIST list, char *path, char *prefix);
+PLIST_MEMBER images_entry_create(PLIST list, const char *name, const char *path, void *RosSym);
 void list_clear(PLIST list);
 
 /* EOF */
@@ -30,6 +30,7 @@ static const char *kdbg_prompt = KDBG_PROMPT;
 static const char *kdbg_cont   = KDBG_CONT;
 
 LIST sources;
+LIST images;
 LINEINFO lastLine;
 FILE *logFile        = NULL;
 LIST cache;
@@ -216,15 +217,11 @@ print_offset(void *data, size_t offset, char *toString)
 }
 
 static int
-process_data(const void *FileData, size_t offset, char *toString)
+process_data(void *RosSym, size_t offset, char *toString)
 {
     int res;
 
-    PIMAGE_SECTION_HEADER PERosSymSectionHeader = get_sectionheader((char *)FileData);
-    if (!PERosSymSectionHeader)
-        return 2;
-
-    res = print_offset((char *)FileData + PERosSymSectionHeader->PointerToRawData, offset, toString);
+    res = print_offset(RosSym, offset, toString);
     if (res)
     {
         if (toString)
@@ -239,22 +236,26 @@ process_data(const void *FileData, size_t offset, char *toString)
 }
 
 static int
-process_file(const char *file_name, size_t offset, char *toString)
+process_file(const char *name, const char *file_name, size_t offset, char *toString)
 {
-    void *FileData;
-    size_t FileSize;
-    int res = 1;
+    PLIST_MEMBER pentry;
+    void *RosSym;
+    int res;
 
-    FileData = load_file(file_name, &FileSize);
-    if (!FileData)
-    {
-        l2l_dbg(0, "An error occured loading '%s'\n", file_name);
-    }
-    else
+    res = load_rossym(file_name, &RosSym);
+    if (res)
     {
-        res = process_data(FileData, offset, toString);
-        free(FileData);
+        if (res == 1)
+            l2l_dbg(0, "An error occured loading '%s'\n", file_name);
+        return res;
     }
+
+    res = process_data(RosSym, offset, toString);
+
+    // Keep the symbols for the next offset in this image
+    pentry = images_entry_create(&images, name, file_name, RosSym);
+    if (!pentry)
+        free(RosSym);
     return res;
 }
 
@@ -270,6 +271,15 @@ translate_file(const char *cpath, size_t offset, char *toString)
     if (!path)
         return 1;
 
+    // Already loaded:
+    pentry = entry_lookup(&images, path);
+    if (pentry)
+    {
+        res = process_data(pentry->RosSym, offset, toString);
+        free(dpath);
+        return res;
+    }
+
     // The path could be absolute:
     if (get_ImageBase(path, &base))
     {
@@ -293,7 +303,7 @@ translate_file(const char *cpath, size_t offset, char *toString)
 
     if (!res)
     {
-        res = process_file(path, offset, toString);
+        res = process_file(dpath, path, offset, toString);
     }
 
     free(dpath);
@@ -557,6 +567,7 @@ main(int argc, const char **argv)
 
     memset(&cache, 0, sizeof(LIST));
     memset(&sources, 0, sizeof(LIST));
+    memset(&images, 0, sizeof(LIST));
     stat_clear(&summ);
     clearLastLine();
 
@@ -666,6 +677,7 @@ cleanup:
 
     list_clear(&sources);
     list_clear(&cache);
+    list_clear(&images);
 
     return res;
 }
@@ -28,6 +28,19 @@
 #define WRAP_OFFSET(x) ((VgaCrtcRegisters[SVGA_CRTC_EXT_DISPLAY_REG] & SVGA_CRTC_EXT_ADDR_WRAP) \
                        ? ((x) & 0xFFFFF) : LOWORD(x))
 
+/*
+ * Activate FRAME_TIME_DISPLAY if you want to display how long the
+ * conversion of the video memory to the framebuffer takes.
+ */
+// #define FRAME_TIME_DISPLAY
+
+/* The video memory is tracked for changes in blocks of this size */
+#define VGA_DIRTY_BLOCK_SHIFT   10
+#define VGA_DIRTY_BLOCKS        ((VGA_NUM_BANKS * SVGA_BANK_SIZE) >> VGA_DIRTY_BLOCK_SHIFT)
+
+/* 256 characters of up to 9 pixels */
+#define VGA_MAX_LINE_PIXELS     (256 * 9)
+
 static CONST DWORD MemoryBase[] = { 0xA0000, 0xA0000, 0xB0000, 0xB8000 };
 static CONST DWORD MemorySize[] = { 0x20000, 0x10000, 0x08000, 0x08000 };
 
@@ -297,6 +310,48 @@ static COORD CurrResolution   = {0};
 
 static SMALL_RECT UpdateRectangle = { 0, 0, 0, 0 };
 
+/*
+ * Everything the conversion of the graphics framebuffer depends on, besides
+ * the video memory itself. The scanlines whose video memory hasn't changed
+ * are only skipped while this stays the same.
+ */
+typedef struct _VGA_DISPLAY_STATE
+{
+    COORD Resolution;
+    DWORD StartAddress;
+    DWORD ScanlineSize;
+    DWORD AddressSize;
+    BYTE SeqExtMode;
+    BYTE GcMode;
+    BYTE GcMisc;
+    BYTE CrtcPresetRowScan;
+    BYTE CrtcLineCompare;
+    BYTE CrtcOverflow;
+    BYTE CrtcMaxScanLine;
+    BYTE CrtcExtDisplay;
+    BOOLEAN AcPalDisable;
+    BYTE AcRegisters[VGA_AC_MAX_REG];
+} VGA_DISPLAY_STATE, *PVGA_DISPLAY_STATE;
+
+static ULONG VgaDirtyBitmap[VGA_DIRTY_BLOCKS / 32];
+static BOOLEAN VgaFullRefresh = TRUE;
+static VGA_DISPLAY_STATE LastDisplayState;
+
+/* One byte per pixel, with room for the panning and a blank pixel in front */
+static BYTE VgaLineBuffer[1 + VGA_MAX_LINE_PIXELS + 16];
+
+/* Planar to packed pixel conversion tables, see VgaInitializeConversionTables */
+static ULONGLONG VgaPlanarTable[256];
+static ULONG VgaPlanar8Table[256];
+static ULONG VgaInterleavedTable[256];
+
+#ifdef FRAME_TIME_DISPLAY
+static ULONGLONG FrameTime = 0ULL;
+static ULONG FrameCount = 0;
+static ULONG ConvertedScanlines = 0;
+static ULONG TotalScanlines = 0;
+#endif
+
 
 
 
@@ -705,6 +760,7 @@ Quit:
 
     /* Trigger a full update of the screen */
     NeedsUpdate = TRUE;
+    VgaFullRefresh = TRUE;
     UpdateRectangle.Left = 0;
     UpdateRectangle.Top  = 0;
     UpdateRectangle.Right  = CurrResolution.X;
@@ -733,6 +789,202 @@ static inline VOID VgaMarkForUpdate(SHORT Row, SHORT Column)
     NeedsUpdate = TRUE;
 }
 
+static inline VOID VgaMarkMemoryDirty(DWORD Index, DWORD Size)
+{
+    DWORD Block, LastBlock;
+
+    if (Size == 0) return;
+
+    LastBlock = (Index + Size - 1) >> VGA_DIRTY_BLOCK_SHIFT;
+    for (Block = Index >> VGA_DIRTY_BLOCK_SHIFT; Block <= LastBlock; Block++)
+    {
+        VgaDirtyBitmap[(Block % VGA_DIRTY_BLOCKS) / 32] |= 1 << (Block % 32);
+    }
+}
+
+static VOID VgaInitializeConversionTables(VOID)
+{
+    UINT Value, Pixel;
+
+    for (Value = 0; Value < 256; Value++)
+    {
+        VgaPlanarTable[Value] = 0ULL;
+        VgaPlanar8Table[Value] = 0;
+        VgaInterleavedTable[Value] = 0;
+
+        /*
+         * Byte N of each entry is pixel N, so the entries of the planes
+         * can be shifted into place and combined 4 or 8 pixels at a time.
+         */
+        for (Pixel = 0; Pixel < 8; Pixel++)
+        {
+            /* 1 bit per pixel, the leftmost pixel in the highest bit */
+            VgaPlanarTable[Value] |= (ULONGLONG)((Value >> (7 - Pixel)) & 1) << (Pixel * 8);
+        }
+
+        for (Pixel = 0; Pixel < 4; Pixel++)
+        {
+            /* 2 bits per pixel, the first one goes to the low nibble and the second to the high one */
+            VgaPlanar8Table[Value] |= (((Value >> ((3 - Pixel) * 2 + 1)) & 1)
+                                      | (((Value >> ((3 - Pixel) * 2)) & 1) << 4)) << (Pixel * 8);
+
+            /* 2 bits per pixel, taken as they are */
+            VgaInterleavedTable[Value] |= ((Value >> (6 - Pixel * 2)) & 3) << (Pixel * 8);
+        }
+    }
+}
+
+static inline DWORD VgaGetPixelsPerAddress(VOID)
+{
+    /* The 256 color modes hold 4 pixels at each address, the others 8 */
+    return (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT) ? 4 : 8;
+}
+
+static BOOLEAN VgaIsScanlineDirty(PULONG DirtyBitmap, DWORD Address, DWORD AddressSize, DWORD Count)
+{
+    DWORD First, Last, Block;
+
+    if (VgaSeqRegisters[SVGA_SEQ_EXT_MODE_REG] & SVGA_SEQ_EXT_MODE_HIGH_RES)
+    {
+        First = Address;
+        Last = Address + Count - 1;
+    }
+    else
+    {
+        First = WRAP_OFFSET(Address * AddressSize) * VGA_NUM_BANKS;
+        Last = WRAP_OFFSET((Address + (Count - 1) / VgaGetPixelsPerAddress()) * AddressSize) * VGA_NUM_BANKS
+               + VGA_NUM_BANKS - 1;
+    }
+
+    /* Don't bother with scanlines that wrap around */
+    if ((Last < First) || (Last >= sizeof(VgaMemory))) return TRUE;
+
+    for (Block = First >> VGA_DIRTY_BLOCK_SHIFT; Block <= (Last >> VGA_DIRTY_BLOCK_SHIFT); Block++)
+    {
+        if (DirtyBitmap[Block / 32] & (1 << (Block % 32))) return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Converts Count pixels of a scanline to one byte per pixel, Count is rounded up to 8 */
+static VOID VgaConvertScanline(PBYTE Pixels, DWORD Address, DWORD AddressSize, DWORD Count)
+{
+    DWORD i, k;
+    PBYTE Planes;
+
+    if (VgaSeqRegisters[SVGA_SEQ_EXT_MODE_REG] & SVGA_SEQ_EXT_MODE_HIGH_RES)
+    {
+        // TODO: Check for high color modes
+
+        /* 256 color mode, blank the part that lies past the end of the video memory */
+        if (Address >= sizeof(VgaMemory))
+        {
+            RtlZeroMemory(Pixels, Count);
+        }
+        else if (Count > sizeof(VgaMemory) - Address)
+        {
+            RtlCopyMemory(Pixels, &VgaMemory[Address], sizeof(VgaMemory) - Address);
+            RtlZeroMemory(&Pixels[sizeof(VgaMemory) - Address], Count - (sizeof(VgaMemory) - Address));
+        }
+        else
+        {
+            RtlCopyMemory(Pixels, &VgaMemory[Address], Count);
+        }
+
+        return;
+    }
+
+    /* Check the shifting mode */
+    if (VgaGcRegisters[VGA_GC_MODE_REG] & VGA_GC_MODE_SHIFT256)
+    {
+        /* 4 bits shifted from each plane */
+
+        /* Check if this is 16 or 256 color mode */
+        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
+        {
+            /* One byte per pixel, the 4 pixels of an address are on the 4 planes */
+            for (i = 0; i < Count; i += VGA_NUM_BANKS)
+            {
+                Planes = &VgaMemory[WRAP_OFFSET((Address + (i / VGA_NUM_BANKS)) * AddressSize) * VGA_NUM_BANKS];
+                *(PULONG)&Pixels[i] = *(PULONG)Planes;
+            }
+        }
+        else
+        {
+            /* 4 bits per pixel, the highest 4 bits first */
+            for (i = 0; i < Count; i += VGA_NUM_BANKS * 2)
+            {
+                Planes = &VgaMemory[WRAP_OFFSET((Address + (i / (VGA_NUM_BANKS * 2))) * AddressSize) * VGA_NUM_BANKS];
+
+                for (k = 0; k < VGA_NUM_BANKS; k++)
+                {
+                    Pixels[i + k * 2] = Planes[k] >> 4;
+                    Pixels[i + k * 2 + 1] = Planes[k] & 0x0F;
+                }
+            }
+        }
+    }
+    else if (VgaGcRegisters[VGA_GC_MODE_REG] & VGA_GC_MODE_SHIFTREG)
+    {
+        /* Check if this is 16 or 256 color mode */
+        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
+        {
+            // TODO: NOT IMPLEMENTED
+            DPRINT1("8-bit interleaved mode is not implemented!\n");
+            RtlZeroMemory(Pixels, Count);
+        }
+        else
+        {
+            /*
+             * 2 bits shifted from plane 0 and 2 for the first 4 pixels,
+             * then 2 bits shifted from plane 1 and 3 for the next 4
+             */
+            for (i = 0; i < Count; i += 8)
+            {
+                Planes = &VgaMemory[WRAP_OFFSET((Address + (i / 8)) * AddressSize) * VGA_NUM_BANKS];
+
+                *(PULONG)&Pixels[i] = VgaInterleavedTable[Planes[0]]
+                                      | (VgaInterleavedTable[Planes[2]] << 2);
+                *(PULONG)&Pixels[i + 4] = VgaInterleavedTable[Planes[1]]
+                                          | (VgaInterleavedTable[Planes[3]] << 2);
+            }
+        }
+    }
+    else
+    {
+        /* 1 bit shifted from each plane */
+
+        /* Check if this is 16 or 256 color mode */
+        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
+        {
+            /* 8 bits per pixel, 2 on each plane */
+            for (i = 0; i < Count; i += 4)
+            {
+                Planes = &VgaMemory[WRAP_OFFSET((Address + (i / 4)) * AddressSize) * VGA_NUM_BANKS];
+
+                *(PULONG)&Pixels[i] = VgaPlanar8Table[Planes[0]]
+                                      | (VgaPlanar8Table[Planes[1]] << 1)
+                                      | (VgaPlanar8Table[Planes[2]] << 2)
+                                      | (VgaPlanar8Table[Planes[3]] << 3);
+            }
+        }
+        else
+        {
+            /* 4 bits per pixel, 1 on each plane */
+            for (i = 0; i < Count; i += 8)
+            {
+                Planes = &VgaMemory[WRAP_OFFSET((Address + (i / 8)) * AddressSize) * VGA_NUM_BANKS];
+
+                *(PULONGLONG)&Pixels[i] = VgaPlanarTable[Planes[0]]
+                                          | (VgaPlanarTable[Planes[1]] << 1)
+                                          | (VgaPlanarTable[Planes[2]] << 2)
+                                          | (VgaPlanarTable[Planes[3]] << 3);
+            }
+        }
+    }
+}
+
 static VOID VgaUpdateFramebuffer(VOID)
 {
     SHORT i, j, k;
@@ -755,8 +1007,75 @@ static VOID VgaUpdateFramebuffer(VOID)
     {
         /* Graphics mode */
         PBYTE GraphicsBuffer = (PBYTE)ActiveFramebuffer;
+        PBYTE Pixels = &VgaLineBuffer[1];
         DWORD InterlaceHighBit = VGA_INTERLACE_HIGH_BIT;
-        SHORT X;
+        SHORT Width = min(CurrResolution.X, VGA_MAX_LINE_PIXELS);
+        DWORD PixelCount = Width + 8;
+        DWORD RowSize = CurrResolution.X * (DoubleWidth ? 2 : 1);
+        ULONG DirtyBitmap[ARRAYSIZE(VgaDirtyBitmap)];
+        VGA_DISPLAY_STATE DisplayState;
+        BOOLEAN FullRefresh;
+        BYTE PaletteMap[16];
+        SHORT X, FirstChanged, LastChanged;
+        PBYTE Row;
+
+        /* Take the changes made to the video memory since the last update */
+        RtlCopyMemory(DirtyBitmap, VgaDirtyBitmap, sizeof(DirtyBitmap));
+        RtlZeroMemory(VgaDirtyBitmap, sizeof(VgaDirtyBitmap));
+
+        /* The unchanged scanlines can only be skipped if the display is set up the same way */
+        RtlZeroMemory(&DisplayState, sizeof(DisplayState));
+        DisplayState.Resolution = CurrResolution;
+        DisplayState.StartAddress = StartAddressLatch;
+        DisplayState.ScanlineSize = ScanlineSizeLatch;
+        DisplayState.AddressSize = AddressSize;
+        DisplayState.SeqExtMode = VgaSeqRegisters[SVGA_SEQ_EXT_MODE_REG];
+        DisplayState.GcMode = VgaGcRegisters[VGA_GC_MODE_REG];
+        DisplayState.GcMisc = VgaGcRegisters[VGA_GC_MISC_REG];
+        DisplayState.CrtcPresetRowScan = VgaCrtcRegisters[VGA_CRTC_PRESET_ROW_SCAN_REG];
+        DisplayState.CrtcLineCompare = VgaCrtcRegisters[VGA_CRTC_LINE_COMPARE_REG];
+        DisplayState.CrtcOverflow = VgaCrtcRegisters[VGA_CRTC_OVERFLOW_REG];
+        DisplayState.CrtcMaxScanLine = VgaCrtcRegisters[VGA_CRTC_MAX_SCAN_LINE_REG];
+        DisplayState.CrtcExtDisplay = VgaCrtcRegisters[SVGA_CRTC_EXT_DISPLAY_REG];
+        DisplayState.AcPalDisable = VgaAcPalDisable;
+        RtlCopyMemory(DisplayState.AcRegisters, VgaAcRegisters, sizeof(VgaAcRegisters));
+
+        FullRefresh = VgaFullRefresh
+                      || (RtlCompareMemory(&DisplayState, &LastDisplayState, sizeof(DisplayState))
+                          != sizeof(DisplayState));
+        LastDisplayState = DisplayState;
+        VgaFullRefresh = FALSE;
+
+        /*
+         * In 16 color mode, the value is an index to the AC registers
+         * if external palette access is disabled, otherwise (in case
+         * of palette loading) it is a blank pixel.
+         */
+        for (k = 0; k < 16; k++)
+        {
+            if (VgaAcPalDisable)
+            {
+                if (!(VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_P54S))
+                {
+                    /* Bits 4 and 5 are taken from the palette register */
+                    PaletteMap[k] = ((VgaAcRegisters[VGA_AC_COLOR_SEL_REG] << 4) & 0xC0)
+                                    | (VgaAcRegisters[k] & 0x3F);
+                }
+                else
+                {
+                    /* Bits 4 and 5 are taken from the color select register */
+                    PaletteMap[k] = (VgaAcRegisters[VGA_AC_COLOR_SEL_REG] << 4)
+                                    | (VgaAcRegisters[k] & 0x0F);
+                }
+            }
+            else
+            {
+                PaletteMap[k] = 0;
+            }
+        }
+
+        /* A pixel shift of 8 or more shifts in a blank pixel */
+        VgaLineBuffer[0] = 0;
 
         /*
          * Synchronize access to the graphics framebuffer
@@ -806,210 +1125,80 @@ static VOID VgaUpdateFramebuffer(VOID)
                 Address |= InterlaceHighBit;
             }
 
-            /* Loop through the pixels */
-            for (j = 0; j < CurrResolution.X; j++)
+#ifdef FRAME_TIME_DISPLAY
+            TotalScanlines++;
+#endif
+
+            /* Only convert the scanlines whose video memory has changed */
+            if (FullRefresh || VgaIsScanlineDirty(DirtyBitmap, Address, AddressSize, PixelCount))
             {
-                BYTE PixelData = 0;
+#ifdef FRAME_TIME_DISPLAY
+                ConvertedScanlines++;
+#endif
+
+                VgaConvertScanline(Pixels, Address, AddressSize, PixelCount);
 
                 /* Apply horizontal pixel panning */
                 if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
                 {
-                    X = j + ((PixelShift >> 1) & 0x03);
+                    X = (PixelShift >> 1) & 0x03;
                 }
                 else
                 {
-                    X = j + ((PixelShift < 8) ? PixelShift : -1);
+                    X = (PixelShift < 8) ? PixelShift : -1;
                 }
 
-                if (VgaSeqRegisters[SVGA_SEQ_EXT_MODE_REG] & SVGA_SEQ_EXT_MODE_HIGH_RES)
-                {
-                    // TODO: Check for high color modes
+                /* Take into account DoubleVision mode when checking for pixel updates */
+                Row = &GraphicsBuffer[i * RowSize * (DoubleHeight ? 2 : 1)];
+                FirstChanged = MAXSHORT;
+                LastChanged = MINSHORT;
 
-                    /* 256 color mode */
-                    PixelData = VgaMemory[Address + X];
-                }
-                else
+                /* Loop through the pixels */
+                for (j = 0; j < Width; j++, X++)
                 {
-                    /* Check the shifting mode */
-                    if (VgaGcRegisters[VGA_GC_MODE_REG] & VGA_GC_MODE_SHIFT256)
-                    {
-                        /* 4 bits shifted from each plane */
-
-                        /* Check if this is 16 or 256 color mode */
-                        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
-                        {
-                            /* One byte per pixel */
-                            PixelData = VgaMemory[WRAP_OFFSET((Address + (X / VGA_NUM_BANKS)) * AddressSize)
-                                                  * VGA_NUM_BANKS + (X % VGA_NUM_BANKS)];
-                        }
-                        else
-                        {
-                            /* 4-bits per pixel */
-
-                            PixelData = VgaMemory[WRAP_OFFSET((Address + (X / (VGA_NUM_BANKS * 2))) * AddressSize)
-                                                  * VGA_NUM_BANKS + ((X / 2) % VGA_NUM_BANKS)];
-
-                            /* Check if we should use the highest 4 bits or lowest 4 */
-                            if ((X % 2) == 0)
-                            {
-                                /* Highest 4 */
-                                PixelData >>= 4;
-                            }
-                            else
-                            {
-                                /* Lowest 4 */
-                                PixelData &= 0x0F;
-                            }
-                        }
-                    }
-                    else if (VgaGcRegisters[VGA_GC_MODE_REG] & VGA_GC_MODE_SHIFTREG)
-                    {
-                        /* Check if this is 16 or 256 color mode */
-                        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
-                        {
-                            // TODO: NOT IMPLEMENTED
-                            DPRINT1("8-bit interleaved mode is not implemented!\n");
-                        }
-                        else
-                        {
-                            /*
-                             * 2 bits shifted from plane 0 and 2 for the first 4 pixels,
-                             * then 2 bits shifted from plane 1 and 3 for the next 4
-                             */
-                            DWORD BankNumber = (X / 4) % 2;
-                            DWORD Offset = Address + (X / 8);
-                            BYTE LowPlaneData = VgaMemory[WRAP_OFFSET(Offset * AddressSize) * VGA_NUM_BANKS + BankNumber];
-                            BYTE HighPlaneData = VgaMemory[WRAP_OFFSET(Offset * AddressSize) * VGA_NUM_BANKS + (BankNumber + 2)];
-
-                            /* Extract the two bits from each plane */
-                            LowPlaneData  = (LowPlaneData  >> (6 - ((X % 4) * 2))) & 0x03;
-                            HighPlaneData = (HighPlaneData >> (6 - ((X % 4) * 2))) & 0x03;
-
-                            /* Combine them into the pixel */
-                            PixelData = LowPlaneData | (HighPlaneData << 2);
-                        }
-                    }
-                    else
+                    BYTE PixelData = Pixels[X];
+
+                    if (!(VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT))
                     {
-                        /* 1 bit shifted from each plane */
-
-                        /* Check if this is 16 or 256 color mode */
-                        if (VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT)
-                        {
-                            /* 8 bits per pixel, 2 on each plane */
-
-                            for (k = 0; k < VGA_NUM_BANKS; k++)
-                            {
-                                /* The data is on plane k, 4 pixels per byte */
-                                BYTE PlaneData = VgaMemory[WRAP_OFFSET((Address + (X >> 2)) * AddressSize) * VGA_NUM_BANKS + k];
-
-                                /* The mask of the first bit in the pair */
-                                BYTE BitMask = 1 << (((3 - (X % VGA_NUM_BANKS)) * 2) + 1);
-
-                                /* Bits 0, 1, 2 and 3 come from the first bit of the pair */
-                                if (PlaneData & BitMask) PixelData |= 1 << k;
-
-                                /* Bits 4, 5, 6 and 7 come from the second bit of the pair */
-                                if (PlaneData & (BitMask >> 1)) PixelData |= 1 << (k + 4);
-                            }
-                        }
-                        else
-                        {
-                            /* 4 bits per pixel, 1 on each plane */
-
-                            for (k = 0; k < VGA_NUM_BANKS; k++)
-                            {
-                                BYTE PlaneData = VgaMemory[WRAP_OFFSET((Address + (X >> 3)) * AddressSize) * VGA_NUM_BANKS + k];
-
-                                /* If the bit on that plane is set, set it */
-                                if (PlaneData & (1 << (7 - (X % 8)))) PixelData |= 1 << k;
-                            }
-                        }
+                        PixelData = PaletteMap[PixelData & 0x0F];
                     }
-                }
-
-                if (!(VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_8BIT))
-                {
-                    /*
-                     * In 16 color mode, the value is an index to the AC registers
-                     * if external palette access is disabled, otherwise (in case
-                     * of palette loading) it is a blank pixel.
-                     */
 
-                    if (VgaAcPalDisable)
+                    if (DoubleWidth)
                     {
-                        if (!(VgaAcRegisters[VGA_AC_CONTROL_REG] & VGA_AC_CONTROL_P54S))
-                        {
-                            /* Bits 4 and 5 are taken from the palette register */
-                            PixelData = ((VgaAcRegisters[VGA_AC_COLOR_SEL_REG] << 4) & 0xC0)
-                                        | (VgaAcRegisters[PixelData & 0x0F] & 0x3F);
-                        }
-                        else
-                        {
-                            /* Bits 4 and 5 are taken from the color select register */
-                            PixelData = (VgaAcRegisters[VGA_AC_COLOR_SEL_REG] << 4)
-                                        | (VgaAcRegisters[PixelData & 0x0F] & 0x0F);
-                        }
+                        /* Now check if the resulting pixel data has changed */
+                        if (Row[j * 2] == PixelData) continue;
+
+                        /* Yes, write the new value */
+                        Row[j * 2] = Row[j * 2 + 1] = PixelData;
                     }
                     else
                     {
-                        PixelData = 0;
-                    }
-                }
+                        /* Now check if the resulting pixel data has changed */
+                        if (Row[j] == PixelData) continue;
 
-                /* Take into account DoubleVision mode when checking for pixel updates */
-                if (DoubleWidth && DoubleHeight)
-                {
-                    /* Now check if the resulting pixel data has changed */
-                    if (GraphicsBuffer[(i * 2 * CurrResolution.X * 2) + (j * 2)] != PixelData)
-                    {
                         /* Yes, write the new value */
-                        GraphicsBuffer[(i * 2 * CurrResolution.X * 2) + (j * 2)] = PixelData;
-                        GraphicsBuffer[(i * 2 * CurrResolution.X * 2) + (j * 2 + 1)] = PixelData;
-                        GraphicsBuffer[((i * 2 + 1) * CurrResolution.X * 2) + (j * 2)] = PixelData;
-                        GraphicsBuffer[((i * 2 + 1) * CurrResolution.X * 2) + (j * 2 + 1)] = PixelData;
-
-                        /* Mark the specified pixel as changed */
-                        VgaMarkForUpdate(i, j);
+                        Row[j] = PixelData;
                     }
-                }
-                else if (DoubleWidth && !DoubleHeight)
-                {
-                    /* Now check if the resulting pixel data has changed */
-                    if (GraphicsBuffer[(i * CurrResolution.X * 2) + (j * 2)] != PixelData)
-                    {
-                        /* Yes, write the new value */
-                        GraphicsBuffer[(i * CurrResolution.X * 2) + (j * 2)] = PixelData;
-                        GraphicsBuffer[(i * CurrResolution.X * 2) + (j * 2 + 1)] = PixelData;
 
-                        /* Mark the specified pixel as changed */
-                        VgaMarkForUpdate(i, j);
-                    }
+                    FirstChanged = min(FirstChanged, j);
+                    LastChanged = j;
                 }
-                else if (!DoubleWidth && DoubleHeight)
-                {
-                    /* Now check if the resulting pixel data has changed */
-                    if (GraphicsBuffer[(i * 2 * CurrResolution.X) + j] != PixelData)
-                    {
-                        /* Yes, write the new value */
-                        GraphicsBuffer[(i * 2 * CurrResolution.X) + j] = PixelData;
-                        GraphicsBuffer[((i * 2 + 1) * CurrResolution.X) + j] = PixelData;
 
-                        /* Mark the specified pixel as changed */
-                        VgaMarkForUpdate(i, j);
-                    }
-                }
-                else // if (!DoubleWidth && !DoubleHeight)
+                if (FirstChanged <= LastChanged)
                 {
-                    /* Now check if the resulting pixel data has changed */
-                    if (GraphicsBuffer[i * CurrResolution.X + j] != PixelData)
+                    if (DoubleHeight)
                     {
-                        /* Yes, write the new value */
-                        GraphicsBuffer[i * CurrResolution.X + j] = PixelData;
+                        /* Copy the changed pixels to the second line */
+                        DWORD PixelWidth = DoubleWidth ? 2 : 1;
 
-                        /* Mark the specified pixel as changed */
-                        VgaMarkForUpdate(i, j);
+                        RtlCopyMemory(&Row[RowSize + FirstChanged * PixelWidth],
+                                      &Row[FirstChanged * PixelWidth],
+                                      (LastChanged - FirstChanged + 1) * PixelWidth);
                     }
+
+                    /* Mark the changed pixels */
+                    VgaMarkForUpdate(i, FirstChanged);
+                    VgaMarkForUpdate(i, LastChanged);
                 }
             }
 
@@ -1612,6 +1801,10 @@ static VOID WINAPI VgaWritePort(USHORT Port, BYTE Data)
 
 static inline VOID VgaVerticalRetrace(VOID)
 {
+#ifdef FRAME_TIME_DISPLAY
+    LARGE_INTEGER StartCount, EndCount, Frequency;
+#endif
+
     /* If nothing has changed, just return */
     // if (!ModeChanged && !CursorChanged && !PaletteChanged && !NeedsUpdate)
         // return;
@@ -1635,8 +1828,31 @@ static inline VOID VgaVerticalRetrace(VOID)
     }
 
     /* Update the contents of the framebuffer */
+#ifdef FRAME_TIME_DISPLAY
+    NtQueryPerformanceCounter(&StartCount, &Frequency);
+#endif
+
     VgaUpdateFramebuffer();
 
+#ifdef FRAME_TIME_DISPLAY
+    NtQueryPerformanceCounter(&EndCount, NULL);
+    FrameTime += EndCount.QuadPart - StartCount.QuadPart;
+    FrameCount++;
+
+    if (FrameCount == 60)
+    {
+        DPRINT1("NTVDM: %I64u us per frame, %lu of %lu scanlines converted\n",
+                FrameTime * 1000000ULL / (FrameCount * (ULONGLONG)Frequency.QuadPart),
+                ConvertedScanlines,
+                TotalScanlines);
+
+        FrameTime = 0ULL;
+        FrameCount = 0;
+        ConvertedScanlines = 0;
+        TotalScanlines = 0;
+    }
+#endif
+
     /* Ignore if there's nothing to update */
     if (!NeedsUpdate) return;
 
@@ -2028,6 +2244,9 @@ BOOLEAN FASTCALL VgaWriteMemory(ULONG Address, PVOID Buffer, ULONG Size)
                 /* Copy the value to the VGA memory */
                 VgaMemory[VideoAddress * VGA_NUM_BANKS + j] = VgaTranslateByteForWriting(BufPtr[i], j);
             }
+
+            /* Mark the planes of this address as changed */
+            VgaMarkMemoryDirty(VideoAddress * VGA_NUM_BANKS, VGA_NUM_BANKS);
         }
     }
     else
@@ -2040,6 +2259,7 @@ BOOLEAN FASTCALL VgaWriteMemory(ULONG Address, PVOID Buffer, ULONG Size)
         /* Just copy to the video memory */
         VideoAddress = VgaTranslateAddress(Address);
         VideoMemory = &VgaMemory[VideoAddress + (Address & 3)];
+        VgaMarkMemoryDirty(VideoAddress + (Address & 3), Size);
 
         switch (Size)
         {
@@ -2074,6 +2294,7 @@ BOOLEAN FASTCALL VgaWriteMemory(ULONG Address, PVOID Buffer, ULONG Size)
 VOID VgaClearMemory(VOID)
 {
     RtlZeroMemory(VgaMemory, sizeof(VgaMemory));
+    RtlFillMemory(VgaDirtyBitmap, sizeof(VgaDirtyBitmap), 0xFF);
 }
 
 VOID VgaWriteTextModeFont(UINT FontNumber, CONST UCHAR* FontData, UINT Height)
@@ -2095,6 +2316,9 @@ VOID VgaWriteTextModeFont(UINT FontNumber, CONST UCHAR* FontData, UINT Height)
             VgaMemory[(i * VGA_MAX_FONT_HEIGHT + j) * VGA_NUM_BANKS + VGA_FONT_BANK] = 0;
         }
     }
+
+    /* The font plane can also be displayed in graphics mode */
+    RtlFillMemory(VgaDirtyBitmap, sizeof(VgaDirtyBitmap), 0xFF);
 }
 
 BOOLEAN VgaInitialize(HANDLE TextHandle)
@@ -2114,6 +2338,9 @@ BOOLEAN VgaInitialize(HANDLE TextHandle)
     /* Reset the sequencer */
     VgaResetSequencer();
 
+    /* Build the tables used to convert the planes to pixels */
+    VgaInitializeConversionTables();
+
     /* Clear the VGA memory */
     VgaClearMemory();
 
@@ -0,0 +1,93 @@
+/*
+ * PROJECT:         Win32 subsystem
+ * LICENSE:         See COPYING in the top level directory
+ * FILE:            win32ss/gdi/dib/alphablend.h
+ * PURPOSE:         32bpp to 32bpp AlphaBlend row kernel
+ *
+ * The kernel only needs the basic integer types, so it can also be
+ * built on the host, see modules/rostests/dibtests/alphablend32.
+ * Its results are bit-identical to the generic per-pixel code.
+ */
+
+#pragma once
+
+#define ALPHABLEND_LANE_MASK 0x00FF00FF
+
+/* Multiply all four channels by Factor and divide by 255, rounding down
+ * like (Channel * Factor) / 255 does. Two channels are processed per
+ * 32-bit operation; a product fits in its 16-bit lane. */
+static __inline ULONG
+AlphaBlend_Scale32(ULONG Pixel, ULONG Factor)
+{
+  ULONG Lo = (Pixel & ALPHABLEND_LANE_MASK) * Factor;
+  ULONG Hi = ((Pixel >> 8) & ALPHABLEND_LANE_MASK) * Factor;
+
+  /* x / 255 == (x + (x >> 8) + 1) >> 8 for all x <= 255 * 255 */
+  Lo = ((Lo + ((Lo >> 8) & ALPHABLEND_LANE_MASK) + 0x00010001) >> 8) & ALPHABLEND_LANE_MASK;
+  Hi = ((Hi + ((Hi >> 8) & ALPHABLEND_LANE_MASK) + 0x00010001) >> 8) & ALPHABLEND_LANE_MASK;
+
+  return Lo | (Hi << 8);
+}
+
+/* Per channel saturating add, the same as Clamp8(a + b) */
+static __inline ULONG
+AlphaBlend_AddSat32(ULONG a, ULONG b)
+{
+  ULONG Lo = (a & ALPHABLEND_LANE_MASK) + (b & ALPHABLEND_LANE_MASK);
+  ULONG Hi = ((a >> 8) & ALPHABLEND_LANE_MASK) + ((b >> 8) & ALPHABLEND_LANE_MASK);
+  ULONG Carry;
+
+  /* Turn a carry out of a lane into 0xFF in that lane */
+  Carry = Lo & 0x01000100;
+  Lo = (Lo | (Carry - (Carry >> 8))) & ALPHABLEND_LANE_MASK;
+  Carry = Hi & 0x01000100;
+  Hi = (Hi | (Carry - (Carry >> 8))) & ALPHABLEND_LANE_MASK;
+
+  return Lo | (Hi << 8);
+}
+
+/* Blend one destination row. Source column n is
+ * SrcX + (n * SrcWidth) / DstWidth, stepped without a division. */
+static __inline void
+DIB_32BPP_AlphaBlendRow(ULONG *Dst, const ULONG *SrcRow, LONG SrcX,
+                        LONG SrcWidth, LONG DstWidth,
+                        UCHAR ConstAlpha, BOOLEAN SrcAlpha)
+{
+  LONG XStep = SrcWidth / DstWidth;
+  LONG XRem = SrcWidth % DstWidth;
+  LONG XFrac = 0;
+  ULONG Src, Alpha;
+  LONG Cols;
+
+  for (Cols = 0; Cols < DstWidth; Cols++)
+  {
+    Src = SrcRow[SrcX];
+    if (ConstAlpha != 255)
+      Src = AlphaBlend_Scale32(Src, ConstAlpha);
+
+    Alpha = SrcAlpha ? (Src >> 24) : ConstAlpha;
+    if (Alpha == 255)
+    {
+      /* Destination * 0 / 255 is zero */
+      *Dst = Src;
+    }
+    else if (Alpha != 0)
+    {
+      *Dst = AlphaBlend_AddSat32(AlphaBlend_Scale32(*Dst, 255 - Alpha), Src);
+    }
+    else if (Src != 0)
+    {
+      /* Destination * 255 / 255 is unchanged */
+      *Dst = AlphaBlend_AddSat32(*Dst, Src);
+    }
+    Dst++;
+
+    SrcX += XStep;
+    XFrac += XRem;
+    if (XFrac >= DstWidth)
+    {
+      XFrac -= DstWidth;
+      SrcX++;
+    }
+  }
+}
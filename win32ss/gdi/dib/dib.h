@@ -132,6 +132,18 @@ extern unsigned char altnotmask[2];
 #define MASK1BPP(x) (1<<(7-((x)&7)))
 
 ULONG DIB_DoRop(ULONG Rop, ULONG Dest, ULONG Source, ULONG Pattern);
+PULONG DIB_GetXlateTable(XLATEOBJ *pxlo, ULONG cColors, PULONG pulTable, ULONG cPixels);
+PULONG DIB_GetSourceXlateTable(SURFOBJ *SourceSurf, XLATEOBJ *pxlo, PULONG pulTable, ULONG cPixels);
+VOID DIB_GetSourceRow(SURFOBJ *SourceSurf, XLATEOBJ *pxlo, PULONG XlateTable, LONG x, LONG y, PULONG Row, ULONG Count);
+
+/* Pixels the row based blitters work on at a time */
+#define DIB_ROW_PIXELS 64
+
+typedef VOID (*PFN_DIB_RopRow)(PULONG, PULONG, ULONG, ULONG);
+PFN_DIB_RopRow DIB_GetRopRow(ROP4 Rop4);
+
+#define DIB_XlateIndex(Table,ColorTranslation,Index)        \
+  ((Table) ? (Table)[Index] : XLATEOBJ_iXlate(ColorTranslation, Index))
 
 #define DIB_GetSource(SourceSurf,sx,sy,ColorTranslation)    \
   XLATEOBJ_iXlate(ColorTranslation,                         \
@@ -142,11 +142,16 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   LONG     i, j, sx, sy, xColor, f1;
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
+  ULONG    XlateTable[256], cPixels;
+  PULONG   Xlate;
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0 + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta) + 2 * BltInfo->DestRect.left;
+  cPixels = (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+            (BltInfo->DestRect.bottom - BltInfo->DestRect.top);
 
   switch(BltInfo->SourceSurface->iBitmapFormat)
   {
   case BMF_1BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 2, XlateTable, 2);
     sx = BltInfo->SourcePoint.x;
     sy = BltInfo->SourcePoint.y;
     for (j=BltInfo->DestRect.top; j<BltInfo->DestRect.bottom; j++)
@@ -156,13 +161,11 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       {
         if(DIB_1BPP_GetPixel(BltInfo->SourceSurface, sx, sy) == 0)
         {
-          DIB_16BPP_PutPixel(BltInfo->DestSurface, i, j,
-            XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 0));
+          DIB_16BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[0]);
         }
         else
         {
-          DIB_16BPP_PutPixel(BltInfo->DestSurface, i, j,
-            XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 1));
+          DIB_16BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[1]);
         }
         sx++;
       }
@@ -171,6 +174,7 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     break;
 
   case BMF_4BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 16, XlateTable, 16);
     SourceBits_4BPP = (PBYTE)BltInfo->SourceSurface->pvScan0 +
       (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) +
       (BltInfo->SourcePoint.x >> 1);
@@ -183,8 +187,7 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
       for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
       {
-        xColor = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest,
-          (*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1)));
+        xColor = Xlate[(*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1))];
         DIB_16BPP_PutPixel(BltInfo->DestSurface, i, j, xColor);
         if(f1 == 1)
         {
@@ -202,6 +205,7 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     break;
 
   case BMF_8BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 256, XlateTable, cPixels);
     SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 +
       (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) +
       BltInfo->SourcePoint.x;
@@ -214,7 +218,7 @@ DIB_16BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
       for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
       {
-        *((WORD *)DestBits) = (WORD)XLATEOBJ_iXlate(
+        *((WORD *)DestBits) = (WORD)DIB_XlateIndex(Xlate,
           BltInfo->XlateSourceToDest, *SourceBits);
         SourceBits += 1;
         DestBits += 2;
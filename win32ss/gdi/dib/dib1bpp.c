@@ -314,6 +314,88 @@ DIB_1BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 }
 
 #ifndef _USE_DIBLIB_
+static VOID
+DIB_1BPP_RopPixel(PBLTINFO BltInfo, PFN_DIB_RopRow RopRow, PULONG Xlate,
+                  LONG DestX, LONG DestY, LONG SourceX, LONG SourceY, ULONG Pattern)
+{
+  ULONG Dest, Source = 0;
+
+  Dest = DIB_1BPP_GetPixel(BltInfo->DestSurface, DestX, DestY);
+  if (ROP4_USES_SOURCE(BltInfo->Rop4))
+  {
+    DIB_GetSourceRow(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, Xlate,
+                     SourceX, SourceY, &Source, 1);
+  }
+  RopRow(&Dest, &Source, Pattern, 1);
+  DIB_1BPP_PutPixel(BltInfo->DestSurface, DestX, DestY, Dest & 1);
+}
+
+/*
+ * The common ROPs with a solid pattern. The ULONGs of 32 pixels in the
+ * middle of a line go through the row function together, the pixels at
+ * both ends one by one.
+ */
+static BOOLEAN
+DIB_1BPP_BitBltRow(PBLTINFO BltInfo, PFN_DIB_RopRow RopRow, ULONG Pattern)
+{
+  ULONG XlateTable[256], SourceRow[DIB_ROW_PIXELS], SourceWords[DIB_ROW_PIXELS / 32];
+  PULONG Xlate = NULL, DestBits;
+  LONG DestX, DestY, SourceX, SourceY, AlignedLeft, AlignedRight, Count, i, j;
+  BOOLEAN UsesSource;
+
+  UsesSource = ROP4_USES_SOURCE(BltInfo->Rop4);
+  if (UsesSource)
+  {
+    Xlate = DIB_GetSourceXlateTable(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, XlateTable,
+                                    (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+                                    (BltInfo->DestRect.bottom - BltInfo->DestRect.top));
+  }
+
+  AlignedLeft = min((BltInfo->DestRect.left + 31) & ~31, BltInfo->DestRect.right);
+  AlignedRight = max(BltInfo->DestRect.right & ~31, AlignedLeft);
+  SourceY = BltInfo->SourcePoint.y;
+
+  for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++, SourceY++)
+  {
+    SourceX = BltInfo->SourcePoint.x;
+
+    for (DestX = BltInfo->DestRect.left; DestX < AlignedLeft; DestX++, SourceX++)
+      DIB_1BPP_RopPixel(BltInfo, RopRow, Xlate, DestX, DestY, SourceX, SourceY, Pattern);
+
+    DestBits = (PULONG)(
+      (PBYTE)BltInfo->DestSurface->pvScan0 +
+      (DestX >> 3) +
+      DestY * BltInfo->DestSurface->lDelta);
+
+    for (; DestX < AlignedRight; DestX += Count, SourceX += Count)
+    {
+      Count = min(AlignedRight - DestX, DIB_ROW_PIXELS);
+
+      if (UsesSource)
+      {
+        DIB_GetSourceRow(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, Xlate,
+                         SourceX, SourceY, SourceRow, Count);
+
+        /* The first pixel of each byte is in its high bit */
+        for (i = 0; i < Count / 32; i++)
+        {
+          SourceWords[i] = 0;
+          for (j = 0; j < 32; j++)
+            SourceWords[i] |= (SourceRow[i * 32 + j] & 1) << ((j & ~7) + 7 - (j & 7));
+        }
+      }
+
+      RopRow(DestBits, SourceWords, Pattern, Count / 32);
+      DestBits += Count / 32;
+    }
+
+    for (; DestX < BltInfo->DestRect.right; DestX++, SourceX++)
+      DIB_1BPP_RopPixel(BltInfo, RopRow, Xlate, DestX, DestY, SourceX, SourceY, Pattern);
+  }
+
+  return TRUE;
+}
+
 BOOLEAN
 DIB_1BPP_BitBlt(PBLTINFO BltInfo)
 {
@@ -326,6 +408,7 @@ DIB_1BPP_BitBlt(PBLTINFO BltInfo)
   BOOLEAN UsesPattern;
   PULONG DestBits;
   LONG RoundedRight;
+  PFN_DIB_RopRow RopRow;
 
   UsesSource = ROP4_USES_SOURCE(BltInfo->Rop4);
   UsesPattern = ROP4_USES_PATTERN(BltInfo->Rop4);
@@ -349,6 +432,11 @@ DIB_1BPP_BitBlt(PBLTINFO BltInfo)
     }
   }
 
+  /* The row function works on whole ULONGs too, so expand the color */
+  RopRow = DIB_GetRopRow(BltInfo->Rop4);
+  if (RopRow && !BltInfo->PatternSurface)
+    return DIB_1BPP_BitBltRow(BltInfo, RopRow, (Pattern & 1) ? 0xFFFFFFFF : 0);
+
   for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++)
   {
     DestX = BltInfo->DestRect.left;
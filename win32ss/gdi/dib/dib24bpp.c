@@ -53,12 +53,17 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
   PWORD    SourceBits_16BPP, SourceLine_16BPP;
+  ULONG    XlateTable[256], cPixels;
+  PULONG   Xlate;
 
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0 + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta) + BltInfo->DestRect.left * 3;
+  cPixels = (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+            (BltInfo->DestRect.bottom - BltInfo->DestRect.top);
 
   switch(BltInfo->SourceSurface->iBitmapFormat)
   {
     case BMF_1BPP:
+      Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 2, XlateTable, 2);
       sx = BltInfo->SourcePoint.x;
       sy = BltInfo->SourcePoint.y;
 
@@ -69,9 +74,9 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
         {
           if(DIB_1BPP_GetPixel(BltInfo->SourceSurface, sx, sy) == 0)
           {
-            DIB_24BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 0));
+            DIB_24BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[0]);
           } else {
-            DIB_24BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 1));
+            DIB_24BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[1]);
           }
           sx++;
         }
@@ -80,6 +85,7 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       break;
 
     case BMF_4BPP:
+      Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 16, XlateTable, 16);
       SourceBits_4BPP = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + (BltInfo->SourcePoint.x >> 1);
 
       for (j=BltInfo->DestRect.top; j<BltInfo->DestRect.bottom; j++)
@@ -91,8 +97,7 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
         for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
         {
-          xColor = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest,
-              (*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1)));
+          xColor = Xlate[(*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1))];
           *DestLine++ = xColor & 0xff;
           *(PWORD)DestLine = (WORD)(xColor >> 8);
           DestLine += 2;
@@ -106,6 +111,7 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       break;
 
     case BMF_8BPP:
+      Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 256, XlateTable, cPixels);
       SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + BltInfo->SourcePoint.x;
       DestLine = DestBits;
 
@@ -116,7 +122,7 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
         for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
         {
-          xColor = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, *SourceBits);
+          xColor = DIB_XlateIndex(Xlate, BltInfo->XlateSourceToDest, *SourceBits);
           *DestBits = xColor & 0xff;
           *(PWORD)(DestBits + 1) = (WORD)(xColor >> 8);
           SourceBits += 1;
@@ -225,6 +231,61 @@ DIB_24BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   return TRUE;
 }
 
+/* The common ROPs with a solid pattern, a row of DIB_ROW_PIXELS at a time */
+static BOOLEAN
+DIB_24BPP_BitBltRow(PBLTINFO BltInfo, PFN_DIB_RopRow RopRow, ULONG Pattern)
+{
+   ULONG XlateTable[256], SourceRow[DIB_ROW_PIXELS], DestRow[DIB_ROW_PIXELS];
+   PULONG Xlate = NULL;
+   LONG DestY, SourceY, Width, X, Count, i;
+   BOOLEAN UsesSource;
+   PBYTE DestLine, DestBits;
+
+   UsesSource = ROP4_USES_SOURCE(BltInfo->Rop4);
+   Width = BltInfo->DestRect.right - BltInfo->DestRect.left;
+   if (UsesSource)
+   {
+      Xlate = DIB_GetSourceXlateTable(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, XlateTable,
+                                      Width * (BltInfo->DestRect.bottom - BltInfo->DestRect.top));
+   }
+
+   SourceY = BltInfo->SourcePoint.y;
+   DestLine = (PBYTE)BltInfo->DestSurface->pvScan0 +
+      (BltInfo->DestRect.left << 1) + BltInfo->DestRect.left +
+      BltInfo->DestRect.top * BltInfo->DestSurface->lDelta;
+
+   for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++, SourceY++)
+   {
+      DestBits = DestLine;
+
+      for (X = 0; X < Width; X += Count)
+      {
+         Count = min(Width - X, DIB_ROW_PIXELS);
+
+         if (UsesSource)
+         {
+            DIB_GetSourceRow(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, Xlate,
+                             BltInfo->SourcePoint.x + X, SourceY, SourceRow, Count);
+         }
+
+         for (i = 0; i < Count; i++)
+            DestRow[i] = *(PUSHORT)(DestBits + i * 3) + (DestBits[i * 3 + 2] << 16);
+
+         RopRow(DestRow, SourceRow, Pattern, Count);
+
+         for (i = 0; i < Count; i++, DestBits += 3)
+         {
+            *(PUSHORT)DestBits = (USHORT)DestRow[i];
+            DestBits[2] = (BYTE)(DestRow[i] >> 16);
+         }
+      }
+
+      DestLine += BltInfo->DestSurface->lDelta;
+   }
+
+   return TRUE;
+}
+
 BOOLEAN
 DIB_24BPP_BitBlt(PBLTINFO BltInfo)
 {
@@ -235,6 +296,7 @@ DIB_24BPP_BitBlt(PBLTINFO BltInfo)
    BOOL UsesSource;
    BOOL UsesPattern;
    PBYTE DestBits;
+   PFN_DIB_RopRow RopRow;
 
    UsesSource = ROP4_USES_SOURCE(BltInfo->Rop4);
    UsesPattern = ROP4_USES_PATTERN(BltInfo->Rop4);
@@ -259,6 +321,10 @@ DIB_24BPP_BitBlt(PBLTINFO BltInfo)
       }
    }
 
+   RopRow = DIB_GetRopRow(BltInfo->Rop4);
+   if (RopRow && !BltInfo->PatternSurface)
+      return DIB_24BPP_BitBltRow(BltInfo, RopRow, Pattern);
+
    for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++)
    {
       SourceX = BltInfo->SourcePoint.x;
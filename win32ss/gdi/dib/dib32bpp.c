@@ -9,6 +9,7 @@
  */
 
 #include <win32k.h>
+#include "alphablend.h"
 
 #define NDEBUG
 #include <debug.h>
@@ -53,14 +54,20 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
   PDWORD   Source32, Dest32;
+  ULONG    XlateTable[256], cPixels;
+  PULONG   Xlate;
 
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0
     + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta)
     + 4 * BltInfo->DestRect.left;
 
+  cPixels = (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+            (BltInfo->DestRect.bottom - BltInfo->DestRect.top);
+
   switch (BltInfo->SourceSurface->iBitmapFormat)
   {
   case BMF_1BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 2, XlateTable, 2);
 
     sx = BltInfo->SourcePoint.x;
     sy = BltInfo->SourcePoint.y;
@@ -72,9 +79,9 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       {
         if (DIB_1BPP_GetPixel(BltInfo->SourceSurface, sx, sy) == 0)
         {
-          DIB_32BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 0));
+          DIB_32BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[0]);
         } else {
-          DIB_32BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 1));
+          DIB_32BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[1]);
         }
         sx++;
       }
@@ -83,6 +90,7 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     break;
 
   case BMF_4BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 16, XlateTable, 16);
     SourceBits_4BPP = (PBYTE)BltInfo->SourceSurface->pvScan0
       + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta)
       + (BltInfo->SourcePoint.x >> 1);
@@ -95,8 +103,7 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
       for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
       {
-        xColor = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest,
-          (*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1)));
+        xColor = Xlate[(*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1))];
         DIB_32BPP_PutPixel(BltInfo->DestSurface, i, j, xColor);
         if (f1 == 1) {
           SourceLine_4BPP++;
@@ -112,6 +119,7 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     break;
 
   case BMF_8BPP:
+    Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 256, XlateTable, cPixels);
     SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + BltInfo->SourcePoint.x;
     DestLine = DestBits;
 
@@ -123,7 +131,7 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
       {
         xColor = *SourceBits;
-        *((PDWORD) DestBits) = (DWORD)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
+        *((PDWORD) DestBits) = (DWORD)DIB_XlateIndex(Xlate, BltInfo->XlateSourceToDest, xColor);
         SourceBits += 1;
         DestBits += 4;
       }
@@ -383,6 +391,43 @@ DIB_32BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
     (DestRect->left << 2));
   SrcBpp = BitsPerFormat(Source->iBitmapFormat);
 
+  /* Fast path: untranslated 32bpp source, read directly and blended two
+     channels at a time, with the source stepped without divisions */
+  if (Source->iBitmapFormat == BMF_32BPP &&
+      (ColorTranslation == NULL || (ColorTranslation->flXlate & XO_TRIVIAL)) &&
+      SourceRect->right > SourceRect->left && SourceRect->bottom > SourceRect->top &&
+      DestRect->right > DestRect->left && DestRect->bottom > DestRect->top)
+  {
+    LONG SrcHeight = SourceRect->bottom - SourceRect->top;
+    LONG DstHeight = DestRect->bottom - DestRect->top;
+    LONG YStep = SrcHeight / DstHeight;
+    LONG YRem = SrcHeight % DstHeight;
+    LONG YFrac = 0;
+
+    SrcY = SourceRect->top;
+    for (Rows = 0; Rows < DstHeight; Rows++)
+    {
+      DIB_32BPP_AlphaBlendRow(Dst,
+                              (PULONG)((ULONG_PTR)Source->pvScan0 + SrcY * Source->lDelta),
+                              SourceRect->left,
+                              SourceRect->right - SourceRect->left,
+                              DestRect->right - DestRect->left,
+                              BlendFunc.SourceConstantAlpha,
+                              (BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0);
+
+      Dst = (PULONG)((ULONG_PTR)Dst + Dest->lDelta);
+      SrcY += YStep;
+      YFrac += YRem;
+      if (YFrac >= DstHeight)
+      {
+        YFrac -= DstHeight;
+        SrcY++;
+      }
+    }
+
+    return TRUE;
+  }
+
   Rows = 0;
    SrcY = SourceRect->top;
    while (++Rows <= DestRect->bottom - DestRect->top)
@@ -218,6 +218,91 @@ DIB_4BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   return(TRUE);
 }
 
+static VOID
+DIB_4BPP_RopPixel(PBLTINFO BltInfo, PFN_DIB_RopRow RopRow, PULONG Xlate,
+                  LONG DestX, LONG DestY, LONG SourceX, LONG SourceY, ULONG Pattern)
+{
+  ULONG Dest, Source = 0;
+
+  Dest = DIB_4BPP_GetPixel(BltInfo->DestSurface, DestX, DestY);
+  if (ROP4_USES_SOURCE(BltInfo->Rop4))
+  {
+    DIB_GetSourceRow(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, Xlate,
+                     SourceX, SourceY, &Source, 1);
+  }
+  RopRow(&Dest, &Source, Pattern, 1);
+  DIB_4BPP_PutPixel(BltInfo->DestSurface, DestX, DestY, Dest & 0xF);
+}
+
+/*
+ * The common ROPs with a solid pattern. The ULONGs of eight pixels in the
+ * middle of a line go through the row function together, the pixels at
+ * both ends one by one.
+ */
+static BOOLEAN
+DIB_4BPP_BitBltRow(PBLTINFO BltInfo, PFN_DIB_RopRow RopRow, ULONG Pattern)
+{
+  ULONG XlateTable[256], SourceRow[DIB_ROW_PIXELS], SourceWords[DIB_ROW_PIXELS / 8];
+  PULONG Xlate = NULL, DestBits;
+  LONG DestX, DestY, SourceX, SourceY, AlignedLeft, AlignedRight, Count, i, j;
+  BOOLEAN UsesSource;
+
+  UsesSource = ROP4_USES_SOURCE(BltInfo->Rop4);
+  if (UsesSource)
+  {
+    Xlate = DIB_GetSourceXlateTable(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, XlateTable,
+                                    (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+                                    (BltInfo->DestRect.bottom - BltInfo->DestRect.top));
+  }
+
+  AlignedLeft = min((BltInfo->DestRect.left + 7) & ~7, BltInfo->DestRect.right);
+  AlignedRight = max(BltInfo->DestRect.right & ~7, AlignedLeft);
+  SourceY = BltInfo->SourcePoint.y;
+
+  for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++, SourceY++)
+  {
+    SourceX = BltInfo->SourcePoint.x;
+
+    for (DestX = BltInfo->DestRect.left; DestX < AlignedLeft; DestX++, SourceX++)
+      DIB_4BPP_RopPixel(BltInfo, RopRow, Xlate, DestX, DestY, SourceX, SourceY, Pattern);
+
+    DestBits = (PULONG)(
+      (PBYTE)BltInfo->DestSurface->pvScan0 +
+      (DestX >> 1) +
+      DestY * BltInfo->DestSurface->lDelta);
+
+    for (; DestX < AlignedRight; DestX += Count, SourceX += Count)
+    {
+      Count = min(AlignedRight - DestX, DIB_ROW_PIXELS);
+
+      if (UsesSource)
+      {
+        DIB_GetSourceRow(BltInfo->SourceSurface, BltInfo->XlateSourceToDest, Xlate,
+                         SourceX, SourceY, SourceRow, Count);
+
+        /* The first pixel of each byte is in its high nibble */
+        for (i = 0; i < Count / 8; i++)
+        {
+          SourceWords[i] = 0;
+          for (j = 0; j < 8; j += 2)
+          {
+            SourceWords[i] |= (((SourceRow[i * 8 + j] & 0xF) << 4) |
+                               (SourceRow[i * 8 + j + 1] & 0xF)) << (j * 4);
+          }
+        }
+      }
+
+      RopRow(DestBits, SourceWords, Pattern, Count / 8);
+      DestBits += Count / 8;
+    }
+
+    for (; DestX < BltInfo->DestRect.right; DestX++, SourceX++)
+      DIB_4BPP_RopPixel(BltInfo, RopRow, Xlate, DestX, DestY, SourceX, SourceY, Pattern);
+  }
+
+  return TRUE;
+}
+
 BOOLEAN
 DIB_4BPP_BitBlt(PBLTINFO BltInfo)
 {
@@ -229,6 +314,7 @@ DIB_4BPP_BitBlt(PBLTINFO BltInfo)
   BOOLEAN UsesPattern;
   PULONG DestBits;
   LONG RoundedRight;
+  PFN_DIB_RopRow RopRow;
   static const ULONG ExpandSolidColor[16] =
   {
     0x00000000 /* 0 */,
@@ -270,6 +356,10 @@ DIB_4BPP_BitBlt(PBLTINFO BltInfo)
     }
   }
 
+  RopRow = DIB_GetRopRow(BltInfo->Rop4);
+  if (RopRow && !BltInfo->PatternSurface)
+    return DIB_4BPP_BitBltRow(BltInfo, RopRow, Pattern);
+
   for (DestY = BltInfo->DestRect.top; DestY < BltInfo->DestRect.bottom; DestY++)
   {
     DestBits = (PULONG)(
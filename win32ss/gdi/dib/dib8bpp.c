@@ -57,12 +57,17 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
   LONG     i, j, sx, sy, xColor, f1;
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
+  ULONG    XlateTable[256], cPixels;
+  PULONG   Xlate;
 
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0 + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta) + BltInfo->DestRect.left;
+  cPixels = (BltInfo->DestRect.right - BltInfo->DestRect.left) *
+            (BltInfo->DestRect.bottom - BltInfo->DestRect.top);
 
   switch(BltInfo->SourceSurface->iBitmapFormat)
   {
     case BMF_1BPP:
+      Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 2, XlateTable, 2);
       sx = BltInfo->SourcePoint.x;
       sy = BltInfo->SourcePoint.y;
 
@@ -73,11 +78,11 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
         {
           if(DIB_1BPP_GetPixel(BltInfo->SourceSurface, sx, sy) == 0)
           {
-            DIB_8BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 0));
+            DIB_8BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[0]);
           }
           else
           {
-            DIB_8BPP_PutPixel(BltInfo->DestSurface, i, j, XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, 1));
+            DIB_8BPP_PutPixel(BltInfo->DestSurface, i, j, Xlate[1]);
           }
           sx++;
         }
@@ -86,6 +91,7 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       break;
 
     case BMF_4BPP:
+      Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 16, XlateTable, 16);
       SourceBits_4BPP = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + (BltInfo->SourcePoint.x >> 1);
 
       for (j=BltInfo->DestRect.top; j<BltInfo->DestRect.bottom; j++)
@@ -96,8 +102,7 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 
         for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
         {
-          xColor = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest,
-              (*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1)));
+          xColor = Xlate[(*SourceLine_4BPP & altnotmask[f1]) >> (4 * (1 - f1))];
           DIB_8BPP_PutPixel(BltInfo->DestSurface, i, j, xColor);
           if(f1 == 1) { SourceLine_4BPP++; f1 = 0; } else { f1 = 1; }
           sx++;
@@ -134,6 +139,7 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       }
       else
       {
+        Xlate = DIB_GetXlateTable(BltInfo->XlateSourceToDest, 256, XlateTable, cPixels);
         if (BltInfo->DestRect.top < BltInfo->SourcePoint.y)
         {
           SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + BltInfo->SourcePoint.x;
@@ -144,7 +150,7 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
             DestBits = DestLine;
             for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
             {
-              *DestBits++ = (BYTE)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, *SourceBits++);
+              *DestBits++ = (BYTE)DIB_XlateIndex(Xlate, BltInfo->XlateSourceToDest, *SourceBits++);
             }
             SourceLine += BltInfo->SourceSurface->lDelta;
             DestLine += BltInfo->DestSurface->lDelta;
@@ -160,7 +166,7 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
             DestBits = DestLine;
             for (i=BltInfo->DestRect.left; i<BltInfo->DestRect.right; i++)
             {
-              *DestBits++ = (BYTE)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, *SourceBits++);
+              *DestBits++ = (BYTE)DIB_XlateIndex(Xlate, BltInfo->XlateSourceToDest, *SourceBits++);
             }
             SourceLine -= BltInfo->SourceSurface->lDelta;
             DestLine -= BltInfo->DestSurface->lDelta;
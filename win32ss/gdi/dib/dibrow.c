@@ -0,0 +1,176 @@
+/*
+ * PROJECT:     ReactOS Win32k subsystem
+ * LICENSE:     GPL-2.0-or-later (https://spdx.org/licenses/GPL-2.0-or-later)
+ * PURPOSE:     Source row fetching and row ROPs shared by the DIB blitters
+ * COPYRIGHT:   Copyright 2026 ReactOS Team
+ */
+
+#include <win32k.h>
+
+#define NDEBUG
+#include <debug.h>
+
+/*
+ * Returns a table translating every index of a palettized source bitmap
+ * with cColors colors. The table of the XLATEOBJ is used when it has one,
+ * otherwise it is built in pulTable, but only when the blit covers at least
+ * as many pixels as the table has entries. NULL means translate per pixel.
+ */
+PULONG
+DIB_GetXlateTable(XLATEOBJ *pxlo, ULONG cColors, PULONG pulTable, ULONG cPixels)
+{
+  ULONG i;
+
+  if (pxlo && (pxlo->flXlate & XO_TABLE) && pxlo->cEntries >= cColors)
+    return pxlo->pulXlate;
+
+  if (cPixels < cColors)
+    return NULL;
+
+  for (i = 0; i < cColors; i++)
+    pulTable[i] = XLATEOBJ_iXlate(pxlo, i);
+
+  return pulTable;
+}
+
+/* Same as DIB_GetXlateTable, for whatever depth the source has */
+PULONG
+DIB_GetSourceXlateTable(SURFOBJ *SourceSurf, XLATEOBJ *pxlo, PULONG pulTable, ULONG cPixels)
+{
+  switch (SourceSurf->iBitmapFormat)
+  {
+    case BMF_1BPP: return DIB_GetXlateTable(pxlo, 2, pulTable, 2);
+    case BMF_4BPP: return DIB_GetXlateTable(pxlo, 16, pulTable, 16);
+    case BMF_8BPP: return DIB_GetXlateTable(pxlo, 256, pulTable, cPixels);
+  }
+
+  return NULL;
+}
+
+/*
+ * Reads Count pixels of a source row starting at x, y and translates them
+ * to the destination format. XlateTable comes from DIB_GetSourceXlateTable.
+ */
+VOID
+DIB_GetSourceRow(SURFOBJ *SourceSurf, XLATEOBJ *pxlo, PULONG XlateTable,
+                 LONG x, LONG y, PULONG Row, ULONG Count)
+{
+  PBYTE Bits = (PBYTE)SourceSurf->pvScan0 + y * SourceSurf->lDelta;
+  BOOLEAN Trivial = (NULL == pxlo || 0 != (pxlo->flXlate & XO_TRIVIAL));
+  ULONG i;
+
+  switch (SourceSurf->iBitmapFormat)
+  {
+    case BMF_1BPP:
+      for (i = 0; i < Count; i++, x++)
+        Row[i] = DIB_XlateIndex(XlateTable, pxlo, (Bits[x >> 3] & MASK1BPP(x)) ? 1 : 0);
+      break;
+
+    case BMF_4BPP:
+      for (i = 0; i < Count; i++, x++)
+        Row[i] = DIB_XlateIndex(XlateTable, pxlo, (Bits[x >> 1] >> ((1 - (x & 1)) << 2)) & 0x0f);
+      break;
+
+    case BMF_8BPP:
+      for (i = 0; i < Count; i++, x++)
+        Row[i] = DIB_XlateIndex(XlateTable, pxlo, Bits[x]);
+      break;
+
+    case BMF_24BPP:
+      Bits += (x << 1) + x;
+      for (i = 0; i < Count; i++, Bits += 3)
+      {
+        Row[i] = *(PUSHORT)Bits + (Bits[2] << 16);
+        if (!Trivial)
+          Row[i] = XLATEOBJ_iXlate(pxlo, Row[i]);
+      }
+      break;
+
+    case BMF_32BPP:
+      if (Trivial)
+      {
+        RtlCopyMemory(Row, (PULONG)Bits + x, Count * sizeof(ULONG));
+        break;
+      }
+      for (i = 0; i < Count; i++, x++)
+        Row[i] = XLATEOBJ_iXlate(pxlo, ((PULONG)Bits)[x]);
+      break;
+
+    default:
+      for (i = 0; i < Count; i++, x++)
+        Row[i] = DIB_GetSource(SourceSurf, x, y, pxlo);
+      break;
+  }
+}
+
+/*
+ * Row versions of the most common ROP3s of DIB_DoRop. Each one combines
+ * Count destination values in place with the source values and a solid
+ * pattern. The values may be pixels or packed words of pixels alike.
+ */
+static VOID
+DIB_RopRowPatCopy(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ = Pattern;
+}
+
+static VOID
+DIB_RopRowPatInvert(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ ^= Pattern;
+}
+
+static VOID
+DIB_RopRowSrcInvert(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ ^= *Source++;
+}
+
+static VOID
+DIB_RopRowSrcAnd(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ &= *Source++;
+}
+
+static VOID
+DIB_RopRowSrcPaint(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ |= *Source++;
+}
+
+static VOID
+DIB_RopRowMergeCopy(PULONG Dest, PULONG Source, ULONG Pattern, ULONG Count)
+{
+  while (Count--)
+    *Dest++ = *Source++ & Pattern;
+}
+
+/*
+ * Returns the row function for a ROP4, or NULL when the blitter has to
+ * go through DIB_DoRop for every pixel.
+ */
+PFN_DIB_RopRow
+DIB_GetRopRow(ROP4 Rop4)
+{
+  if (ROP4_USES_MASK(Rop4))
+    return NULL;
+
+  switch (ROP4_FGND(Rop4))
+  {
+    case R3_OPINDEX_PATCOPY:   return DIB_RopRowPatCopy;
+    case R3_OPINDEX_PATINVERT: return DIB_RopRowPatInvert;
+    case R3_OPINDEX_SRCINVERT: return DIB_RopRowSrcInvert;
+    case R3_OPINDEX_SRCAND:    return DIB_RopRowSrcAnd;
+    case R3_OPINDEX_SRCPAINT:  return DIB_RopRowSrcPaint;
+    case R3_OPINDEX_MERGECOPY: return DIB_RopRowMergeCopy;
+  }
+
+  return NULL;
+}
+
+/* EOF */
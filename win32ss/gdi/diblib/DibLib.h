@@ -26,11 +26,22 @@ extern const BYTE ajShift4[2];
 
 #include "DibLib_interface.h"
 
-#define _DibXlate(pBltData, ulColor) (pBltData->pfnXlate(pBltData->pxlo, ulColor))
-
 #define __PASTE_(s1,s2) s1##s2
 #define __PASTE(s1,s2) __PASTE_(s1,s2)
 
+/* Indexed sources look their colors up in a per blit table, direct color
+   sources skip the xlate call when it would not change anything */
+#define _DibXlate(pBltData, ulColor) __PASTE(_DibXlate_, _SOURCE_BPP)(pBltData, ulColor)
+#define _DibXlateTable(pBltData, ulColor) ((pBltData)->pulXlate[ulColor])
+#define _DibXlateDirect(pBltData, ulColor) \
+    ((pBltData)->bTrivialXlate ? (ulColor) : (pBltData)->pfnXlate((pBltData)->pxlo, ulColor))
+#define _DibXlate_1 _DibXlateTable
+#define _DibXlate_4 _DibXlateTable
+#define _DibXlate_8 _DibXlateTable
+#define _DibXlate_16 _DibXlateDirect
+#define _DibXlate_24 _DibXlateDirect
+#define _DibXlate_32 _DibXlateDirect
+
 #define __DIB_FUNCTION_NAME_SRCDST2(name, src_bpp, dst_bpp) Dib_ ## name ## _S ## src_bpp ## _D ## dst_bpp
 #define __DIB_FUNCTION_NAME_SRCDST(name, src_bpp, dst_bpp) __DIB_FUNCTION_NAME_SRCDST2(name, src_bpp, dst_bpp)
 
@@ -43,7 +43,7 @@
 #undef _NextPixel_
 
 #undef _DibXlate
-#define _DibXlate(pBltData, ulColor) (pBltData->pfnXlate(pBltData->pxlo, ulColor))
+#define _DibXlate(pBltData, ulColor) __PASTE(_DibXlate_, _SOURCE_BPP)(pBltData, ulColor)
 
 PFN_DIBFUNCTION
 __PASTE(gapfn, __FUNCTIONNAME)[7][7] =
@@ -25,6 +25,8 @@ typedef struct
     ULONG ulPatHeight;
     XLATEOBJ *pxlo;
     PFN_XLATE pfnXlate;
+    const ULONG *pulXlate; /* Color per source index, for sources up to 8 bpp */
+    BOOLEAN bTrivialXlate;
     ULONG rop4;
     PFN_DOROP apfnDoRop[2];
     ULONG ulSolidColor;
@@ -4,6 +4,8 @@
 extern PFN_DIBFUNCTION gapfnBitBlt_SRCCOPY[7][7];
 extern PFN_DIBFUNCTION gapfnBitBlt_SRCINVERT[7][7];
 
+static const ULONG aulMaskXlate[2] = {0, 1};
+
 VOID
 FASTCALL
 Dib_MaskCopy(PBLTDATA pBltData)
@@ -12,6 +14,7 @@ Dib_MaskCopy(PBLTDATA pBltData)
 
     /* Create an XLATEOBJ */
     pBltData->pxlo = 0;// FIXME: use 1bpp -> destbpp
+    pBltData->pulXlate = aulMaskXlate;
 
     /* 4 possibilities... */
     if (pBltData->rop4 == MAKEROP4(BLACKNESS, WHITENESS))
@@ -112,6 +112,7 @@ EngBitBlt(
 {
     BLTDATA bltdata;
     ULONG i, iFunctionIndex, iDirection = CD_ANY;
+    ULONG aulXlate[256];
     RECTL rcTrg;
     PFN_DIBFUNCTION pfnBitBlt;
     BOOL bEnumMore;
@@ -141,6 +142,8 @@ EngBitBlt(
     if (!pxlo) pxlo = &gexloTrivial.xlo;
     bltdata.pxlo = pxlo;
     bltdata.pfnXlate = XLATEOBJ_pfnXlate(pxlo);
+    bltdata.pulXlate = NULL;
+    bltdata.bTrivialXlate = (pxlo->flXlate & XO_TRIVIAL) != 0;
 
     /* Check if the ROP uses a source */
     if (ROP4_USES_SOURCE(rop4))
@@ -194,6 +197,24 @@ EngBitBlt(
         bltdata.siSrc.lDelta = psoSrc->lDelta;
         bltdata.siSrc.cjAdvanceY = bltdata.dy * psoSrc->lDelta;
         bltdata.siSrc.jBpp = gajBitsPerFormat[psoSrc->iBitmapFormat];
+
+        /* Indexed sources are translated through a table built once per
+           blit, so the inner loops don't call the xlate function */
+        if (bltdata.siSrc.jBpp <= 8)
+        {
+            ULONG cColors = 1 << bltdata.siSrc.jBpp;
+
+            if ((pxlo->flXlate & XO_TABLE) && (pxlo->cEntries >= cColors))
+            {
+                bltdata.pulXlate = pxlo->pulXlate;
+            }
+            else
+            {
+                for (i = 0; i < cColors; i++)
+                    aulXlate[i] = XLATEOBJ_iXlate(pxlo, i);
+                bltdata.pulXlate = aulXlate;
+            }
+        }
     }
     else
     {
@@ -19,6 +19,40 @@ EXLATEOBJ_iXlateTrivial(
     _In_ PEXLATEOBJ pexlo,
     _In_ ULONG iColor);
 
+/* Kinds of cached translation data */
+#define XCE_TABLE       0 /* Indexed to indexed table, ULONG per source index */
+#define XCE_CUBE555     1 /* 555 to indexed inverse cube, USHORT per color */
+#define XCE_CUBE565     2 /* 565 to indexed inverse cube, USHORT per color */
+
+/* Upper bound for the memory used by unreferenced cache entries */
+#define XLATE_CACHE_MAX_SIZE (1024 * 1024)
+
+/* A realized translation, shared between all EXLATEOBJs with the same
+ * palette contents. Keying by contents instead of by palette object means
+ * an entry can never be stale: a palette that was changed or deleted
+ * simply doesn't match it anymore and the entry ages out of the cache. */
+typedef struct _XLATECACHE_ENTRY
+{
+    LIST_ENTRY leLink;
+    LONG cRefs;
+    ULONG iType;
+    ULONG ulHash;
+    SIZE_T cjSize;
+    ULONG cSrcColors;
+    ULONG cDstColors;
+    PALETTEENTRY *ppeSrc;
+    PALETTEENTRY *ppeDst;
+    BOOL bTrivial;
+    union
+    {
+        /* XCE_TABLE: the translation table */
+        PULONG pulXlate;
+
+        /* XCE_CUBE*: palette index + 1 per 16 bit color, 0 until looked up */
+        PUSHORT pusCube;
+    };
+} XLATECACHE_ENTRY, *PXLATECACHE_ENTRY;
+
 /** Globals *******************************************************************/
 
 EXLATEOBJ gexloTrivial = {{0, XO_TRIVIAL, 0, 0, 0, 0}, EXLATEOBJ_iXlateTrivial};
@@ -35,6 +69,9 @@ static const BYTE gajXlate6to8[64] =
 130,134,138,142,146,150,154,158,162,166,170,174,178,182,186,190,
 194,198,202,207,210,215,219,223,227,231,235,239,243,247,251,255};
 
+static HSEMAPHORE ghsemXlateCache;
+static LIST_ENTRY gleXlateCache;
+static SIZE_T gcjXlateCache = 0;
 
 /** iXlate functions **********************************************************/
 
@@ -324,6 +361,49 @@ EXLATEOBJ_iXlate565toPal(EXLATEOBJ *pexlo, ULONG iColor)
     return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
 }
 
+_Function_class_(FN_XLATE)
+ULONG
+FASTCALL
+EXLATEOBJ_iXlate555toPalCube(PEXLATEOBJ pexlo, ULONG iColor)
+{
+    PUSHORT pusCube = pexlo->pxce->pusCube;
+    ULONG iIndex;
+
+    /* Only the low 15 bits are used by the conversion */
+    iColor &= 0x7FFF;
+
+    iIndex = pusCube[iColor];
+    if (iIndex == 0)
+    {
+        /* First time we see this color, search the palette. Concurrent
+           users of the cube can only ever store the same value here */
+        iIndex = EXLATEOBJ_iXlate555toPal(pexlo, iColor) + 1;
+        pusCube[iColor] = (USHORT)iIndex;
+    }
+
+    return iIndex - 1;
+}
+
+_Function_class_(FN_XLATE)
+ULONG
+FASTCALL
+EXLATEOBJ_iXlate565toPalCube(PEXLATEOBJ pexlo, ULONG iColor)
+{
+    PUSHORT pusCube = pexlo->pxce->pusCube;
+    ULONG iIndex;
+
+    iColor &= 0xFFFF;
+
+    iIndex = pusCube[iColor];
+    if (iIndex == 0)
+    {
+        iIndex = EXLATEOBJ_iXlate565toPal(pexlo, iColor) + 1;
+        pusCube[iColor] = (USHORT)iIndex;
+    }
+
+    return iIndex - 1;
+}
+
 _Function_class_(FN_XLATE)
 ULONG
 FASTCALL
@@ -351,6 +431,276 @@ EXLATEOBJ_iXlateBitfieldsToPal(PEXLATEOBJ pexlo, ULONG iColor)
 }
 
 
+/** Translation cache *********************************************************/
+
+INIT_FUNCTION
+NTSTATUS
+NTAPI
+InitXlateImpl(VOID)
+{
+    InitializeListHead(&gleXlateCache);
+
+    ghsemXlateCache = EngCreateSemaphore();
+    if (!ghsemXlateCache)
+    {
+        DPRINT1("Failed to create ghsemXlateCache\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+static
+ULONG
+XLATECACHE_ulHashColors(
+    _In_ ULONG ulHash,
+    _In_ ULONG cColors,
+    _In_reads_(cColors) const PALETTEENTRY *ppe)
+{
+    const ULONG *pulColors = (const ULONG *)ppe;
+    ULONG i;
+
+    /* FNV-1a over whole entries */
+    ulHash = (ulHash ^ cColors) * 16777619;
+    for (i = 0; i < cColors; i++)
+        ulHash = (ulHash ^ pulColors[i]) * 16777619;
+
+    return ulHash;
+}
+
+static
+ULONG
+XLATECACHE_ulHash(
+    _In_ ULONG iType,
+    _In_opt_ PPALETTE ppalSrc,
+    _In_ PPALETTE ppalDst)
+{
+    ULONG ulHash = 2166136261 ^ iType;
+
+    if (ppalSrc)
+        ulHash = XLATECACHE_ulHashColors(ulHash, ppalSrc->NumColors, ppalSrc->IndexedColors);
+
+    return XLATECACHE_ulHashColors(ulHash, ppalDst->NumColors, ppalDst->IndexedColors);
+}
+
+static
+BOOL
+XLATECACHE_bMatch(
+    _In_ PXLATECACHE_ENTRY pxce,
+    _In_ ULONG iType,
+    _In_ ULONG ulHash,
+    _In_opt_ PPALETTE ppalSrc,
+    _In_ PPALETTE ppalDst)
+{
+    ULONG cSrcColors = ppalSrc ? ppalSrc->NumColors : 0;
+
+    if (pxce->ulHash != ulHash ||
+        pxce->iType != iType ||
+        pxce->cSrcColors != cSrcColors ||
+        pxce->cDstColors != ppalDst->NumColors)
+    {
+        return FALSE;
+    }
+
+    if (cSrcColors &&
+        RtlCompareMemory(pxce->ppeSrc, ppalSrc->IndexedColors,
+                         cSrcColors * sizeof(PALETTEENTRY)) != cSrcColors * sizeof(PALETTEENTRY))
+    {
+        return FALSE;
+    }
+
+    return RtlCompareMemory(pxce->ppeDst, ppalDst->IndexedColors,
+                            pxce->cDstColors * sizeof(PALETTEENTRY)) ==
+           pxce->cDstColors * sizeof(PALETTEENTRY);
+}
+
+/* Look up an entry and reference it. Must be called with the cache lock held. */
+static
+PXLATECACHE_ENTRY
+XLATECACHE_pxceFind(
+    _In_ ULONG iType,
+    _In_ ULONG ulHash,
+    _In_opt_ PPALETTE ppalSrc,
+    _In_ PPALETTE ppalDst)
+{
+    PXLATECACHE_ENTRY pxce;
+    PLIST_ENTRY ple;
+
+    for (ple = gleXlateCache.Flink; ple != &gleXlateCache; ple = ple->Flink)
+    {
+        pxce = CONTAINING_RECORD(ple, XLATECACHE_ENTRY, leLink);
+        if (XLATECACHE_bMatch(pxce, iType, ulHash, ppalSrc, ppalDst))
+        {
+            /* Move it to the front, so the list stays in LRU order */
+            RemoveEntryList(&pxce->leLink);
+            InsertHeadList(&gleXlateCache, &pxce->leLink);
+            InterlockedIncrement(&pxce->cRefs);
+            return pxce;
+        }
+    }
+
+    return NULL;
+}
+
+/* Insert a new, referenced entry and trim the cache. Must be called with
+   the cache lock held. */
+static
+VOID
+XLATECACHE_vInsert(
+    _In_ PXLATECACHE_ENTRY pxce)
+{
+    PXLATECACHE_ENTRY pxceOld;
+    PLIST_ENTRY ple;
+
+    InsertHeadList(&gleXlateCache, &pxce->leLink);
+    gcjXlateCache += pxce->cjSize;
+
+    /* Free the least recently used entries nobody is using right now.
+       Entries that are in use are only freed once they are released and
+       age out again. */
+    ple = gleXlateCache.Blink;
+    while (gcjXlateCache > XLATE_CACHE_MAX_SIZE && ple != &gleXlateCache)
+    {
+        pxceOld = CONTAINING_RECORD(ple, XLATECACHE_ENTRY, leLink);
+        ple = ple->Blink;
+
+        if (pxceOld->cRefs != 0)
+            continue;
+
+        RemoveEntryList(&pxceOld->leLink);
+        gcjXlateCache -= pxceOld->cjSize;
+        EngFreeMem(pxceOld);
+    }
+}
+
+static
+PXLATECACHE_ENTRY
+XLATECACHE_pxceAlloc(
+    _In_ ULONG iType,
+    _In_ ULONG ulHash,
+    _In_opt_ PPALETTE ppalSrc,
+    _In_ PPALETTE ppalDst,
+    _In_ SIZE_T cjData)
+{
+    PXLATECACHE_ENTRY pxce;
+    ULONG cSrcColors = ppalSrc ? ppalSrc->NumColors : 0;
+    SIZE_T cjSize;
+
+    cjSize = sizeof(XLATECACHE_ENTRY) +
+             (cSrcColors + ppalDst->NumColors) * sizeof(PALETTEENTRY) +
+             cjData;
+
+    /* Zeroed, so an inverse cube starts out without any lookups */
+    pxce = EngAllocMem(FL_ZERO_MEMORY, cjSize, GDITAG_PXLATE);
+    if (!pxce)
+        return NULL;
+
+    pxce->cRefs = 1;
+    pxce->iType = iType;
+    pxce->ulHash = ulHash;
+    pxce->cjSize = cjSize;
+    pxce->cSrcColors = cSrcColors;
+    pxce->cDstColors = ppalDst->NumColors;
+    pxce->pulXlate = (PULONG)(pxce + 1);
+    pxce->ppeSrc = (PALETTEENTRY*)((PUCHAR)pxce->pulXlate + cjData);
+    pxce->ppeDst = pxce->ppeSrc + cSrcColors;
+
+    if (cSrcColors)
+        RtlCopyMemory(pxce->ppeSrc, ppalSrc->IndexedColors, cSrcColors * sizeof(PALETTEENTRY));
+    RtlCopyMemory(pxce->ppeDst, ppalDst->IndexedColors, pxce->cDstColors * sizeof(PALETTEENTRY));
+
+    return pxce;
+}
+
+static
+VOID
+XLATECACHE_vRelease(
+    _In_ PXLATECACHE_ENTRY pxce)
+{
+    /* Entries are only freed under the cache lock while unreferenced */
+    InterlockedDecrement(&pxce->cRefs);
+}
+
+/* Get the shared indexed to indexed translation table */
+static
+PXLATECACHE_ENTRY
+XLATECACHE_pxceGetTable(
+    _In_ PPALETTE ppalSrc,
+    _In_ PPALETTE ppalDst)
+{
+    PXLATECACHE_ENTRY pxce, pxceCached;
+    ULONG ulHash, i, ulColor, cDiff = 0;
+
+    ulHash = XLATECACHE_ulHash(XCE_TABLE, ppalSrc, ppalDst);
+
+    EngAcquireSemaphore(ghsemXlateCache);
+    pxce = XLATECACHE_pxceFind(XCE_TABLE, ulHash, ppalSrc, ppalDst);
+    EngReleaseSemaphore(ghsemXlateCache);
+    if (pxce)
+        return pxce;
+
+    /* Not cached, do the expensive palette searches without the lock */
+    pxce = XLATECACHE_pxceAlloc(XCE_TABLE, ulHash, ppalSrc, ppalDst,
+                                ppalSrc->NumColors * sizeof(ULONG));
+    if (!pxce)
+        return NULL;
+
+    for (i = 0; i < pxce->cSrcColors; i++)
+    {
+        ulColor = RGB(pxce->ppeSrc[i].peRed,
+                      pxce->ppeSrc[i].peGreen,
+                      pxce->ppeSrc[i].peBlue);
+
+        pxce->pulXlate[i] = PALETTE_ulGetNearestPaletteIndex(ppalDst, ulColor);
+
+        if (pxce->pulXlate[i] != i) cDiff++;
+    }
+    pxce->bTrivial = (cDiff == 0);
+
+    /* Someone else might have been faster */
+    EngAcquireSemaphore(ghsemXlateCache);
+    pxceCached = XLATECACHE_pxceFind(XCE_TABLE, ulHash, ppalSrc, ppalDst);
+    if (!pxceCached)
+        XLATECACHE_vInsert(pxce);
+    EngReleaseSemaphore(ghsemXlateCache);
+
+    if (pxceCached)
+    {
+        EngFreeMem(pxce);
+        pxce = pxceCached;
+    }
+
+    return pxce;
+}
+
+/* Get the shared inverse color cube of a palette for 16 bit sources */
+static
+PXLATECACHE_ENTRY
+XLATECACHE_pxceGetCube(
+    _In_ ULONG iType,
+    _In_ PPALETTE ppalDst)
+{
+    PXLATECACHE_ENTRY pxce;
+    ULONG ulHash;
+
+    ulHash = XLATECACHE_ulHash(iType, NULL, ppalDst);
+
+    EngAcquireSemaphore(ghsemXlateCache);
+    pxce = XLATECACHE_pxceFind(iType, ulHash, NULL, ppalDst);
+    if (!pxce)
+    {
+        /* The cube is filled lazily, so a new one is cheap to create */
+        pxce = XLATECACHE_pxceAlloc(iType, ulHash, NULL, ppalDst,
+                                    (iType == XCE_CUBE555 ? 0x8000 : 0x10000) * sizeof(USHORT));
+        if (pxce)
+            XLATECACHE_vInsert(pxce);
+    }
+    EngReleaseSemaphore(ghsemXlateCache);
+
+    return pxce;
+}
+
+
 /** Private Functions *********************************************************/
 
 VOID
@@ -375,6 +725,7 @@ EXLATEOBJ_vInitialize(
     pexlo->xlo.pulXlate = pexlo->aulXlate;
     pexlo->pfnXlate = EXLATEOBJ_iXlateTrivial;
     pexlo->hColorTransform = NULL;
+    pexlo->pxce = NULL;
     pexlo->ppalSrc = ppalSrc;
     pexlo->ppalDst = ppalDst;
     pexlo->xlo.iSrcType = (USHORT)ppalSrc->flFlags;
@@ -455,6 +806,32 @@ EXLATEOBJ_vInitialize(
     {
         cEntries = ppalSrc->NumColors;
 
+        /* Use a shared table for palettes that need a buffer anyway, this
+           saves a nearest color search per source entry on every blit */
+        if (cEntries > 6 && (ppalDst->flFlags & PAL_INDEXED))
+        {
+            pexlo->pxce = XLATECACHE_pxceGetTable(ppalSrc, ppalDst);
+            if (pexlo->pxce)
+            {
+                if (pexlo->pxce->bTrivial)
+                {
+                    XLATECACHE_vRelease(pexlo->pxce);
+                    pexlo->pxce = NULL;
+                    pexlo->pfnXlate = EXLATEOBJ_iXlateTrivial;
+                    pexlo->xlo.flXlate = XO_TRIVIAL;
+                    return;
+                }
+
+                pexlo->pfnXlate = EXLATEOBJ_iXlateTable;
+                pexlo->xlo.cEntries = cEntries;
+                pexlo->xlo.flXlate |= XO_TABLE;
+                pexlo->xlo.pulXlate = pexlo->pxce->pulXlate;
+                return;
+            }
+
+            /* Fall back to a private table */
+        }
+
         /* Allocate buffer if needed */
         if (cEntries > 6)
         {
@@ -553,7 +930,11 @@ EXLATEOBJ_vInitialize(
     else if (ppalSrc->flFlags & PAL_RGB16_555)
     {
         if (ppalDst->flFlags & PAL_INDEXED)
-            pexlo->pfnXlate = EXLATEOBJ_iXlate555toPal;
+        {
+            pexlo->pxce = XLATECACHE_pxceGetCube(XCE_CUBE555, ppalDst);
+            pexlo->pfnXlate = pexlo->pxce ? EXLATEOBJ_iXlate555toPalCube :
+                                            EXLATEOBJ_iXlate555toPal;
+        }
 
         else if (ppalDst->flFlags & PAL_RGB)
             pexlo->pfnXlate = EXLATEOBJ_iXlate555toRGB;
@@ -570,7 +951,11 @@ EXLATEOBJ_vInitialize(
     else if (ppalSrc->flFlags & PAL_RGB16_565)
     {
         if (ppalDst->flFlags & PAL_INDEXED)
-            pexlo->pfnXlate = EXLATEOBJ_iXlate565toPal;
+        {
+            pexlo->pxce = XLATECACHE_pxceGetCube(XCE_CUBE565, ppalDst);
+            pexlo->pfnXlate = pexlo->pxce ? EXLATEOBJ_iXlate565toPalCube :
+                                            EXLATEOBJ_iXlate565toPal;
+        }
 
         else if (ppalDst->flFlags & PAL_RGB)
             pexlo->pfnXlate = EXLATEOBJ_iXlate565toRGB;
@@ -649,7 +1034,13 @@ NTAPI
 EXLATEOBJ_vCleanup(
     _Inout_ PEXLATEOBJ pexlo)
 {
-    if (pexlo->xlo.pulXlate != pexlo->aulXlate)
+    if (pexlo->pxce)
+    {
+        /* The table belongs to the cache */
+        XLATECACHE_vRelease(pexlo->pxce);
+        pexlo->pxce = NULL;
+    }
+    else if (pexlo->xlo.pulXlate != pexlo->aulXlate)
     {
         EngFreeMem(pexlo->xlo.pulXlate);
     }
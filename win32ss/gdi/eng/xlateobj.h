@@ -8,6 +8,7 @@
  */
 
 struct _EXLATEOBJ;
+struct _XLATECACHE_ENTRY;
 
 _Function_class_(FN_XLATE)
 typedef
@@ -28,6 +29,9 @@ typedef struct _EXLATEOBJ
 
     HANDLE hColorTransform;
 
+    /* Shared translation table or inverse color cube, if any */
+    struct _XLATECACHE_ENTRY *pxce;
+
     union
     {
         ULONG aulXlate[6];
@@ -54,6 +58,11 @@ XLATEOBJ_pfnXlate(
     return ((PEXLATEOBJ)pxlo)->pfnXlate;
 }
 
+INIT_FUNCTION
+NTSTATUS
+NTAPI
+InitXlateImpl(VOID);
+
 VOID
 NTAPI
 EXLATEOBJ_vInitialize(
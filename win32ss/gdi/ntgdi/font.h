@@ -25,7 +25,10 @@ typedef struct _FONT_ENTRY_COLL_MEM
 
 typedef struct _FONT_CACHE_ENTRY
 {
-    LIST_ENTRY ListEntry;
+    LIST_ENTRY ListEntry;       /* LRU order */
+    LIST_ENTRY HashEntry;       /* Hash bucket chain */
+    ULONG Hash;
+    SIZE_T Size;                /* Bytes charged against the cache budget */
     int GlyphIndex;
     FT_Face Face;
     FT_BitmapGlyph BitmapGlyph;
@@ -130,6 +130,13 @@ SOFTWARE.
 PREGION prgnDefault = NULL;
 HRGN    hrgnDefault = NULL;
 
+/* Rect buffers up to this size come from a lookaside list. Window
+   invalidation and clipping creates and frees lots of small ones. */
+#define RGN_POOL_RECTS 16
+#define RGN_POOL_SIZE (RGN_POOL_RECTS * sizeof(RECTL))
+
+static PPAGED_LOOKASIDE_LIST gpRegionBufferLookaside;
+
 // Internal Functions
 
 #if 1
@@ -413,6 +420,66 @@ typedef struct _SCANLINE_LISTBLOCK
 #define LARGE_COORDINATE  INT_MAX
 #define SMALL_COORDINATE  INT_MIN
 
+INIT_FUNCTION
+NTSTATUS
+NTAPI
+InitRegionImpl(VOID)
+{
+    gpRegionBufferLookaside = ExAllocatePoolWithTag(NonPagedPool,
+                                                    sizeof(PAGED_LOOKASIDE_LIST),
+                                                    TAG_REGION);
+    if (!gpRegionBufferLookaside)
+        return STATUS_NO_MEMORY;
+
+    ExInitializePagedLookasideList(gpRegionBufferLookaside,
+                                   NULL,
+                                   NULL,
+                                   0,
+                                   RGN_POOL_SIZE,
+                                   TAG_REGION,
+                                   256);
+
+    return STATUS_SUCCESS;
+}
+
+/* Allocate a buffer for at least *pcjSize bytes of rects and return its
+   real size in *pcjSize. The size must be passed back when freeing it. */
+static
+PRECTL
+REGION_pAllocRects(
+    _Inout_ PULONG pcjSize)
+{
+    if (*pcjSize <= RGN_POOL_SIZE)
+    {
+        *pcjSize = RGN_POOL_SIZE;
+        return ExAllocateFromPagedLookasideList(gpRegionBufferLookaside);
+    }
+
+    return ExAllocatePoolWithTag(PagedPool, *pcjSize, TAG_REGION);
+}
+
+static
+VOID
+REGION_vFreeRects(
+    _In_ PRECTL prcl,
+    _In_ ULONG cjSize)
+{
+    if (cjSize == RGN_POOL_SIZE)
+        ExFreeToPagedLookasideList(gpRegionBufferLookaside, prcl);
+    else
+        ExFreePoolWithTag(prcl, TAG_REGION);
+}
+
+/* Free the rect buffer of a region, unless it's the embedded one */
+static __inline
+VOID
+REGION_vFreeBuffer(
+    _Inout_ PREGION prgn)
+{
+    if ((prgn->Buffer != NULL) && (prgn->Buffer != &prgn->rdh.rcBound))
+        REGION_vFreeRects(prgn->Buffer, prgn->rdh.nRgnSize);
+}
+
 static
 BOOL
 REGION_bGrowBufferSize(
@@ -441,7 +508,7 @@ REGION_bGrowBufferSize(
     }
 
     /* Allocate the new buffer */
-    pvBuffer = ExAllocatePoolWithTag(PagedPool, cjNewSize, TAG_REGION);
+    pvBuffer = REGION_pAllocRects(&cjNewSize);
     if (pvBuffer == NULL)
     {
         return FALSE;
@@ -451,10 +518,7 @@ REGION_bGrowBufferSize(
     COPY_RECTS(pvBuffer, prgn->Buffer, prgn->rdh.nCount);
 
     /* Free the old buffer */
-    if (prgn->Buffer != &prgn->rdh.rcBound)
-    {
-        ExFreePoolWithTag(prgn->Buffer, TAG_REGION);
-    }
+    REGION_vFreeBuffer(prgn);
 
     /* Set the new buffer */
     prgn->Buffer = pvBuffer;
@@ -595,21 +659,19 @@ REGION_CopyRegion(
         if (dst->rdh.nRgnSize < src->rdh.nCount * sizeof(RECT))
         {
             PRECTL temp;
+            ULONG cjSize = src->rdh.nCount * sizeof(RECT);
 
             /* Allocate a new buffer */
-            temp = ExAllocatePoolWithTag(PagedPool,
-                                         src->rdh.nCount * sizeof(RECT),
-                                         TAG_REGION);
+            temp = REGION_pAllocRects(&cjSize);
             if (temp == NULL)
                 return FALSE;
 
             /* Free the old buffer */
-            if ((dst->Buffer != NULL) && (dst->Buffer != &dst->rdh.rcBound))
-                ExFreePoolWithTag(dst->Buffer, TAG_REGION);
+            REGION_vFreeBuffer(dst);
 
             /* Set the new buffer and the size */
             dst->Buffer = temp;
-            dst->rdh.nRgnSize = src->rdh.nCount * sizeof(RECT);
+            dst->rdh.nRgnSize = cjSize;
         }
 
         dst->rdh.nCount = src->rdh.nCount;
@@ -669,6 +731,29 @@ REGION_SetExtents(
     pReg->rdh.iType = RDH_RECTANGLES;
 }
 
+/* Replace the rects of a region with rects that are already banded and
+   coalesced. prcl must not point into the region's own buffer. */
+static
+BOOL
+REGION_bSetRects(
+    _Inout_ PREGION prgn,
+    _In_reads_(cRects) const RECTL *prcl,
+    _In_ ULONG cRects)
+{
+    /* A single rect always fits into the embedded buffer */
+    if ((cRects > 1) || (prgn->Buffer != &prgn->rdh.rcBound))
+    {
+        prgn->rdh.nCount = 0;
+        if (!REGION_bEnsureBufferSize(prgn, cRects))
+            return FALSE;
+    }
+
+    COPY_RECTS(prgn->Buffer, (PRECTL)prcl, cRects);
+    prgn->rdh.nCount = cRects;
+    REGION_SetExtents(prgn);
+    return TRUE;
+}
+
 // FIXME: This function needs review and testing
 /***********************************************************************
  *           REGION_CropRegion
@@ -723,13 +808,12 @@ REGION_CropRegion(
     if ((rgnDst != rgnSrc) && (rgnDst->rdh.nRgnSize < nRgnSize))
     {
         PRECTL temp;
-        temp = ExAllocatePoolWithTag(PagedPool, nRgnSize, TAG_REGION);
+        temp = REGION_pAllocRects(&nRgnSize);
         if (temp == NULL)
             return ERROR;
 
         /* Free the old buffer */
-        if (rgnDst->Buffer && (rgnDst->Buffer != &rgnDst->rdh.rcBound))
-            ExFreePoolWithTag(rgnDst->Buffer, TAG_REGION);
+        REGION_vFreeBuffer(rgnDst);
 
         rgnDst->Buffer = temp;
         rgnDst->rdh.nCount = 0;
@@ -972,6 +1056,8 @@ REGION_RegionOp(
     INT ybot;                          /* Bottom of intersection */
     INT ytop;                          /* Top of intersection */
     RECTL *oldRects;                   /* Old rects for newReg */
+    ULONG cjOldSize;                   /* Size of the old rects buffer */
+    ULONG cjSize;                      /* Size of the new rects buffer */
     ULONG prevBand;                    /* Index of start of
                                         * Previous band in newReg */
     ULONG curBand;                     /* Index of start of current band in newReg */
@@ -994,6 +1080,7 @@ REGION_RegionOp(
      * note of its rects pointer (so that we can free them later), preserve its
      * extents and simply set numRects to zero. */
     oldRects = newReg->Buffer;
+    cjOldSize = newReg->rdh.nRgnSize;
     newReg->rdh.nCount = 0;
 
     /* Allocate a reasonable number of rectangles for the new region. The idea
@@ -1001,15 +1088,25 @@ REGION_RegionOp(
      * reallocate and copy the array, which is time consuming, yet we don't
      * have to worry about using too much memory. I hope to be able to
      * nuke the Xrealloc() at the end of this function eventually. */
-    newReg->rdh.nRgnSize = max(reg1->rdh.nCount + 1, reg2->rdh.nCount) * 2 * sizeof(RECT);
+    cjSize = max(reg1->rdh.nCount + 1, reg2->rdh.nCount) * 2 * sizeof(RECT);
 
-    newReg->Buffer = ExAllocatePoolWithTag(PagedPool,
-                                           newReg->rdh.nRgnSize,
-                                           TAG_REGION);
-    if (newReg->Buffer == NULL)
+    if ((newReg != reg1) && (newReg != reg2) &&
+        (oldRects != &newReg->rdh.rcBound) && (cjOldSize >= cjSize))
     {
-        newReg->rdh.nRgnSize = 0;
-        return FALSE;
+        /* The old rects of newReg aren't needed by the operation, so
+         * just build the result in place */
+        oldRects = NULL;
+    }
+    else
+    {
+        newReg->rdh.nRgnSize = cjSize;
+        newReg->Buffer = REGION_pAllocRects(&newReg->rdh.nRgnSize);
+        if (newReg->Buffer == NULL)
+        {
+            newReg->Buffer = oldRects;
+            newReg->rdh.nRgnSize = cjOldSize;
+            return FALSE;
+        }
     }
 
     /* Initialize ybot and ytop.
@@ -1186,14 +1283,16 @@ REGION_RegionOp(
      * Only do this stuff if the number of rectangles allocated is more than
      * twice the number of rectangles in the region (a simple optimization...). */
     if ((newReg->rdh.nRgnSize > (2 * newReg->rdh.nCount * sizeof(RECT))) &&
+        (newReg->rdh.nRgnSize > RGN_POOL_SIZE) &&
         (newReg->rdh.nCount > 2))
     {
         if (REGION_NOT_EMPTY(newReg))
         {
             RECTL *prev_rects = newReg->Buffer;
-            newReg->Buffer = ExAllocatePoolWithTag(PagedPool,
-                                                   newReg->rdh.nCount * sizeof(RECT),
-                                                   TAG_REGION);
+            ULONG cjPrevSize = newReg->rdh.nRgnSize;
+
+            cjSize = newReg->rdh.nCount * sizeof(RECT);
+            newReg->Buffer = REGION_pAllocRects(&cjSize);
 
             if (newReg->Buffer == NULL)
             {
@@ -1201,31 +1300,26 @@ REGION_RegionOp(
             }
             else
             {
-                newReg->rdh.nRgnSize = newReg->rdh.nCount*sizeof(RECT);
+                newReg->rdh.nRgnSize = cjSize;
                 COPY_RECTS(newReg->Buffer, prev_rects, newReg->rdh.nCount);
                 if (prev_rects != &newReg->rdh.rcBound)
-                    ExFreePoolWithTag(prev_rects, TAG_REGION);
+                    REGION_vFreeRects(prev_rects, cjPrevSize);
             }
         }
         else
         {
             /* No point in doing the extra work involved in an Xrealloc if
              * the region is empty */
+            REGION_vFreeBuffer(newReg);
+            newReg->Buffer = &newReg->rdh.rcBound;
             newReg->rdh.nRgnSize = sizeof(RECT);
-            if (newReg->Buffer != &newReg->rdh.rcBound)
-                ExFreePoolWithTag(newReg->Buffer, TAG_REGION);
-
-            newReg->Buffer = ExAllocatePoolWithTag(PagedPool,
-                                                   sizeof(RECT),
-                                                   TAG_REGION);
-            ASSERT(newReg->Buffer);
         }
     }
 
     newReg->rdh.iType = RDH_RECTANGLES;
 
-    if (oldRects != &newReg->rdh.rcBound)
-        ExFreePoolWithTag(oldRects, TAG_REGION);
+    if ((oldRects != NULL) && (oldRects != &newReg->rdh.rcBound))
+        REGION_vFreeRects(oldRects, cjOldSize);
     return TRUE;
 }
 
@@ -1315,6 +1409,17 @@ REGION_IntersectRegion(
     {
         newReg->rdh.nCount = 0;
     }
+    else if ((reg1->rdh.nCount == 1) && (reg2->rdh.nCount == 1))
+    {
+        RECTL rcl;
+
+        /* Two overlapping rects, no need for the band algorithm */
+        rcl.left = max(reg1->Buffer[0].left, reg2->Buffer[0].left);
+        rcl.top = max(reg1->Buffer[0].top, reg2->Buffer[0].top);
+        rcl.right = min(reg1->Buffer[0].right, reg2->Buffer[0].right);
+        rcl.bottom = min(reg1->Buffer[0].bottom, reg2->Buffer[0].bottom);
+        return REGION_bSetRects(newReg, &rcl, 1);
+    }
     else
     {
         if (!REGION_RegionOp(newReg,
@@ -1539,6 +1644,27 @@ REGION_UnionRegion(
         return ret;
     }
 
+    /* Two rects in the same band that touch or overlap, or two rects of the
+       same width on top of each other, form a single rect */
+    if ((reg1->rdh.nCount == 1) && (reg2->rdh.nCount == 1))
+    {
+        const RECTL *prcl1 = &reg1->Buffer[0];
+        const RECTL *prcl2 = &reg2->Buffer[0];
+        RECTL rcl;
+
+        if (((prcl1->top == prcl2->top) && (prcl1->bottom == prcl2->bottom) &&
+             (prcl1->left <= prcl2->right) && (prcl2->left <= prcl1->right)) ||
+            ((prcl1->left == prcl2->left) && (prcl1->right == prcl2->right) &&
+             (prcl1->top <= prcl2->bottom) && (prcl2->top <= prcl1->bottom)))
+        {
+            rcl.left = min(prcl1->left, prcl2->left);
+            rcl.top = min(prcl1->top, prcl2->top);
+            rcl.right = max(prcl1->right, prcl2->right);
+            rcl.bottom = max(prcl1->bottom, prcl2->bottom);
+            return REGION_bSetRects(newReg, &rcl, 1);
+        }
+    }
+
     if ((ret = REGION_RegionOp(newReg,
                     reg1,
                     reg2,
@@ -1715,6 +1841,65 @@ REGION_SubtractO(
     return TRUE;
 }
 
+/*!
+ *      Subtract an overlapping rect from another one. The result has at
+ *      most 4 rects: the band above, left and right of, and below the
+ *      subtrahend. None of these bands can be coalesced.
+ */
+static
+BOOL
+FASTCALL
+REGION_bSubtractRectFromRect(
+    PREGION regD,
+    const RECTL *prclM,
+    const RECTL *prclS)
+{
+    RECTL arcl[4];
+    ULONG cRects = 0;
+    LONG top, bottom;
+
+    if (prclS->top > prclM->top)
+    {
+        arcl[cRects].left = prclM->left;
+        arcl[cRects].top = prclM->top;
+        arcl[cRects].right = prclM->right;
+        arcl[cRects].bottom = prclS->top;
+        cRects++;
+    }
+
+    top = max(prclM->top, prclS->top);
+    bottom = min(prclM->bottom, prclS->bottom);
+
+    if (prclS->left > prclM->left)
+    {
+        arcl[cRects].left = prclM->left;
+        arcl[cRects].top = top;
+        arcl[cRects].right = prclS->left;
+        arcl[cRects].bottom = bottom;
+        cRects++;
+    }
+
+    if (prclS->right < prclM->right)
+    {
+        arcl[cRects].left = prclS->right;
+        arcl[cRects].top = top;
+        arcl[cRects].right = prclM->right;
+        arcl[cRects].bottom = bottom;
+        cRects++;
+    }
+
+    if (prclS->bottom < prclM->bottom)
+    {
+        arcl[cRects].left = prclM->left;
+        arcl[cRects].top = prclS->bottom;
+        arcl[cRects].right = prclM->right;
+        arcl[cRects].bottom = prclM->bottom;
+        cRects++;
+    }
+
+    return REGION_bSetRects(regD, arcl, cRects);
+}
+
 /*!
  *      Subtract regS from regM and leave the result in regD.
  *      S stands for subtrahend, M for minuend and D for difference.
@@ -1742,6 +1927,11 @@ REGION_SubtractRegion(
         return REGION_CopyRegion(regD, regM);
     }
 
+    if ((regM->rdh.nCount == 1) && (regS->rdh.nCount == 1))
+    {
+        return REGION_bSubtractRectFromRect(regD, &regM->Buffer[0], &regS->Buffer[0]);
+    }
+
     if (!REGION_RegionOp(regD,
                     regM,
                     regS,
@@ -1770,36 +1960,23 @@ REGION_XorRegion(
     PREGION sra,
     PREGION srb)
 {
-    HRGN htra, htrb;
-    PREGION tra, trb;
+    REGION tra, trb;
     BOOL ret;
 
-    // FIXME: Don't use a handle
-    tra = REGION_AllocRgnWithHandle(sra->rdh.nCount + 1);
-    if (tra == NULL)
-    {
-        return FALSE;
-    }
-    htra = tra->BaseObject.hHmgr;
-
-    // FIXME: Don't use a handle
-    trb = REGION_AllocRgnWithHandle(srb->rdh.nCount + 1);
-    if (trb == NULL)
-    {
-        REGION_UnlockRgn(tra);
-        GreDeleteObject(htra);
-        return FALSE;
-    }
-    htrb = trb->BaseObject.hHmgr;
+    /* The temporaries only need a rect buffer, not a region object */
+    tra.Buffer = &tra.rdh.rcBound;
+    tra.rdh.nRgnSize = sizeof(RECT);
+    EMPTY_REGION(&tra);
+    trb.Buffer = &trb.rdh.rcBound;
+    trb.rdh.nRgnSize = sizeof(RECT);
+    EMPTY_REGION(&trb);
 
-    ret = REGION_SubtractRegion(tra, sra, srb) &&
-          REGION_SubtractRegion(trb, srb, sra) &&
-          REGION_UnionRegion(dr, tra, trb);
-    REGION_UnlockRgn(tra);
-    REGION_UnlockRgn(trb);
+    ret = REGION_SubtractRegion(&tra, sra, srb) &&
+          REGION_SubtractRegion(&trb, srb, sra) &&
+          REGION_UnionRegion(dr, &tra, &trb);
 
-    GreDeleteObject(htra);
-    GreDeleteObject(htrb);
+    REGION_vFreeBuffer(&tra);
+    REGION_vFreeBuffer(&trb);
     return ret;
 }
 
@@ -1839,6 +2016,25 @@ REGION_SubtractRectFromRgn(
     return REGION_Complexity(prgnDest);
 }
 
+INT
+FASTCALL
+REGION_IntersectRectWithRgn(
+    PREGION prgnDest,
+    PREGION prgnSrc,
+    const RECTL *prcl)
+{
+    REGION rgnLocal;
+
+    rgnLocal.Buffer = &rgnLocal.rdh.rcBound;
+    rgnLocal.rdh.nCount = ((prcl->left < prcl->right) && (prcl->top < prcl->bottom)) ? 1 : 0;
+    rgnLocal.rdh.nRgnSize = sizeof(RECT);
+    rgnLocal.rdh.rcBound = *prcl;
+    if (!REGION_IntersectRegion(prgnDest, prgnSrc, &rgnLocal))
+        return ERROR;
+
+    return REGION_Complexity(prgnDest);
+}
+
 BOOL
 FASTCALL
 REGION_bCopy(
@@ -1935,9 +2131,7 @@ REGION_bMakeSimpleFrameRgn(
         NT_ASSERT(prgn->rdh.nCount > 1);
         prgn->rdh.nRgnSize = prgn->rdh.nCount * sizeof(RECT);
         NT_ASSERT(prgn->Buffer == &prgn->rdh.rcBound);
-        prgn->Buffer = ExAllocatePoolWithTag(PagedPool,
-                                            prgn->rdh.nRgnSize,
-                                            TAG_REGION);
+        prgn->Buffer = REGION_pAllocRects(&prgn->rdh.nRgnSize);
         if (prgn->Buffer == NULL)
         {
             prgn->rdh.nRgnSize = 0;
@@ -2233,6 +2427,7 @@ REGION_AllocRgnWithHandle(
 
     //hReg = pReg->BaseObject.hHmgr;
 
+    pReg->rdh.nRgnSize = nReg * sizeof(RECT);
     if ((nReg == 0) || (nReg == 1))
     {
         /* Testing shows that > 95% of all regions have only 1 rect.
@@ -2241,9 +2436,7 @@ REGION_AllocRgnWithHandle(
     }
     else
     {
-        pReg->Buffer = ExAllocatePoolWithTag(PagedPool,
-                                             nReg * sizeof(RECT),
-                                             TAG_REGION);
+        pReg->Buffer = REGION_pAllocRects(&pReg->rdh.nRgnSize);
         if (pReg->Buffer == NULL)
         {
             DPRINT1("Could not allocate region buffer\n");
@@ -2255,7 +2448,6 @@ REGION_AllocRgnWithHandle(
     EMPTY_REGION(pReg);
     pReg->rdh.dwSize = sizeof(RGNDATAHEADER);
     pReg->rdh.nCount = nReg;
-    pReg->rdh.nRgnSize = nReg * sizeof(RECT);
     pReg->prgnattr = &pReg->rgnattr;
 
     /* Initialize the region attribute */
@@ -2459,8 +2651,7 @@ REGION_vCleanup(PVOID ObjectBody)
     if (pRgn->prgnattr != &pRgn->rgnattr)
         GdiPoolFree(ppi->pPoolRgnAttr, pRgn->prgnattr);
 
-    if (pRgn->Buffer && pRgn->Buffer != &pRgn->rdh.rcBound)
-        ExFreePoolWithTag(pRgn->Buffer, TAG_REGION);
+    REGION_vFreeBuffer(pRgn);
 }
 
 VOID
@@ -3072,6 +3263,7 @@ REGION_PtsToRegion(
     INT i;
     RECTL *extents, *temp;
     INT numRects;
+    ULONG cjSize;
 
     extents = &reg->rdh.rcBound;
 
@@ -3083,7 +3275,8 @@ REGION_PtsToRegion(
         numRects = 1;
     }
 
-    temp = ExAllocatePoolWithTag(PagedPool, numRects * sizeof(RECT), TAG_REGION);
+    cjSize = numRects * sizeof(RECT);
+    temp = REGION_pAllocRects(&cjSize);
     if (temp == NULL)
     {
         return 0;
@@ -3092,10 +3285,10 @@ REGION_PtsToRegion(
     if (reg->Buffer != NULL)
     {
         COPY_RECTS(temp, reg->Buffer, reg->rdh.nCount);
-        if (reg->Buffer != &reg->rdh.rcBound)
-            ExFreePoolWithTag(reg->Buffer, TAG_REGION);
+        REGION_vFreeBuffer(reg);
     }
     reg->Buffer = temp;
+    reg->rdh.nRgnSize = cjSize;
 
     reg->rdh.nCount = numRects;
     CurPtBlock = FirstPtBlock;
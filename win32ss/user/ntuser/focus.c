@@ -1532,7 +1532,7 @@ NtUserGetForegroundWindow(VOID)
    DECLARE_RETURN(HWND);
 
    TRACE("Enter NtUserGetForegroundWindow\n");
-   UserEnterExclusive();
+   UserEnterShared();
 
    RETURN( UserGetForegroundWindow());
 
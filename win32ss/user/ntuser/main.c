@@ -414,6 +414,7 @@ UserDeleteW32Thread(PTHREADINFO pti)
    }
 
    MsqCleanupThreadMsgs(pti);
+   MsqFreePostSlots(pti);
 
    ObDereferenceObject(pti->pEThread);
 
@@ -485,6 +486,7 @@ InitThreadCallback(PETHREAD Thread)
     InitializeListHead(&ptiCurrent->WindowListHead);
     InitializeListHead(&ptiCurrent->W32CallbackListHead);
     InitializeListHead(&ptiCurrent->PostedMessagesListHead);
+    ExInitializePushLock(&ptiCurrent->PostLock);
     InitializeListHead(&ptiCurrent->SentMessagesListHead);
     InitializeListHead(&ptiCurrent->PtiLink);
     for (i = 0; i < NB_HOOKS; i++)
@@ -981,6 +983,8 @@ DriverEntry(
 
     NT_ROF(InitGdiHandleTable());
     NT_ROF(InitPaletteImpl());
+    NT_ROF(InitXlateImpl());
+    NT_ROF(InitRegionImpl());
 
     /* Create stock objects, ie. precreated objects commonly
        used by win32 applications */
@@ -2096,10 +2096,16 @@ IntGetQueueStatus(DWORD Changes)
        Low  word, types of messages that have been added to the queue and that
                   are still in the queue
      */
+    /* NtUserGetThreadState calls us with the user lock shared, keep
+       posters from setting bits while we clear them */
+    ExAcquirePushLockExclusive(&pti->PostLock);
+
     Result = MAKELONG(pti->pcti->fsChangeBits & Changes, pti->pcti->fsWakeBits & Changes);
 
     pti->pcti->fsChangeBits &= ~Changes;
 
+    ExReleasePushLockExclusive(&pti->PostLock);
+
     return Result;
 }
 
@@ -2229,7 +2235,18 @@ NtUserPostMessage(HWND hWnd,
 {
     BOOL ret;
 
-    UserEnterExclusive();
+    /* A plain post to a window only queues the message and wakes its
+       thread, which is safe with the user lock shared. Broadcasts, thread
+       posts (gptiCurrent) and DDE (which may allocate objects) are not. */
+    if (hWnd && hWnd != HWND_BROADCAST && hWnd != HWND_TOPMOST &&
+        !(Msg >= WM_DDE_FIRST && Msg <= WM_DDE_LAST))
+    {
+        UserEnterShared();
+    }
+    else
+    {
+        UserEnterExclusive();
+    }
 
     ret = UserPostMessage(hWnd, Msg, wParam, lParam);
 
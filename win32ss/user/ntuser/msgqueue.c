@@ -13,9 +13,13 @@ DBG_DEFAULT_CHANNEL(UserMsgQ);
 
 /* GLOBALS *******************************************************************/
 
+/* Posted messages are first taken from a block of this many messages per
+   receiving thread, see MsqAllocPostedMessage. One bit each in a LONG. */
+#define MSQ_POST_SLOTS 32
+
 static PPAGED_LOOKASIDE_LIST pgMessageLookasideList;
 static PPAGED_LOOKASIDE_LIST pgSendMsgLookasideList;
-INT PostMsgCount = 0;
+LONG PostMsgCount = 0;
 INT SendMsgCount = 0;
 PUSER_MESSAGE_QUEUE gpqCursor;
 ULONG_PTR gdwMouseMoveExtraInfo = 0;
@@ -437,7 +441,10 @@ MsqWakeQueue(PTHREADINFO pti, DWORD MessageBits, BOOL KeyEvent)
    if (MessageBits & QS_HOTKEY)      pti->nCntsQBits[QSRosHotKey]++;
    if (MessageBits & QS_EVENT)       pti->nCntsQBits[QSRosEvent]++;
 
-   if (KeyEvent)
+   /* The event auto-resets when a wait is satisfied. If it is still
+      signaled, the receiver hasn't consumed the last wake yet and will
+      see our bits when it does, so don't go through the dispatcher. */
+   if (KeyEvent && !KeReadStateEvent(pti->pEventQueueServer))
       KeSetEvent(pti->pEventQueueServer, IO_NO_INCREMENT, FALSE);
 }
 
@@ -740,23 +747,82 @@ MsqCreateMessage(LPMSG Msg)
 
    RtlZeroMemory(Message, sizeof(*Message));
    RtlMoveMemory(&Message->Msg, Msg, sizeof(MSG));
-   PostMsgCount++;
+   InterlockedIncrement(&PostMsgCount);
+   return Message;
+}
+
+/*
+ * Allocate a message posted to pti. The caller holds pti->PostLock, so
+ * only frees can race with us here, and they only ever clear bits.
+ */
+static PUSER_MESSAGE FASTCALL
+MsqAllocPostedMessage(PTHREADINFO pti, LPMSG Msg)
+{
+   PUSER_MESSAGE Message;
+   ULONG Slot;
+
+   if (!pti->pPostSlots)
+   {
+      /* Only threads that get messages posted pay for the block */
+      pti->pPostSlots = ExAllocatePoolWithTag(PagedPool,
+                                              MSQ_POST_SLOTS * sizeof(USER_MESSAGE),
+                                              TAG_USRMSG);
+      pti->PostSlotsUsed = 0;
+   }
+
+   if (!pti->pPostSlots || !BitScanForward(&Slot, ~(ULONG)pti->PostSlotsUsed))
+   {
+      /* The block is full, overflow to the lookaside list */
+      return MsqCreateMessage(Msg);
+   }
+
+   InterlockedOr(&pti->PostSlotsUsed, (LONG)(1UL << Slot));
+   Message = &pti->pPostSlots[Slot];
+
+   RtlZeroMemory(Message, sizeof(*Message));
+   RtlMoveMemory(&Message->Msg, Msg, sizeof(MSG));
+   Message->iPostSlot = (UCHAR)(Slot + 1);
+   InterlockedIncrement(&PostMsgCount);
    return Message;
 }
 
 VOID FASTCALL
 MsqDestroyMessage(PUSER_MESSAGE Message)
 {
+   PTHREADINFO pti = Message->pti;
+
    TRACE("Post Destroy %d\n",PostMsgCount);
-   if (Message->pti == NULL)
+   if (pti == NULL)
    {
       ERR("Double Free Message\n");
       return;
    }
    RemoveEntryList(&Message->ListEntry);
    Message->pti = NULL;
-   ExFreeToPagedLookasideList(pgMessageLookasideList, Message);
-   PostMsgCount--;
+
+   /* Only posted messages come from a slot, and those are destroyed
+      before their thread goes away */
+   if (Message->iPostSlot)
+   {
+      ASSERT(Message == &pti->pPostSlots[Message->iPostSlot - 1]);
+      InterlockedAnd(&pti->PostSlotsUsed, ~(LONG)(1UL << (Message->iPostSlot - 1)));
+   }
+   else
+   {
+      ExFreeToPagedLookasideList(pgMessageLookasideList, Message);
+   }
+   InterlockedDecrement(&PostMsgCount);
+}
+
+VOID FASTCALL
+MsqFreePostSlots(PTHREADINFO pti)
+{
+   if (pti->pPostSlots)
+   {
+      ASSERT(pti->PostSlotsUsed == 0);
+      ExFreePoolWithTag(pti->pPostSlots, TAG_USRMSG);
+      pti->pPostSlots = NULL;
+   }
 }
 
 PUSER_SENT_MESSAGE FASTCALL
@@ -1351,12 +1417,28 @@ MsqPostMessage(PTHREADINFO pti,
       return;
    }
 
-   if(!(Message = MsqCreateMessage(Msg)))
+   MessageQueue = pti->MessageQueue;
+
+   /* NtUserPostMessage only holds the user lock shared, so posts to the
+      same thread from different threads can race here */
+   ExAcquirePushLockExclusive(&pti->PostLock);
+
+   if (!HardwareMessage)
+      Message = MsqAllocPostedMessage(pti, Msg);
+   else
+      Message = MsqCreateMessage(Msg);
+
+   if (!Message)
    {
+      ExReleasePushLockExclusive(&pti->PostLock);
       return;
    }
 
-   MessageQueue = pti->MessageQueue;
+   if (Msg->message == WM_HOTKEY) MessageBits |= QS_HOTKEY; // Justin Case, just set it.
+   Message->dwQEvent = dwQEvent;
+   Message->ExtraInfo = ExtraInfo;
+   Message->QS_Flags = MessageBits;
+   Message->pti = pti;
 
    if (!HardwareMessage)
    {
@@ -1367,12 +1449,9 @@ MsqPostMessage(PTHREADINFO pti,
        InsertTailList(&MessageQueue->HardwareMessagesListHead, &Message->ListEntry);
    }
 
-   if (Msg->message == WM_HOTKEY) MessageBits |= QS_HOTKEY; // Justin Case, just set it.
-   Message->dwQEvent = dwQEvent;
-   Message->ExtraInfo = ExtraInfo;
-   Message->QS_Flags = MessageBits;
-   Message->pti = pti;
    MsqWakeQueue(pti, MessageBits, TRUE);
+
+   ExReleasePushLockExclusive(&pti->PostLock);
    TRACE("Post Message %d\n",PostMsgCount);
 }
 
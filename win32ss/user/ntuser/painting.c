@@ -642,14 +642,7 @@ IntInvalidateWindows(PWND Wnd, PREGION Rgn, ULONG Flags)
        */
       if ((Flags & RDW_INVALIDATE) != 0 && (Flags & RDW_FRAME) == 0)
       {
-         PREGION RgnClient;
-
-         RgnClient = IntSysCreateRectpRgnIndirect(&Wnd->rcClient);
-         if (RgnClient)
-         {
-             RgnType = IntGdiCombineRgn(Rgn, Rgn, RgnClient, RGN_AND);
-             REGION_Delete(RgnClient);
-         }
+         RgnType = REGION_IntersectRectWithRgn(Rgn, Rgn, &Wnd->rcClient);
       }
 
       /*
@@ -658,12 +651,7 @@ IntInvalidateWindows(PWND Wnd, PREGION Rgn, ULONG Flags)
 
       if (!Wnd->hrgnClip || (Wnd->style & WS_MINIMIZE))
       {
-         PREGION RgnWindow = IntSysCreateRectpRgnIndirect(&Wnd->rcWindow);
-         if (RgnWindow)
-         {
-             RgnType = IntGdiCombineRgn(Rgn, Rgn, RgnWindow, RGN_AND);
-             REGION_Delete(RgnWindow);
-         }
+         RgnType = REGION_IntersectRectWithRgn(Rgn, Rgn, &Wnd->rcWindow);
       }
       else
       {
@@ -146,6 +146,11 @@ typedef struct _THREADINFO
     // Hard list QS_MOUSE|QS_KEY only
     // Accounting of queue bit sets, the rest are flags. QS_TIMER QS_PAINT counts are handled in thread information.
     DWORD nCntsQBits[QSIDCOUNTS]; // QS_KEY QS_MOUSEMOVE QS_MOUSEBUTTON QS_POSTMESSAGE QS_SENDMESSAGE QS_HOTKEY
+    // Posters only hold the user lock shared, this serializes them on the post list and the wake bits.
+    EX_PUSH_LOCK PostLock;
+    // Preallocated posted messages, bit n of PostSlotsUsed is set while slot n is in use.
+    struct _USER_MESSAGE *pPostSlots;
+    LONG PostSlotsUsed;
 
     LIST_ENTRY WindowListHead;
     LIST_ENTRY W32CallbackListHead;